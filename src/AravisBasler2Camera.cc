@@ -141,7 +141,9 @@ namespace karabo {
         // In case of synchronization loss, a camera reset could be needed.
 
         // Karabo current timestamp
-        m_reference_karabo_time = this->getActualTimestamp();
+        TimestampReference reference;
+        reference.karabo_time = this->getActualTimestamp();
+        reference.tick_frequency = this->get<int>("tickFrequency");
 
         boost::mutex::scoped_lock camera_lock(m_camera_mtx);
 
@@ -150,7 +152,7 @@ namespace karabo {
         // thus this is the precision we can aim to in the synchronization.
         arv_camera_execute_command(m_camera, "TimestampLatch", &error);
         if (error == nullptr) {
-            m_reference_camera_timestamp = arv_camera_get_integer(m_camera, "TimestampLatchValue", &error);
+            reference.camera_time = arv_camera_get_integer(m_camera, "TimestampLatchValue", &error);
         }
 
         if (error != nullptr) {
@@ -160,6 +162,8 @@ namespace karabo {
             return false; // failure
         }
 
+        // The reference is swapped atomically, images being processed are not blocked
+        this->set_timestamp_reference(reference);
         return true; // success
     }
 
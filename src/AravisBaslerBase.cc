@@ -165,7 +165,7 @@ namespace karabo {
         // Get timestamp from buffer
         gint64 timestamp;
         {
-            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+            boost::mutex::scoped_lock parser_lock(m_parser_mtx);
             timestamp = arv_chunk_parser_get_integer_value(m_parser, buffer, tsFeature.c_str(), &error);
         }
         if (error != nullptr) {
@@ -175,8 +175,13 @@ namespace karabo {
             return false; // failure
         }
 
-        const int tick_frequency = this->get<int>("tickFrequency");
-        if (tick_frequency == 0) {
+        const std::shared_ptr<const TimestampReference> reference = this->get_timestamp_reference();
+        if (!reference) {
+            // Not synchronized yet
+            return false; // failure
+        }
+
+        if (reference->tick_frequency == 0) {
             KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
                                        << ": Could not read image timestamp: tick_frequency is 0";
             return false; // failure
@@ -185,7 +190,7 @@ namespace karabo {
         // Elapsed time since last synchronization.
         // NB This can be negative, if the image acquisition started before
         //    synchronization, but finished after.
-        const double elapsed_t = double(timestamp - m_reference_camera_timestamp) / tick_frequency;
+        const double elapsed_t = double(timestamp - reference->camera_time) / reference->tick_frequency;
 
         // Split elapsed time in seconds and attoseconds, then convert to TimeDuration.
         // elapsed_t is in seconds and TimeDuration expects fractions in attoseconds,
@@ -198,7 +203,7 @@ namespace karabo {
         const TimeDuration duration(seconds, fractions);
 
         // Calculate frame epochstamp from refrence time and elapsed time
-        Epochstamp epoch(m_reference_karabo_time.getEpochstamp());
+        Epochstamp epoch(reference->karabo_time.getEpochstamp());
         if (seconds <= m_max_correction_time) {
             if (this->get<bool>("wouldCorrectAboveMaxTime")) {
                 this->set("wouldCorrectAboveMaxTime", false);
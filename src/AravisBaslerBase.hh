@@ -37,7 +37,6 @@ namespace karabo {
 
        protected:
         bool m_ptp_enabled;
-        gint64 m_reference_camera_timestamp;
 
        private:
         void postAcquisitionStop() override;
@@ -186,7 +186,9 @@ namespace karabo {
         }
 
         // Karabo current timestamp
-        m_reference_karabo_time = this->getActualTimestamp();
+        TimestampReference reference;
+        reference.karabo_time = this->getActualTimestamp();
+        reference.tick_frequency = this->get<int>("tickFrequency");
 
         // Get current timestamp on the camera.
         // It has been verified on an acA640-120gm that this takes 1 ms ca.,
@@ -194,12 +196,12 @@ namespace karabo {
         if (m_is_gv_device) { // GEV camera
             arv_camera_execute_command(m_camera, "GevTimestampControlLatch", &error);
             if (error == nullptr) {
-                m_reference_camera_timestamp = arv_camera_get_integer(m_camera, "GevTimestampValue", &error);
+                reference.camera_time = arv_camera_get_integer(m_camera, "GevTimestampValue", &error);
             }
         } else { // USB3V camera
             arv_camera_execute_command(m_camera, "TimestampLatch", &error);
             if (error == nullptr) {
-                m_reference_camera_timestamp = arv_camera_get_integer(m_camera, "TimestampLatchValue", &error);
+                reference.camera_time = arv_camera_get_integer(m_camera, "TimestampLatchValue", &error);
             }
         }
 
@@ -209,6 +211,8 @@ namespace karabo {
             return false; // failure
         }
 
+        // The reference is swapped atomically, images being processed are not blocked
+        this->set_timestamp_reference(reference);
         return true; // success
     }
 
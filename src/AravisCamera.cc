@@ -8,7 +8,17 @@
 
 #include "AravisCamera.hh"
 
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include <boost/algorithm/string/trim.hpp>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <tuple>
+#include <type_traits>
 
 using namespace std;
 
@@ -27,6 +37,8 @@ namespace karabo {
 
     boost::mutex AravisCamera::m_connect_mtx;
 
+    const char* const AravisCamera::m_compressionCodec = "bitshuffle-lz4";
+
     // m_supportedPixelFormats contains the list of pixel formats supported by the process_buffer and
     // updateOutputSchema functions
     const std::set<ArvPixelFormat> AravisCamera::m_supportedPixelFormats = {
@@ -47,6 +59,32 @@ namespace karabo {
           ARV_PIXEL_FORMAT_BAYER_GR_12P,   ARV_PIXEL_FORMAT_YCBCR_422_8,
           ARV_PIXEL_FORMAT_YUV_422_PACKED, ARV_PIXEL_FORMAT_YUV_422_YUYV_PACKED};
 
+    // Each software ROI has an output channel, thus their number is fixed
+    const unsigned int AravisCamera::m_maxSoftwareRois = 4;
+
+    // All the statuses defined in ArvBufferStatus, in the same order
+    const std::vector<AravisCamera::BufferStatusKey> AravisCamera::m_bufferStatusKeys = {
+          {ARV_BUFFER_STATUS_UNKNOWN, "unknown", "Unknown"},
+          {ARV_BUFFER_STATUS_SUCCESS, "success", "Success"},
+          {ARV_BUFFER_STATUS_CLEARED, "cleared", "Cleared"},
+          {ARV_BUFFER_STATUS_TIMEOUT, "timeout", "Timeout"},
+          {ARV_BUFFER_STATUS_MISSING_PACKETS, "missingPackets", "Missing Packets"},
+          {ARV_BUFFER_STATUS_WRONG_PACKET_ID, "wrongPacketId", "Wrong Packet ID"},
+          {ARV_BUFFER_STATUS_SIZE_MISMATCH, "sizeMismatch", "Size Mismatch"},
+          {ARV_BUFFER_STATUS_FILLING, "filling", "Filling"},
+          {ARV_BUFFER_STATUS_ABORTED, "aborted", "Aborted"}};
+
+    // The stages of an image through the pipeline, from the stream callback to the buffer being pushed back
+    const std::vector<AravisCamera::PipelineStage> AravisCamera::m_pipelineStages = {
+          {"queueWait", "Queue Wait", &FrameTimes::received, &FrameTimes::dequeued},
+          {"workerWait", "Worker Wait", &FrameTimes::dequeued, &FrameTimes::started},
+          {"process", "Unpack, Flip and Rotate", &FrameTimes::started, &FrameTimes::processed},
+          {"postProcess", "Correction, Statistics and Compression", &FrameTimes::processed, &FrameTimes::transformed},
+          {"reorderWait", "Reorder Wait", &FrameTimes::transformed, &FrameTimes::writing},
+          {"write", "Write Channels", &FrameTimes::writing, &FrameTimes::written},
+          {"release", "Other Outputs and Release", &FrameTimes::written, &FrameTimes::done},
+          {"total", "Total", &FrameTimes::received, &FrameTimes::done}};
+
 
     void AravisCamera::expectedParameters(Schema& expected) {
         OVERWRITE_ELEMENT(expected)
@@ -136,2323 +174,5804 @@ namespace karabo {
               .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        SLOT_ELEMENT(expected).key("acquire").displayedName("Acquire").allowedStates(State::ON).commit();
+        // GEV cameras only
+        NODE_ELEMENT(expected)
+              .key("streamTuning")
+              .displayedName("Stream Tuning")
+              .description(
+                    "The receiving side of the GigE Vision stream. The settings are applied when the stream is "
+                    "created, i.e. at the next acquisition start.")
+              .commit();
 
-        SLOT_ELEMENT(expected).key("stop").displayedName("Stop").allowedStates(State::ACQUIRING).commit();
+        STRING_ELEMENT(expected)
+              .key("streamTuning.socketBufferMode")
+              .displayedName("Socket Buffer Mode")
+              .description(
+                    "In 'Auto' mode the socket receive buffer is sized after the image payload, limited by "
+                    "'socketBufferSize' if not 0. In 'Fixed' mode it has 'socketBufferSize' bytes, or the system "
+                    "default if 0.")
+              .assignmentOptional()
+              .defaultValue("Auto")
+              .options("Auto,Fixed")
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
 
-        SLOT_ELEMENT(expected)
-              .key("trigger")
-              .displayedName("Software Trigger")
-              .allowedStates(State::ACQUIRING)
+        UINT32_ELEMENT(expected)
+              .key("streamTuning.socketBufferSize")
+              .displayedName("Socket Buffer Size")
+              .description(
+                    "The size of the socket receive buffer. The kernel does not grant more than net.core.rmem_max, "
+                    "unless the device server has the CAP_NET_ADMIN capability.")
+              .assignmentOptional()
+              .defaultValue(0)
+              .unit(Unit::BYTE)
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        SLOT_ELEMENT(expected)
-              .key("refresh")
-              .displayedName("Refresh")
-              .description("Refresh hardware parameters and options.")
-              .allowedStates(State::ON)
+        UINT32_ELEMENT(expected)
+              .key("streamTuning.packetTimeout")
+              .displayedName("Packet Timeout")
+              .description("The time to wait for a missing packet, before its resend is requested.")
+              .assignmentOptional()
+              .defaultValue(20000)
+              .minInc(1000)
+              .unit(Unit::SECOND)
+              .metricPrefix(MetricPrefix::MICRO)
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        SLOT_ELEMENT(expected)
-              .key("reset")
-              .displayedName("Reset")
-              .description("'Software' reset, i.e. just reset the error state.")
-              .allowedStates(State::ERROR)
+        UINT32_ELEMENT(expected)
+              .key("streamTuning.frameRetention")
+              .displayedName("Frame Retention")
+              .description("The time to wait for the missing packets of an image, before it is given up.")
+              .assignmentOptional()
+              .defaultValue(100000)
+              .minInc(1000)
+              .unit(Unit::SECOND)
+              .metricPrefix(MetricPrefix::MICRO)
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        NODE_ELEMENT(expected).key("frameRate").displayedName("Frame Rate").commit();
+        STRING_ELEMENT(expected)
+              .key("streamTuning.packetResend")
+              .displayedName("Packet Resend")
+              .description("Whether the missing packets are requested again from the camera.")
+              .assignmentOptional()
+              .defaultValue("Always")
+              .options("Always,Never")
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
 
         BOOL_ELEMENT(expected)
-              .key("frameRate.enable")
-              .displayedName("Frame Rate Enable")
-              .description("Enable the frame rate control.")
+              .key("streamTuning.packetSocket")
+              .displayedName("Packet Socket")
+              .description(
+                    "Receive the packets with a memory-mapped packet socket (PACKET_MMAP), which is faster than a "
+                    "regular socket. It requires the CAP_NET_RAW capability, otherwise a regular socket is used.")
               .assignmentOptional()
-              .defaultValue(false)
+              .defaultValue(true)
               .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        FLOAT_ELEMENT(expected)
-              .key("frameRate.target")
-              .displayedName("Target Frame Rate")
+        UINT32_ELEMENT(expected)
+              .key("streamTuning.socketBufferLimit")
+              .displayedName("Socket Buffer Limit")
               .description(
-                    "Sets the 'target' value of the acquisition frame rate on the camera. "
-                    "Please be aware that if you enable this feature in combination with external trigger, "
-                    "the resulting 'actual' frame rate will most likely be smaller.")
+                    "The socket receive buffer size granted by the kernel to a probe socket, for the size the stream "
+                    "requests, 0 for the system default. The stream socket itself is not accessible, it gets the "
+                    "same size unless the limits change in the meanwhile.")
+              .unit(Unit::BYTE)
+              .readOnly()
+              .initialValue(0)
+              .commit();
+
+        BOOL_ELEMENT(expected)
+              .key("streamTuning.packetSocketAvailable")
+              .displayedName("Packet Socket Available")
+              .description(
+                    "Whether a probe packet socket could be opened, i.e. whether the stream can use one. It does not "
+                    "tell whether the stream actually uses it.")
+              .readOnly()
+              .initialValue(false)
+              .commit();
+
+        NODE_ELEMENT(expected)
+              .key("bufferPool")
+              .displayedName("Stream Buffer Pool")
+              .description("The pool of buffers the stream fills with incoming images.")
+              .commit();
+
+        STRING_ELEMENT(expected)
+              .key("bufferPool.mode")
+              .displayedName("Pool Mode")
+              .description(
+                    "In 'Fixed' mode the stream gets 'count' buffers. In 'Adaptive' mode the number of buffers is "
+                    "calculated from the payload size, the frame rate and the memory budget, and the pool is grown "
+                    "during acquisition if the stream reports underruns.")
               .assignmentOptional()
-              .defaultValue(10.)
-              .minInc(0.)
-              .unit(Unit::HERTZ)
+              .defaultValue("Fixed")
+              .options("Fixed,Adaptive")
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        UINT32_ELEMENT(expected)
+              .key("bufferPool.count")
+              .displayedName("Buffer Count")
+              .description("The number of buffers in 'Fixed' mode, the minimum number of buffers in 'Adaptive' mode.")
+              .assignmentOptional()
+              .defaultValue(10)
+              .minInc(2)
+              .maxInc(10000)
               .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
         FLOAT_ELEMENT(expected)
-              .key("frameRate.actual")
-              .displayedName("Actual Frame Rate")
-              .description("The measured frame rate.")
-              .unit(Unit::HERTZ)
-              .readOnly()
-              .defaultValue(0.)
+              .key("bufferPool.slack")
+              .displayedName("Time Slack")
+              .description(
+                    "Only used in 'Adaptive' mode: the pool is sized to hold this much time worth of images, at the "
+                    "measured frame rate.")
+              .assignmentOptional()
+              .defaultValue(200.f)
+              .minExc(0.f)
+              .unit(Unit::SECOND)
+              .metricPrefix(MetricPrefix::MILLI)
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        UINT64_ELEMENT(expected)
-              .key("errorCount")
-              .displayedName("Acq. Error Count")
-              .description("The number of errors occurred during acquisition.")
+        UINT32_ELEMENT(expected)
+              .key("bufferPool.memoryBudget")
+              .displayedName("Memory Budget")
+              .description("Only used in 'Adaptive' mode: the maximum memory which can be allocated for the pool.")
+              .assignmentOptional()
+              .defaultValue(1024)
+              .minInc(1)
+              .unit(Unit::BYTE)
+              .metricPrefix(MetricPrefix::MEGA)
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        BOOL_ELEMENT(expected)
+              .key("bufferPool.zeroCopy")
+              .displayedName("Zero-Copy Output")
+              .description(
+                    "If true, images are handed over to the output channels together with the ownership of their "
+                    "memory, without being copied: a stream buffer is given back to the stream only when the last "
+                    "consumer (e.g. output channel, preview) releases the image. The images queued for recording "
+                    "are copied. "
+                    "Buffers held by slow consumers are not available to the stream, thus a bigger pool may be "
+                    "needed.")
+              .assignmentOptional()
+              .defaultValue(false)
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        UINT32_ELEMENT(expected)
+              .key("bufferPool.size")
+              .displayedName("Pool Size")
+              .description("The number of buffers currently allocated to the stream.")
               .unit(Unit::COUNT)
               .readOnly()
               .defaultValue(0)
               .commit();
 
-        STRING_ELEMENT(expected)
-              .key("lastError")
-              .displayedName("Last Acq. Error")
-              .description("Description of the last error occurred during acquisition.")
+        UINT32_ELEMENT(expected)
+              .key("bufferPool.occupancy")
+              .displayedName("Pool Occupancy")
+              .description(
+                    "The number of buffers which are not available to the stream for filling, i.e. "
+                    "waiting to be processed or being processed.")
+              .unit(Unit::COUNT)
               .readOnly()
-              .defaultValue("")
+              .defaultValue(0)
               .commit();
 
         UINT64_ELEMENT(expected)
-              .key("timestampErrorCount")
-              .displayedName("Timestamp Error Count")
-              .description("The number of errors occurred while reading image timestamp.")
+              .key("bufferPool.underruns")
+              .displayedName("Underruns")
+              .description("The number of times the stream had no free buffer to fill, since acquisition start.")
               .unit(Unit::COUNT)
               .readOnly()
               .defaultValue(0)
               .commit();
 
-        STRING_ELEMENT(expected)
-              .key("lastTimestampError")
-              .displayedName("Last Timestamp Error")
-              .description("Description of the last error occurred while reading image timestamp.")
+        UINT32_ELEMENT(expected)
+              .key("bufferPool.queueDepth")
+              .displayedName("Queue Depth")
+              .description("The number of received images waiting to be processed.")
+              .unit(Unit::COUNT)
               .readOnly()
-              .defaultValue("")
+              .defaultValue(0)
+              .commit();
+
+        UINT32_ELEMENT(expected)
+              .key("bufferPool.queueHighWaterMark")
+              .displayedName("Queue High-Water Mark")
+              .description("The maximum number of received images waiting to be processed, since acquisition start.")
+              .unit(Unit::COUNT)
+              .readOnly()
+              .defaultValue(0)
               .commit();
 
         NODE_ELEMENT(expected)
-              .key("latency")
-              .displayedName("Image Latency")
+              .key("streamStatistics")
+              .displayedName("Stream Statistics")
               .description(
-                    "The latency between the image timestamp - if available - and the "
-                    "reception time. The reference interval is 1 s.")
+                    "The statistics of the stream receiving the images, since acquisition start. They help sizing "
+                    "the network and spotting problems of the network interface before images are lost.")
               .commit();
 
+        const std::vector<std::tuple<std::string, std::string, std::string>> streamCounters = {
+              {"completed", "Completed Buffers", "The number of buffers successfully filled by the stream."},
+              {"failures", "Failures", "The number of buffers which could not be filled, e.g. incomplete images."},
+              {"underruns", "Underruns", "The number of times the stream had no free buffer to fill."},
+              {"resentPackets", "Resent Packets", "The number of packets resent by the camera on request."},
+              {"missingPackets", "Missing Packets", "The number of packets never received, even if requested again."},
+              {"ignoredPackets", "Ignored Packets", "The number of packets received but ignored, e.g. late ones."},
+              {"timeouts", "Timeouts", "The number of images given up, as their packets took too long to come."},
+              {"queueOverflows", "Queue Overflows",
+               "The number of images dropped as the processing queue was full."}};
+        for (const auto& [key, name, description] : streamCounters) {
+            UINT64_ELEMENT(expected)
+                  .key("streamStatistics." + key)
+                  .displayedName(name)
+                  .description(description)
+                  .unit(Unit::COUNT)
+                  .readOnly()
+                  .initialValue(0ull)
+                  .commit();
+        }
+
         FLOAT_ELEMENT(expected)
-              .key("latency.mean")
-              .displayedName("Mean Latency")
-              .description("Mean image latency.")
-              .unit(Unit::SECOND)
-              .metricPrefix(MetricPrefix::MILLI)
+              .key("streamStatistics.bandwidth")
+              .displayedName("Payload Bandwidth")
+              .description("The image payload received per second, protocol overhead excluded.")
+              .unit(Unit::BYTE)
+              .metricPrefix(MetricPrefix::MEGA)
               .readOnly()
-              .defaultValue(0.)
+              .initialValue(0.f)
               .commit();
 
         FLOAT_ELEMENT(expected)
-              .key("latency.min")
-              .displayedName("Min Latency")
-              .description("Minimum image latency.")
-              .unit(Unit::SECOND)
-              .metricPrefix(MetricPrefix::MILLI)
+              .key("streamStatistics.linkCapacity")
+              .displayedName("Link Capacity")
+              .description("The capacity per second of the link of the camera, as reported by it. 0 if unknown.")
+              .unit(Unit::BYTE)
+              .metricPrefix(MetricPrefix::MEGA)
               .readOnly()
-              .defaultValue(0.)
+              .initialValue(0.f)
               .commit();
 
         FLOAT_ELEMENT(expected)
-              .key("latency.max")
-              .displayedName("Max Latency")
-              .description("Maximum image latency.")
-              .unit(Unit::SECOND)
-              .metricPrefix(MetricPrefix::MILLI)
+              .key("streamStatistics.linkUsage")
+              .displayedName("Link Usage")
+              .description("The payload bandwidth relative to the link capacity.")
+              .unit(Unit::PERCENT)
               .readOnly()
-              .defaultValue(0.)
+              .initialValue(0.f)
               .commit();
 
-        INT32_ELEMENT(expected)
-              .key("tickFrequency")
-              .displayedName("Tick Frequency")
-              .description("This value indicates the number of clock ticks per second.")
-              .unit(Unit::HERTZ)
-              .readOnly()
+        NODE_ELEMENT(expected)
+              .key("streamStatistics.status")
+              .displayedName("Buffer Status")
+              .description("The number of buffers completed by the stream, per status.")
               .commit();
 
-        INT32_ELEMENT(expected)
-              .key("pollingInterval")
-              .displayedName("Polling Interval")
-              .description("The interval for polling the camera for read-out values.")
+        for (const BufferStatusKey& status : m_bufferStatusKeys) {
+            UINT64_ELEMENT(expected)
+                  .key(std::string("streamStatistics.status.") + status.key)
+                  .displayedName(status.name)
+                  .unit(Unit::COUNT)
+                  .readOnly()
+                  .initialValue(0ull)
+                  .commit();
+        }
+
+        NODE_ELEMENT(expected)
+              .key("processing")
+              .displayedName("Image Processing")
+              .description(
+                    "The processing of the received images: unpacking, demosaicing, YUV conversion, flipping and "
+                    "rotation.")
+              .commit();
+
+        UINT32_ELEMENT(expected)
+              .key("processing.workers")
+              .displayedName("Worker Threads")
+              .description(
+                    "The number of threads processing images concurrently. The images are written to the output "
+                    "channels in order of reception. If 0, the images are processed one at a time.")
               .assignmentOptional()
-              .defaultValue(20)
-              .unit(Unit::SECOND)
-              .minInc(5)
-              .maxInc(60)
+              .defaultValue(0)
+              .minInc(0)
+              .maxInc(64)
               .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        STRING_ELEMENT(expected).key("camId").displayedName("Camera ID").readOnly().defaultValue("").commit();
-
         STRING_ELEMENT(expected)
-              .key("vendor")
-              .displayedName("Vendor Name")
-              .description("The vendor of the camera.")
+              .key("processing.instructionSet")
+              .displayedName("Instruction Set")
+              .description(
+                    "The instruction set used for unpacking, demosaicing and converting the pixels, detected at "
+                    "start-up.")
               .readOnly()
               .defaultValue("")
               .commit();
 
-        STRING_ELEMENT(expected)
-              .key("supportedVendor")
-              .displayedName("Supported Vendor")
-              .description("The vendor supported by this Karabo device.")
+        FLOAT_ELEMENT(expected)
+              .key("processing.processTime")
+              .displayedName("Processing Time")
+              .description("The mean time spent unpacking, demosaicing, converting, flipping and rotating an image.")
+              .unit(Unit::SECOND)
+              .metricPrefix(MetricPrefix::MILLI)
               .readOnly()
-              .defaultValue("")
+              .defaultValue(0.)
               .commit();
 
-        STRING_ELEMENT(expected)
-              .key("model")
-              .displayedName("Model Name")
-              .description("The model of the camera.")
+        FLOAT_ELEMENT(expected)
+              .key("processing.writeTime")
+              .displayedName("Writing Time")
+              .description("The mean time spent writing an image to the output channels.")
+              .unit(Unit::SECOND)
+              .metricPrefix(MetricPrefix::MILLI)
               .readOnly()
-              .defaultValue("")
+              .defaultValue(0.)
               .commit();
 
-        VECTOR_STRING_ELEMENT(expected)
-              .key("supportedModels")
-              .displayedName("Supported Models")
-              .description("The camera models supported by this Karabo device.")
-              .readOnly()
-              .defaultValue({})
+        NODE_ELEMENT(expected)
+              .key("timing")
+              .displayedName("Pipeline Timing")
+              .description(
+                    "The time spent by the images in each stage of the pipeline, measured with a monotonic clock "
+                    "on the host, from the stream callback to the stream buffer being pushed back. Unlike 'latency', "
+                    "the time spent in the camera and on the network is not included. The reference interval is 1 s.")
               .commit();
 
-        INT32_ELEMENT(expected).key("width").displayedName("Sensor Width").readOnly().defaultValue(0).commit();
+        for (const PipelineStage& stage : m_pipelineStages) {
+            const std::string key = std::string("timing.") + stage.key;
+            NODE_ELEMENT(expected).key(key).displayedName(stage.name).commit();
+
+            FLOAT_ELEMENT(expected)
+                  .key(key + ".p50")
+                  .displayedName("Median")
+                  .unit(Unit::SECOND)
+                  .metricPrefix(MetricPrefix::MILLI)
+                  .readOnly()
+                  .initialValue(0.f)
+                  .commit();
 
-        INT32_ELEMENT(expected).key("height").displayedName("Sensor Height").readOnly().defaultValue(0).commit();
+            FLOAT_ELEMENT(expected)
+                  .key(key + ".p99")
+                  .displayedName("99th Percentile")
+                  .unit(Unit::SECOND)
+                  .metricPrefix(MetricPrefix::MILLI)
+                  .readOnly()
+                  .initialValue(0.f)
+                  .commit();
 
-        NODE_ELEMENT(expected).key("roi").displayedName("Image ROI").commit();
+            FLOAT_ELEMENT(expected)
+                  .key(key + ".max")
+                  .displayedName("Maximum")
+                  .unit(Unit::SECOND)
+                  .metricPrefix(MetricPrefix::MILLI)
+                  .readOnly()
+                  .initialValue(0.f)
+                  .commit();
+        }
 
-        INT32_ELEMENT(expected)
-              .key("roi.x")
-              .displayedName("X Offset")
-              .unit(Unit::PIXEL)
+        NODE_ELEMENT(expected)
+              .key("demosaic")
+              .displayedName("Demosaicing")
+              .description("The interpolation of the Bayer pixel formats to RGB images, done on the host.")
+              .commit();
+
+        STRING_ELEMENT(expected)
+              .key("demosaic.method")
+              .displayedName("Method")
+              .description(
+                    "The interpolation method: 'Bilinear' averages the nearest pixels of each missing colour, "
+                    "'EdgeAware' interpolates the green channel along the edges and red and blue from the colour "
+                    "differences, which reduces the colour fringes. If 'None', the raw Bayer images are written. "
+                    "Other pixel formats are not affected.")
               .assignmentOptional()
-              .defaultValue(0)
-              .minInc(0)
+              .defaultValue("None")
+              .options("None,Bilinear,EdgeAware")
               .reconfigurable()
               .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        INT32_ELEMENT(expected)
-              .key("roi.y")
-              .displayedName("Y Offset")
-              .unit(Unit::PIXEL)
+        FLOAT_ELEMENT(expected)
+              .key("demosaic.redGain")
+              .displayedName("Red Gain")
+              .description("The white-balance gain applied to the red channel of the demosaiced images.")
               .assignmentOptional()
-              .defaultValue(0)
-              .minInc(0)
+              .defaultValue(1.f)
+              .minInc(0.f)
+              .maxInc(15.f)
               .reconfigurable()
               .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        INT32_ELEMENT(expected)
-              .key("roi.width")
-              .displayedName("Width")
-              .description("The ROI width. Use '0' for the whole sensor width.")
-              .unit(Unit::PIXEL)
+        FLOAT_ELEMENT(expected)
+              .key("demosaic.greenGain")
+              .displayedName("Green Gain")
+              .description("The white-balance gain applied to the green channel of the demosaiced images.")
               .assignmentOptional()
-              .defaultValue(0)
-              .minInc(0)
+              .defaultValue(1.f)
+              .minInc(0.f)
+              .maxInc(15.f)
               .reconfigurable()
               .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        INT32_ELEMENT(expected)
-              .key("roi.height")
-              .displayedName("Height")
-              .description("The ROI height. Use '0' for the whole sensor height.")
-              .unit(Unit::PIXEL)
+        FLOAT_ELEMENT(expected)
+              .key("demosaic.blueGain")
+              .displayedName("Blue Gain")
+              .description("The white-balance gain applied to the blue channel of the demosaiced images.")
               .assignmentOptional()
-              .defaultValue(0)
-              .minInc(0)
+              .defaultValue(1.f)
+              .minInc(0.f)
+              .maxInc(15.f)
               .reconfigurable()
               .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        NODE_ELEMENT(expected).key("bin").displayedName("Image Binning").commit();
-
-        INT32_ELEMENT(expected)
-              .key("bin.x")
-              .displayedName("X Binning")
-              .unit(Unit::PIXEL)
+        STRING_ELEMENT(expected)
+              .key("yuvConversion")
+              .displayedName("YUV Conversion")
+              .description(
+                    "The conversion of the YUV 4:2:2 pixel formats, done on the host: to 'RGB8', or to 'Mono8' by "
+                    "keeping the luma only. If 'None', the YUV images are written as received, with a trailing "
+                    "dimension of 2: when flipped or rotated in software, their chroma is averaged over the new "
+                    "pairs of pixels, which is slower. Other pixel formats are not affected.")
               .assignmentOptional()
-              .defaultValue(1)
-              .minInc(1)
+              .defaultValue("None")
+              .options("None,RGB8,Mono8")
               .reconfigurable()
               .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        INT32_ELEMENT(expected)
-              .key("bin.y")
-              .displayedName("Y Binning")
-              .unit(Unit::PIXEL)
+        NODE_ELEMENT(expected)
+              .key("preview")
+              .displayedName("Preview")
+              .description(
+                    "Decimated and downscaled images written to the 'previewOutput' channel, e.g. for GUI clients. "
+                    "They are computed by a thread of their own, thus they never delay the other output channels.")
+              .commit();
+
+        BOOL_ELEMENT(expected)
+              .key("preview.enable")
+              .displayedName("Enable")
+              .description(
+                    "Write preview images. Raw YUV 4:2:2 and planar images are not previewed, Bayer images are "
+                    "previewed as gray images.")
               .assignmentOptional()
-              .defaultValue(1)
-              .minInc(1)
+              .defaultValue(false)
               .reconfigurable()
-              .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        NODE_ELEMENT(expected)
-              .key("flip")
-              .displayedName("Image Flip")
-              .description("Enables mirroring of the image.")
+        FLOAT_ELEMENT(expected)
+              .key("preview.maxRate")
+              .displayedName("Maximum Rate")
+              .description(
+                    "The maximum rate of the preview images. Images are also skipped while the previous preview "
+                    "image is being processed.")
+              .unit(Unit::HERTZ)
+              .assignmentOptional()
+              .defaultValue(5.f)
+              .minExc(0.f)
+              .maxInc(100.f)
+              .reconfigurable()
               .commit();
 
-        BOOL_ELEMENT(expected)
-              .key("flip.X")
-              .displayedName("Horizonzal Flip")
-              .description("Enable horizontal flip. This is done before the image rotation.")
+        UINT32_ELEMENT(expected)
+              .key("preview.downscale")
+              .displayedName("Downscaling Factor")
+              .description(
+                    "Each preview pixel is the average of downscale x downscale image pixels. The columns and rows "
+                    "which do not fill a whole block are dropped.")
               .assignmentOptional()
-              .defaultValue(false)
+              .defaultValue(4)
+              .minInc(1)
+              .maxInc(16)
               .reconfigurable()
-              .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
         BOOL_ELEMENT(expected)
-              .key("flip.Y")
-              .displayedName("Vertical Flip")
-              .description("Enable vertical flip. This is done before the image rotation.")
+              .key("preview.eightBit")
+              .displayedName("Convert to 8 Bits")
+              .description("Convert the preview images to 8 bits per channel, by dropping the least significant bits.")
               .assignmentOptional()
               .defaultValue(false)
               .reconfigurable()
-              .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        UINT32_ELEMENT(expected)
-              .key("rotation")
-              .displayedName("Image Rotation")
-              .description("The image rotation. This is done after the image flip.")
+        Schema softwareRoiSchema;
+        UINT32_ELEMENT(softwareRoiSchema)
+              .key("x")
+              .displayedName("X")
               .assignmentOptional()
               .defaultValue(0)
-              .options("0,90,180,270")
-              .unit(Unit::DEGREE)
-              .allowedStates(State::UNKNOWN, State::ON)
               .reconfigurable()
               .commit();
 
-        STRING_ELEMENT(expected)
-              .key("pixelFormat")
-              .displayedName("Pixel Format")
-              .description(
-                    "This enumeration sets the format of the pixel data transmitted for acquired images. "
-                    "For example Mono8 means monochromatic, 8 bits-per-pixel.")
+        UINT32_ELEMENT(softwareRoiSchema)
+              .key("y")
+              .displayedName("Y")
               .assignmentOptional()
-              .defaultValue("Mono12Packed")
-              // Fill-up with some commonly available options. They will be updated on connection.
-              .options("Mono8,Mono12,Mono12Packed")
+              .defaultValue(0)
               .reconfigurable()
-              .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        UINT16_ELEMENT(expected).key("bpp").displayedName("Bits-per-pixel").readOnly().defaultValue(0).commit();
+        UINT32_ELEMENT(softwareRoiSchema)
+              .key("width")
+              .displayedName("Width")
+              .assignmentOptional()
+              .defaultValue(64)
+              .minInc(1)
+              .reconfigurable()
+              .commit();
 
-        DOUBLE_ELEMENT(expected)
-              .key("exposureTime")
-              .displayedName("Exposure Time")
-              .description(
-                    "This float value sets the camera's exposure time. "
-                    "It can only be a multiple of the minimum exposure time.")
-              .unit(Unit::SECOND)
-              .metricPrefix(MetricPrefix::MICRO)
+        UINT32_ELEMENT(softwareRoiSchema)
+              .key("height")
+              .displayedName("Height")
               .assignmentOptional()
-              .defaultValue(10.)
-              .minExc(0.)
+              .defaultValue(64)
+              .minInc(1)
               .reconfigurable()
               .commit();
 
-        STRING_ELEMENT(expected)
-              .key("triggerSelector")
-              .displayedName("Trigger Selector")
+        UINT32_ELEMENT(softwareRoiSchema)
+              .key("bin")
+              .displayedName("Binning")
+              .description("Each pixel of the region is the average of bin x bin image pixels.")
+              .assignmentOptional()
+              .defaultValue(1)
+              .minInc(1)
+              .maxInc(16)
+              .reconfigurable()
+              .commit();
+
+        TABLE_ELEMENT(expected)
+              .key("softwareRois")
+              .displayedName("Software ROIs")
               .description(
-                    "This enumeration selects the trigger type to configure. "
-                    "Once a trigger type has been selected, all changes to the trigger settings will be applied to "
-                    "the selected trigger.")
+                    "Regions of interest cropped by the host from every image written to the 'output' channel, "
+                    "i.e. in its pixels, after binning, flip and rotation. The region in row i is written to the "
+                    "'roiOutput<i>' channel, starting from 0. The regions are clipped to the image. Bayer regions "
+                    "start at even offsets, and are gray if binned. Raw YUV 4:2:2 and planar images are not "
+                    "cropped.")
+              .setColumns(softwareRoiSchema)
               .assignmentOptional()
-              .noDefaultValue()
-              // options will be injected on connection
+              .defaultValue(std::vector<Hash>())
+              .maxSize(m_maxSoftwareRois)
               .reconfigurable()
-              .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        STRING_ELEMENT(expected)
-              .key("triggerMode")
-              .displayedName("Trigger Mode")
-              .description("This enumeration enables or disables the selected trigger.")
+        NODE_ELEMENT(expected)
+              .key("correction")
+              .displayedName("Correction")
+              .description(
+                    "Dark-frame subtraction and flat-field correction, done by the host after any other processing: "
+                    "(image - dark) * gain. The gain map is the mean of (flat - dark) over the image, for each "
+                    "channel, divided by (flat - dark); the pixels with no signal in the flat are zeroed. The "
+                    "references are captured with the 'captureDark' and 'captureFlat' slots, and saved to disk. "
+                    "They must have the shape of the images, a missing one is not applied.")
+              .commit();
+
+        BOOL_ELEMENT(expected)
+              .key("correction.enable")
+              .displayedName("Enable")
               .assignmentOptional()
-              .defaultValue("Off")
-              .options("On,Off")
+              .defaultValue(false)
               .reconfigurable()
               .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
         STRING_ELEMENT(expected)
-              .key("triggerSource")
-              .displayedName("Trigger Source")
-              .description("This enumeration sets the signal source for the selected trigger.")
+              .key("correction.output")
+              .displayedName("Output")
+              .description(
+                    "The type of the corrected images: 16-bit pixels, rounded and clamped to the bit depth of the "
+                    "image, or floats. Float images are neither previewed, nor cropped, nor accumulated, nor "
+                    "their statistics computed.")
               .assignmentOptional()
-              .noDefaultValue()
-              // options will be injected on connection
+              .defaultValue("UInt16")
+              .options("UInt16,Float32")
               .reconfigurable()
               .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        STRING_ELEMENT(expected)
-              .key("triggerActivation")
-              .displayedName("Trigger Activation")
-              .description("This enumeration sets the signal transition needed to activate the selected trigger.")
+        UINT32_ELEMENT(expected)
+              .key("correction.referenceFrames")
+              .displayedName("Reference Frames")
+              .description("The number of images averaged into a reference.")
               .assignmentOptional()
-              .defaultValue("RisingEdge")
-              .options("RisingEdge,FallingEdge")
+              .defaultValue(20)
+              .minInc(1)
+              .maxInc(1000)
               .reconfigurable()
-              .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
         STRING_ELEMENT(expected)
-              .key("autoGain")
-              .displayedName("Auto Gain")
-              .description("Configures automatic gain feature.")
+              .key("correction.directory")
+              .displayedName("Directory")
+              .description(
+                    "The directory where the references are saved, and loaded from when the device starts. It is "
+                    "relative to the directory of the device server, if not absolute.")
               .assignmentOptional()
-              .defaultValue("Off")
-              .options("Off,Once,Continuous")
+              .defaultValue("calibration")
               .reconfigurable()
               .commit();
 
         BOOL_ELEMENT(expected)
-              .key("isNormGain")
-              .displayedName("Enable Normalized Gain")
-              .description("The 'gain' parameter will be interpreted as 'normalized'.")
-              .assignmentOptional()
-              .defaultValue(true)
-              .init() // XXX What happens if I make it reconfigurable?
+              .key("correction.darkReference")
+              .displayedName("Dark Reference")
+              .description("A dark reference has been captured or loaded.")
+              .readOnly()
+              .initialValue(false)
               .commit();
 
-        DOUBLE_ELEMENT(expected)
-              .key("gain")
-              .displayedName("Gain")
-              .description("Sets the gain of the ADC converter.")
-              .assignmentOptional()
-              .noDefaultValue()
-              .reconfigurable()
+        BOOL_ELEMENT(expected)
+              .key("correction.flatReference")
+              .displayedName("Flat Reference")
+              .description("A flat reference has been captured or loaded.")
+              .readOnly()
+              .initialValue(false)
               .commit();
 
-        DOUBLE_ELEMENT(expected)
-              .key("absGain")
-              .displayedName("Absolute Gain")
-              .description("The absolute gain of the ADC converter.")
+        BOOL_ELEMENT(expected)
+              .key("correction.active")
+              .displayedName("Active")
+              .description("The images are corrected, i.e. correction is enabled and the references match them.")
               .readOnly()
+              .initialValue(false)
+              .commit();
+
+        NODE_ELEMENT(expected)
+              .key("accumulation")
+              .displayedName("Accumulation")
+              .description(
+                    "Accumulation of the images written to the 'output' channel, done by the host. The results "
+                    "are written to the 'accumulatedOutput' channel, every N images.")
+              .commit();
+
+        BOOL_ELEMENT(expected)
+              .key("accumulation.enable")
+              .displayedName("Enable")
+              .assignmentOptional()
+              .defaultValue(false)
+              .reconfigurable()
               .commit();
 
         STRING_ELEMENT(expected)
-              .key("acquisitionMode")
-              .displayedName("Acquisition Mode")
-              .description("This property sets the image acquisition mode.")
+              .key("accumulation.mode")
+              .displayedName("Mode")
+              .description(
+                    "'Sum': 32-bit sums of N images, 64-bit for 32-bit images, e.g. binned sums. 'Mean': means "
+                    "of N images, as floats. 'EWMA': exponentially weighted moving average with weight 1 / N, as "
+                    "floats, written every N images. The accumulation restarts when the acquisition starts, or the "
+                    "images change shape or type.")
               .assignmentOptional()
-              .defaultValue("Continuous")
-              .options("Continuous,SingleFrame,MultiFrame")
+              .defaultValue("Mean")
+              .options("Sum,Mean,EWMA")
               .reconfigurable()
-              .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
-        INT64_ELEMENT(expected)
-              .key("frameCount")
-              .displayedName("Frame Count")
-              .description("This value sets the number of frames acquired in the 'Multiframe' acquisition mode.")
+        UINT32_ELEMENT(expected)
+              .key("accumulation.frames")
+              .displayedName("Frames")
+              .description("The number N of images per result, or the time constant of the moving average.")
               .assignmentOptional()
-              .noDefaultValue()
+              .defaultValue(10)
               .minInc(1)
+              .maxInc(65535) // The sums of 16-bit pixels fit in 32 bits
+              .reconfigurable()
+              .commit();
+
+        UINT64_ELEMENT(expected)
+              .key("accumulation.dropped")
+              .displayedName("Dropped Results")
+              .description("The number of results not written, as the previous one was still being written.")
+              .unit(Unit::COUNT)
+              .readOnly()
+              .initialValue(0ull)
+              .commit();
+
+        NODE_ELEMENT(expected)
+              .key("statistics")
+              .displayedName("Statistics")
+              .description(
+                    "Statistics of the pixel values, computed for every image while it is processed. They are "
+                    "published at a limited rate, as properties and to the 'statisticsOutput' channel. The "
+                    "channels of colour images are taken together.")
+              .commit();
+
+        BOOL_ELEMENT(expected)
+              .key("statistics.enable")
+              .displayedName("Enable")
+              .assignmentOptional()
+              .defaultValue(false)
               .reconfigurable()
-              .allowedStates(State::UNKNOWN, State::ON)
               .commit();
 
         UINT32_ELEMENT(expected)
-              .key("maxCorrectionTime")
-              .displayedName("Max. Train Correction Time")
+              .key("statistics.saturation")
+              .displayedName("Saturation")
               .description(
-                    "Maximum time the clock based train Id correction will correct. If the delay "
-                    "is outside this time, no correction will be performed.")
-              .unit(Unit::SECOND)
+                    "The pixel values at or above it are counted as saturated. If 0, the full scale of the "
+                    "image bit depth is used.")
               .assignmentOptional()
-              .defaultValue(5)
-              .minInc(1)
-              .maxInc(600)
-              .init()
+              .defaultValue(0)
+              .reconfigurable()
               .commit();
 
-        BOOL_ELEMENT(expected)
-              .key("wouldCorrectAboveMaxTime")
-              .displayedName("Would Correct Above Max. Time")
-              .description("True if a correction above maxCorrectionTime would happen.")
+        FLOAT_ELEMENT(expected)
+              .key("statistics.maxRate")
+              .displayedName("Maximum Rate")
+              .description("The maximum rate at which the statistics of the latest image are published.")
+              .unit(Unit::HERTZ)
+              .assignmentOptional()
+              .defaultValue(2.f)
+              .minExc(0.f)
+              .maxInc(100.f)
+              .reconfigurable()
+              .commit();
+
+        UINT32_ELEMENT(expected)
+              .key("statistics.min")
+              .displayedName("Minimum")
+              .description("The minimum pixel value of the latest image.")
               .readOnly()
+              .initialValue(0)
               .commit();
-    }
 
+        UINT32_ELEMENT(expected)
+              .key("statistics.max")
+              .displayedName("Maximum")
+              .description("The maximum pixel value of the latest image.")
+              .readOnly()
+              .initialValue(0)
+              .commit();
 
-    AravisCamera::AravisCamera(const karabo::data::Hash& config)
-        : CameraImageSource(config),
-          m_is_base_class(true),
-          m_arv_camera_trigger(true),
-          m_is_device_reset_available(false),
-          m_is_frame_count_available(false),
-          m_camera(nullptr),
-          m_device(nullptr),
-          m_parser(nullptr),
-          m_timestampErrorCount(0ull),
-          m_chunk_mode(false),
-          m_width(0),
-          m_height(0),
-          m_buffer_size(0),
-          m_format(0),
-          m_max_correction_time(0),
-          m_min_latency(0.),
-          m_max_latency(0.),
-          m_outputStrand(karabo::data::Configurator<Strand>::create("Strand", Hash())),
-          m_connect(true),
-          m_is_connected(false),
-          m_reconnect_timer(EventLoop::getIOService()),
-          m_failed_connections(0u),
-          m_poll_timer(EventLoop::getIOService()),
-          m_is_acquiring(false),
-          m_stream(nullptr),
-          m_is_binning_available(false),
-          m_is_exposure_time_available(false),
-          m_is_flip_x_available(false),
-          m_is_flip_y_available(false),
-          m_is_frame_rate_available(false),
-          m_is_gain_available(false),
-          m_is_gain_auto_available(false),
-          m_errorCount(0ull),
-          m_lastError(ARV_BUFFER_STATUS_SUCCESS),
-          m_counter(0) {
-        m_max_correction_time = config.get<unsigned int>("maxCorrectionTime");
+        DOUBLE_ELEMENT(expected)
+              .key("statistics.mean")
+              .displayedName("Mean")
+              .description("The mean pixel value of the latest image.")
+              .readOnly()
+              .initialValue(0.)
+              .commit();
 
-        // From <arvbuffer.h>
-        m_bufferStatus[ARV_BUFFER_STATUS_UNKNOWN] = "Unknown status";
-        m_bufferStatus[ARV_BUFFER_STATUS_SUCCESS] = "The buffer contains a valid image";
-        m_bufferStatus[ARV_BUFFER_STATUS_CLEARED] = "The buffer is cleared";
-        m_bufferStatus[ARV_BUFFER_STATUS_TIMEOUT] = "Timeout was reached before all packets are received";
-        m_bufferStatus[ARV_BUFFER_STATUS_MISSING_PACKETS] = "Stream has missing packets";
-        m_bufferStatus[ARV_BUFFER_STATUS_WRONG_PACKET_ID] = "Stream has packet with wrong id";
-        m_bufferStatus[ARV_BUFFER_STATUS_SIZE_MISMATCH] = "The received image didn't fit in the buffer data space";
-        m_bufferStatus[ARV_BUFFER_STATUS_FILLING] = "The image is currently being filled";
-        m_bufferStatus[ARV_BUFFER_STATUS_ABORTED] = "The filling was aborted before completion";
+        UINT64_ELEMENT(expected)
+              .key("statistics.sum")
+              .displayedName("Sum")
+              .description("The sum of the pixel values of the latest image.")
+              .readOnly()
+              .initialValue(0ull)
+              .commit();
 
-        KARABO_SLOT(acquire);
-        KARABO_SLOT(stop);
-        KARABO_SLOT(trigger);
-        KARABO_SLOT(refresh);
-        KARABO_SLOT(reset);
-        KARABO_SLOT(resetCamera);
+        UINT64_ELEMENT(expected)
+              .key("statistics.saturated")
+              .displayedName("Saturated Pixels")
+              .description("The number of saturated pixels in the latest image.")
+              .unit(Unit::COUNT)
+              .readOnly()
+              .initialValue(0ull)
+              .commit();
 
-        KARABO_INITIAL_FUNCTION(initialize);
-    }
+        UINT64_ELEMENT(expected)
+              .key("statistics.saturatedFrames")
+              .displayedName("Saturated Images")
+              .description("The number of images with saturated pixels, since the previous update.")
+              .unit(Unit::COUNT)
+              .readOnly()
+              .initialValue(0ull)
+              .commit();
 
+        VECTOR_UINT64_ELEMENT(expected)
+              .key("statistics.histogram")
+              .displayedName("Histogram")
+              .description(
+                    "Coarse histogram of the pixel values of the latest image, in 64 bins spanning the full scale "
+                    "of the image bit depth.")
+              .readOnly()
+              .initialValue(std::vector<unsigned long long>())
+              .commit();
 
-    void AravisCamera::preDestruction() {
-        m_connect = false;
-        m_reconnect_timer.cancel();
-        m_poll_timer.cancel();
+        NODE_ELEMENT(expected)
+              .key("compression")
+              .displayedName("Compression")
+              .description(
+                    "Lossless compression of the 8- and 16-bit images, written to the 'compressedOutput' channel. "
+                    "The pixels are bitshuffled and compressed with LZ4 in blocks of 8 kB, in the format of the "
+                    "bitshuffle HDF5 filter (ID 32008), i.e. the images can be decoded, or stored as they are, "
+                    "by standard tools. The uncompressed images are not written to the 'output' channel, unless "
+                    "requested.")
+              .commit();
 
-        if (this->getState() == State::ACQUIRING) {
-            this->stop();
-        }
+#ifdef KARABO_WITH_LZ4
+        BOOL_ELEMENT(expected)
+              .key("compression.enable")
+              .displayedName("Enable")
+              .assignmentOptional()
+              .defaultValue(false)
+              .reconfigurable()
+              .commit();
+#else
+        BOOL_ELEMENT(expected)
+              .key("compression.enable")
+              .displayedName("Enable")
+              .description("Not available: the device was built without LZ4.")
+              .readOnly()
+              .initialValue(false)
+              .commit();
+#endif
 
-        this->clear_stream();
-        this->clear_camera();
-    }
+        BOOL_ELEMENT(expected)
+              .key("compression.rawOutput")
+              .displayedName("Raw Output")
+              .description("Write also the uncompressed images to the 'output' channel.")
+              .assignmentOptional()
+              .defaultValue(false)
+              .reconfigurable()
+              .commit();
 
+        FLOAT_ELEMENT(expected)
+              .key("compression.ratio")
+              .displayedName("Compression Ratio")
+              .description("The uncompressed over the compressed size of the images, since the previous update.")
+              .readOnly()
+              .initialValue(0.f)
+              .commit();
 
-    void AravisCamera::preReconfigure(karabo::data::Hash& incomingReconfiguration) {
-        this->configure(incomingReconfiguration);
-        // This should not be needed, but what has been observed is that if any
-        // camera parameter is set and the stream is not created anew, then
-        // when the acquisition is started we do not get any data.
-        m_need_stream_clear = true;
-    }
+        UINT64_ELEMENT(expected)
+              .key("compression.compressedSize")
+              .displayedName("Compressed Size")
+              .description("The mean compressed size of the images, since the previous update.")
+              .unit(Unit::BYTE)
+              .readOnly()
+              .initialValue(0ull)
+              .commit();
 
+        NODE_ELEMENT(expected)
+              .key("recording")
+              .displayedName("Recording")
+              .description(
+                    "Recording of the images written to the 'output' channel to a local disk, for bursts which "
+                    "the network cannot sustain. It is started and stopped with the 'startRecording' and "
+                    "'stopRecording' slots. Each recording is a directory of chunks: 'chunk_<n>.dat' holds the "
+                    "images, aligned to 4096 bytes, 'chunk_<n>.idx' the frame ID, train ID, timestamp (seconds and "
+                    "attoseconds), offset and size of each image, as 64-bit integers, and 'chunk_<n>.txt' the "
+                    "image shape, type and encoding.")
+              .commit();
 
-    void AravisCamera::postReconfigure() {
-        const bool success = this->updateOutputSchema();
-        if (!success) {
-            this->updateState(State::ERROR);
-        }
-    }
+        STRING_ELEMENT(expected)
+              .key("recording.directory")
+              .displayedName("Directory")
+              .description(
+                    "Where the recordings are written, each one to a sub-directory named after the device and the "
+                    "start time. A local disk, e.g. NVMe, should be used.")
+              .assignmentOptional()
+              .defaultValue("recordings")
+              .reconfigurable()
+              .commit();
 
+        UINT32_ELEMENT(expected)
+              .key("recording.chunkSize")
+              .displayedName("Chunk Size")
+              .description("The maximum size of a chunk data file.")
+              .assignmentOptional()
+              .defaultValue(4096)
+              .minInc(1)
+              .unit(Unit::BYTE)
+              .metricPrefix(MetricPrefix::MEGA)
+              .reconfigurable()
+              .commit();
 
-    void AravisCamera::getPathsByTag(std::vector<std::string>& paths, const std::string& tags) {
-        // N.B. Device::getCurrentConfiguration(tags)) cannot be used, as it
-        // does not return parameters with no value set
+        UINT32_ELEMENT(expected)
+              .key("recording.queueSize")
+              .displayedName("Queue Size")
+              .description(
+                    "The maximum number of images waiting to be written to disk. Further images are not recorded "
+                    "until the queue drains. The images still in a stream buffer are copied when queued.")
+              .assignmentOptional()
+              .defaultValue(64)
+              .minInc(1)
+              .reconfigurable()
+              .commit();
 
-        const Schema schema = this->getFullSchema();
-        const Hash& parameters = schema.getParameterHash();
-        const Hash filteredParameters = this->filterByTags(parameters, tags);
+        BOOL_ELEMENT(expected)
+              .key("recording.active")
+              .displayedName("Active")
+              .readOnly()
+              .initialValue(false)
+              .commit();
 
-        filteredParameters.getPaths(paths);
-    }
+        STRING_ELEMENT(expected)
+              .key("recording.path")
+              .displayedName("Path")
+              .description("The directory of the current, or last, recording.")
+              .readOnly()
+              .initialValue("")
+              .commit();
 
+        BOOL_ELEMENT(expected)
+              .key("recording.direct")
+              .displayedName("Direct I/O")
+              .description("The images are written bypassing the page cache, i.e. with O_DIRECT.")
+              .readOnly()
+              .initialValue(false)
+              .commit();
 
-    // Check that a feature is implemented and available on the camera
-    // XXX For getting/setting a feature we should check that the feature is available
-    //     (it could be implemented but temporarily unavailable.)
-    //     For updating the schema we should only check that it is implemented.
-    bool AravisCamera::isFeatureAvailable(const std::string& feature) const {
-        if (m_device != nullptr) {
-            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-            ArvGcNode* node = arv_device_get_feature(m_device, feature.c_str());
-            if (node != nullptr && arv_gc_feature_node_is_implemented(ARV_GC_FEATURE_NODE(node), NULL) &&
-                arv_gc_feature_node_is_available(ARV_GC_FEATURE_NODE(node), NULL)) {
-                // The feature is implemented and available
-                return true;
-            }
-        }
+        UINT64_ELEMENT(expected)
+              .key("recording.frames")
+              .displayedName("Recorded Images")
+              .unit(Unit::COUNT)
+              .readOnly()
+              .initialValue(0ull)
+              .commit();
 
-        return false;
-    }
+        UINT64_ELEMENT(expected)
+              .key("recording.dropped")
+              .displayedName("Dropped Images")
+              .description("The number of images not recorded, as the queue was full.")
+              .unit(Unit::COUNT)
+              .readOnly()
+              .initialValue(0ull)
+              .commit();
 
+        FLOAT_ELEMENT(expected)
+              .key("recording.rate")
+              .displayedName("Write Rate")
+              .description("The sustained rate at which the images are written to disk.")
+              .unit(Unit::BYTE)
+              .metricPrefix(MetricPrefix::MEGA)
+              .readOnly()
+              .initialValue(0.f)
+              .commit();
 
-    void AravisCamera::disableElement(const std::string& key, karabo::data::Schema& schemaUpdate) {
-        OVERWRITE_ELEMENT(schemaUpdate)
-              .key(key)
-              .setNewDescription("Not available on this camera.")
-              .setNowReadOnly()
+        UINT32_ELEMENT(expected)
+              .key("recording.queueDepth")
+              .displayedName("Queue Depth")
+              .description("The number of images waiting to be written to disk.")
+              .readOnly()
+              .initialValue(0u)
               .commit();
-    }
 
+        NODE_ELEMENT(expected)
+              .key("preTrigger")
+              .displayedName("Pre-Trigger")
+              .description(
+                    "The latest images are kept in memory, without being published. On an event, triggered by the "
+                    "'triggerEvent' slot or by the mean pixel value, the images around it are dumped to the "
+                    "'eventOutput' channel, or to disk in the recording format. During the dump the history is "
+                    "frozen, and starts over afterwards.")
+              .commit();
 
-    Result AravisCamera::getBoolFeature(const std::string& feature, bool& value) {
-        if (!this->isFeatureAvailable(feature)) return Result::NOT_AVAILABLE;
+        BOOL_ELEMENT(expected)
+              .key("preTrigger.enable")
+              .displayedName("Enable")
+              .assignmentOptional()
+              .defaultValue(false)
+              .reconfigurable()
+              .commit();
 
-        GError* error = nullptr;
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-        value = arv_device_get_boolean_feature_value(m_device, feature.c_str(), &error);
+        FLOAT_ELEMENT(expected)
+              .key("preTrigger.history")
+              .displayedName("History")
+              .description("The time kept before an event.")
+              .unit(Unit::SECOND)
+              .assignmentOptional()
+              .defaultValue(2.f)
+              .minExc(0.f)
+              .reconfigurable()
+              .commit();
 
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
-                                       << ": arv_device_get_boolean_feature_value failed: " << error->message;
-            g_clear_error(&error);
-            return Result::FAIL;
-        }
+        FLOAT_ELEMENT(expected)
+              .key("preTrigger.postEvent")
+              .displayedName("Post-Event")
+              .description("The time kept after an event.")
+              .unit(Unit::SECOND)
+              .assignmentOptional()
+              .defaultValue(0.5f)
+              .minInc(0.f)
+              .reconfigurable()
+              .commit();
 
-        return Result::SUCCESS;
-    }
+        UINT32_ELEMENT(expected)
+              .key("preTrigger.memoryBudget")
+              .displayedName("Memory Budget")
+              .description(
+                    "The maximum memory of the ring holding the images. It is allocated after the first image, for "
+                    "the measured, or else the target, frame rate. The history is shorter if it does not fit.")
+              .assignmentOptional()
+              .defaultValue(2048)
+              .minInc(1)
+              .unit(Unit::BYTE)
+              .metricPrefix(MetricPrefix::MEGA)
+              .reconfigurable()
+              .commit();
 
+        STRING_ELEMENT(expected)
+              .key("preTrigger.condition")
+              .displayedName("Condition")
+              .description(
+                    "Trigger an event when the mean pixel value crosses the threshold upwards, or downwards. It "
+                    "needs 'statistics.enable'.")
+              .assignmentOptional()
+              .defaultValue("None")
+              .options("None,Above,Below")
+              .reconfigurable()
+              .commit();
 
-    Result AravisCamera::getStringFeature(const std::string& feature, std::string& value) {
-        if (!this->isFeatureAvailable(feature)) return Result::NOT_AVAILABLE;
+        DOUBLE_ELEMENT(expected)
+              .key("preTrigger.threshold")
+              .displayedName("Threshold")
+              .assignmentOptional()
+              .defaultValue(0.)
+              .reconfigurable()
+              .commit();
 
-        GError* error = nullptr;
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-        value = arv_device_get_string_feature_value(m_device, feature.c_str(), &error);
+        STRING_ELEMENT(expected)
+              .key("preTrigger.destination")
+              .displayedName("Destination")
+              .description(
+                    "'Channel': the 'eventOutput' channel. 'Disk': a sub-directory of 'recording.directory', "
+                    "named after the device and the event time.")
+              .assignmentOptional()
+              .defaultValue("Channel")
+              .options("Channel,Disk")
+              .reconfigurable()
+              .commit();
 
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
-                                       << ": arv_device_get_string_feature_value failed: " << error->message;
-            g_clear_error(&error);
-            return Result::FAIL;
-        }
+        UINT32_ELEMENT(expected)
+              .key("preTrigger.capacity")
+              .displayedName("Capacity")
+              .description("The number of images the ring can hold.")
+              .readOnly()
+              .initialValue(0u)
+              .commit();
 
-        return Result::SUCCESS;
-    }
+        UINT64_ELEMENT(expected)
+              .key("preTrigger.events")
+              .displayedName("Events")
+              .description("The number of events dumped.")
+              .unit(Unit::COUNT)
+              .readOnly()
+              .initialValue(0ull)
+              .commit();
+
+        UINT64_ELEMENT(expected)
+              .key("preTrigger.missedEvents")
+              .displayedName("Missed Events")
+              .description("The number of events triggered while the previous one was being dumped.")
+              .unit(Unit::COUNT)
+              .readOnly()
+              .initialValue(0ull)
+              .commit();
 
+        Schema statisticsSchema;
+        UINT32_ELEMENT(statisticsSchema).key("min").readOnly().commit();
+        UINT32_ELEMENT(statisticsSchema).key("max").readOnly().commit();
+        DOUBLE_ELEMENT(statisticsSchema).key("mean").readOnly().commit();
+        UINT64_ELEMENT(statisticsSchema).key("sum").readOnly().commit();
+        UINT64_ELEMENT(statisticsSchema).key("saturated").readOnly().commit();
+        UINT64_ELEMENT(statisticsSchema).key("saturatedFrames").readOnly().commit();
+        VECTOR_UINT64_ELEMENT(statisticsSchema).key("histogram").readOnly().commit();
+
+        OUTPUT_CHANNEL(expected)
+              .key("statisticsOutput")
+              .displayedName("Statistics Output")
+              .description("The image statistics, see the 'statistics' node.")
+              .dataSchema(statisticsSchema)
+              .commit();
 
-    Result AravisCamera::getIntFeature(const std::string& feature, long long& value) {
-        if (!this->isFeatureAvailable(feature)) return Result::NOT_AVAILABLE;
+        Schema imageSchema;
+        NODE_ELEMENT(imageSchema).key("data").displayedName("Data").commit();
+        IMAGEDATA_ELEMENT(imageSchema).key("data.image").displayedName("Image").commit();
+
+        OUTPUT_CHANNEL(expected)
+              .key("previewOutput")
+              .displayedName("Preview Output")
+              .description("The preview images, see the 'preview' node.")
+              .dataSchema(imageSchema)
+              .commit();
+
+        for (unsigned int i = 0; i < m_maxSoftwareRois; ++i) {
+            OUTPUT_CHANNEL(expected)
+                  .key("roiOutput" + toString(i))
+                  .displayedName("ROI Output " + toString(i))
+                  .description("The region in row " + toString(i) + " of the 'softwareRois' table.")
+                  .dataSchema(imageSchema)
+                  .commit();
+        }
+
+        Schema accumulatedSchema;
+        NODE_ELEMENT(accumulatedSchema).key("data").displayedName("Data").commit();
+        IMAGEDATA_ELEMENT(accumulatedSchema).key("data.image").displayedName("Image").commit();
+        UINT32_ELEMENT(accumulatedSchema).key("data.frames").displayedName("Frames").readOnly().commit();
+
+        OUTPUT_CHANNEL(expected)
+              .key("accumulatedOutput")
+              .displayedName("Accumulated Output")
+              .description("The accumulated images, see the 'accumulation' node.")
+              .dataSchema(accumulatedSchema)
+              .commit();
+
+        Schema compressedSchema;
+        NODE_ELEMENT(compressedSchema).key("data").displayedName("Data").commit();
+        BYTEARRAY_ELEMENT(compressedSchema).key("data.compressed").displayedName("Image").readOnly().commit();
+        STRING_ELEMENT(compressedSchema)
+              .key("data.codec")
+              .displayedName("Codec")
+              .description(
+                    "'bitshuffle-lz4': a chunk of the bitshuffle HDF5 filter with LZ4, as the DECTRIS 'bslz4' "
+                    "encoding. The stream starts with the uncompressed size (64-bit big-endian) and the block size "
+                    "(32-bit big-endian), both in bytes, followed by the blocks: each one is bitshuffled, compressed "
+                    "with LZ4, and preceded by its compressed size (32-bit big-endian). The pixels left over by the "
+                    "last block, less than 8, follow uncompressed.")
+              .readOnly()
+              .commit();
+        UINT32_ELEMENT(compressedSchema).key("data.filterId").displayedName("HDF5 Filter ID").readOnly().commit();
+        VECTOR_UINT32_ELEMENT(compressedSchema)
+              .key("data.filterOptions")
+              .displayedName("HDF5 Filter Options")
+              .readOnly()
+              .commit();
+        UINT32_ELEMENT(compressedSchema)
+              .key("data.blockSize")
+              .displayedName("Block Size")
+              .unit(Unit::BYTE)
+              .readOnly()
+              .commit();
+        VECTOR_UINT64_ELEMENT(compressedSchema).key("data.shape").displayedName("Shape").readOnly().commit();
+        STRING_ELEMENT(compressedSchema).key("data.type").displayedName("Pixel Type").readOnly().commit();
+        INT32_ELEMENT(compressedSchema).key("data.encoding").displayedName("Encoding").readOnly().commit();
+        UINT16_ELEMENT(compressedSchema).key("data.bitsPerPixel").displayedName("Bits per Pixel").readOnly().commit();
+        VECTOR_UINT64_ELEMENT(compressedSchema).key("data.binning").displayedName("Binning").readOnly().commit();
+        VECTOR_UINT64_ELEMENT(compressedSchema).key("data.roiOffsets").displayedName("Offsets").readOnly().commit();
+        UINT64_ELEMENT(compressedSchema)
+              .key("data.compressedSize")
+              .displayedName("Compressed Size")
+              .readOnly()
+              .commit();
+        UINT64_ELEMENT(compressedSchema).key("data.originalSize").displayedName("Original Size").readOnly().commit();
+        FLOAT_ELEMENT(compressedSchema).key("data.ratio").displayedName("Compression Ratio").readOnly().commit();
+
+        OUTPUT_CHANNEL(expected)
+              .key("compressedOutput")
+              .displayedName("Compressed Output")
+              .description("The compressed images, see the 'compression' node.")
+              .dataSchema(compressedSchema)
+              .commit();
+
+        Schema eventSchema;
+        NODE_ELEMENT(eventSchema).key("data").displayedName("Data").commit();
+        IMAGEDATA_ELEMENT(eventSchema).key("data.image").displayedName("Image").commit();
+        UINT64_ELEMENT(eventSchema).key("data.frameId").displayedName("Frame ID").readOnly().commit();
+        UINT64_ELEMENT(eventSchema).key("data.event").displayedName("Event").readOnly().commit();
+
+        OUTPUT_CHANNEL(expected)
+              .key("eventOutput")
+              .displayedName("Event Output")
+              .description("The images around the events, see the 'preTrigger' node.")
+              .dataSchema(eventSchema)
+              .commit();
+
+        SLOT_ELEMENT(expected).key("acquire").displayedName("Acquire").allowedStates(State::ON).commit();
+
+        SLOT_ELEMENT(expected).key("stop").displayedName("Stop").allowedStates(State::ACQUIRING).commit();
+
+        SLOT_ELEMENT(expected)
+              .key("trigger")
+              .displayedName("Software Trigger")
+              .allowedStates(State::ACQUIRING)
+              .commit();
+
+        SLOT_ELEMENT(expected)
+              .key("captureDark")
+              .displayedName("Capture Dark")
+              .description("Capture the dark reference, averaged over 'correction.referenceFrames' images.")
+              .allowedStates(State::ACQUIRING)
+              .commit();
+
+        SLOT_ELEMENT(expected)
+              .key("captureFlat")
+              .displayedName("Capture Flat")
+              .description("Capture the flat reference, averaged over 'correction.referenceFrames' images.")
+              .allowedStates(State::ACQUIRING)
+              .commit();
+
+        SLOT_ELEMENT(expected)
+              .key("startRecording")
+              .displayedName("Start Recording")
+              .description("Start recording the images to disk, see the 'recording' node.")
+              .allowedStates(State::ON, State::ACQUIRING)
+              .commit();
+
+        SLOT_ELEMENT(expected)
+              .key("stopRecording")
+              .displayedName("Stop Recording")
+              .description("Stop recording the images. The queued images are still written.")
+              .allowedStates(State::ON, State::ACQUIRING)
+              .commit();
+
+        SLOT_ELEMENT(expected)
+              .key("triggerEvent")
+              .displayedName("Trigger Event")
+              .description("Dump the images around now, see the 'preTrigger' node.")
+              .allowedStates(State::ACQUIRING)
+              .commit();
+
+        SLOT_ELEMENT(expected)
+              .key("dumpLatencyHistogram")
+              .displayedName("Dump Latency Histogram")
+              .description("Update 'latency.histogram' with the distribution since the acquisition start.")
+              .allowedStates(State::ON, State::ACQUIRING)
+              .commit();
+
+        SLOT_ELEMENT(expected)
+              .key("refresh")
+              .displayedName("Refresh")
+              .description("Refresh hardware parameters and options.")
+              .allowedStates(State::ON)
+              .commit();
+
+        SLOT_ELEMENT(expected)
+              .key("reset")
+              .displayedName("Reset")
+              .description("'Software' reset, i.e. just reset the error state.")
+              .allowedStates(State::ERROR)
+              .commit();
+
+        NODE_ELEMENT(expected).key("frameRate").displayedName("Frame Rate").commit();
+
+        BOOL_ELEMENT(expected)
+              .key("frameRate.enable")
+              .displayedName("Frame Rate Enable")
+              .description("Enable the frame rate control.")
+              .assignmentOptional()
+              .defaultValue(false)
+              .reconfigurable()
+              .commit();
+
+        FLOAT_ELEMENT(expected)
+              .key("frameRate.target")
+              .displayedName("Target Frame Rate")
+              .description(
+                    "Sets the 'target' value of the acquisition frame rate on the camera. "
+                    "Please be aware that if you enable this feature in combination with external trigger, "
+                    "the resulting 'actual' frame rate will most likely be smaller.")
+              .assignmentOptional()
+              .defaultValue(10.)
+              .minInc(0.)
+              .unit(Unit::HERTZ)
+              .reconfigurable()
+              .commit();
+
+        FLOAT_ELEMENT(expected)
+              .key("frameRate.actual")
+              .displayedName("Actual Frame Rate")
+              .description("The measured frame rate.")
+              .unit(Unit::HERTZ)
+              .readOnly()
+              .defaultValue(0.)
+              .commit();
+
+        UINT64_ELEMENT(expected)
+              .key("errorCount")
+              .displayedName("Acq. Error Count")
+              .description("The number of errors occurred during acquisition.")
+              .unit(Unit::COUNT)
+              .readOnly()
+              .defaultValue(0)
+              .commit();
+
+        STRING_ELEMENT(expected)
+              .key("lastError")
+              .displayedName("Last Acq. Error")
+              .description("Description of the last error occurred during acquisition.")
+              .readOnly()
+              .defaultValue("")
+              .commit();
+
+        UINT64_ELEMENT(expected)
+              .key("timestampErrorCount")
+              .displayedName("Timestamp Error Count")
+              .description("The number of errors occurred while reading image timestamp.")
+              .unit(Unit::COUNT)
+              .readOnly()
+              .defaultValue(0)
+              .commit();
+
+        STRING_ELEMENT(expected)
+              .key("lastTimestampError")
+              .displayedName("Last Timestamp Error")
+              .description("Description of the last error occurred while reading image timestamp.")
+              .readOnly()
+              .defaultValue("")
+              .commit();
+
+        NODE_ELEMENT(expected)
+              .key("latency")
+              .displayedName("Image Latency")
+              .description(
+                    "The latency between the image timestamp - if available - and the "
+                    "reception time. The reference interval is 1 s.")
+              .commit();
+
+        FLOAT_ELEMENT(expected)
+              .key("latency.mean")
+              .displayedName("Mean Latency")
+              .description("Mean image latency.")
+              .unit(Unit::SECOND)
+              .metricPrefix(MetricPrefix::MILLI)
+              .readOnly()
+              .defaultValue(0.)
+              .commit();
+
+        FLOAT_ELEMENT(expected)
+              .key("latency.min")
+              .displayedName("Min Latency")
+              .description("Minimum image latency.")
+              .unit(Unit::SECOND)
+              .metricPrefix(MetricPrefix::MILLI)
+              .readOnly()
+              .defaultValue(0.)
+              .commit();
+
+        FLOAT_ELEMENT(expected)
+              .key("latency.max")
+              .displayedName("Max Latency")
+              .description("Maximum image latency.")
+              .unit(Unit::SECOND)
+              .metricPrefix(MetricPrefix::MILLI)
+              .readOnly()
+              .defaultValue(0.)
+              .commit();
+
+        UINT32_ELEMENT(expected)
+              .key("latency.windowLength")
+              .displayedName("Window Length")
+              .description("The length of the sliding window of the 'latency.window' percentiles.")
+              .unit(Unit::SECOND)
+              .assignmentOptional()
+              .defaultValue(60)
+              .minInc(1)
+              .maxInc(600)
+              .reconfigurable()
+              .commit();
+
+        const std::vector<std::pair<std::string, std::string>> latencyWindows = {
+              {"second", "Last Second"}, {"window", "Sliding Window"}, {"total", "Since Start"}};
+        const std::vector<std::pair<std::string, std::string>> latencyPercentiles = {
+              {"p50", "Median"}, {"p90", "90th Percentile"}, {"p99", "99th Percentile"},
+              {"p999", "99.9th Percentile"}, {"max", "Maximum"}};
+        for (const auto& [key, name] : latencyWindows) {
+            NODE_ELEMENT(expected)
+                  .key("latency." + key)
+                  .displayedName(name)
+                  .description("Percentiles of the image latency, with a resolution of 2 %.")
+                  .commit();
+
+            for (const auto& [percentile, percentileName] : latencyPercentiles) {
+                FLOAT_ELEMENT(expected)
+                      .key("latency." + key + "." + percentile)
+                      .displayedName(percentileName)
+                      .unit(Unit::SECOND)
+                      .metricPrefix(MetricPrefix::MILLI)
+                      .readOnly()
+                      .initialValue(0.f)
+                      .commit();
+            }
+        }
+
+        NODE_ELEMENT(expected)
+              .key("latency.histogram")
+              .displayedName("Histogram")
+              .description(
+                    "The latency histogram since the acquisition start, updated by the 'dumpLatencyHistogram' slot. "
+                    "Only the non-empty bins are given.")
+              .commit();
+
+        VECTOR_FLOAT_ELEMENT(expected)
+              .key("latency.histogram.bounds")
+              .displayedName("Upper Bounds")
+              .unit(Unit::SECOND)
+              .metricPrefix(MetricPrefix::MILLI)
+              .readOnly()
+              .initialValue(std::vector<float>())
+              .commit();
+
+        VECTOR_UINT64_ELEMENT(expected)
+              .key("latency.histogram.counts")
+              .displayedName("Counts")
+              .readOnly()
+              .initialValue(std::vector<unsigned long long>())
+              .commit();
+
+        INT32_ELEMENT(expected)
+              .key("tickFrequency")
+              .displayedName("Tick Frequency")
+              .description("This value indicates the number of clock ticks per second.")
+              .unit(Unit::HERTZ)
+              .readOnly()
+              .commit();
+
+        INT32_ELEMENT(expected)
+              .key("pollingInterval")
+              .displayedName("Polling Interval")
+              .description("The interval for polling the camera for read-out values.")
+              .assignmentOptional()
+              .defaultValue(20)
+              .unit(Unit::SECOND)
+              .minInc(5)
+              .maxInc(60)
+              .reconfigurable()
+              .commit();
+
+        STRING_ELEMENT(expected).key("camId").displayedName("Camera ID").readOnly().defaultValue("").commit();
+
+        STRING_ELEMENT(expected)
+              .key("vendor")
+              .displayedName("Vendor Name")
+              .description("The vendor of the camera.")
+              .readOnly()
+              .defaultValue("")
+              .commit();
+
+        STRING_ELEMENT(expected)
+              .key("supportedVendor")
+              .displayedName("Supported Vendor")
+              .description("The vendor supported by this Karabo device.")
+              .readOnly()
+              .defaultValue("")
+              .commit();
+
+        STRING_ELEMENT(expected)
+              .key("model")
+              .displayedName("Model Name")
+              .description("The model of the camera.")
+              .readOnly()
+              .defaultValue("")
+              .commit();
+
+        VECTOR_STRING_ELEMENT(expected)
+              .key("supportedModels")
+              .displayedName("Supported Models")
+              .description("The camera models supported by this Karabo device.")
+              .readOnly()
+              .defaultValue({})
+              .commit();
+
+        INT32_ELEMENT(expected).key("width").displayedName("Sensor Width").readOnly().defaultValue(0).commit();
+
+        INT32_ELEMENT(expected).key("height").displayedName("Sensor Height").readOnly().defaultValue(0).commit();
+
+        NODE_ELEMENT(expected).key("roi").displayedName("Image ROI").commit();
+
+        INT32_ELEMENT(expected)
+              .key("roi.x")
+              .displayedName("X Offset")
+              .unit(Unit::PIXEL)
+              .assignmentOptional()
+              .defaultValue(0)
+              .minInc(0)
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        INT32_ELEMENT(expected)
+              .key("roi.y")
+              .displayedName("Y Offset")
+              .unit(Unit::PIXEL)
+              .assignmentOptional()
+              .defaultValue(0)
+              .minInc(0)
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        INT32_ELEMENT(expected)
+              .key("roi.width")
+              .displayedName("Width")
+              .description("The ROI width. Use '0' for the whole sensor width.")
+              .unit(Unit::PIXEL)
+              .assignmentOptional()
+              .defaultValue(0)
+              .minInc(0)
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        INT32_ELEMENT(expected)
+              .key("roi.height")
+              .displayedName("Height")
+              .description("The ROI height. Use '0' for the whole sensor height.")
+              .unit(Unit::PIXEL)
+              .assignmentOptional()
+              .defaultValue(0)
+              .minInc(0)
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        NODE_ELEMENT(expected).key("bin").displayedName("Image Binning").commit();
+
+        INT32_ELEMENT(expected)
+              .key("bin.x")
+              .displayedName("X Binning")
+              .unit(Unit::PIXEL)
+              .assignmentOptional()
+              .defaultValue(1)
+              .minInc(1)
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        INT32_ELEMENT(expected)
+              .key("bin.y")
+              .displayedName("Y Binning")
+              .unit(Unit::PIXEL)
+              .assignmentOptional()
+              .defaultValue(1)
+              .minInc(1)
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        STRING_ELEMENT(expected)
+              .key("bin.mode")
+              .displayedName("Binning Mode")
+              .description("How the pixels in a bin are combined, when binning is done in software. 'Sum' gives "
+                           "32-bit pixels, 'Average' keeps the pixel type. Not used if the camera bins the image.")
+              .assignmentOptional()
+              .defaultValue("Sum")
+              .options("Sum,Average")
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        BOOL_ELEMENT(expected)
+              .key("bin.software")
+              .displayedName("Software Binning")
+              .description("True if the camera cannot bin the image, and binning is done on the host. "
+                           "Only mono formats can be binned in software.")
+              .readOnly()
+              .commit();
+
+        NODE_ELEMENT(expected)
+              .key("flip")
+              .displayedName("Image Flip")
+              .description("Enables mirroring of the image.")
+              .commit();
+
+        BOOL_ELEMENT(expected)
+              .key("flip.X")
+              .displayedName("Horizonzal Flip")
+              .description("Enable horizontal flip. This is done before the image rotation.")
+              .assignmentOptional()
+              .defaultValue(false)
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        BOOL_ELEMENT(expected)
+              .key("flip.Y")
+              .displayedName("Vertical Flip")
+              .description("Enable vertical flip. This is done before the image rotation.")
+              .assignmentOptional()
+              .defaultValue(false)
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        UINT32_ELEMENT(expected)
+              .key("rotation")
+              .displayedName("Image Rotation")
+              .description("The image rotation. This is done after the image flip.")
+              .assignmentOptional()
+              .defaultValue(0)
+              .options("0,90,180,270")
+              .unit(Unit::DEGREE)
+              .allowedStates(State::UNKNOWN, State::ON)
+              .reconfigurable()
+              .commit();
+
+        STRING_ELEMENT(expected)
+              .key("pixelFormat")
+              .displayedName("Pixel Format")
+              .description(
+                    "This enumeration sets the format of the pixel data transmitted for acquired images. "
+                    "For example Mono8 means monochromatic, 8 bits-per-pixel.")
+              .assignmentOptional()
+              .defaultValue("Mono12Packed")
+              // Fill-up with some commonly available options. They will be updated on connection.
+              .options("Mono8,Mono12,Mono12Packed")
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        UINT16_ELEMENT(expected).key("bpp").displayedName("Bits-per-pixel").readOnly().defaultValue(0).commit();
+
+        DOUBLE_ELEMENT(expected)
+              .key("exposureTime")
+              .displayedName("Exposure Time")
+              .description(
+                    "This float value sets the camera's exposure time. "
+                    "It can only be a multiple of the minimum exposure time.")
+              .unit(Unit::SECOND)
+              .metricPrefix(MetricPrefix::MICRO)
+              .assignmentOptional()
+              .defaultValue(10.)
+              .minExc(0.)
+              .reconfigurable()
+              .commit();
+
+        STRING_ELEMENT(expected)
+              .key("triggerSelector")
+              .displayedName("Trigger Selector")
+              .description(
+                    "This enumeration selects the trigger type to configure. "
+                    "Once a trigger type has been selected, all changes to the trigger settings will be applied to "
+                    "the selected trigger.")
+              .assignmentOptional()
+              .noDefaultValue()
+              // options will be injected on connection
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        STRING_ELEMENT(expected)
+              .key("triggerMode")
+              .displayedName("Trigger Mode")
+              .description("This enumeration enables or disables the selected trigger.")
+              .assignmentOptional()
+              .defaultValue("Off")
+              .options("On,Off")
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        STRING_ELEMENT(expected)
+              .key("triggerSource")
+              .displayedName("Trigger Source")
+              .description("This enumeration sets the signal source for the selected trigger.")
+              .assignmentOptional()
+              .noDefaultValue()
+              // options will be injected on connection
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        STRING_ELEMENT(expected)
+              .key("triggerActivation")
+              .displayedName("Trigger Activation")
+              .description("This enumeration sets the signal transition needed to activate the selected trigger.")
+              .assignmentOptional()
+              .defaultValue("RisingEdge")
+              .options("RisingEdge,FallingEdge")
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        STRING_ELEMENT(expected)
+              .key("autoGain")
+              .displayedName("Auto Gain")
+              .description("Configures automatic gain feature.")
+              .assignmentOptional()
+              .defaultValue("Off")
+              .options("Off,Once,Continuous")
+              .reconfigurable()
+              .commit();
+
+        BOOL_ELEMENT(expected)
+              .key("isNormGain")
+              .displayedName("Enable Normalized Gain")
+              .description("The 'gain' parameter will be interpreted as 'normalized'.")
+              .assignmentOptional()
+              .defaultValue(true)
+              .init() // XXX What happens if I make it reconfigurable?
+              .commit();
+
+        DOUBLE_ELEMENT(expected)
+              .key("gain")
+              .displayedName("Gain")
+              .description("Sets the gain of the ADC converter.")
+              .assignmentOptional()
+              .noDefaultValue()
+              .reconfigurable()
+              .commit();
+
+        DOUBLE_ELEMENT(expected)
+              .key("absGain")
+              .displayedName("Absolute Gain")
+              .description("The absolute gain of the ADC converter.")
+              .readOnly()
+              .commit();
+
+        STRING_ELEMENT(expected)
+              .key("acquisitionMode")
+              .displayedName("Acquisition Mode")
+              .description("This property sets the image acquisition mode.")
+              .assignmentOptional()
+              .defaultValue("Continuous")
+              .options("Continuous,SingleFrame,MultiFrame")
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        INT64_ELEMENT(expected)
+              .key("frameCount")
+              .displayedName("Frame Count")
+              .description("This value sets the number of frames acquired in the 'Multiframe' acquisition mode.")
+              .assignmentOptional()
+              .noDefaultValue()
+              .minInc(1)
+              .reconfigurable()
+              .allowedStates(State::UNKNOWN, State::ON)
+              .commit();
+
+        UINT32_ELEMENT(expected)
+              .key("maxCorrectionTime")
+              .displayedName("Max. Train Correction Time")
+              .description(
+                    "Maximum time the clock based train Id correction will correct. If the delay "
+                    "is outside this time, no correction will be performed.")
+              .unit(Unit::SECOND)
+              .assignmentOptional()
+              .defaultValue(5)
+              .minInc(1)
+              .maxInc(600)
+              .init()
+              .commit();
+
+        FLOAT_ELEMENT(expected)
+              .key("timestampSyncInterval")
+              .displayedName("Timestamp Sync Interval")
+              .description(
+                    "The interval between two synchronizations of the camera clock with the Karabo time. "
+                    "The synchronization runs independently of the image processing.")
+              .unit(Unit::SECOND)
+              .assignmentOptional()
+              .defaultValue(1.f)
+              .minInc(0.1f)
+              .maxInc(600.f)
+              .reconfigurable()
+              .commit();
+
+        BOOL_ELEMENT(expected)
+              .key("wouldCorrectAboveMaxTime")
+              .displayedName("Would Correct Above Max. Time")
+              .description("True if a correction above maxCorrectionTime would happen.")
+              .readOnly()
+              .commit();
+    }
+
+
+    AravisCamera::AravisCamera(const karabo::data::Hash& config)
+        : CameraImageSource(config),
+          m_is_base_class(true),
+          m_arv_camera_trigger(true),
+          m_is_device_reset_available(false),
+          m_is_frame_count_available(false),
+          m_camera(nullptr),
+          m_device(nullptr),
+          m_parser(nullptr),
+          m_timestampErrorCount(0ull),
+          m_chunk_mode(false),
+          m_width(0),
+          m_height(0),
+          m_buffer_size(0),
+          m_format(0),
+          m_max_correction_time(0),
+          m_min_latency(0.),
+          m_max_latency(0.),
+          m_connect(true),
+          m_is_connected(false),
+          m_reconnect_timer(EventLoop::getIOService()),
+          m_failed_connections(0u),
+          m_poll_timer(EventLoop::getIOService()),
+          m_sync_timer(EventLoop::getIOService()),
+          m_is_acquiring(false),
+          m_stream_generation(0u),
+          m_ready_buffers(16384), // Can hold the largest buffer pool
+          m_next_sequence(0ull),
+          m_next_write(0ull),
+          m_is_writing(false),
+          m_process_time(0.),
+          m_write_time(0.),
+          m_stage_times(m_pipelineStages.size()),
+          m_is_previewing(false),
+          m_is_capturing(false),
+          m_capture_reference(CorrectionReference::DARK),
+          m_capture_target(0u),
+          m_capture_frames(0u),
+          m_capture_claimed(0u),
+          m_capture_generation(0u),
+          m_capture_type(Types::UNKNOWN),
+          m_is_writing_accumulation(false),
+          m_reset_accumulation(false),
+          m_dropped_accumulations(0ull),
+          m_saturated_frames(0ull),
+          m_compressed_frames(0ull),
+          m_compressed_bytes(0ull),
+          m_original_bytes(0ull),
+          m_recording_queue(0u),
+          m_recorded_bytes(0ull),
+          m_recorded_frames(0ull),
+          m_dropped_recordings(0ull),
+          m_is_dumping(false),
+          m_event_requested(false),
+          m_event_pending(false),
+          m_event_condition_met(false),
+          m_event_time(0.),
+          m_events(0ull),
+          m_missed_events(0ull),
+          m_stream(nullptr),
+          m_pool_size(0u),
+          m_pool_underruns_start(0ull),
+          m_pool_underruns(0ull),
+          m_last_frame_rate(0.f),
+          m_last_completed(0ull),
+          m_link_capacity(0.f),
+          m_queue_overflows(0ull),
+          m_is_binning_available(false),
+          m_is_software_binning(false),
+          m_is_exposure_time_available(false),
+          m_is_flip_x_available(false),
+          m_is_flip_y_available(false),
+          m_is_frame_rate_available(false),
+          m_is_gain_available(false),
+          m_is_gain_auto_available(false),
+          m_errorCount(0ull),
+          m_lastError(ARV_BUFFER_STATUS_SUCCESS),
+          m_counter(0),
+          m_latency_timer(EventLoop::getIOService()) {
+        m_max_correction_time = config.get<unsigned int>("maxCorrectionTime");
+
+        // From <arvbuffer.h>
+        m_bufferStatus[ARV_BUFFER_STATUS_UNKNOWN] = "Unknown status";
+        m_bufferStatus[ARV_BUFFER_STATUS_SUCCESS] = "The buffer contains a valid image";
+        m_bufferStatus[ARV_BUFFER_STATUS_CLEARED] = "The buffer is cleared";
+        m_bufferStatus[ARV_BUFFER_STATUS_TIMEOUT] = "Timeout was reached before all packets are received";
+        m_bufferStatus[ARV_BUFFER_STATUS_MISSING_PACKETS] = "Stream has missing packets";
+        m_bufferStatus[ARV_BUFFER_STATUS_WRONG_PACKET_ID] = "Stream has packet with wrong id";
+        m_bufferStatus[ARV_BUFFER_STATUS_SIZE_MISMATCH] = "The received image didn't fit in the buffer data space";
+        m_bufferStatus[ARV_BUFFER_STATUS_FILLING] = "The image is currently being filled";
+        m_bufferStatus[ARV_BUFFER_STATUS_ABORTED] = "The filling was aborted before completion";
+
+        KARABO_SLOT(acquire);
+        KARABO_SLOT(stop);
+        KARABO_SLOT(trigger);
+        KARABO_SLOT(refresh);
+        KARABO_SLOT(reset);
+        KARABO_SLOT(resetCamera);
+        KARABO_SLOT(captureDark);
+        KARABO_SLOT(captureFlat);
+        KARABO_SLOT(startRecording);
+        KARABO_SLOT(stopRecording);
+        KARABO_SLOT(triggerEvent);
+        KARABO_SLOT(dumpLatencyHistogram);
+
+        KARABO_INITIAL_FUNCTION(initialize);
+    }
+
+
+    void AravisCamera::preDestruction() {
+        m_connect = false;
+        m_reconnect_timer.cancel();
+        m_poll_timer.cancel();
+        m_sync_timer.cancel();
+        m_latency_timer.cancel();
+
+        if (this->getState() == State::ACQUIRING) {
+            this->stop();
+        }
+
+        this->clear_stream();
+        this->clear_camera();
+        this->stop_processing_thread();
+
+        // The images in flight use the worker pool, it is released once they are written
+        this->wait_for_frames();
+        std::atomic_store(&m_workers, std::shared_ptr<WorkerPool>());
+        std::atomic_store(&m_preview_worker, std::shared_ptr<WorkerPool>());
+        std::atomic_store(&m_accumulation_worker, std::shared_ptr<WorkerPool>());
+        std::atomic_store(&m_recorder, std::shared_ptr<FrameRecorder>());
+        std::atomic_store(&m_recording_worker, std::shared_ptr<WorkerPool>());
+        std::atomic_store(&m_event_worker, std::shared_ptr<WorkerPool>());
+    }
+
+
+    AravisCamera::~AravisCamera() {
+        this->stop_processing_thread();
+    }
+
+
+    void AravisCamera::preReconfigure(karabo::data::Hash& incomingReconfiguration) {
+        // Throws if the images could not be processed, before anything is set to the camera
+        this->check_frame_processor(incomingReconfiguration);
+
+        this->configure(incomingReconfiguration);
+        // This should not be needed, but what has been observed is that if any
+        // camera parameter is set and the stream is not created anew, then
+        // when the acquisition is started we do not get any data.
+        m_need_stream_clear = true;
+    }
+
+
+    void AravisCamera::postReconfigure() {
+        const bool success = this->updateOutputSchema();
+        if (!success) {
+            this->updateState(State::ERROR);
+        }
+
+        // Parameters like flip do not require a schema update, but still change the frame plan
+        this->build_frame_plan();
+    }
+
+
+    void AravisCamera::getPathsByTag(std::vector<std::string>& paths, const std::string& tags) {
+        // N.B. Device::getCurrentConfiguration(tags)) cannot be used, as it
+        // does not return parameters with no value set
+
+        const Schema schema = this->getFullSchema();
+        const Hash& parameters = schema.getParameterHash();
+        const Hash filteredParameters = this->filterByTags(parameters, tags);
+
+        filteredParameters.getPaths(paths);
+    }
+
+
+    // Check that a feature is implemented and available on the camera
+    // XXX For getting/setting a feature we should check that the feature is available
+    //     (it could be implemented but temporarily unavailable.)
+    //     For updating the schema we should only check that it is implemented.
+    bool AravisCamera::isFeatureAvailable(const std::string& feature) const {
+        if (m_device != nullptr) {
+            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+            ArvGcNode* node = arv_device_get_feature(m_device, feature.c_str());
+            if (node != nullptr && arv_gc_feature_node_is_implemented(ARV_GC_FEATURE_NODE(node), NULL) &&
+                arv_gc_feature_node_is_available(ARV_GC_FEATURE_NODE(node), NULL)) {
+                // The feature is implemented and available
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    void AravisCamera::disableElement(const std::string& key, karabo::data::Schema& schemaUpdate) {
+        OVERWRITE_ELEMENT(schemaUpdate)
+              .key(key)
+              .setNewDescription("Not available on this camera.")
+              .setNowReadOnly()
+              .commit();
+    }
+
+
+    Result AravisCamera::getBoolFeature(const std::string& feature, bool& value) {
+        if (!this->isFeatureAvailable(feature)) return Result::NOT_AVAILABLE;
+
+        GError* error = nullptr;
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+        value = arv_device_get_boolean_feature_value(m_device, feature.c_str(), &error);
+
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
+                                       << ": arv_device_get_boolean_feature_value failed: " << error->message;
+            g_clear_error(&error);
+            return Result::FAIL;
+        }
+
+        return Result::SUCCESS;
+    }
+
+
+    Result AravisCamera::getStringFeature(const std::string& feature, std::string& value) {
+        if (!this->isFeatureAvailable(feature)) return Result::NOT_AVAILABLE;
+
+        GError* error = nullptr;
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+        value = arv_device_get_string_feature_value(m_device, feature.c_str(), &error);
+
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
+                                       << ": arv_device_get_string_feature_value failed: " << error->message;
+            g_clear_error(&error);
+            return Result::FAIL;
+        }
+
+        return Result::SUCCESS;
+    }
+
+
+    Result AravisCamera::getIntFeature(const std::string& feature, long long& value) {
+        if (!this->isFeatureAvailable(feature)) return Result::NOT_AVAILABLE;
+
+        GError* error = nullptr;
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+        value = arv_device_get_integer_feature_value(m_device, feature.c_str(), &error);
+
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
+                                       << ": arv_device_get_integer_feature_value failed: " << error->message;
+            g_clear_error(&error);
+            return Result::FAIL;
+        }
+
+        return Result::SUCCESS;
+    }
+
+
+    Result AravisCamera::getFloatFeature(const std::string& feature, double& value) {
+        if (!this->isFeatureAvailable(feature)) return Result::NOT_AVAILABLE;
+
+        GError* error = nullptr;
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+        value = arv_device_get_float_feature_value(m_device, feature.c_str(), &error);
+
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
+                                       << ": arv_device_get_float_feature_value failed: " << error->message;
+            g_clear_error(&error);
+            return Result::FAIL;
+        }
+
+        return Result::SUCCESS;
+    }
+
+
+    Result AravisCamera::setBoolFeature(const std::string& feature, bool& value) {
+        if (!this->isFeatureAvailable(feature)) return Result::NOT_AVAILABLE;
+
+        GError* error = nullptr;
+        const std::string& deviceId = this->getInstanceId();
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+        arv_device_set_boolean_feature_value(m_device, feature.c_str(), value, &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId
+                                       << ": arv_device_set_boolean_feature_value failed: " << error->message;
+            g_clear_error(&error);
+        } else {
+            return Result::SUCCESS; // success
+        }
+
+        // read back value
+        const bool rvalue = arv_device_get_boolean_feature_value(m_device, feature.c_str(), &error);
+        if (error != nullptr) { // Could not read back value
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId
+                                       << ": arv_device_get_boolean_feature_value failed: " << error->message;
+            g_clear_error(&error);
+            return Result::FAIL;
+        } else if (rvalue != value) { // The value was not set
+            value = rvalue;
+            return Result::FAIL;
+        } else { // The value was set
+            return Result::SUCCESS;
+        }
+    }
+
+
+    Result AravisCamera::setStringFeature(const std::string& feature, std::string& value) {
+        if (!this->isFeatureAvailable(feature)) return Result::NOT_AVAILABLE;
+
+        GError* error = nullptr;
+        const std::string& deviceId = this->getInstanceId();
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+        arv_device_set_string_feature_value(m_device, feature.c_str(), value.c_str(), &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId
+                                       << ": arv_device_set_string_feature_value failed: " << error->message;
+            g_clear_error(&error);
+        } else {
+            return Result::SUCCESS; // success
+        }
+
+        // read back value
+        const std::string rvalue = arv_device_get_string_feature_value(m_device, feature.c_str(), &error);
+        if (error != nullptr) { // Could not read back value
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId
+                                       << ": arv_device_get_string_feature_value failed: " << error->message;
+            g_clear_error(&error);
+            return Result::FAIL;
+        } else if (rvalue != value) { // The value was not set
+            value = rvalue;
+            return Result::FAIL;
+        } else { // The value was set
+            return Result::SUCCESS;
+        }
+    }
+
+
+    Result AravisCamera::setIntFeature(const std::string& feature, long long& value) {
+        if (!this->isFeatureAvailable(feature)) return Result::NOT_AVAILABLE;
+
+        GError* error = nullptr;
+        const std::string& deviceId = this->getInstanceId();
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+        arv_device_set_integer_feature_value(m_device, feature.c_str(), value, &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId
+                                       << ": arv_device_set_integer_feature_value failed: " << error->message;
+            g_clear_error(&error);
+        } else {
+            return Result::SUCCESS; // success
+        }
+
+        // read back value
+        const long long rvalue = arv_device_get_integer_feature_value(m_device, feature.c_str(), &error);
+        if (error != nullptr) { // Could not read back value
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId
+                                       << ": arv_device_get_integer_feature_value failed: " << error->message;
+            g_clear_error(&error);
+            return Result::FAIL;
+        } else if (rvalue != value) { // The value was not set
+            value = rvalue;
+            return Result::FAIL;
+        } else { // The value was set
+            return Result::SUCCESS;
+        }
+    }
+
+
+    Result AravisCamera::setFloatFeature(const std::string& feature, double& value) {
+        if (!this->isFeatureAvailable(feature)) return Result::NOT_AVAILABLE;
+
+        GError* error = nullptr;
+        const std::string& deviceId = this->getInstanceId();
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+        arv_device_set_float_feature_value(m_device, feature.c_str(), value, &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ":arv_device_set_float_feature_value failed: " << error->message;
+            g_clear_error(&error);
+        } else {
+            return Result::SUCCESS; // success
+        }
+
+        // read back value
+        const double rvalue = arv_device_get_float_feature_value(m_device, feature.c_str(), &error);
+        if (error != nullptr) { // The value was not set
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_device_get_float_feature_value failed: " << error->message;
+            g_clear_error(&error);
+            return Result::FAIL;
+        } else if (rvalue != value) { // The value was not set
+            value = rvalue;
+            return Result::FAIL;
+        } else { // The value was set
+            return Result::SUCCESS;
+        }
+    }
+
+
+    void AravisCamera::initialize() {
+        this->set("processing.instructionSet", kernels::toString(kernels::detectSimdLevel()));
+
+        // Received images are processed in a dedicated thread
+        m_processing_thread = std::thread(&AravisCamera::process_buffers, this);
+        std::atomic_store(&m_preview_worker, std::make_shared<WorkerPool>(1));
+        std::atomic_store(&m_accumulation_worker, std::make_shared<WorkerPool>(1));
+        std::atomic_store(&m_recording_worker, std::make_shared<WorkerPool>(1));
+        std::atomic_store(&m_event_worker, std::make_shared<WorkerPool>(1));
+
+        // Correction references captured earlier
+        this->load_references();
+
+        m_reconnect_timer.expires_from_now(boost::posix_time::milliseconds(1));
+        m_reconnect_timer.async_wait(
+              karabo::util::bind_weak(&AravisCamera::connect, this, boost::asio::placeholders::error));
+
+        m_poll_timer.expires_from_now(boost::posix_time::seconds(1l));
+        m_poll_timer.async_wait(
+              karabo::util::bind_weak(&AravisCamera::pollCamera, this, boost::asio::placeholders::error));
+    }
+
+
+    void AravisCamera::connect(const boost::system::error_code& ec) {
+        if (ec == boost::asio::error::operation_aborted) return;
+        if (!m_connect) return;
+
+        if (m_is_connected) {
+            // Already connected
+            m_reconnect_timer.expires_from_now(boost::posix_time::seconds(5l));
+            m_reconnect_timer.async_wait(
+                  karabo::util::bind_weak(&AravisCamera::connect, this, boost::asio::placeholders::error));
+            return;
+        } else {
+            // Clear resources before trying reconnection
+            this->clear_camera();
+            this->clear_stream();
+        }
+
+        const std::string& idType = this->get<std::string>("idType");
+        const std::string& cameraId = this->get<std::string>("cameraId");
+        std::string cameraIp;
+
+        // ArvInterface (e.g arv_interface_update_device_list) is not thread safe, thus I create
+        // here a class level lock.
+        boost::mutex::scoped_lock class_lock(AravisCamera::m_connect_mtx);
+
+        // Update the internal list of available devices
+        arv_update_device_list();
+
+        if (idType == "IP") { // IP address
+            if (cameraId.size() == 0) {
+                this->connection_failed_helper("Cannot connect: the provided IP is empty");
+                return;
+            }
+
+            cameraIp = cameraId;
+
+        } else if (idType == "HOST") { // IP name
+            std::string message;
+            const bool success = this->resolveHostname(cameraId, cameraIp, message);
+            if (!success) {
+                this->connection_failed_helper(message);
+                return;
+            } else if (m_failed_connections < 1) {
+                KARABO_LOG_INFO << message;
+            }
+
+        } else if (idType == "SN") { // Serial number
+
+            if (cameraId.size() == 0) {
+                this->connection_failed_helper("Cannot connect: the provided SN is empty");
+                return;
+            }
+
+            const std::string& supportedVendor = this->get<std::string>("supportedVendor");
+
+            if (supportedVendor.size() != 0) {
+                // If the vendor is known, the camera can be simply addressed
+                // by <Vendor>-<SerialNumber>.
+                // Note: this is the only way to access USB3V cameras!
+                cameraIp = supportedVendor + "-" + cameraId;
+
+            } else {
+                // If supportedVendor is not defined, we loop over all
+                // auto-discovered cameras and try to match the SN
+
+                for (unsigned int idx = 0; idx < arv_get_n_devices(); ++idx) {
+                    // Look for a matching serial number
+                    if (cameraId == arv_get_device_serial_nbr(idx)) {
+                        cameraIp = arv_get_device_address(idx);
+                        if (m_failed_connections < 1) {
+                            KARABO_LOG_INFO << "Serial number resolved: " << cameraId << " -> " << cameraIp;
+                        }
+                        break;
+                    }
+                }
+            }
+
+            if (cameraIp.size() == 0) {
+                const std::string message("Could not discover any camera with serial: " + cameraId);
+                this->connection_failed_helper(message);
+                return;
+            }
+
+        } else if (idType == "MAC") { // MAC address
+            if (cameraId.size() == 0) {
+                this->connection_failed_helper("Cannot connect: the provided MAC is empty");
+                return;
+            }
+
+            cameraIp = cameraId;
+        }
+
+        GError* error = nullptr;
+        Hash h; // For the bulk update
+
+        {
+            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+
+            m_camera = arv_camera_new(cameraIp.c_str(), &error);
+
+            if (error != nullptr) {
+                std::stringstream ss;
+                ss << "arv_camera_new failed: " << error->message; // detailed message
+                if (ss.str().find("LIBUSB_ERROR_BUSY") != std::string::npos) {
+                    const std::string message("Cannot connect to " + cameraIp +
+                                              ". Another application might be controlling it.");
+                    this->connection_failed_helper(message, ss.str());
+                } else {
+                    this->connection_failed_helper("Cannot connect to " + cameraIp, ss.str());
+                }
+                g_clear_error(&error);
+                return;
+            }
+
+            m_is_gv_device = arv_camera_is_gv_device(m_camera);
+            m_is_uv_device = arv_camera_is_uv_device(m_camera);
+            if (m_is_gv_device) {
+                h.set("interfaceStandard", "GEV");
+            } else if (m_is_uv_device) {
+                // Use the asynchronous libusb API for better performances
+                arv_camera_uv_set_usb_mode(m_camera, ARV_UV_USB_MODE_ASYNC);
+                h.set("interfaceStandard", "USB3V");
+            } else {
+                h.set("interfaceStandard", "Unknown");
+                const std::string msg("Unsupported interface standard");
+                h.set("status", msg);
+                KARABO_LOG_ERROR << msg;
+
+                // Must unlock before 'clear_camera' is called
+                camera_lock.unlock();
+                this->clear_camera();
+                // Camera not supported -> quit connection loop
+                m_connect = false;
+                this->updateState(State::ERROR, h);
+                return;
+            }
+
+            // Read immutable properties
+            if (m_is_gv_device) {
+                // Not available for USB3V
+                if (error == nullptr) h.set("camId", std::string(arv_camera_get_device_id(m_camera, &error)));
+            }
+
+            const char* vendor = arv_camera_get_vendor_name(m_camera, &error);
+            if (error == nullptr) h.set("vendor", std::string(vendor));
+            const char* model = arv_camera_get_model_name(m_camera, &error);
+            if (error == nullptr) h.set("model", std::string(model));
+
+            // For derived classes, check that vendor and model are supported by the class
+            const bool is_supported = m_is_base_class || this->verify_vendor_and_model(vendor, model);
+            if (!is_supported) {
+                // Must unlock before 'clear_camera' is called
+                camera_lock.unlock();
+                this->clear_camera();
+                // Camera not supported -> quit connection loop. It can be restarted by 'reset'
+                m_connect = false;
+                this->updateState(State::ERROR, h);
+                return;
+            }
+
+            // ArvDevice gives more complete access to camera features
+            m_device = arv_camera_get_device(m_camera);
+
+            // The following is a workaround due to the fact that ARAVIS 0.6 does
+            // not decode the AccessStatus from the discovery pong.
+            // Therefore we send a "TriggerSoftware" command, which is listed as
+            // "recommended" in the GenICam standard, and check for status.
+            // If it is not "SUCCESS" we assume it's because of another application
+            // controlling the camera.
+            arv_device_execute_command(m_device, "TriggerSoftware", &error);
+            if (error != nullptr) {
+                const std::string message("Cannot connect to " + cameraIp +
+                                          ". Another application might be controlling it.");
+                std::stringstream ss;
+                ss << "arv_device_execute_command failed: " << error->message; // detailed message
+                this->connection_failed_helper(message, ss.str());
+                g_clear_error(&error);
+                return;
+            }
+
+            // Instantiation of a chunk parser.
+            // The parser has its own GenICam instance, thus it is protected by its own lock and images can be
+            // parsed without waiting for the camera lock.
+            boost::mutex::scoped_lock parser_lock(m_parser_mtx);
+            m_parser = arv_camera_create_chunk_parser(m_camera);
+        }
+
+        // Enable chunk data, if available on the camera
+        this->configure_timestamp_chunk();
+
+        // Successfully connected!
+        const std::string message("Connected to " + cameraIp);
+        h.set("status", message);
+        KARABO_LOG_INFO << message;
+
+        {
+            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+            // Connect the control-lost signal
+            g_signal_connect(m_device, "control-lost", G_CALLBACK(AravisCamera::control_lost_cb),
+                             static_cast<void*>(this));
+
+            if (error == nullptr) {
+                gint width, height;
+                arv_camera_get_sensor_size(m_camera, &width, &height, &error);
+                h.set("width", width);
+                h.set("height", height);
+            }
+
+            // There are two ways of accessing camera features in ARAVIS, the low-level one (arv_device_* commands) and
+            // the high-level one (arv_camera_* commands).
+            // In the first case we need to know the GenICam feature name, which can have different name for
+            // different vendors. But if the camera vendor/type is known to ARAVIS, the library allows to use
+            // high-level functions (arv_camera_*) without knowing the camera details. In the case of binning one can
+            // use the arv_camera_set_binning function.
+            // Here we use arv_camera_is_binning_available to check whether the arv_camera_set_binning and the other
+            // high-level binning-related functions can be used; if so we set m_is_binning_available to true.
+            // For cameras where the high-level functions cannot be used for binning, but still the binning is
+            // available, we need to define alias and tags for "bin.x" and "bin.y", respectively to the feature name
+            // and to "genicam", then AravisCamera::configure will set the binning by calling the low-level
+            // arv_device_set_integer_feature_value function. There is also a protection in place to avoid that the
+            // binning parameters are set twice by high-level and low-level function calls.
+            // In case they are accessible via arv_camera_set_binning and they also have an alias, only the high-level
+            // function will be called.
+            if (error == nullptr) m_is_binning_available = arv_camera_is_binning_available(m_camera, &error);
+
+            if (error == nullptr) {
+                m_is_exposure_time_available = arv_camera_is_exposure_time_available(m_camera, &error);
+            }
+            if (error == nullptr) m_is_frame_rate_available = arv_camera_is_frame_rate_available(m_camera, &error);
+            if (error == nullptr) m_is_gain_available = arv_camera_is_gain_available(m_camera, &error);
+            if (error == nullptr) m_is_gain_auto_available = arv_camera_is_gain_auto_available(m_camera, &error);
+        }
+
+        // Verify whether frame count is available on the camera
+        m_is_frame_count_available = this->is_frame_count_available();
+
+        // Verify whether horizontal and vertical flip are available on the camera
+        m_is_flip_x_available = this->is_flip_x_available();
+        m_is_flip_y_available = this->is_flip_y_available();
+
+        // Bin on the host if binning is neither available to arv_camera commands nor by alias
+        m_is_software_binning = !m_is_binning_available && !this->keyHasAlias("bin.x") && !this->keyHasAlias("bin.y");
+
+        // The exposure time feature name is used to read out the increment
+        std::vector<std::string> features = {"ExposureTime",     // e.g. Basler a2A
+                                             "ExposureTimeRaw"}; // e.g. Basler acA
+        for (const std::string& feat : features) {
+            if (this->isFeatureAvailable(feat)) {
+                m_exposure_time_feature = feat;
+                break;
+            }
+        }
+
+        if (error != nullptr) {
+            const std::string detailed_msg(error->message);
+            this->connection_failed_helper("An error occurred whilst connecting to " + cameraIp, detailed_msg);
+            g_clear_error(&error);
+            return;
+        }
+
+        this->set(h);
+
+        // Apply initial configuration
+        Hash initialConfiguration = this->getCurrentConfiguration();
+        this->configure(initialConfiguration);
+
+        m_need_schema_update = true; // Always update schema upon connection
+        const bool success = this->updateOutputSchema();
+        if (!success) {
+            this->connection_failed_helper("Could not update output schema");
+            return;
+        }
+
+        if (m_is_acquiring) {
+            // Connection to the camera was lost during acquisition -> restart it
+            this->acquire();
+        } else {
+            this->updateState(State::ON);
+        }
+
+        m_is_connected = true;
+        m_failed_connections = 0;
+        m_reconnect_timer.expires_from_now(boost::posix_time::seconds(5l));
+        m_reconnect_timer.async_wait(
+              karabo::util::bind_weak(&AravisCamera::connect, this, boost::asio::placeholders::error));
+    }
+
+
+    void AravisCamera::connection_failed_helper(const std::string& message, const std::string& detailed_msg) {
+        const std::string& deviceId = this->getInstanceId();
+
+        if (m_failed_connections < 1) {
+            // Only log first error message
+            KARABO_LOG_ERROR << message;
+            this->set("status", message);
+            if (!detailed_msg.empty()) {
+                KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": " << detailed_msg;
+            }
+        } else {
+            KARABO_LOG_DEBUG << message;
+            if (!detailed_msg.empty()) {
+                KARABO_LOG_FRAMEWORK_DEBUG << deviceId << ": " << detailed_msg;
+            }
+        }
+
+        // Increase counter
+        ++m_failed_connections;
+
+        // Try reconnecting after some time
+        m_reconnect_timer.expires_from_now(boost::posix_time::seconds(5l));
+        m_reconnect_timer.async_wait(
+              karabo::util::bind_weak(&AravisCamera::connect, this, boost::asio::placeholders::error));
+    }
+
+
+    bool AravisCamera::verify_vendor_and_model(const std::string& vendor, const std::string& model) {
+        const std::string& supportedVendor = this->get<std::string>("supportedVendor");
+        if (vendor != supportedVendor) {
+            const std::string msg("This Karabo device does not support cameras from " + vendor);
+            KARABO_LOG_ERROR << msg;
+            this->set("status", msg);
+            return false;
+        }
+
+        const std::vector<std::string>& supportedModels = this->get<std::vector<std::string>>("supportedModels");
+        for (const std::string& supported : supportedModels) {
+            if (model.find(supported) == 0) {
+                return true;
+            }
+        }
+        const std::string msg("This Karabo device does not support model " + model + " from " + vendor);
+        KARABO_LOG_ERROR << msg;
+        this->set("status", msg);
+        return false;
+    }
+
+
+    bool AravisCamera::set_auto_packet_size() {
+        if (!m_is_gv_device) {
+            // Available on GEV cameras only
+            return true;
+        }
+
+        GError* error = nullptr;
+        const std::string& deviceId = this->getInstanceId();
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+
+        const guint packetSize = arv_camera_gv_auto_packet_size(m_camera, &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_gv_auto_packet_size failed: " << error->message;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        arv_camera_gv_set_packet_size(m_camera, packetSize, &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_gv_set_packet_size failed: " << error->message;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        return true; // success
+    }
+
+
+    bool AravisCamera::set_region(int& x, int& y, int& width, int& height) {
+        GError* error = nullptr;
+        const std::string& deviceId = this->getInstanceId();
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+
+        // Before getting width and height bounds, reset x and y offsets.
+        arv_camera_set_region(m_camera, 0, 0, width, height, &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_region failed: " << error->message;
+            m_width = 0;
+            m_height = 0;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        // Get bounds for width and height.
+        // x and y bounds can only be gotten after width and height are applied.
+        gint wmin, wmax, hmin, hmax;
+        arv_camera_get_width_bounds(m_camera, &wmin, &wmax, &error);
+        if (error == nullptr) {
+            arv_camera_get_height_bounds(m_camera, &hmin, &hmax, &error);
+        }
+
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << "Could not get ROI bounds: " << error->message;
+            m_width = 0;
+            m_height = 0;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        if (width == 0) {
+            // Whole sensor width
+            width = wmax;
+        } else {
+            width = max(width, wmin);
+            width = min(width, wmax);
+        }
+
+        if (height == 0) {
+            // Whole sensor height
+            height = hmax;
+        } else {
+            height = max(height, hmin);
+            height = min(height, hmax);
+        }
+
+        // Apply width and height settings
+        arv_camera_set_region(m_camera, 0, 0, width, height, &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_region failed: " << error->message;
+            m_width = 0;
+            m_height = 0;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        // Get x and y bounds
+        gint xmin, xmax, ymin, ymax;
+        arv_camera_get_x_offset_bounds(m_camera, &xmin, &xmax, &error);
+        if (error == nullptr) {
+            arv_camera_get_y_offset_bounds(m_camera, &ymin, &ymax, &error);
+        }
+
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << "Could not get ROI bounds: " << error->message;
+            m_width = 0;
+            m_height = 0;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        x = max(x, xmin);
+        x = min(x, xmax);
+        y = max(y, ymin);
+        y = min(y, ymax);
+
+        // Finally x and y offsets too
+        arv_camera_set_region(m_camera, x, y, width, height, &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_region failed: " << error->message;
+            m_width = 0;
+            m_height = 0;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        m_width = width;
+        m_height = height;
+        return true; // success
+    }
+
+
+    bool AravisCamera::set_binning(int& bin_x, int& bin_y) {
+        GError* error = nullptr;
+        const std::string& deviceId = this->getInstanceId();
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+
+        // Get bounds
+        gint xmin, xmax, ymin, ymax;
+        arv_camera_get_x_binning_bounds(m_camera, &xmin, &xmax, &error);
+        if (error == nullptr) {
+            arv_camera_get_y_binning_bounds(m_camera, &ymin, &ymax, &error);
+        }
+
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": Could not get binning bounds: " << error->message;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        // Apply bounds
+        bin_x = max(bin_x, xmin);
+        bin_x = min(bin_x, xmax);
+        bin_y = max(bin_y, ymin);
+        bin_y = min(bin_y, ymax);
+
+        arv_camera_set_binning(m_camera, bin_x, bin_y, &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_binning failed: " << error->message;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        return true; // success
+    }
+
+
+    bool AravisCamera::set_exposure_time(double& exposure_time) {
+        GError* error = nullptr;
+        const std::string& deviceId = this->getInstanceId();
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+
+        // Get bounds
+        double tmin, tmax;
+        arv_camera_get_exposure_time_bounds(m_camera, &tmin, &tmax, &error);
+
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId
+                                       << ": arv_camera_get_exposure_time_bounds failed: " << error->message;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        // Get increment
+        double incr = G_MINDOUBLE;
+        ArvGcNode* exptime_node = arv_device_get_feature(m_device, m_exposure_time_feature.c_str());
+        if (ARV_IS_GC_INTEGER(exptime_node)) {
+            incr = arv_camera_get_integer_increment(m_camera, m_exposure_time_feature.c_str(), &error);
+        } else if (ARV_IS_GC_FLOAT(exptime_node)) {
+            incr = arv_camera_get_float_increment(m_camera, m_exposure_time_feature.c_str(), &error);
+        }
+
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_get_*_increment failed: " << error->message;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        if (incr > G_MINDOUBLE) {
+            // Exposure time must be incremented in steps.
+            exposure_time = tmin + incr * round((exposure_time - tmin) / incr);
+        }
+
+        // Apply bounds
+        exposure_time = max(exposure_time, tmin);
+        exposure_time = min(exposure_time, tmax);
+
+        arv_camera_set_exposure_time(m_camera, exposure_time, &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_exposure_time failed: " << error->message;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        return true; // success
+    }
+
+    std::string AravisCamera::get_frame_rate_enable_parameter_name() const {
+        return "AcquisitionFrameRateEnable";
+    }
+
+    bool AravisCamera::set_frame_rate(bool enable, double frame_rate) {
+        GError* error = nullptr;
+        const std::string& deviceId = this->getInstanceId();
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+
+        if (enable) {
+            // set frame rate
+
+            if (frame_rate <= 0.) {
+                // If no valid rate is provided, the one on the camera is re-applied
+                frame_rate = arv_camera_get_frame_rate(m_camera, &error);
+                if (error != nullptr) {
+                    KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_get_frame_rate failed: " << error->message;
+                    g_clear_error(&error);
+                    return false; // failure
+                }
+            }
+
+            // read the current trigger selector
+            const std::string& triggerSelector =
+                  arv_device_get_string_feature_value(m_device, "TriggerSelector", &error);
+            if (error != nullptr) {
+                KARABO_LOG_FRAMEWORK_ERROR << deviceId
+                                           << ": arv_device_get_string_feature_value failed: " << error->message;
+                g_clear_error(&error);
+                return false; // failure
+            }
+
+            // read which triggers are "On" in order to restore them later
+            guint n_triggers;
+            const char** triggerSelectorOptions = arv_camera_dup_available_triggers(m_camera, &n_triggers, &error);
+            if (error != nullptr) {
+                KARABO_LOG_FRAMEWORK_ERROR << deviceId
+                                           << ": arv_camera_dup_available_triggers failed: " << error->message;
+                g_clear_error(&error);
+                return false; // failure
+            }
+
+            std::vector<std::string> triggerOn;
+            for (unsigned short i = 0; i < n_triggers; ++i) {
+                arv_device_set_string_feature_value(m_device, "TriggerSelector", triggerSelectorOptions[i], &error);
+                if (error != nullptr) break;
+
+                const std::string mode(arv_device_get_string_feature_value(m_device, "TriggerMode", &error));
+                if (error != nullptr) break;
+
+                if (mode == "On") {
+                    triggerOn.push_back(triggerSelectorOptions[i]);
+                }
+            }
+
+            if (error != nullptr) {
+                KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": Could not get TriggerModes: " << error->message;
+                g_clear_error(&error);
+                return false; // failure
+            }
+
+            // N.B. this function will set triggerMode to "Off" on all the selectors
+            arv_camera_set_frame_rate(m_camera, frame_rate, &error);
+            if (error != nullptr) {
+                KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_frame_rate failed: " << error->message;
+                g_clear_error(&error);
+                return false; // failure
+            }
+
+            // restore trigger modes
+            for (const std::string& selector : triggerOn) {
+                arv_device_set_string_feature_value(m_device, "TriggerSelector", selector.c_str(), &error);
+                if (error != nullptr) break;
+
+                arv_device_set_string_feature_value(m_device, "TriggerMode", "On", &error);
+                if (error != nullptr) break;
+            }
+
+            if (error != nullptr) {
+                KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": Could not restore TriggerModes: " << error->message;
+                g_clear_error(&error);
+                return false; // failure
+            }
+
+            // restore trigger selector
+            arv_device_set_string_feature_value(m_device, "TriggerSelector", triggerSelector.c_str(), &error);
+            if (error != nullptr) {
+                KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": Could not restore TriggerSelector: " << error->message;
+                g_clear_error(&error);
+                return false; // failure
+            }
+
+        } else { // enable == false
+            const std::string parameter_name(get_frame_rate_enable_parameter_name());
+            arv_device_set_boolean_feature_value(m_device, parameter_name.c_str(), false, &error);
+            if (error != nullptr) {
+                KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": Could not set " << parameter_name << ": "
+                                           << error->message;
+                g_clear_error(&error);
+                return false; // failure
+            }
+        }
+
+        return true; // success
+    }
+
+
+    bool AravisCamera::get_gain(double& absGain, double& normGain) {
+        GError* error = nullptr;
+        const std::string& deviceId = this->getInstanceId();
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+
+        // Get bounds
+        double gmin, gmax;
+        arv_camera_get_gain_bounds(m_camera, &gmin, &gmax, &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_get_gain_bounds failed: " << error->message;
+            g_clear_error(&error);
+            return false; // failure
+        } else if (gmin >= gmax) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": gmin >= gmax";
+            return false;
+        }
+
+        const double _gain = arv_camera_get_gain(m_camera, &error); // raw gain
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_get_gain failed: " << error->message;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        absGain = _gain;
+        normGain = (_gain - gmin) / (gmax - gmin); // normalized gain
+        return true;                               // success
+    }
+
+
+    bool AravisCamera::set_gain(double& absGain, double& normGain, bool normalized) {
+        GError* error = nullptr;
+        const std::string& deviceId = this->getInstanceId();
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+
+        // Get bounds
+        double gmin, gmax;
+        arv_camera_get_gain_bounds(m_camera, &gmin, &gmax, &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_get_gain_bounds failed: " << error->message;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        if (normalized) { // Convert normalized to absolute gain
+            if (normGain < 0) {
+                normGain = 0;
+                absGain = gmin;
+            } else if (normGain < 1.) {
+                absGain = gmin + normGain * (gmax - gmin);
+            } else {
+                normGain = 1;
+                absGain = gmax;
+            }
+        } else {
+            if (absGain < gmin) {
+                absGain = gmin;
+                normGain = 0;
+            } else if (absGain < gmax) {
+                normGain = (absGain - gmin) / (gmax - gmin);
+            } else {
+                absGain = gmax;
+                normGain = 1.;
+            }
+        }
+
+        arv_camera_set_gain(m_camera, absGain, &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_gain failed: " << error->message;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        return true; // success
+    }
+
+
+    bool AravisCamera::set_frame_count(gint64& frame_count) {
+        GError* error = nullptr;
+        const std::string& deviceId = this->getInstanceId();
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+
+        // Get bounds
+        gint64 fmin, fmax;
+        arv_camera_get_frame_count_bounds(m_camera, &fmin, &fmax, &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_get_frame_count_bounds failed: " << error->message;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        // Apply bounds
+        frame_count = max(frame_count, fmin);
+        frame_count = min(frame_count, fmax);
+
+        arv_camera_set_frame_count(m_camera, frame_count, &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_frame_count failed: " << error->message;
+            g_clear_error(&error);
+            return false; // failure
+        }
+
+        return true; // success
+    }
+
+
+    void AravisCamera::configure(karabo::data::Hash& configuration) {
+        if (m_camera == nullptr) {
+            // cannot configure camera, as we are not connected
+            return;
+        }
+
+        GError* error = nullptr;
+        const std::string& deviceId = this->getInstanceId();
+
+        // Available on GEV cameras only
+        if (m_is_gv_device) {
+            if (configuration.has("packetDelay")) {
+                boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+                arv_camera_gv_set_packet_delay(m_camera, configuration.get<long long>("packetDelay"), &error);
+                if (error != nullptr) {
+                    KARABO_LOG_FRAMEWORK_ERROR << deviceId
+                                               << ": arv_camera_gv_set_packet_delay failed: " << error->message;
+                    configuration.erase("packetDelay");
+                    g_clear_error(&error);
+                }
+            }
+
+            const bool autoPacketSize = GET_PATH(configuration, "autoPacketSize", bool);
+            if (autoPacketSize) {
+                const bool success = this->set_auto_packet_size();
+                if (!success && configuration.has("autoPacketSize")) {
+                    configuration.erase("autoPacketSize");
+                }
+            } else {
+                try {
+                    const guint packetSize = GET_PATH(configuration, "packetSize", int);
+                    boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+                    arv_camera_gv_set_packet_size(m_camera, packetSize, &error);
+                    if (error != nullptr) {
+                        KARABO_LOG_FRAMEWORK_ERROR << deviceId
+                                                   << ": arv_camera_gv_set_packet_size failed: " << error->message;
+                        if (configuration.has("packetSize")) configuration.erase("packetSize");
+                        g_clear_error(&error);
+                    }
+                } catch (const karabo::data::ParameterException& e) {
+                    // key neither in configuration nor on device
+                }
+            }
+        }
+
+        if (configuration.has("rotation")) {
+            // Rotation is done on software, thus nothing is set to the camera.
+            // Still, schema needs to be updated if rotation is changed by +- 90 degrees.
+            const int change = configuration.get<unsigned int>("rotation") - this->get<unsigned int>("rotation");
+            if (change % 180 != 0) {
+                m_need_schema_update = true;
+            }
+        }
+
+        if (configuration.has("demosaic.method") || configuration.has("yuvConversion")) {
+            // Demosaicing and YUV conversion are done in software, the schema needs to be updated as the image
+            // shape and encoding change
+            m_need_schema_update = true;
+        }
+
+        if (configuration.has("correction.enable") || configuration.has("correction.output")) {
+            // The corrected images have another data type
+            m_need_schema_update = true;
+        }
+
+        if (configuration.has("pixelFormat")) {
+            const char* pixelFormat = configuration.get<std::string>("pixelFormat").c_str();
+            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+            arv_camera_set_pixel_format_from_string(m_camera, pixelFormat, &error);
+            if (error == nullptr) m_format = arv_camera_get_pixel_format(m_camera, &error);
+            if (error != nullptr) {
+                KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": could not set pixel format to " << pixelFormat << ": "
+                                           << error->message;
+                m_format = 0;
+                configuration.erase("pixelFormat");
+                g_clear_error(&error);
+            }
+            m_need_schema_update = true; // Schema update is needes as data type changed
+        }
+
+        if (configuration.has("bin")) {
+            if (m_is_binning_available) {
+                // Use arv_camera functions to set binning
+                int bin_x = GET_PATH(configuration, "bin.x", int);
+                int bin_y = GET_PATH(configuration, "bin.y", int);
+
+                const bool success = this->set_binning(bin_x, bin_y);
+                if (success) { // update values
+                    configuration.set("bin.x", bin_x);
+                    configuration.set("bin.y", bin_y);
+                } else {
+                    configuration.erase("bin");
+                }
+            }
+            m_need_schema_update = true; // Schema update is needed as image shape changed
+        }
+
+        // The ROI must be applied after binning, as the values for the former
+        // are after applying the latter.
+        if (configuration.has("roi")) {
+            int x = GET_PATH(configuration, "roi.x", int);
+            int y = GET_PATH(configuration, "roi.y", int);
+            int width = GET_PATH(configuration, "roi.width", int);
+            int height = GET_PATH(configuration, "roi.height", int);
+
+            const bool success = this->set_region(x, y, width, height);
+            if (success) { // update values
+                configuration.set("roi.x", x);
+                configuration.set("roi.y", y);
+                configuration.set("roi.width", width);
+                configuration.set("roi.height", height);
+            } else {
+                configuration.erase("roi");
+            }
+            m_need_schema_update = true; // Schema update is needed as image shape changed
+        }
+
+        if (configuration.has("exposureTime") && m_is_exposure_time_available) {
+            double exposureTime = configuration.get<double>("exposureTime");
+
+            const bool success = this->set_exposure_time(exposureTime);
+            if (success) { // update the value
+                exposureTime = arv_camera_get_exposure_time(m_camera, nullptr);
+                configuration.set("exposureTime", exposureTime);
+            } else {
+                configuration.erase("exposureTime");
+            }
+        }
+
+        if (configuration.has("frameRate") && m_is_frame_rate_available) {
+            const bool enable = GET_PATH(configuration, "frameRate.enable", bool);
+            double frameRate;
+            try {
+                frameRate = GET_PATH(configuration, "frameRate.target", float);
+            } catch (const karabo::data::ParameterException& e) {
+                // key neither in configuration nor on device
+                frameRate = -1; // i.e. read from camera
+            }
+
+            bool success = this->set_frame_rate(enable, frameRate);
+            if (!success) {
+                configuration.erase("frameRate");
+            }
+        }
+
+        if (m_arv_camera_trigger) {
+            // trigger properties can be accessed with the arv_camera interface
+            Result success;
+
+            if (configuration.has("triggerSelector")) {
+                std::string triggerSelector = configuration.get<std::string>("triggerSelector");
+                success = this->setStringFeature("TriggerSelector", triggerSelector);
+                if (success != Result::SUCCESS) {
+                    configuration.erase("triggerSelector");
+                }
+                m_need_schema_update =
+                      true; // Schema update is needed as trigger mode, source and activation must be updated.
+            }
+
+            if (configuration.has("triggerMode")) {
+                std::string triggerMode = configuration.get<std::string>("triggerMode");
+                success = this->setStringFeature("TriggerMode", triggerMode);
+                if (success != Result::SUCCESS) {
+                    configuration.erase("triggerMode");
+                }
+            }
+
+            if (configuration.has("triggerSource")) {
+                std::string triggerSource = configuration.get<std::string>("triggerSource");
+                success = this->setStringFeature("TriggerSource", triggerSource);
+                if (success != Result::SUCCESS) {
+                    configuration.erase("triggerSource");
+                }
+            }
+
+            if (configuration.has("triggerActivation")) {
+                std::string triggerActivation = configuration.get<std::string>("triggerActivation");
+                success = this->setStringFeature("TriggerActivation", triggerActivation);
+                if (success != Result::SUCCESS) {
+                    configuration.erase("triggerActivation");
+                }
+            }
+        }
+
+        if (configuration.has("autoGain") && m_is_gain_auto_available) {
+            const std::string& autoGainStr = configuration.get<std::string>("autoGain");
+            const ArvAuto autoGain = arv_auto_from_string(autoGainStr.c_str());
+            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+            arv_camera_set_gain_auto(m_camera, autoGain, &error);
+            if (error != nullptr) {
+                KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_gain_auto failed: " << error->message;
+                configuration.erase("autoGain");
+                g_clear_error(&error);
+            }
+        }
+
+        if (configuration.has("gain") && m_is_gain_available) {
+            double absGain = configuration.get<double>("gain");
+            double normGain = configuration.get<double>("gain");
+            const bool isNormalized = this->get<bool>("isNormGain");
+            const bool success = this->set_gain(absGain, normGain, isNormalized);
+
+            if (success) { // update the values
+                if (isNormalized) {
+                    configuration.set("gain", normGain);
+                } else {
+                    configuration.set("gain", absGain);
+                }
+                configuration.set("absGain", absGain);
+            } else {
+                configuration.erase("gain");
+            }
+        }
+
+        if (configuration.has("acquisitionMode")) {
+            const std::string& acquisitionMode = configuration.get<std::string>("acquisitionMode");
+            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+            arv_camera_set_acquisition_mode(m_camera, arv_acquisition_mode_from_string(acquisitionMode.c_str()),
+                                            &error);
+            if (error != nullptr) {
+                KARABO_LOG_FRAMEWORK_ERROR << deviceId
+                                           << ": arv_camera_set_acquisition_mode failed: " << error->message;
+                configuration.erase("acquisitionMode");
+                g_clear_error(&error);
+            }
+        }
 
-        GError* error = nullptr;
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-        value = arv_device_get_integer_feature_value(m_device, feature.c_str(), &error);
+        if (configuration.has("frameCount") && m_is_frame_count_available) {
+            gint64 frameCount = configuration.get<long long>("frameCount");
 
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
-                                       << ": arv_device_get_integer_feature_value failed: " << error->message;
-            g_clear_error(&error);
-            return Result::FAIL;
+            const bool success = this->set_frame_count(frameCount);
+            if (success) { // update value
+                configuration.set("frameCount", frameCount);
+            } else {
+                configuration.erase("frameCount");
+            }
         }
 
-        return Result::SUCCESS;
-    }
+        // Filter configuration by tag "genicam" and loop over it
+        // XXX possibly need a tag "update_schema" for parameter changing image "size"
+        const Hash filtered = this->filterByTags(configuration, "genicam");
+        const Schema schema = this->getFullSchema();
+        std::vector<std::string> paths;
+        filtered.getPaths(paths);
+        for (const auto& key : paths) {
+            Result success = Result::FAIL;
+            const auto feature = this->getAliasFromKey<std::string>(key);
+            const auto valueType = this->getValueType(key);
+            const auto accessMode = schema.getAccessMode(key);
+            bool boolValue;
+            long long intValue;
+            double floatValue;
+            std::string stringValue;
 
+            if (accessMode == AccessType::READ) {
+                // Read-Only parameter
+                continue;
+            }
 
-    Result AravisCamera::getFloatFeature(const std::string& feature, double& value) {
-        if (!this->isFeatureAvailable(feature)) return Result::NOT_AVAILABLE;
+            if (m_is_binning_available && (key == "bin.x" || key == "bin.y")) {
+                // Already taken care previously by calling set_binning
+                continue;
+            }
 
-        GError* error = nullptr;
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-        value = arv_device_get_float_feature_value(m_device, feature.c_str(), &error);
+            switch (valueType) {
+                case Types::BOOL:
+                    boolValue = configuration.get<bool>(key);
+                    success = this->setBoolFeature(feature, boolValue);
+                    configuration.set<bool>(key, boolValue); // set read value
+                    break;
+                case Types::STRING:
+                    stringValue = configuration.get<std::string>(key);
+                    success = this->setStringFeature(feature, stringValue);
+                    configuration.set<std::string>(key, stringValue); // set read value
+                    break;
+                case Types::INT32:
+                    intValue = configuration.get<int>(key);
+                    success = this->setIntFeature(feature, intValue);
+                    configuration.set<int>(key, intValue); // set read value
+                    break;
+                case Types::INT64:
+                    intValue = configuration.get<long long>(key);
+                    success = this->setIntFeature(feature, intValue);
+                    configuration.set<long long>(key, intValue); // set read value
+                    break;
+                case Types::FLOAT:
+                    floatValue = configuration.get<float>(key);
+                    success = this->setFloatFeature(feature, floatValue);
+                    configuration.set<float>(key, floatValue); // set read value
+                    break;
+                case Types::DOUBLE:
+                    floatValue = configuration.get<double>(key);
+                    success = this->setFloatFeature(feature, floatValue);
+                    configuration.set<double>(key, floatValue); // set read value
+                    break;
+                default:
+                    throw KARABO_NOT_IMPLEMENTED_EXCEPTION(key + " datatype not available in GenICam");
+            }
 
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
-                                       << ": arv_device_get_float_feature_value failed: " << error->message;
-            g_clear_error(&error);
-            return Result::FAIL;
+            if (success == Result::FAIL) {
+                const std::string message("Setting value for " + key + " may not have been successful");
+                KARABO_LOG_WARN << message << ". Value on device updated according to camera.";
+                this->set("status", message);
+            }
         }
+    }
 
-        return Result::SUCCESS;
+
+    bool AravisCamera::synchronize_timestamp() {
+        // If the camera can provide HW timestamping, then synchronize it with the timeserver
+        return true;
     }
 
 
-    Result AravisCamera::setBoolFeature(const std::string& feature, bool& value) {
-        if (!this->isFeatureAvailable(feature)) return Result::NOT_AVAILABLE;
+    void AravisCamera::set_timestamp_reference(const TimestampReference& reference) {
+        std::atomic_store(&m_timestamp_reference, std::make_shared<const TimestampReference>(reference));
+    }
 
-        GError* error = nullptr;
-        const std::string& deviceId = this->getInstanceId();
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-        arv_device_set_boolean_feature_value(m_device, feature.c_str(), value, &error);
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId
-                                       << ": arv_device_set_boolean_feature_value failed: " << error->message;
-            g_clear_error(&error);
-        } else {
-            return Result::SUCCESS; // success
-        }
 
-        // read back value
-        const bool rvalue = arv_device_get_boolean_feature_value(m_device, feature.c_str(), &error);
-        if (error != nullptr) { // Could not read back value
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId
-                                       << ": arv_device_get_boolean_feature_value failed: " << error->message;
-            g_clear_error(&error);
-            return Result::FAIL;
-        } else if (rvalue != value) { // The value was not set
-            value = rvalue;
-            return Result::FAIL;
-        } else { // The value was set
-            return Result::SUCCESS;
-        }
+    std::shared_ptr<const AravisCamera::TimestampReference> AravisCamera::get_timestamp_reference() const {
+        return std::atomic_load(&m_timestamp_reference);
     }
 
 
-    Result AravisCamera::setStringFeature(const std::string& feature, std::string& value) {
-        if (!this->isFeatureAvailable(feature)) return Result::NOT_AVAILABLE;
+    void AravisCamera::syncTimestamp(const boost::system::error_code& ec) {
+        if (ec == boost::asio::error::operation_aborted) return;
+        if (!m_is_acquiring) return;
 
-        GError* error = nullptr;
-        const std::string& deviceId = this->getInstanceId();
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-        arv_device_set_string_feature_value(m_device, feature.c_str(), value.c_str(), &error);
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId
-                                       << ": arv_device_set_string_feature_value failed: " << error->message;
-            g_clear_error(&error);
-        } else {
-            return Result::SUCCESS; // success
-        }
+        // Synchronize camera timestamp with timeserver.
+        // This shall be repeated regularly to correct for drift.
+        this->synchronize_timestamp();
 
-        // read back value
-        const std::string rvalue = arv_device_get_string_feature_value(m_device, feature.c_str(), &error);
-        if (error != nullptr) { // Could not read back value
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId
-                                       << ": arv_device_get_string_feature_value failed: " << error->message;
-            g_clear_error(&error);
-            return Result::FAIL;
-        } else if (rvalue != value) { // The value was not set
-            value = rvalue;
-            return Result::FAIL;
-        } else { // The value was set
-            return Result::SUCCESS;
-        }
+        const float interval = this->get<float>("timestampSyncInterval");
+        m_sync_timer.expires_from_now(boost::posix_time::milliseconds(static_cast<long>(1000.f * interval)));
+        m_sync_timer.async_wait(
+              karabo::util::bind_weak(&AravisCamera::syncTimestamp, this, boost::asio::placeholders::error));
     }
 
 
-    Result AravisCamera::setIntFeature(const std::string& feature, long long& value) {
-        if (!this->isFeatureAvailable(feature)) return Result::NOT_AVAILABLE;
-
-        GError* error = nullptr;
-        const std::string& deviceId = this->getInstanceId();
+    bool AravisCamera::configure_timestamp_chunk() {
         boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-        arv_device_set_integer_feature_value(m_device, feature.c_str(), value, &error);
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId
-                                       << ": arv_device_set_integer_feature_value failed: " << error->message;
-            g_clear_error(&error);
-        } else {
-            return Result::SUCCESS; // success
-        }
 
-        // read back value
-        const long long rvalue = arv_device_get_integer_feature_value(m_device, feature.c_str(), &error);
-        if (error != nullptr) { // Could not read back value
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId
-                                       << ": arv_device_get_integer_feature_value failed: " << error->message;
-            g_clear_error(&error);
-            return Result::FAIL;
-        } else if (rvalue != value) { // The value was not set
-            value = rvalue;
-            return Result::FAIL;
-        } else { // The value was set
-            return Result::SUCCESS;
-        }
-    }
+        // By default chunk mode is disabled.
+        // It can be enabled in the derived class, if the camera provides HW timestamping.
+        arv_camera_set_chunk_mode(m_camera, false, nullptr);
+        m_chunk_mode = false;
 
+        return true;
+    }
 
-    Result AravisCamera::setFloatFeature(const std::string& feature, double& value) {
-        if (!this->isFeatureAvailable(feature)) return Result::NOT_AVAILABLE;
 
+    bool AravisCamera::get_region(gint& x, gint& y, gint& width, gint& height) {
         GError* error = nullptr;
-        const std::string& deviceId = this->getInstanceId();
         boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-        arv_device_set_float_feature_value(m_device, feature.c_str(), value, &error);
+
+        arv_camera_get_region(m_camera, &x, &y, &width, &height, &error);
+
         if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ":arv_device_set_float_feature_value failed: " << error->message;
+            KARABO_LOG_FRAMEWORK_WARN << this->getInstanceId() << ": arv_camera_get_region failed: " << error->message;
+            m_width = 0;
+            m_height = 0;
             g_clear_error(&error);
-        } else {
-            return Result::SUCCESS; // success
+            return false; // failure
         }
 
-        // read back value
-        const double rvalue = arv_device_get_float_feature_value(m_device, feature.c_str(), &error);
-        if (error != nullptr) { // The value was not set
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_device_get_float_feature_value failed: " << error->message;
-            g_clear_error(&error);
-            return Result::FAIL;
-        } else if (rvalue != value) { // The value was not set
-            value = rvalue;
-            return Result::FAIL;
-        } else { // The value was set
-            return Result::SUCCESS;
-        }
+        m_width = width;
+        m_height = height;
+        return true; // success
     }
 
 
-    void AravisCamera::initialize() {
-        m_reconnect_timer.expires_from_now(boost::posix_time::milliseconds(1));
-        m_reconnect_timer.async_wait(
-              karabo::util::bind_weak(&AravisCamera::connect, this, boost::asio::placeholders::error));
-
-        m_poll_timer.expires_from_now(boost::posix_time::seconds(1l));
-        m_poll_timer.async_wait(
-              karabo::util::bind_weak(&AravisCamera::pollCamera, this, boost::asio::placeholders::error));
+    int AravisCamera::get_tick_frequency() {
+        // If the camera provides a "tick frequency", this function shall be overridden
+        return 0;
     }
 
 
-    void AravisCamera::connect(const boost::system::error_code& ec) {
-        if (ec == boost::asio::error::operation_aborted) return;
-        if (!m_connect) return;
-
-        if (m_is_connected) {
-            // Already connected
-            m_reconnect_timer.expires_from_now(boost::posix_time::seconds(5l));
-            m_reconnect_timer.async_wait(
-                  karabo::util::bind_weak(&AravisCamera::connect, this, boost::asio::placeholders::error));
-            return;
-        } else {
-            // Clear resources before trying reconnection
-            this->clear_camera();
-            this->clear_stream();
-        }
-
-        const std::string& idType = this->get<std::string>("idType");
-        const std::string& cameraId = this->get<std::string>("cameraId");
-        std::string cameraIp;
-
-        // ArvInterface (e.g arv_interface_update_device_list) is not thread safe, thus I create
-        // here a class level lock.
-        boost::mutex::scoped_lock class_lock(AravisCamera::m_connect_mtx);
-
-        // Update the internal list of available devices
-        arv_update_device_list();
-
-        if (idType == "IP") { // IP address
-            if (cameraId.size() == 0) {
-                this->connection_failed_helper("Cannot connect: the provided IP is empty");
-                return;
-            }
-
-            cameraIp = cameraId;
+    bool AravisCamera::get_timestamp(ArvBuffer* buffer, karabo::data::Timestamp& ts) {
+        // If the camera provides HW timestamping in chunk data, this function shall be overridden
+        return false;
+    }
 
-        } else if (idType == "HOST") { // IP name
-            std::string message;
-            const bool success = this->resolveHostname(cameraId, cameraIp, message);
-            if (!success) {
-                this->connection_failed_helper(message);
-                return;
-            } else if (m_failed_connections < 1) {
-                KARABO_LOG_INFO << message;
-            }
 
-        } else if (idType == "SN") { // Serial number
+    bool AravisCamera::is_frame_count_available() const {
+        GError* error = nullptr;
+        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
 
-            if (cameraId.size() == 0) {
-                this->connection_failed_helper("Cannot connect: the provided SN is empty");
-                return;
+        bool is_available = false;
+        guint n_values;
+        const char** options = arv_device_dup_available_enumeration_feature_values_as_strings(
+              m_device, "AcquisitionMode", &n_values, &error);
+        if (error != nullptr) {
+            KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
+                                       << ": arv_device_dup_available_enumeration_feature_values_as_strings failed: "
+                                       << error->message;
+            g_clear_error(&error);
+        } else {
+            for (size_t i = 0; i < n_values; ++i) {
+                if (std::string(options[i]) == "MultiFrame") {
+                    // Frame Count is available
+                    is_available = true;
+                    break;
+                }
             }
+        }
+        g_free(options);
+        return is_available;
+    }
 
-            const std::string& supportedVendor = this->get<std::string>("supportedVendor");
 
-            if (supportedVendor.size() != 0) {
-                // If the vendor is known, the camera can be simply addressed
-                // by <Vendor>-<SerialNumber>.
-                // Note: this is the only way to access USB3V cameras!
-                cameraIp = supportedVendor + "-" + cameraId;
+    bool AravisCamera::is_flip_x_available() const {
+        // If the camera provides horizontal flip, this function shall be overridden.
+        // Also, "genicam" tag and alias shall be provided for "flip.X".
+        return false;
+    }
 
-            } else {
-                // If supportedVendor is not defined, we loop over all
-                // auto-discovered cameras and try to match the SN
 
-                for (unsigned int idx = 0; idx < arv_get_n_devices(); ++idx) {
-                    // Look for a matching serial number
-                    if (cameraId == arv_get_device_serial_nbr(idx)) {
-                        cameraIp = arv_get_device_address(idx);
-                        if (m_failed_connections < 1) {
-                            KARABO_LOG_INFO << "Serial number resolved: " << cameraId << " -> " << cameraIp;
-                        }
-                        break;
-                    }
-                }
-            }
+    bool AravisCamera::is_flip_y_available() const {
+        // If the camera provides vertical flip, this function shall be overridden.
+        // Also, "genicam" tag and alias shall be provided for "flip.Y".
+        return false;
+    }
 
-            if (cameraIp.size() == 0) {
-                const std::string message("Could not discover any camera with serial: " + cameraId);
-                this->connection_failed_helper(message);
-                return;
-            }
 
-        } else if (idType == "MAC") { // MAC address
-            if (cameraId.size() == 0) {
-                this->connection_failed_helper("Cannot connect: the provided MAC is empty");
-                return;
-            }
+    void AravisCamera::acquire() {
+        GError* error = nullptr;
 
-            cameraIp = cameraId;
+        const std::shared_ptr<const FramePlan> plan = std::atomic_load(&m_framePlan);
+        if (!plan || plan->process == nullptr) {
+            // e.g. the camera was already set to an unsupported pixel format
+            std::stringstream ss;
+            ss << "Pixel format " << m_format << " cannot be processed with the current demosaicing, flip and rotation";
+            this->acquire_failed_helper(ss.str());
+            return;
         }
 
-        GError* error = nullptr;
-        Hash h; // For the bulk update
+        m_timer.now();
+        m_counter = 0;
+        m_reset_accumulation = true;
+        Hash h; // Updated properties of the stream
+        {
+            boost::mutex::scoped_lock latency_lock(m_latency_mtx);
+            m_latency_second.reset();
+            m_latency_window.reset();
+            m_latency_total.reset();
+            m_latency_seconds.clear();
+        }
 
         {
             boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-
-            m_camera = arv_camera_new(cameraIp.c_str(), &error);
+            const guint payload = arv_camera_get_payload(m_camera, &error);
 
             if (error != nullptr) {
                 std::stringstream ss;
-                ss << "arv_camera_new failed: " << error->message; // detailed message
-                if (ss.str().find("LIBUSB_ERROR_BUSY") != std::string::npos) {
-                    const std::string message("Cannot connect to " + cameraIp +
-                                              ". Another application might be controlling it.");
-                    this->connection_failed_helper(message, ss.str());
-                } else {
-                    this->connection_failed_helper("Cannot connect to " + cameraIp, ss.str());
-                }
+                ss << "arv_camera_get_payload failed: " << error->message;
+                this->acquire_failed_helper(ss.str());
                 g_clear_error(&error);
                 return;
             }
 
-            m_is_gv_device = arv_camera_is_gv_device(m_camera);
-            m_is_uv_device = arv_camera_is_uv_device(m_camera);
-            if (m_is_gv_device) {
-                h.set("interfaceStandard", "GEV");
-            } else if (m_is_uv_device) {
-                // Use the asynchronous libusb API for better performances
-                arv_camera_uv_set_usb_mode(m_camera, ARV_UV_USB_MODE_ASYNC);
-                h.set("interfaceStandard", "USB3V");
-            } else {
-                h.set("interfaceStandard", "Unknown");
-                const std::string msg("Unsupported interface standard");
-                h.set("status", msg);
-                KARABO_LOG_ERROR << msg;
-
-                // Must unlock before 'clear_camera' is called
-                camera_lock.unlock();
-                this->clear_camera();
-                // Camera not supported -> quit connection loop
-                m_connect = false;
-                this->updateState(State::ERROR, h);
-                return;
-            }
-
-            // Read immutable properties
-            if (m_is_gv_device) {
-                // Not available for USB3V
-                if (error == nullptr) h.set("camId", std::string(arv_camera_get_device_id(m_camera, &error)));
-            }
-
-            const char* vendor = arv_camera_get_vendor_name(m_camera, &error);
-            if (error == nullptr) h.set("vendor", std::string(vendor));
-            const char* model = arv_camera_get_model_name(m_camera, &error);
-            if (error == nullptr) h.set("model", std::string(model));
+            if (m_stream != nullptr && (payload != m_buffer_size || m_need_stream_clear)) {
+                // The payload size changed, or the stream need to be cleared for other reasons:
+                // clear the stream and the associated buffers.
 
-            // For derived classes, check that vendor and model are supported by the class
-            const bool is_supported = m_is_base_class || this->verify_vendor_and_model(vendor, model);
-            if (!is_supported) {
-                // Must unlock before 'clear_camera' is called
-                camera_lock.unlock();
-                this->clear_camera();
-                // Camera not supported -> quit connection loop. It can be restarted by 'reset'
-                m_connect = false;
-                this->updateState(State::ERROR, h);
-                return;
+                this->clear_stream();
+                m_need_stream_clear = false;
             }
+            m_buffer_size = payload;
 
-            // ArvDevice gives more complete access to camera features
-            m_device = arv_camera_get_device(m_camera);
-
-            // The following is a workaround due to the fact that ARAVIS 0.6 does
-            // not decode the AccessStatus from the discovery pong.
-            // Therefore we send a "TriggerSoftware" command, which is listed as
-            // "recommended" in the GenICam standard, and check for status.
-            // If it is not "SUCCESS" we assume it's because of another application
-            // controlling the camera.
-            arv_device_execute_command(m_device, "TriggerSoftware", &error);
-            if (error != nullptr) {
-                const std::string message("Cannot connect to " + cameraIp +
-                                          ". Another application might be controlling it.");
-                std::stringstream ss;
-                ss << "arv_device_execute_command failed: " << error->message; // detailed message
-                this->connection_failed_helper(message, ss.str());
-                g_clear_error(&error);
-                return;
-            }
+            if (m_stream == nullptr) {
+                boost::mutex::scoped_lock stream_lock(m_stream_mtx);
 
-            // Instantiation of a chunk parser
-            m_parser = arv_camera_create_chunk_parser(m_camera);
-        }
+                auto handle = std::make_shared<StreamHandle>();
+                handle->camera = this;
+                handle->generation = ++m_stream_generation;
+                if (m_is_gv_device) {
+                    // The socket type is chosen when the stream is created
+                    const bool packetSocket = this->get<bool>("streamTuning.packetSocket");
+                    arv_gv_device_set_stream_options(ARV_GV_DEVICE(m_device),
+                                                     packetSocket ? ARV_GV_STREAM_OPTION_NONE
+                                                                  : ARV_GV_STREAM_OPTION_PACKET_SOCKET_DISABLED);
+                }
+                m_stream = arv_camera_create_stream(m_camera, AravisCamera::stream_cb, static_cast<void*>(handle.get()),
+                                                    nullptr, &error);
 
-        // Enable chunk data, if available on the camera
-        this->configure_timestamp_chunk();
+                if (error != nullptr) {
+                    std::stringstream ss;
+                    ss << "arv_camera_create_stream failed: " << error->message;
+                    this->acquire_failed_helper(ss.str());
+                    g_clear_error(&error);
+                    return;
+                }
 
-        // Successfully connected!
-        const std::string message("Connected to " + cameraIp);
-        h.set("status", message);
-        KARABO_LOG_INFO << message;
+                handle->stream = m_stream;
+                handle->rx_stream.store(m_stream, std::memory_order_release);
+                m_stream_handle = handle;
 
-        {
-            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-            // Connect the control-lost signal
-            g_signal_connect(m_device, "control-lost", G_CALLBACK(AravisCamera::control_lost_cb),
-                             static_cast<void*>(this));
+                if (ARV_IS_GV_STREAM(m_stream)) {
+                    // Before any buffer is pushed, thus before any packet is received
+                    this->tune_gv_stream(payload, h);
+                }
 
-            if (error == nullptr) {
-                gint width, height;
-                arv_camera_get_sensor_size(m_camera, &width, &height, &error);
-                h.set("width", width);
-                h.set("height", height);
+                // Create and push buffers to the stream
+                m_pool_size = 0;
+                this->grow_buffer_pool(this->get_buffer_pool_size(m_last_frame_rate, 0));
             }
 
-            // There are two ways of accessing camera features in ARAVIS, the low-level one (arv_device_* commands) and
-            // the high-level one (arv_camera_* commands).
-            // In the first case we need to know the GenICam feature name, which can have different name for
-            // different vendors. But if the camera vendor/type is known to ARAVIS, the library allows to use
-            // high-level functions (arv_camera_*) without knowing the camera details. In the case of binning one can
-            // use the arv_camera_set_binning function.
-            // Here we use arv_camera_is_binning_available to check whether the arv_camera_set_binning and the other
-            // high-level binning-related functions can be used; if so we set m_is_binning_available to true.
-            // For cameras where the high-level functions cannot be used for binning, but still the binning is
-            // available, we need to define alias and tags for "bin.x" and "bin.y", respectively to the feature name
-            // and to "genicam", then AravisCamera::configure will set the binning by calling the low-level
-            // arv_device_set_integer_feature_value function. There is also a protection in place to avoid that the
-            // binning parameters are set twice by high-level and low-level function calls.
-            // In case they are accessible via arv_camera_set_binning and they also have an alias, only the high-level
-            // function will be called.
-            if (error == nullptr) m_is_binning_available = arv_camera_is_binning_available(m_camera, &error);
+            boost::mutex::scoped_lock stream_lock(m_stream_mtx);
+            this->read_stream_counters(m_stream_counters_start);
+            m_pool_underruns_start = m_stream_counters_start.underruns;
+            m_pool_underruns = m_pool_underruns_start;
+            m_last_completed = m_stream_counters_start.completed;
+        }
 
-            if (error == nullptr) {
-                m_is_exposure_time_available = arv_camera_is_exposure_time_available(m_camera, &error);
-            }
-            if (error == nullptr) m_is_frame_rate_available = arv_camera_is_frame_rate_available(m_camera, &error);
-            if (error == nullptr) m_is_gain_available = arv_camera_is_gain_available(m_camera, &error);
-            if (error == nullptr) m_is_gain_auto_available = arv_camera_is_gain_auto_available(m_camera, &error);
+        for (std::atomic<unsigned long long>& count : m_status_counts) {
+            count = 0ull;
         }
+        m_queue_overflows = 0ull;
 
-        // Verify whether frame count is available on the camera
-        m_is_frame_count_available = this->is_frame_count_available();
+        // The link capacity, from the standard feature if available, otherwise from the GigE Vision one
+        long long linkSpeed;
+        if (this->getIntFeature("DeviceLinkSpeed", linkSpeed) == Result::SUCCESS) {
+            m_link_capacity = 1.e-6 * linkSpeed; // B/s -> MB/s
+        } else if (m_is_gv_device && this->getIntFeature("GevLinkSpeed", linkSpeed) == Result::SUCCESS) {
+            m_link_capacity = 0.125 * linkSpeed; // Mb/s -> MB/s
+        } else {
+            m_link_capacity = 0.f;
+        }
 
-        // Verify whether horizontal and vertical flip are available on the camera
-        m_is_flip_x_available = this->is_flip_x_available();
-        m_is_flip_y_available = this->is_flip_y_available();
+        m_ready_buffers.resetHighWaterMark();
+        this->update_workers();
+        h.set("bufferPool.size", m_pool_size);
+        h.set("bufferPool.underruns", 0ull);
+        h.set("bufferPool.queueHighWaterMark", 0u);
+        this->set(h);
+        // Synchronize timestamp.
+        // This will be repeated periodically during acquisition, see syncTimestamp
+        this->synchronize_timestamp();
 
-        // The exposure time feature name is used to read out the increment
-        std::vector<std::string> features = {"ExposureTime",     // e.g. Basler a2A
-                                             "ExposureTimeRaw"}; // e.g. Basler acA
-        for (const std::string& feat : features) {
-            if (this->isFeatureAvailable(feat)) {
-                m_exposure_time_feature = feat;
-                break;
-            }
+        const std::string acquisitionMode = this->get<std::string>("acquisitionMode");
+        if (acquisitionMode == "SingleFrame") {
+            m_isContinuousMode = false;
+            m_imgsToBeAcquired = 1;
+        } else if (acquisitionMode == "MultiFrame") {
+            m_isContinuousMode = false;
+            m_imgsToBeAcquired = this->get<long long int>("frameCount");
+        } else {
+            m_isContinuousMode = true;
+            m_imgsToBeAcquired = 0; // unused in continuous mode
         }
 
-        if (error != nullptr) {
-            const std::string detailed_msg(error->message);
-            this->connection_failed_helper("An error occurred whilst connecting to " + cameraIp, detailed_msg);
-            g_clear_error(&error);
-            return;
+        {
+            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+            arv_camera_start_acquisition(m_camera, &error);
+            if (error != nullptr) {
+                std::stringstream ss;
+                ss << "arv_camera_start_acquisition failed: " << error->message;
+                this->acquire_failed_helper(ss.str());
+                g_clear_error(&error);
+                return;
+            }
         }
 
-        this->set(h);
+        m_is_acquiring = true;
+        this->set("status", "Acquisition started");
+        this->updateState(State::ACQUIRING);
 
-        // Apply initial configuration
-        Hash initialConfiguration = this->getCurrentConfiguration();
-        this->configure(initialConfiguration);
+        const float interval = this->get<float>("timestampSyncInterval");
+        m_sync_timer.expires_from_now(boost::posix_time::milliseconds(static_cast<long>(1000.f * interval)));
+        m_sync_timer.async_wait(
+              karabo::util::bind_weak(&AravisCamera::syncTimestamp, this, boost::asio::placeholders::error));
 
-        m_need_schema_update = true; // Always update schema upon connection
-        const bool success = this->updateOutputSchema();
-        if (!success) {
-            this->connection_failed_helper("Could not update output schema");
-            return;
-        }
+        m_latency_timer.expires_from_now(boost::posix_time::seconds(1l));
+        m_latency_timer.async_wait(
+              karabo::util::bind_weak(&AravisCamera::updateLatency, this, boost::asio::placeholders::error));
+    }
 
-        if (m_is_acquiring) {
-            // Connection to the camera was lost during acquisition -> restart it
-            this->acquire();
-        } else {
-            this->updateState(State::ON);
-        }
 
-        m_is_connected = true;
-        m_failed_connections = 0;
-        m_reconnect_timer.expires_from_now(boost::posix_time::seconds(5l));
-        m_reconnect_timer.async_wait(
-              karabo::util::bind_weak(&AravisCamera::connect, this, boost::asio::placeholders::error));
+    void AravisCamera::acquire_failed_helper(const std::string& detailed_msg) {
+        const std::string message("Could not start acquisition");
+
+        KARABO_LOG_ERROR << message;
+        KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId() << ": " << detailed_msg;
+        this->postAcquisitionStop();
+        this->updateState(State::ERROR, Hash("status", message));
     }
 
 
-    void AravisCamera::connection_failed_helper(const std::string& message, const std::string& detailed_msg) {
-        const std::string& deviceId = this->getInstanceId();
+    void AravisCamera::stop() {
+        Hash h;
+        h.set("frameRate.actual", 0.f);
+        h.set("errorCount", 0ull);
+        h.set("lastError", "");
+        h.set("timestampErrorCount", 0ull);
+        h.set("lastTimestampError", "");
+        h.set("latency.mean", 0.f);
+        h.set("latency.min", 0.f);
+        h.set("latency.max", 0.f);
+        h.set("bufferPool.occupancy", 0u);
+        h.set("bufferPool.queueDepth", 0u);
+        h.set("processing.processTime", 0.f);
+        h.set("processing.writeTime", 0.f);
+        h.set("recording.rate", 0.f);
+        h.set("streamStatistics.bandwidth", 0.f);
+        h.set("streamStatistics.linkUsage", 0.f);
 
-        if (m_failed_connections < 1) {
-            // Only log first error message
-            KARABO_LOG_ERROR << message;
-            this->set("status", message);
-            if (!detailed_msg.empty()) {
-                KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": " << detailed_msg;
-            }
-        } else {
-            KARABO_LOG_DEBUG << message;
-            if (!detailed_msg.empty()) {
-                KARABO_LOG_FRAMEWORK_DEBUG << deviceId << ": " << detailed_msg;
-            }
+        GError* error = nullptr;
+        {
+            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+            arv_camera_stop_acquisition(m_camera, &error);
         }
+        m_is_acquiring = false;
+        m_sync_timer.cancel();
+        m_latency_timer.cancel();
+        m_errorCount = 0;
+        m_lastError = ARV_BUFFER_STATUS_SUCCESS;
+        m_timestampErrorCount = 0;
+        m_timestampError = "";
 
-        // Increase counter
-        ++m_failed_connections;
+        if (error != nullptr) {
+            const std::string message("Could not stop acquisition");
+            KARABO_LOG_ERROR << message;
+            KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
+                                       << ": arv_camera_stop_acquisition failed: " << error->message;
+            g_clear_error(&error);
+            h.set("status", message);
+            this->updateState(State::ERROR, h);
+            return;
+        }
 
-        // Try reconnecting after some time
-        m_reconnect_timer.expires_from_now(boost::posix_time::seconds(5l));
-        m_reconnect_timer.async_wait(
-              karabo::util::bind_weak(&AravisCamera::connect, this, boost::asio::placeholders::error));
+        h.set("status", "Acquisition stopped");
+        this->signalEOS(); // End-of-Stream signal
+        this->postAcquisitionStop();
+        this->updateState(State::ON, h);
     }
 
 
-    bool AravisCamera::verify_vendor_and_model(const std::string& vendor, const std::string& model) {
-        const std::string& supportedVendor = this->get<std::string>("supportedVendor");
-        if (vendor != supportedVendor) {
-            const std::string msg("This Karabo device does not support cameras from " + vendor);
-            KARABO_LOG_ERROR << msg;
-            this->set("status", msg);
-            return false;
+    void AravisCamera::trigger() {
+        if (!m_arv_camera_trigger) {
+            return;
         }
 
-        const std::vector<std::string>& supportedModels = this->get<std::vector<std::string>>("supportedModels");
-        for (const std::string& supported : supportedModels) {
-            if (model.find(supported) == 0) {
-                return true;
+        GError* error = nullptr;
+
+        const std::string& triggerMode = this->get<std::string>("triggerMode");
+        if (triggerMode == "On") {
+            const std::string& triggerSource = this->get<std::string>("triggerSource");
+            if (triggerSource == "Software") {
+                boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+                arv_camera_software_trigger(m_camera, &error);
+                if (error != nullptr) {
+                    KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
+                                               << ": arv_camera_software_trigger failed: " << error->message;
+                    g_clear_error(&error);
+                }
             }
         }
-        const std::string msg("This Karabo device does not support model " + model + " from " + vendor);
-        KARABO_LOG_ERROR << msg;
-        this->set("status", msg);
-        return false;
     }
 
 
-    bool AravisCamera::set_auto_packet_size() {
-        if (!m_is_gv_device) {
-            // Available on GEV cameras only
-            return true;
+    void AravisCamera::refresh() {
+        // Poll parameters and update options
+        const bool success = this->updateOutputSchema();
+        if (!success) {
+            this->updateState(State::ERROR);
         }
+    }
 
-        GError* error = nullptr;
-        const std::string& deviceId = this->getInstanceId();
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
 
-        const guint packetSize = arv_camera_gv_auto_packet_size(m_camera, &error);
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_gv_auto_packet_size failed: " << error->message;
-            g_clear_error(&error);
-            return false; // failure
+    void AravisCamera::reset() {
+        if (!m_connect) {
+            // Connection task has been stopped
+            this->updateState(State::UNKNOWN, Hash("status", ""));
+            m_connect = true;
+            m_reconnect_timer.expires_from_now(boost::posix_time::milliseconds(1));
+            m_reconnect_timer.async_wait(
+                  karabo::util::bind_weak(&AravisCamera::connect, this, boost::asio::placeholders::error));
+            return;
         }
 
-        arv_camera_gv_set_packet_size(m_camera, packetSize, &error);
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_gv_set_packet_size failed: " << error->message;
-            g_clear_error(&error);
-            return false; // failure
+        // Poll parameters and update options
+        const bool success = this->updateOutputSchema();
+        if (success) {
+            this->updateState(State::ON, Hash("status", ""));
         }
+    }
 
-        return true; // success
+    void AravisCamera::postAcquisitionStop() {
+        // Hook that can be implemented in the derived class, if needed.
     }
 
 
-    bool AravisCamera::set_region(int& x, int& y, int& width, int& height) {
-        GError* error = nullptr;
-        const std::string& deviceId = this->getInstanceId();
+    void AravisCamera::resetCamera() {
+        // To be implemented in the derived class, if the feature is available.
+    }
+
+
+    void AravisCamera::clear_camera() {
         boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+        g_clear_object(&m_camera);
+        m_device = nullptr; // Has been clearead by clearing m_camera
+        boost::mutex::scoped_lock parser_lock(m_parser_mtx);
+        g_clear_object(&m_parser);
+    }
 
-        // Before getting width and height bounds, reset x and y offsets.
-        arv_camera_set_region(m_camera, 0, 0, width, height, &error);
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_region failed: " << error->message;
-            m_width = 0;
-            m_height = 0;
-            g_clear_error(&error);
-            return false; // failure
-        }
 
-        // Get bounds for width and height.
-        // x and y bounds can only be gotten after width and height are applied.
-        gint wmin, wmax, hmin, hmax;
-        arv_camera_get_width_bounds(m_camera, &wmin, &wmax, &error);
-        if (error == nullptr) {
-            arv_camera_get_height_bounds(m_camera, &hmin, &hmax, &error);
+    void AravisCamera::clear_stream() {
+        if (m_stream != nullptr) {
+            // Disable emission of signals and free resource
+            boost::mutex::scoped_lock stream_lock(m_stream_mtx);
+            // The handle is the context of stream_cb, thus it must be kept alive until the stream is cleared
+            std::shared_ptr<StreamHandle> handle;
+            handle.swap(m_stream_handle);
+            if (handle) {
+                // Buffers still held by consumers will not be pushed back to the stream, but freed
+                boost::mutex::scoped_lock handle_lock(handle->mtx);
+                handle->stream = nullptr;
+            }
+            g_clear_object(&m_stream);
+            m_pool_size = 0; // The buffers have been freed together with the stream
         }
+    }
 
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << "Could not get ROI bounds: " << error->message;
-            m_width = 0;
-            m_height = 0;
-            g_clear_error(&error);
-            return false; // failure
-        }
 
-        if (width == 0) {
-            // Whole sensor width
-            width = wmax;
+    void AravisCamera::release_buffer(const std::shared_ptr<StreamHandle>& handle, ArvBuffer* buffer) {
+        boost::mutex::scoped_lock handle_lock(handle->mtx);
+        if (handle->stream != nullptr) {
+            // Push back the buffer to the stream
+            arv_stream_push_buffer(handle->stream, buffer);
         } else {
-            width = max(width, wmin);
-            width = min(width, wmax);
+            // The stream has been cleared in the meanwhile
+            g_object_unref(buffer);
         }
+    }
 
-        if (height == 0) {
-            // Whole sensor height
-            height = hmax;
-        } else {
-            height = max(height, hmin);
-            height = min(height, hmax);
-        }
 
-        // Apply width and height settings
-        arv_camera_set_region(m_camera, 0, 0, width, height, &error);
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_region failed: " << error->message;
-            m_width = 0;
-            m_height = 0;
-            g_clear_error(&error);
-            return false; // failure
+    uint16_t* AravisCamera::get_unpacked_data(std::shared_ptr<void>& owner, bool pooled) {
+        if (!pooled) {
+            return m_unpackedData.data();
         }
 
-        // Get x and y bounds
-        gint xmin, xmax, ymin, ymax;
-        arv_camera_get_x_offset_bounds(m_camera, &xmin, &xmax, &error);
-        if (error == nullptr) {
-            arv_camera_get_y_offset_bounds(m_camera, &ymin, &ymax, &error);
+        // Recycle unpacked data which are not referenced any more by consumers, or by images in flight
+        boost::mutex::scoped_lock unpacked_lock(m_unpacked_mtx);
+        for (const auto& data : m_unpackedPool) {
+            if (data.use_count() == 1) {
+                owner = data;
+                return data->data();
+            }
         }
 
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << "Could not get ROI bounds: " << error->message;
-            m_width = 0;
-            m_height = 0;
-            g_clear_error(&error);
-            return false; // failure
-        }
+        auto data = std::make_shared<std::vector<uint16_t>>(m_unpackedData.size());
+        m_unpackedPool.push_back(data);
+        owner = data;
+        return data->data();
+    }
 
-        x = max(x, xmin);
-        x = min(x, xmax);
-        y = max(y, ymin);
-        y = min(y, ymax);
 
-        // Finally x and y offsets too
-        arv_camera_set_region(m_camera, x, y, width, height, &error);
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_region failed: " << error->message;
-            m_width = 0;
-            m_height = 0;
-            g_clear_error(&error);
-            return false; // failure
+    void* AravisCamera::get_pooled_data(size_t size, std::shared_ptr<void>& owner) {
+        // Recycle images which are not referenced any more by consumers, or by images in flight
+        boost::mutex::scoped_lock unpacked_lock(m_unpacked_mtx);
+        for (const auto& data : m_imagePool) {
+            if (data.use_count() == 1 && data->size() == size) {
+                owner = data;
+                return data->data();
+            }
         }
 
-        m_width = width;
-        m_height = height;
-        return true; // success
+        auto data = std::make_shared<std::vector<uint8_t>>(size);
+        m_imagePool.push_back(data);
+        owner = data;
+        return data->data();
     }
 
 
-    bool AravisCamera::set_binning(int& bin_x, int& bin_y) {
-        GError* error = nullptr;
-        const std::string& deviceId = this->getInstanceId();
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+    char* AravisCamera::get_recording_data(size_t size, std::shared_ptr<char>& owner) {
+        // Recycle the copies which have been written, those of another size are freed
+        for (auto it = m_recordingPool.begin(); it != m_recordingPool.end();) {
+            if (it->second.use_count() > 1) {
+                ++it;
+            } else if (it->first == size) {
+                owner = it->second;
+                return owner.get();
+            } else {
+                it = m_recordingPool.erase(it);
+            }
+        }
 
-        // Get bounds
-        gint xmin, xmax, ymin, ymax;
-        arv_camera_get_x_binning_bounds(m_camera, &xmin, &xmax, &error);
-        if (error == nullptr) {
-            arv_camera_get_y_binning_bounds(m_camera, &ymin, &ymax, &error);
+        owner = FrameRecorder::allocate(size);
+        m_recordingPool.emplace_back(size, owner);
+        return owner.get();
+    }
+
+
+    unsigned int AravisCamera::get_buffer_pool_size(float frame_rate, unsigned int min_size) const {
+        const unsigned int count = this->get<unsigned int>("bufferPool.count");
+        if (this->get<std::string>("bufferPool.mode") != "Adaptive" || m_buffer_size == 0) {
+            return count;
         }
 
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": Could not get binning bounds: " << error->message;
-            g_clear_error(&error);
-            return false; // failure
+        if (frame_rate <= 0.f && this->get<bool>("frameRate.enable")) {
+            // Frame rate not measured yet: use the target one
+            frame_rate = this->get<float>("frameRate.target");
         }
 
-        // Apply bounds
-        bin_x = max(bin_x, xmin);
-        bin_x = min(bin_x, xmax);
-        bin_y = max(bin_y, ymin);
-        bin_y = min(bin_y, ymax);
+        // Enough buffers to bridge 'slack' at the given frame rate...
+        const float slack = 1.e-3f * this->get<float>("bufferPool.slack"); // ms -> s
+        unsigned long long n_buffers = std::ceil(slack * frame_rate);
+        n_buffers = std::max<unsigned long long>({n_buffers, count, min_size});
 
-        arv_camera_set_binning(m_camera, bin_x, bin_y, &error);
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_binning failed: " << error->message;
-            g_clear_error(&error);
-            return false; // failure
-        }
+        // ... but not more than what fits in the memory budget
+        const unsigned long long budget = 1000000ull * this->get<unsigned int>("bufferPool.memoryBudget"); // MB -> B
+        const unsigned long long affordable = std::max(2ull, budget / m_buffer_size);
 
-        return true; // success
+        return std::min({n_buffers, affordable, 10000ull});
     }
 
 
-    bool AravisCamera::set_exposure_time(double& exposure_time) {
-        GError* error = nullptr;
-        const std::string& deviceId = this->getInstanceId();
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+    void AravisCamera::grow_buffer_pool(unsigned int n_buffers) {
+        // N.B. The caller must hold m_stream_mtx
+        for (; m_pool_size < n_buffers; ++m_pool_size) {
+            arv_stream_push_buffer(m_stream, arv_buffer_new(m_buffer_size, nullptr));
+        }
+    }
 
-        // Get bounds
-        double tmin, tmax;
-        arv_camera_get_exposure_time_bounds(m_camera, &tmin, &tmax, &error);
 
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId
-                                       << ": arv_camera_get_exposure_time_bounds failed: " << error->message;
-            g_clear_error(&error);
-            return false; // failure
-        }
+    void AravisCamera::update_buffer_pool(karabo::data::Hash& h) {
+        boost::mutex::scoped_lock stream_lock(m_stream_mtx);
+        if (m_stream == nullptr) return;
 
-        // Get increment
-        double incr = G_MINDOUBLE;
-        ArvGcNode* exptime_node = arv_device_get_feature(m_device, m_exposure_time_feature.c_str());
-        if (ARV_IS_GC_INTEGER(exptime_node)) {
-            incr = arv_camera_get_integer_increment(m_camera, m_exposure_time_feature.c_str(), &error);
-        } else if (ARV_IS_GC_FLOAT(exptime_node)) {
-            incr = arv_camera_get_float_increment(m_camera, m_exposure_time_feature.c_str(), &error);
+        guint64 n_completed, n_failures, n_underruns;
+        arv_stream_get_statistics(m_stream, &n_completed, &n_failures, &n_underruns);
+
+        if (this->get<std::string>("bufferPool.mode") == "Adaptive") {
+            unsigned int min_size = m_pool_size;
+            if (n_underruns > m_pool_underruns) {
+                // The stream ran out of buffers: grow the pool by 50%
+                min_size += std::max(2u, m_pool_size / 2);
+            }
+
+            // The pool is also grown if the frame rate increased
+            const unsigned int n_buffers = this->get_buffer_pool_size(m_last_frame_rate, min_size);
+            if (n_buffers > m_pool_size) {
+                KARABO_LOG_FRAMEWORK_INFO << this->getInstanceId() << ": growing the buffer pool from " << m_pool_size
+                                          << " to " << n_buffers << " buffers";
+                this->grow_buffer_pool(n_buffers);
+            }
         }
+        m_pool_underruns = n_underruns;
 
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_get_*_increment failed: " << error->message;
-            g_clear_error(&error);
-            return false; // failure
+        gint n_input, n_output;
+        arv_stream_get_n_buffers(m_stream, &n_input, &n_output);
+        h.set("bufferPool.size", m_pool_size);
+        h.set("bufferPool.occupancy", static_cast<unsigned int>(std::max(0, int(m_pool_size) - n_input)));
+        h.set("bufferPool.underruns", static_cast<unsigned long long>(n_underruns - m_pool_underruns_start));
+        h.set("bufferPool.queueDepth", static_cast<unsigned int>(m_ready_buffers.depth()));
+        h.set("bufferPool.queueHighWaterMark", static_cast<unsigned int>(m_ready_buffers.highWaterMark()));
+    }
+
+
+    void AravisCamera::tune_gv_stream(guint payload, karabo::data::Hash& h) {
+        // N.B. The caller must hold m_stream_mtx
+        const std::string& deviceId = this->getInstanceId();
+        const bool isAuto = (this->get<std::string>("streamTuning.socketBufferMode") == "Auto");
+        const unsigned int bufferSize = this->get<unsigned int>("streamTuning.socketBufferSize");
+        const bool packetResend = (this->get<std::string>("streamTuning.packetResend") == "Always");
+        const guint packetTimeout = this->get<unsigned int>("streamTuning.packetTimeout");   // us
+        const guint frameRetention = this->get<unsigned int>("streamTuning.frameRetention"); // us
+        const ArvGvStreamSocketBuffer socketBuffer =
+              isAuto ? ARV_GV_STREAM_SOCKET_BUFFER_AUTO : ARV_GV_STREAM_SOCKET_BUFFER_FIXED;
+        const ArvGvStreamPacketResend resend =
+              packetResend ? ARV_GV_STREAM_PACKET_RESEND_ALWAYS : ARV_GV_STREAM_PACKET_RESEND_NEVER;
+        g_object_set(m_stream, "socket-buffer", socketBuffer, "socket-buffer-size",
+                     static_cast<gint>(std::min<unsigned int>(bufferSize, G_MAXINT)), "packet-timeout", packetTimeout,
+                     "frame-retention", frameRetention, "packet-resend", resend, nullptr);
+
+        // The stream sets the buffer size of its socket the same way, and does not complain if it is not granted.
+        // Thus the same request is done on a probe socket, and the granted size is read back.
+        unsigned int requested = bufferSize;
+        if (isAuto) {
+            requested = (bufferSize > 0) ? std::min<unsigned int>(payload, bufferSize) : payload;
+        }
+        unsigned int granted = 0u;
+        if (requested > 0) {
+            const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+            int value = static_cast<int>(std::min<unsigned int>(requested, G_MAXINT));
+            socklen_t length = sizeof(value);
+            if (fd >= 0 && setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &value, length) == 0 &&
+                getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &value, &length) == 0) {
+                // The kernel doubles the requested size, to account for its bookkeeping
+                granted = value / 2;
+                if (granted < requested) {
+                    KARABO_LOG_FRAMEWORK_WARN << deviceId << ": socket receive buffer of " << requested
+                                              << " bytes requested, but only " << granted
+                                              << " granted. Consider increasing net.core.rmem_max";
+                }
+            }
+            if (fd >= 0) close(fd);
         }
 
-        if (incr > G_MINDOUBLE) {
-            // Exposure time must be incremented in steps.
-            exposure_time = tmin + incr * round((exposure_time - tmin) / incr);
+        // Without CAP_NET_RAW the stream silently falls back to a regular socket
+        bool packetSocket = false;
+        if (this->get<bool>("streamTuning.packetSocket")) {
+            const int fd = socket(AF_PACKET, SOCK_RAW, 0);
+            packetSocket = (fd >= 0);
+            if (packetSocket) {
+                close(fd);
+            } else {
+                KARABO_LOG_FRAMEWORK_WARN << deviceId << ": packet socket not available (" << std::strerror(errno)
+                                          << "), a regular socket is used";
+            }
         }
 
-        // Apply bounds
-        exposure_time = max(exposure_time, tmin);
-        exposure_time = min(exposure_time, tmax);
+        h.set("streamTuning.socketBufferLimit", granted);
+        h.set("streamTuning.packetSocketAvailable", packetSocket);
+    }
 
-        arv_camera_set_exposure_time(m_camera, exposure_time, &error);
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_exposure_time failed: " << error->message;
-            g_clear_error(&error);
-            return false; // failure
-        }
 
-        return true; // success
+    void AravisCamera::read_stream_counters(StreamCounters& counters) const {
+        // N.B. The caller must hold m_stream_mtx
+        arv_stream_get_statistics(m_stream, &counters.completed, &counters.failures, &counters.underruns);
+
+        if (ARV_IS_GV_STREAM(m_stream)) {
+            counters.resentPackets = arv_stream_get_info_uint64_by_name(m_stream, "n_resent_packets");
+            counters.missingPackets = arv_stream_get_info_uint64_by_name(m_stream, "n_missing_packets");
+            counters.ignoredPackets = arv_stream_get_info_uint64_by_name(m_stream, "n_ignored_packets");
+            counters.timeouts = arv_stream_get_info_uint64_by_name(m_stream, "n_timeouts");
+        }
     }
 
-    std::string AravisCamera::get_frame_rate_enable_parameter_name() const {
-        return "AcquisitionFrameRateEnable";
+
+    void AravisCamera::update_stream_statistics(karabo::data::Hash& h, double elapsed) {
+        StreamCounters counters;
+        {
+            boost::mutex::scoped_lock stream_lock(m_stream_mtx);
+            if (m_stream == nullptr) return;
+            this->read_stream_counters(counters);
+        }
+
+        const StreamCounters& start = m_stream_counters_start;
+        h.set("streamStatistics.completed", static_cast<unsigned long long>(counters.completed - start.completed));
+        h.set("streamStatistics.failures", static_cast<unsigned long long>(counters.failures - start.failures));
+        h.set("streamStatistics.underruns", static_cast<unsigned long long>(counters.underruns - start.underruns));
+        h.set("streamStatistics.resentPackets",
+              static_cast<unsigned long long>(counters.resentPackets - start.resentPackets));
+        h.set("streamStatistics.missingPackets",
+              static_cast<unsigned long long>(counters.missingPackets - start.missingPackets));
+        h.set("streamStatistics.ignoredPackets",
+              static_cast<unsigned long long>(counters.ignoredPackets - start.ignoredPackets));
+        h.set("streamStatistics.timeouts", static_cast<unsigned long long>(counters.timeouts - start.timeouts));
+        h.set("streamStatistics.queueOverflows", m_queue_overflows.load());
+
+        for (size_t i = 0; i < m_bufferStatusKeys.size(); ++i) {
+            h.set(std::string("streamStatistics.status.") + m_bufferStatusKeys[i].key, m_status_counts[i].load());
+        }
+
+        // Only the completed buffers are counted, thus the bandwidth is the useful one
+        const float bandwidth = 1.e-6 * (counters.completed - m_last_completed) * m_buffer_size / elapsed; // MB/s
+        m_last_completed = counters.completed;
+        h.set("streamStatistics.bandwidth", bandwidth);
+        h.set("streamStatistics.linkCapacity", m_link_capacity);
+        h.set<float>("streamStatistics.linkUsage", (m_link_capacity > 0.f) ? 100. * bandwidth / m_link_capacity : 0.);
     }
 
-    bool AravisCamera::set_frame_rate(bool enable, double frame_rate) {
-        GError* error = nullptr;
-        const std::string& deviceId = this->getInstanceId();
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
 
-        if (enable) {
-            // set frame rate
+    size_t AravisCamera::status_index(ArvBufferStatus status) {
+        // The statuses added by later aravis versions are counted as unknown
+        if (status < ARV_BUFFER_STATUS_UNKNOWN || status > ARV_BUFFER_STATUS_ABORTED) return 0;
+        return status - ARV_BUFFER_STATUS_UNKNOWN;
+    }
 
-            if (frame_rate <= 0.) {
-                // If no valid rate is provided, the one on the camera is re-applied
-                frame_rate = arv_camera_get_frame_rate(m_camera, &error);
-                if (error != nullptr) {
-                    KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_get_frame_rate failed: " << error->message;
-                    g_clear_error(&error);
-                    return false; // failure
-                }
-            }
 
-            // read the current trigger selector
-            const std::string& triggerSelector =
-                  arv_device_get_string_feature_value(m_device, "TriggerSelector", &error);
-            if (error != nullptr) {
-                KARABO_LOG_FRAMEWORK_ERROR << deviceId
-                                           << ": arv_device_get_string_feature_value failed: " << error->message;
-                g_clear_error(&error);
-                return false; // failure
-            }
+    void AravisCamera::stream_cb(void* context, ArvStreamCallbackType type, ArvBuffer* buffer) {
+        // This code is called from the stream receiving thread, which means all the time spent there is less time
+        // available for the reception of incoming packets
 
-            // read which triggers are "On" in order to restore them later
-            guint n_triggers;
-            const char** triggerSelectorOptions = arv_camera_dup_available_triggers(m_camera, &n_triggers, &error);
-            if (error != nullptr) {
-                KARABO_LOG_FRAMEWORK_ERROR << deviceId
-                                           << ": arv_camera_dup_available_triggers failed: " << error->message;
-                g_clear_error(&error);
-                return false; // failure
+        StreamHandle* handle = static_cast<StreamHandle*>(context);
+        AravisCamera* self = handle->camera;
+        const std::string& deviceId = self->getInstanceId();
+
+        if (type == ARV_STREAM_CALLBACK_TYPE_INIT) {
+            // Stream thread started
+            KARABO_LOG_FRAMEWORK_DEBUG << deviceId << ": ARV_STREAM_CALLBACK_TYPE_INIT";
+            if (!arv_make_thread_realtime(10) && !arv_make_thread_high_priority(-10)) {
+                KARABO_LOG_FRAMEWORK_WARN << deviceId << ": Failed to make stream thread high priority";
             }
+        } else if (type == ARV_STREAM_CALLBACK_TYPE_BUFFER_DONE) {
+            // No lock is taken here: the stream is valid as long as its thread is running
+            ArvStream* stream = handle->rx_stream.load(std::memory_order_acquire);
 
-            std::vector<std::string> triggerOn;
-            for (unsigned short i = 0; i < n_triggers; ++i) {
-                arv_device_set_string_feature_value(m_device, "TriggerSelector", triggerSelectorOptions[i], &error);
-                if (error != nullptr) break;
+            // The buffer is received, successfully or not
+            ArvBufferStatus buffer_status = arv_buffer_get_status(buffer);
+            self->m_status_counts[AravisCamera::status_index(buffer_status)].fetch_add(1, std::memory_order_relaxed);
+            if (buffer == arv_stream_pop_buffer(stream) && buffer_status == ARV_BUFFER_STATUS_SUCCESS) {
+                // AravisCamera::process_buffer can take long thus is executed in the processing thread.
+                // 'process_buffer' shall also take care of calling arv_stream_push_buffer
+                if (self->m_ready_buffers.try_push({buffer, handle->generation, std::chrono::steady_clock::now()})) {
+                    return;
+                }
 
-                const std::string mode(arv_device_get_string_feature_value(m_device, "TriggerMode", &error));
-                if (error != nullptr) break;
+                // The queue is full: the image is dropped
+                arv_stream_push_buffer(stream, buffer);
+                self->m_queue_overflows.fetch_add(1, std::memory_order_relaxed);
+                self->m_errorCount.fetch_add(1, std::memory_order_relaxed);
+                self->m_lastError.store(ARV_BUFFER_STATUS_UNKNOWN, std::memory_order_relaxed);
+            } else {
+                // Push back the buffer to the stream
+                arv_stream_push_buffer(stream, buffer);
 
-                if (mode == "On") {
-                    triggerOn.push_back(triggerSelectorOptions[i]);
+                self->m_errorCount.fetch_add(1, std::memory_order_relaxed);
+                if (buffer_status == ARV_BUFFER_STATUS_SUCCESS) {
+                    // Other ERROR:
+                    // The buffer status is OK but the buffer received by the
+                    // callback does not match the one popped from the queue.
+                    self->m_lastError.store(ARV_BUFFER_STATUS_UNKNOWN, std::memory_order_relaxed);
+                } else {
+                    self->m_lastError.store(buffer_status, std::memory_order_relaxed);
                 }
             }
+        }
+    }
 
-            if (error != nullptr) {
-                KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": Could not get TriggerModes: " << error->message;
-                g_clear_error(&error);
-                return false; // failure
-            }
 
-            // N.B. this function will set triggerMode to "Off" on all the selectors
-            arv_camera_set_frame_rate(m_camera, frame_rate, &error);
-            if (error != nullptr) {
-                KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_frame_rate failed: " << error->message;
-                g_clear_error(&error);
-                return false; // failure
+    void AravisCamera::process_buffers() {
+        std::shared_ptr<StreamHandle> handle;
+        ReadyBuffer ready;
+
+        while (true) {
+            if (!m_ready_buffers.try_pop(ready)) {
+                m_ready_buffers.wait();
+                continue;
             }
 
-            // restore trigger modes
-            for (const std::string& selector : triggerOn) {
-                arv_device_set_string_feature_value(m_device, "TriggerSelector", selector.c_str(), &error);
-                if (error != nullptr) break;
+            if (ready.buffer == nullptr) {
+                // Stop requested
+                break;
+            }
 
-                arv_device_set_string_feature_value(m_device, "TriggerMode", "On", &error);
-                if (error != nullptr) break;
+            if (!handle || handle->generation != ready.generation) {
+                // The stream has changed since the last image
+                boost::mutex::scoped_lock stream_lock(m_stream_mtx);
+                handle = m_stream_handle;
             }
 
-            if (error != nullptr) {
-                KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": Could not restore TriggerModes: " << error->message;
-                g_clear_error(&error);
-                return false; // failure
+            if (!handle || handle->generation != ready.generation) {
+                // The stream the buffer belongs to has been cleared in the meanwhile
+                g_object_unref(ready.buffer);
+                continue;
             }
 
-            // restore trigger selector
-            arv_device_set_string_feature_value(m_device, "TriggerSelector", triggerSelector.c_str(), &error);
-            if (error != nullptr) {
-                KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": Could not restore TriggerSelector: " << error->message;
-                g_clear_error(&error);
-                return false; // failure
+            try {
+                this->process_buffer(ready.buffer, handle, ready.received);
+            } catch (const std::exception& e) {
+                KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId() << ": Could not process image: " << e.what();
             }
+        }
+    }
 
-        } else { // enable == false
-            const std::string parameter_name(get_frame_rate_enable_parameter_name());
-            arv_device_set_boolean_feature_value(m_device, parameter_name.c_str(), false, &error);
-            if (error != nullptr) {
-                KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": Could not set " << parameter_name << ": "
-                                           << error->message;
-                g_clear_error(&error);
-                return false; // failure
+
+    void AravisCamera::update_workers() {
+        const unsigned int n_workers = this->get<unsigned int>("processing.workers");
+        const std::shared_ptr<WorkerPool> workers = std::atomic_load(&m_workers);
+
+        if (n_workers == 0) {
+            // Images are processed in the processing thread
+            std::atomic_store(&m_workers, std::shared_ptr<WorkerPool>());
+        } else if (!workers || workers->size() != n_workers) {
+            std::atomic_store(&m_workers, std::make_shared<WorkerPool>(n_workers));
+        } else {
+            return;
+        }
+        // The images still in the previous pool are written before its threads are joined
+        this->wait_for_frames();
+    }
+
+
+    void AravisCamera::wait_for_frames() {
+        // The images do not own the worker pool: it must not be released while any of them is in flight.
+        // An image gets its sequence number before it gets the pool, thus it is waited for if it got the previous one.
+        const unsigned long long sequence = m_next_sequence;
+        while (true) {
+            {
+                boost::mutex::scoped_lock reorder_lock(m_reorder_mtx);
+                if (m_next_write >= sequence && !m_is_writing) return;
             }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
+    }
 
-        return true; // success
+
+    void AravisCamera::stop_processing_thread() {
+        if (!m_processing_thread.joinable()) return;
+
+        // The stream has been cleared, thus this is now the only producer
+        while (!m_ready_buffers.try_push({nullptr, 0u, {}})) {
+            std::this_thread::yield();
+        }
+        m_processing_thread.join();
     }
 
 
-    bool AravisCamera::get_gain(double& absGain, double& normGain) {
-        GError* error = nullptr;
-        const std::string& deviceId = this->getInstanceId();
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+    void AravisCamera::process_buffer(ArvBuffer* arv_buffer, const std::shared_ptr<StreamHandle>& handle,
+                                      std::chrono::steady_clock::time_point received) {
+        const auto dequeued = std::chrono::steady_clock::now();
+        const karabo::data::Timestamp dev_ts = this->getActualTimestamp();
+        const std::shared_ptr<const FramePlan> plan = std::atomic_load(&m_framePlan);
+        if (!plan || plan->process == nullptr) {
+            // Not configured yet, or the images cannot be processed
+            AravisCamera::release_buffer(handle, arv_buffer);
+            return;
+        }
 
-        // Get bounds
-        double gmin, gmax;
-        arv_camera_get_gain_bounds(m_camera, &gmin, &gmax, &error);
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_get_gain_bounds failed: " << error->message;
-            g_clear_error(&error);
-            return false; // failure
-        } else if (gmin >= gmax) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": gmin >= gmax";
-            return false;
+        auto frame = std::make_shared<Frame>();
+        frame->buffer = arv_buffer;
+        frame->frame_id = arv_buffer_get_frame_id(arv_buffer);
+        frame->handle = handle;
+        frame->plan = plan;
+        frame->times.received = received;
+        frame->times.dequeued = dequeued;
+
+        if (this->get_timestamp(arv_buffer, frame->ts)) {
+            // Latency between the image timestamp and the reception time
+            frame->has_latency = true;
+            frame->latency = dev_ts.getEpochstamp() - frame->ts.getEpochstamp();
+        } else {
+            // HW timestamp not available: use actual one from device
+            frame->has_latency = false;
+            frame->ts = dev_ts;
         }
 
-        const double _gain = arv_camera_get_gain(m_camera, &error); // raw gain
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_get_gain failed: " << error->message;
-            g_clear_error(&error);
-            return false; // failure
+        // From now on the frame must reach complete_frame, otherwise the next images would never be written.
+        // The sequence number is taken before the worker pool, see wait_for_frames.
+        frame->sequence = m_next_sequence++;
+        const std::shared_ptr<WorkerPool> workers = std::atomic_load(&m_workers);
+        frame->workers = workers.get();
+
+        if (!workers) {
+            this->transform_frame(*frame);
+            this->complete_frame(frame);
+            return;
+        }
+
+        // Unpacking, flipping and rotating the images can be done concurrently,
+        // complete_frame will take care of writing them in order
+        workers->post([this, frame]() {
+            this->transform_frame(*frame);
+            this->complete_frame(frame);
+        });
+    }
+
+
+    void AravisCamera::transform_frame(Frame& frame) {
+        // This function can be executed concurrently for several images,
+        // thus it must only access the frame and the immutable plan, or the reference capture as done by capture_frame.
+        const FramePlan& plan = *frame.plan;
+        const auto start = std::chrono::steady_clock::now();
+        frame.times.started = start;
+
+        size_t buffer_size;
+        const void* buffer_data = arv_buffer_get_data(frame.buffer, &buffer_size);
+
+        try {
+            // No pixel format, flip or rotation is evaluated here: they were resolved when the plan was built
+            (this->*plan.process)(buffer_data, frame);
+            frame.times.processed = std::chrono::steady_clock::now();
+            if (m_is_capturing && frame.image) {
+                this->capture_frame(frame);
+            }
+            if (plan.correction && frame.image) {
+                this->correct_frame(frame);
+            }
+            if (plan.statistics && frame.image && !frame.statistics) {
+                // Not accumulated while unpacking
+                this->compute_statistics(frame);
+            }
+            if (plan.compression && frame.image) {
+                this->compress_frame(frame);
+            }
+        } catch (const std::exception& e) {
+            KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId() << ": Could not process image: " << e.what();
+            frame.image.reset();
         }
 
-        absGain = _gain;
-        normGain = (_gain - gmin) / (gmax - gmin); // normalized gain
-        return true;                               // success
+        frame.times.transformed = std::chrono::steady_clock::now();
+        frame.process_time = std::chrono::duration<double>(frame.times.transformed - start).count();
     }
 
 
-    bool AravisCamera::set_gain(double& absGain, double& normGain, bool normalized) {
-        GError* error = nullptr;
-        const std::string& deviceId = this->getInstanceId();
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+    template <class T, AravisCamera::PixelSource Source, AravisCamera::PixelTransform Transform, bool Orient,
+              bool ZeroCopy>
+    void AravisCamera::process_frame(const void* data, Frame& frame) {
+        const FramePlan& plan = *frame.plan;
 
-        // Get bounds
-        double gmin, gmax;
-        arv_camera_get_gain_bounds(m_camera, &gmin, &gmax, &error);
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_get_gain_bounds failed: " << error->message;
-            g_clear_error(&error);
-            return false; // failure
-        }
+        if constexpr (Transform == PixelTransform::DEMOSAIC) {
+            std::shared_ptr<void> unpackedOwner; // The unpacked mosaic is only needed until interpolated
+            const T* mosaic = this->read_pixels<T, Source>(data, frame, unpackedOwner);
 
-        if (normalized) { // Convert normalized to absolute gain
-            if (normGain < 0) {
-                normGain = 0;
-                absGain = gmin;
-            } else if (normGain < 1.) {
-                absGain = gmin + normGain * (gmax - gmin);
+            // Interpolate the RGB image, in stripes of rows processed concurrently by the worker pool, if any
+            std::shared_ptr<void> rgbOwner;
+            T* rgb = static_cast<T*>(this->get_pooled_data(plan.shape.size() * sizeof(T), rgbOwner));
+            const auto demosaicRows = [&plan, mosaic, rgb](size_t rowBegin, size_t rowEnd) {
+                kernels::demosaic(mosaic, plan.width, plan.height, plan.demosaicParameters, rowBegin, rowEnd, rgb);
+            };
+            if (frame.workers) {
+                frame.workers->parallel_for(plan.height, 64, demosaicRows);
             } else {
-                normGain = 1;
-                absGain = gmax;
+                demosaicRows(0, plan.height);
             }
-        } else {
-            if (absGain < gmin) {
-                absGain = gmin;
-                normGain = 0;
-            } else if (absGain < gmax) {
-                normGain = (absGain - gmin) / (gmax - gmin);
+
+            // The stream buffer is not needed any more
+            AravisCamera::release_buffer(frame.handle, frame.buffer);
+            frame.buffer = nullptr;
+
+            if constexpr (Orient) {
+                const void* oriented = this->orient_image(rgb, 3 * sizeof(T), frame);
+                this->make_image<T>(oriented, frame, plan.orientedShape);
             } else {
-                absGain = gmax;
-                normGain = 1.;
+                frame.owner = rgbOwner;
+                this->make_image<T>(rgb, frame, plan.shape);
+            }
+        } else if constexpr (Transform == PixelTransform::BIN_SUM || Transform == PixelTransform::BIN_AVERAGE) {
+            typedef std::conditional_t<Transform == PixelTransform::BIN_SUM, uint32_t, T> Binned;
+            std::shared_ptr<void> unpackedOwner; // The unpacked pixels are only needed until binned
+            const T* pixels = this->read_pixels<T, Source>(data, frame, unpackedOwner);
+
+            // Bin the image, in stripes of rows processed concurrently by the worker pool, if any.
+            // plan.shape is the binned shape.
+            std::shared_ptr<void> binnedOwner;
+            Binned* binned =
+                  static_cast<Binned*>(this->get_pooled_data(plan.shape.size() * sizeof(Binned), binnedOwner));
+            const auto binRows = [&plan, pixels, binned](size_t rowBegin, size_t rowEnd) {
+                if constexpr (Transform == PixelTransform::BIN_SUM) {
+                    kernels::binSum(pixels, plan.width, plan.binX, plan.binY, rowBegin, rowEnd, binned);
+                } else {
+                    kernels::binAverage(pixels, plan.width, plan.binX, plan.binY, rowBegin, rowEnd, binned);
+                }
+            };
+            if (frame.workers) {
+                frame.workers->parallel_for(plan.shape.x1(), 16, binRows);
+            } else {
+                binRows(0, plan.shape.x1());
             }
-        }
 
-        arv_camera_set_gain(m_camera, absGain, &error);
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_gain failed: " << error->message;
-            g_clear_error(&error);
-            return false; // failure
-        }
+            // The stream buffer is not needed any more
+            AravisCamera::release_buffer(frame.handle, frame.buffer);
+            frame.buffer = nullptr;
 
-        return true; // success
+            if constexpr (Orient) {
+                const void* oriented = this->orient_image(binned, sizeof(Binned), frame);
+                this->make_image<Binned>(oriented, frame, plan.orientedShape);
+            } else {
+                frame.owner = binnedOwner;
+                this->make_image<Binned>(binned, frame, plan.shape);
+            }
+        } else if constexpr (Source == PixelSource::YUV) {
+            static_assert(std::is_same_v<T, unsigned char>, "YUV 4:2:2 pixels are converted to 8 bits");
+            const uint8_t* yuv = static_cast<const uint8_t*>(data);
+            const size_t width = plan.width;
+            const size_t channels = (plan.shape.rank() > 2) ? plan.shape.x3() : 1;
+
+            // Convert into an image from the pool, in stripes of rows processed concurrently by the worker pool,
+            // if any. Each stripe must start with a full pair of pixels.
+            std::shared_ptr<void> convertedOwner;
+            uint8_t* converted = static_cast<uint8_t*>(this->get_pooled_data(plan.shape.size(), convertedOwner));
+            const auto convertRows = [&plan, yuv, converted, width, channels](size_t rowBegin, size_t rowEnd) {
+                plan.convertYuv(yuv + 2 * rowBegin * width, (rowEnd - rowBegin) * width,
+                                converted + rowBegin * width * channels);
+            };
+            if (frame.workers && width % 2 == 0) {
+                frame.workers->parallel_for(plan.height, 64, convertRows);
+            } else {
+                convertRows(0, plan.height);
+            }
+
+            // The stream buffer is not needed any more
+            AravisCamera::release_buffer(frame.handle, frame.buffer);
+            frame.buffer = nullptr;
+
+            if constexpr (Orient) {
+                const void* oriented = this->orient_image(converted, channels, frame);
+                this->make_image<T>(oriented, frame, plan.orientedShape);
+            } else {
+                frame.owner = convertedOwner;
+                this->make_image<T>(converted, frame, plan.shape);
+            }
+        } else if constexpr (Source == PixelSource::PACKED) {
+            static_assert(std::is_same_v<T, unsigned short>, "Packed pixels are unpacked to 16 bits");
+            // In zero-copy mode the unpacked data are handed over to the output channels together with their
+            // ownership, they are recycled when the last consumer releases the image. They are also pooled if
+            // several images are processed concurrently, or if the preview thread may still read them.
+            const uint8_t* packed = reinterpret_cast<const uint8_t*>(data);
+            const bool pooled = ZeroCopy || frame.workers != nullptr || plan.preview;
+            uint16_t* unpacked = this->get_unpacked_data(frame.owner, pooled);
+            if constexpr (Orient) {
+                // Unpack, flip and rotate in one pass
+                kernels::unpackOriented(plan.unpack, plan.packedBits, packed, plan.width, plan.height,
+                                        plan.orientation, unpacked);
+                this->make_image<T>(unpacked, frame, plan.orientedShape);
+            } else if (plan.statistics && !plan.correction) {
+                // Unpack and accumulate the statistics in one pass
+                frame.statistics.emplace();
+                kernels::unpackStatistics(plan.unpack, plan.packedBits, packed, size_t(plan.width) * plan.height,
+                                          plan.saturation, plan.histogramShift, unpacked, *frame.statistics);
+                this->make_image<T>(unpacked, frame, plan.shape);
+            } else {
+                plan.unpack(packed, size_t(plan.width) * plan.height, unpacked);
+                this->make_image<T>(unpacked, frame, plan.shape);
+            }
+        } else if constexpr (Source == PixelSource::PLANAR && Orient) {
+            // The planes are flipped and rotated one by one, plan.shape is (3, height, width)
+            const size_t planeBytes = size_t(plan.width) * plan.height * sizeof(T);
+            uint8_t* oriented = static_cast<uint8_t*>(this->get_pooled_data(3 * planeBytes, frame.owner));
+            for (size_t plane = 0; plane < 3; ++plane) {
+                kernels::orientImage(static_cast<const uint8_t*>(data) + plane * planeBytes, plan.width, plan.height,
+                                     sizeof(T), plan.orientation, oriented + plane * planeBytes);
+            }
+            AravisCamera::release_buffer(frame.handle, frame.buffer);
+            frame.buffer = nullptr;
+            this->make_image<T>(oriented, frame, plan.orientedShape);
+        } else if constexpr (Source == PixelSource::RAW_YUV && Orient) {
+            static_assert(std::is_same_v<T, unsigned char>, "YUV 4:2:2 pixels are 8-bit");
+            // Pairs of pixels share the chroma: the slow path moves the luma and resamples the chroma
+            uint8_t* oriented = static_cast<uint8_t*>(this->get_pooled_data(plan.shape.size(), frame.owner));
+            kernels::orientYuv422(static_cast<const uint8_t*>(data), plan.width, plan.height,
+                                  plan.encoding == Encoding::YUV422_UYVY, plan.orientation, oriented);
+            AravisCamera::release_buffer(frame.handle, frame.buffer);
+            frame.buffer = nullptr;
+            this->make_image<T>(oriented, frame, plan.orientedShape);
+        } else if constexpr (Orient) {
+            const size_t pixelBytes = sizeof(T) * (plan.shape.rank() > 2 ? plan.shape.x3() : 1);
+            const void* oriented = this->orient_image(data, pixelBytes, frame);
+            // The stream buffer is not needed any more
+            AravisCamera::release_buffer(frame.handle, frame.buffer);
+            frame.buffer = nullptr;
+            this->make_image<T>(oriented, frame, plan.orientedShape);
+        } else {
+            if constexpr (ZeroCopy) {
+                // The stream buffer is handed over to the output channels together with its ownership, it is
+                // pushed back to the stream when the last consumer releases the image
+                const std::shared_ptr<StreamHandle> handle = frame.handle;
+                frame.owner.reset(frame.buffer,
+                                  [handle](ArvBuffer* buffer) { AravisCamera::release_buffer(handle, buffer); });
+                frame.stream_owner = true;
+                frame.buffer = nullptr;
+            }
+            // Otherwise the stream buffer is pushed back as soon as the image has been written
+            this->make_image<T>(data, frame, plan.shape);
+        }
     }
 
 
-    bool AravisCamera::set_frame_count(gint64& frame_count) {
-        GError* error = nullptr;
-        const std::string& deviceId = this->getInstanceId();
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+    void* AravisCamera::orient_image(const void* data, size_t pixelBytes, Frame& frame) {
+        // Flip and rotate into an image from the pool, which then owns the image data
+        const FramePlan& plan = *frame.plan;
+        void* oriented = this->get_pooled_data(plan.shape.x1() * plan.shape.x2() * pixelBytes, frame.owner);
+        kernels::orientImage(data, plan.shape.x2(), plan.shape.x1(), pixelBytes, plan.orientation, oriented);
+        return oriented;
+    }
 
-        // Get bounds
-        gint64 fmin, fmax;
-        arv_camera_get_frame_count_bounds(m_camera, &fmin, &fmax, &error);
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_get_frame_count_bounds failed: " << error->message;
-            g_clear_error(&error);
-            return false; // failure
+
+    template <class T, AravisCamera::PixelSource Source>
+    const T* AravisCamera::read_pixels(const void* data, Frame& frame, std::shared_ptr<void>& owner) {
+        if constexpr (Source == PixelSource::PACKED) {
+            // The unpacked data are pooled if several images are processed concurrently
+            const FramePlan& plan = *frame.plan;
+            uint16_t* unpacked = this->get_unpacked_data(owner, frame.workers != nullptr);
+            plan.unpack(static_cast<const uint8_t*>(data), size_t(plan.width) * plan.height, unpacked);
+            return unpacked;
+        } else {
+            return static_cast<const T*>(data);
         }
+    }
 
-        // Apply bounds
-        frame_count = max(frame_count, fmin);
-        frame_count = min(frame_count, fmax);
 
-        arv_camera_set_frame_count(m_camera, frame_count, &error);
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_frame_count failed: " << error->message;
-            g_clear_error(&error);
-            return false; // failure
+    template <class T, AravisCamera::PixelSource Source, AravisCamera::PixelTransform Transform>
+    AravisCamera::FrameProcessor AravisCamera::select_frame_processor(bool orient, bool zeroCopy) {
+        if (orient) {
+            return zeroCopy ? &AravisCamera::process_frame<T, Source, Transform, true, true>
+                            : &AravisCamera::process_frame<T, Source, Transform, true, false>;
+        } else {
+            return zeroCopy ? &AravisCamera::process_frame<T, Source, Transform, false, true>
+                            : &AravisCamera::process_frame<T, Source, Transform, false, false>;
         }
+    }
 
-        return true; // success
+
+    template <class T, AravisCamera::PixelSource Source>
+    AravisCamera::FrameProcessor AravisCamera::select_frame_processor(PixelTransform transform, bool orient,
+                                                                      bool zeroCopy) {
+        switch (transform) {
+            case PixelTransform::DEMOSAIC:
+                return select_frame_processor<T, Source, PixelTransform::DEMOSAIC>(orient, zeroCopy);
+            case PixelTransform::BIN_SUM:
+                return select_frame_processor<T, Source, PixelTransform::BIN_SUM>(orient, zeroCopy);
+            case PixelTransform::BIN_AVERAGE:
+                return select_frame_processor<T, Source, PixelTransform::BIN_AVERAGE>(orient, zeroCopy);
+            default:
+                return select_frame_processor<T, Source, PixelTransform::NONE>(orient, zeroCopy);
+        }
     }
 
 
-    void AravisCamera::configure(karabo::data::Hash& configuration) {
-        if (m_camera == nullptr) {
-            // cannot configure camera, as we are not connected
-            return;
+    AravisCamera::FrameProcessor AravisCamera::select_frame_processor(const FramePlan& plan) {
+        const bool orient = plan.orient;
+        const bool zeroCopy = plan.zeroCopy;
+        // Software binning is only done on monochrome images
+        const PixelTransform binning = !plan.bin          ? PixelTransform::NONE
+                                       : plan.binAverage ? PixelTransform::BIN_AVERAGE
+                                                         : PixelTransform::BIN_SUM;
+        const PixelTransform demosaic = plan.demosaic ? PixelTransform::DEMOSAIC : PixelTransform::NONE;
+        const PixelTransform none = PixelTransform::NONE;
+
+        // NB When a new pixel format is supported, do not forget to add it to m_supportedPixelFormats
+        // and to the updateOutputSchema function
+        switch (plan.format) {
+            case ARV_PIXEL_FORMAT_MONO_8:
+                return select_frame_processor<unsigned char, PixelSource::DIRECT>(binning, orient, zeroCopy);
+            case ARV_PIXEL_FORMAT_MONO_10:
+            case ARV_PIXEL_FORMAT_MONO_12:
+            case ARV_PIXEL_FORMAT_MONO_14:
+            case ARV_PIXEL_FORMAT_MONO_16:
+                return select_frame_processor<unsigned short, PixelSource::DIRECT>(binning, orient, zeroCopy);
+            case ARV_PIXEL_FORMAT_MONO_10_PACKED:
+            case ARV_PIXEL_FORMAT_MONO_12_PACKED:
+            case ARV_PIXEL_FORMAT_MONO_10_P:
+            case ARV_PIXEL_FORMAT_MONO_12_P:
+                return select_frame_processor<unsigned short, PixelSource::PACKED>(binning, orient, zeroCopy);
+            default:
+                break;
         }
 
-        GError* error = nullptr;
-        const std::string& deviceId = this->getInstanceId();
+        if (plan.bin) {
+            return nullptr;
+        }
 
-        // Available on GEV cameras only
-        if (m_is_gv_device) {
-            if (configuration.has("packetDelay")) {
-                boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-                arv_camera_gv_set_packet_delay(m_camera, configuration.get<long long>("packetDelay"), &error);
-                if (error != nullptr) {
-                    KARABO_LOG_FRAMEWORK_ERROR << deviceId
-                                               << ": arv_camera_gv_set_packet_delay failed: " << error->message;
-                    configuration.erase("packetDelay");
-                    g_clear_error(&error);
+        switch (plan.format) {
+            case ARV_PIXEL_FORMAT_RGB_8_PACKED:
+            case ARV_PIXEL_FORMAT_BGR_8_PACKED:
+                return select_frame_processor<unsigned char, PixelSource::DIRECT>(none, orient, zeroCopy);
+            case ARV_PIXEL_FORMAT_BAYER_RG_8:
+            case ARV_PIXEL_FORMAT_BAYER_GR_8:
+                return select_frame_processor<unsigned char, PixelSource::DIRECT>(demosaic, orient, zeroCopy);
+            case ARV_PIXEL_FORMAT_RGB_10_PACKED:
+            case ARV_PIXEL_FORMAT_BGR_10_PACKED:
+            case ARV_PIXEL_FORMAT_RGB_12_PACKED:
+            case ARV_PIXEL_FORMAT_BGR_12_PACKED:
+                // XXX RGB and BGR not tested
+                return select_frame_processor<unsigned short, PixelSource::DIRECT>(none, orient, zeroCopy);
+            case ARV_PIXEL_FORMAT_BAYER_RG_10:
+            case ARV_PIXEL_FORMAT_BAYER_RG_12:
+            case ARV_PIXEL_FORMAT_BAYER_GR_10:
+            case ARV_PIXEL_FORMAT_BAYER_GR_12:
+                return select_frame_processor<unsigned short, PixelSource::DIRECT>(demosaic, orient, zeroCopy);
+            case ARV_PIXEL_FORMAT_BAYER_RG_10P:
+            case ARV_PIXEL_FORMAT_BAYER_GR_10P:
+            case ARV_PIXEL_FORMAT_BAYER_RG_12P:
+            case ARV_PIXEL_FORMAT_BAYER_GR_12P:
+                return select_frame_processor<unsigned short, PixelSource::PACKED>(demosaic, orient, zeroCopy);
+            case ARV_PIXEL_FORMAT_YCBCR_422_8:
+            case ARV_PIXEL_FORMAT_YUV_422_PACKED:
+            case ARV_PIXEL_FORMAT_YUV_422_YUYV_PACKED:
+                if (plan.convertYuv != nullptr) {
+                    // The converted image can be flipped and rotated
+                    return select_frame_processor<unsigned char, PixelSource::YUV, PixelTransform::NONE>(
+                          orient, zeroCopy);
                 }
-            }
-
-            const bool autoPacketSize = GET_PATH(configuration, "autoPacketSize", bool);
-            if (autoPacketSize) {
-                const bool success = this->set_auto_packet_size();
-                if (!success && configuration.has("autoPacketSize")) {
-                    configuration.erase("autoPacketSize");
+                // In YUV 4:2:2 images, pairs of pixels share the chroma: they cannot be flipped nor rotated
+                // pixel by pixel, the generic path is slower
+                if (orient) {
+                    return select_frame_processor<unsigned char, PixelSource::RAW_YUV, PixelTransform::NONE>(
+                          true, zeroCopy);
                 }
-            } else {
-                try {
-                    const guint packetSize = GET_PATH(configuration, "packetSize", int);
-                    boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-                    arv_camera_gv_set_packet_size(m_camera, packetSize, &error);
-                    if (error != nullptr) {
-                        KARABO_LOG_FRAMEWORK_ERROR << deviceId
-                                                   << ": arv_camera_gv_set_packet_size failed: " << error->message;
-                        if (configuration.has("packetSize")) configuration.erase("packetSize");
-                        g_clear_error(&error);
-                    }
-                } catch (const karabo::data::ParameterException& e) {
-                    // key neither in configuration nor on device
+                return select_frame_processor<unsigned char, PixelSource::DIRECT>(none, false, zeroCopy);
+            case ARV_PIXEL_FORMAT_RGB_8_PLANAR:
+                // Planar images are flipped and rotated plane by plane
+                if (orient) {
+                    return select_frame_processor<unsigned char, PixelSource::PLANAR, PixelTransform::NONE>(
+                          true, zeroCopy);
                 }
-            }
+                return select_frame_processor<unsigned char, PixelSource::DIRECT>(none, false, zeroCopy);
+            case ARV_PIXEL_FORMAT_RGB_10_PLANAR:
+            case ARV_PIXEL_FORMAT_RGB_12_PLANAR:
+            case ARV_PIXEL_FORMAT_RGB_16_PLANAR:
+                // XXX not tested
+                if (orient) {
+                    return select_frame_processor<unsigned short, PixelSource::PLANAR, PixelTransform::NONE>(
+                          true, zeroCopy);
+                }
+                return select_frame_processor<unsigned short, PixelSource::DIRECT>(none, false, zeroCopy);
+            default:
+                return nullptr;
         }
+    }
 
-        if (configuration.has("rotation")) {
-            // Rotation is done on software, thus nothing is set to the camera.
-            // Still, schema needs to be updated if rotation is changed by +- 90 degrees.
-            const int change = configuration.get<unsigned int>("rotation") - this->get<unsigned int>("rotation");
-            if (change % 180 != 0) {
-                m_need_schema_update = true;
-            }
+
+    bool AravisCamera::get_bayer_layout(ArvPixelFormat format, kernels::BayerPattern& pattern, unsigned int& bits) {
+        switch (format) {
+            case ARV_PIXEL_FORMAT_BAYER_RG_8:
+            case ARV_PIXEL_FORMAT_BAYER_RG_10:
+            case ARV_PIXEL_FORMAT_BAYER_RG_12:
+            case ARV_PIXEL_FORMAT_BAYER_RG_10P:
+            case ARV_PIXEL_FORMAT_BAYER_RG_12P:
+                pattern = kernels::BayerPattern::RGGB;
+                break;
+            case ARV_PIXEL_FORMAT_BAYER_GR_8:
+            case ARV_PIXEL_FORMAT_BAYER_GR_10:
+            case ARV_PIXEL_FORMAT_BAYER_GR_12:
+            case ARV_PIXEL_FORMAT_BAYER_GR_10P:
+            case ARV_PIXEL_FORMAT_BAYER_GR_12P:
+                pattern = kernels::BayerPattern::GRBG;
+                break;
+            default:
+                return false;
         }
 
-        if (configuration.has("pixelFormat")) {
-            const char* pixelFormat = configuration.get<std::string>("pixelFormat").c_str();
-            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-            arv_camera_set_pixel_format_from_string(m_camera, pixelFormat, &error);
-            if (error == nullptr) m_format = arv_camera_get_pixel_format(m_camera, &error);
-            if (error != nullptr) {
-                KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": could not set pixel format to " << pixelFormat << ": "
-                                           << error->message;
-                m_format = 0;
-                configuration.erase("pixelFormat");
-                g_clear_error(&error);
-            }
-            m_need_schema_update = true; // Schema update is needes as data type changed
+        switch (format) {
+            case ARV_PIXEL_FORMAT_BAYER_RG_8:
+            case ARV_PIXEL_FORMAT_BAYER_GR_8:
+                bits = 8;
+                break;
+            case ARV_PIXEL_FORMAT_BAYER_RG_10:
+            case ARV_PIXEL_FORMAT_BAYER_GR_10:
+            case ARV_PIXEL_FORMAT_BAYER_RG_10P:
+            case ARV_PIXEL_FORMAT_BAYER_GR_10P:
+                bits = 10;
+                break;
+            default:
+                bits = 12;
         }
+        return true;
+    }
 
-        if (configuration.has("bin")) {
-            if (m_is_binning_available) {
-                // Use arv_camera functions to set binning
-                int bin_x = GET_PATH(configuration, "bin.x", int);
-                int bin_y = GET_PATH(configuration, "bin.y", int);
 
-                const bool success = this->set_binning(bin_x, bin_y);
-                if (success) { // update values
-                    configuration.set("bin.x", bin_x);
-                    configuration.set("bin.y", bin_y);
-                } else {
-                    configuration.erase("bin");
+    void AravisCamera::check_frame_processor(const karabo::data::Hash& configuration) const {
+        if (m_camera == nullptr) {
+            // The pixel format is not known, the check will be done when acquisition is started
+            return;
+        }
+
+        ArvPixelFormat format = m_format;
+        if (configuration.has("pixelFormat")) {
+            const std::string& pixelFormat = configuration.get<std::string>("pixelFormat");
+            for (const auto& option : m_pixelFormatOptions) {
+                if (option.second == pixelFormat) {
+                    format = option.first;
+                    break;
                 }
             }
-            m_need_schema_update = true; // Schema update is needed as image shape changed
         }
 
-        // The ROI must be applied after binning, as the values for the former
-        // are after applying the latter.
-        if (configuration.has("roi")) {
-            int x = GET_PATH(configuration, "roi.x", int);
-            int y = GET_PATH(configuration, "roi.y", int);
-            int width = GET_PATH(configuration, "roi.width", int);
-            int height = GET_PATH(configuration, "roi.height", int);
+        FramePlan plan = {};
+        plan.format = format;
+        this->set_frame_processing(plan, configuration);
 
-            const bool success = this->set_region(x, y, width, height);
-            if (success) { // update values
-                configuration.set("roi.x", x);
-                configuration.set("roi.y", y);
-                configuration.set("roi.width", width);
-                configuration.set("roi.height", height);
+        if (AravisCamera::select_frame_processor(plan) == nullptr) {
+            std::stringstream ss;
+            ss << "Pixel format " << format;
+            const auto it = m_pixelFormatOptions.find(format);
+            if (it != m_pixelFormatOptions.end()) {
+                ss << " (" << it->second << ")";
+            }
+            if (plan.bin) {
+                ss << " cannot be binned in software";
+            } else if (plan.orient) {
+                ss << " cannot be flipped or rotated in software";
             } else {
-                configuration.erase("roi");
+                ss << " is not supported";
             }
-            m_need_schema_update = true; // Schema update is needed as image shape changed
+            throw KARABO_PARAMETER_EXCEPTION(ss.str());
+        }
+    }
+
+
+    void AravisCamera::set_frame_processing(FramePlan& plan, const karabo::data::Hash& configuration) const {
+        // Apply flip on software if not available on camera
+        const bool flipX = GET_PATH(configuration, "flip.X", bool);
+        const bool flipY = GET_PATH(configuration, "flip.Y", bool);
+        plan.flipX = flipX && !m_is_flip_x_available;
+        plan.flipY = flipY && !m_is_flip_y_available;
+        plan.rotation = GET_PATH(configuration, "rotation", unsigned int);
+        plan.orient = (plan.flipX || plan.flipY || plan.rotation != 0);
+
+        kernels::DemosaicParameters& demosaic = plan.demosaicParameters;
+        unsigned int bits = 0;
+        const std::string demosaicMethod = GET_PATH(configuration, "demosaic.method", std::string);
+        plan.demosaic = AravisCamera::get_bayer_layout(plan.format, demosaic.pattern, bits) && demosaicMethod != "None";
+        if (plan.demosaic) {
+            demosaic.method = (demosaicMethod == "EdgeAware") ? kernels::DemosaicMethod::EDGE_AWARE
+                                                              : kernels::DemosaicMethod::BILINEAR;
+            demosaic.redGain = GET_PATH(configuration, "demosaic.redGain", float);
+            demosaic.greenGain = GET_PATH(configuration, "demosaic.greenGain", float);
+            demosaic.blueGain = GET_PATH(configuration, "demosaic.blueGain", float);
+            demosaic.maxValue = (1u << bits) - 1;
+        }
+
+        const std::string yuvConversion = GET_PATH(configuration, "yuvConversion", std::string);
+        const kernels::YuvKernels& yuvKernels = kernels::getYuvKernels();
+        switch (plan.format) {
+            case ARV_PIXEL_FORMAT_YCBCR_422_8:
+            case ARV_PIXEL_FORMAT_YUV_422_YUYV_PACKED:
+                plan.convertYuv = (yuvConversion == "RGB8")    ? yuvKernels.yuyvToRgb
+                                  : (yuvConversion == "Mono8") ? yuvKernels.yuyvToMono
+                                                               : nullptr;
+                break;
+            case ARV_PIXEL_FORMAT_YUV_422_PACKED:
+                plan.convertYuv = (yuvConversion == "RGB8")    ? yuvKernels.uyvyToRgb
+                                  : (yuvConversion == "Mono8") ? yuvKernels.uyvyToMono
+                                                               : nullptr;
+                break;
+            default:
+                plan.convertYuv = nullptr;
+                break;
         }
 
-        if (configuration.has("exposureTime") && m_is_exposure_time_available) {
-            double exposureTime = configuration.get<double>("exposureTime");
+        plan.binX = GET_PATH(configuration, "bin.x", int);
+        plan.binY = GET_PATH(configuration, "bin.y", int);
+        const std::string binMode = GET_PATH(configuration, "bin.mode", std::string);
+        plan.bin = m_is_software_binning && (plan.binX > 1 || plan.binY > 1);
+        plan.binAverage = (binMode == "Average");
 
-            const bool success = this->set_exposure_time(exposureTime);
-            if (success) { // update the value
-                exposureTime = arv_camera_get_exposure_time(m_camera, nullptr);
-                configuration.set("exposureTime", exposureTime);
-            } else {
-                configuration.erase("exposureTime");
+        plan.zeroCopy = GET_PATH(configuration, "bufferPool.zeroCopy", bool);
+    }
+
+
+    void AravisCamera::complete_frame(const std::shared_ptr<Frame>& frame) {
+        {
+            boost::mutex::scoped_lock reorder_lock(m_reorder_mtx);
+            m_reorder.emplace(frame->sequence, frame);
+            if (m_is_writing) {
+                // Another thread is writing, it will also write this image when its turn comes
+                return;
             }
+            m_is_writing = true;
         }
 
-        if (configuration.has("frameRate") && m_is_frame_rate_available) {
-            const bool enable = GET_PATH(configuration, "frameRate.enable", bool);
-            double frameRate;
+        // Write the images in order of reception, as long as the next one is available
+        while (true) {
+            std::shared_ptr<Frame> next;
+            {
+                boost::mutex::scoped_lock reorder_lock(m_reorder_mtx);
+                auto it = m_reorder.find(m_next_write);
+                if (it == m_reorder.end()) {
+                    m_is_writing = false;
+                    return;
+                }
+                next = std::move(it->second);
+                m_reorder.erase(it);
+                ++m_next_write;
+            }
+
             try {
-                frameRate = GET_PATH(configuration, "frameRate.target", float);
-            } catch (const karabo::data::ParameterException& e) {
-                // key neither in configuration nor on device
-                frameRate = -1; // i.e. read from camera
+                this->write_frame(*next);
+            } catch (const std::exception& e) {
+                KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId() << ": Could not write image: " << e.what();
             }
 
-            bool success = this->set_frame_rate(enable, frameRate);
-            if (!success) {
-                configuration.erase("frameRate");
+            if (next->buffer != nullptr) {
+                // The buffer has not been handed over: push it back to the stream
+                AravisCamera::release_buffer(next->handle, next->buffer);
+                next->buffer = nullptr;
             }
         }
+    }
 
-        if (m_arv_camera_trigger) {
-            // trigger properties can be accessed with the arv_camera interface
-            Result success;
 
-            if (configuration.has("triggerSelector")) {
-                std::string triggerSelector = configuration.get<std::string>("triggerSelector");
-                success = this->setStringFeature("TriggerSelector", triggerSelector);
-                if (success != Result::SUCCESS) {
-                    configuration.erase("triggerSelector");
-                }
-                m_need_schema_update =
-                      true; // Schema update is needed as trigger mode, source and activation must be updated.
-            }
+    void AravisCamera::write_frame(Frame& frame) {
+        // The images are written one at a time, in order of reception
+        const FramePlan& plan = *frame.plan;
+        frame.times.writing = std::chrono::steady_clock::now();
+        frame.times.written = frame.times.writing;
+        const bool has_image = frame.image.has_value();
 
-            if (configuration.has("triggerMode")) {
-                std::string triggerMode = configuration.get<std::string>("triggerMode");
-                success = this->setStringFeature("TriggerMode", triggerMode);
-                if (success != Result::SUCCESS) {
-                    configuration.erase("triggerMode");
-                }
+        if (frame.has_latency) {
+            if (m_counter == 0) {
+                m_min_latency = frame.latency;
+                m_max_latency = frame.latency;
+                m_mean_latency = frame.latency;
+            } else {
+                m_min_latency = std::min(frame.latency, m_min_latency);
+                m_max_latency = std::max(frame.latency, m_max_latency);
+                m_mean_latency = (m_counter * m_mean_latency + frame.latency) / (m_counter + 1);
             }
-
-            if (configuration.has("triggerSource")) {
-                std::string triggerSource = configuration.get<std::string>("triggerSource");
-                success = this->setStringFeature("TriggerSource", triggerSource);
-                if (success != Result::SUCCESS) {
-                    configuration.erase("triggerSource");
+            // A negative latency, i.e. an offset between the clocks, is counted as 0
+            boost::mutex::scoped_lock latency_lock(m_latency_mtx);
+            m_latency_second.record(std::llround(1.e6 * std::max(0., frame.latency)));
+        }
+
+        if (frame.image) {
+            const auto start = std::chrono::steady_clock::now();
+            if (!plan.preTrigger) {
+                // Send image and metadata to output channel, unless it is written compressed only
+                if (!frame.compressed || plan.rawOutput) {
+                    this->writeChannels(*frame.image, plan.binning, plan.bpp, plan.encoding, plan.roiOffsets,
+                                        frame.ts);
                 }
-            }
-
-            if (configuration.has("triggerActivation")) {
-                std::string triggerActivation = configuration.get<std::string>("triggerActivation");
-                success = this->setStringFeature("TriggerActivation", triggerActivation);
-                if (success != Result::SUCCESS) {
-                    configuration.erase("triggerActivation");
+                if (frame.compressed) {
+                    this->write_compressed(frame);
                 }
+                frame.times.written = std::chrono::steady_clock::now();
+                this->write_software_rois(frame);
+                this->accumulate_frame(frame);
+                this->record_frame(frame);
             }
+            // Otherwise the images are only kept in the pre-trigger history, until an event
+            this->buffer_event_frame(frame);
+            m_write_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            m_process_time += frame.process_time;
+
+            this->preview_frame(frame);
         }
 
-        if (configuration.has("autoGain") && m_is_gain_auto_available) {
-            const std::string& autoGainStr = configuration.get<std::string>("autoGain");
-            const ArvAuto autoGain = arv_auto_from_string(autoGainStr.c_str());
-            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-            arv_camera_set_gain_auto(m_camera, autoGain, &error);
-            if (error != nullptr) {
-                KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": arv_camera_set_gain_auto failed: " << error->message;
-                configuration.erase("autoGain");
-                g_clear_error(&error);
-            }
+        if (frame.statistics) {
+            this->publish_statistics(frame);
         }
 
-        if (configuration.has("gain") && m_is_gain_available) {
-            double absGain = configuration.get<double>("gain");
-            double normGain = configuration.get<double>("gain");
-            const bool isNormalized = this->get<bool>("isNormGain");
-            const bool success = this->set_gain(absGain, normGain, isNormalized);
+        // The image has been written: the stream buffer can be re-used
+        frame.image.reset();
+        frame.compressed.reset();
+        if (frame.buffer != nullptr) {
+            AravisCamera::release_buffer(frame.handle, frame.buffer);
+            frame.buffer = nullptr;
+        }
+        frame.times.done = std::chrono::steady_clock::now();
 
-            if (success) { // update the values
-                if (isNormalized) {
-                    configuration.set("gain", normGain);
-                } else {
-                    configuration.set("gain", absGain);
-                }
-                configuration.set("absGain", absGain);
-            } else {
-                configuration.erase("gain");
-            }
+        if (has_image) {
+            // The images which could not be processed would distort the stage times
+            this->record_stage_times(frame.times);
         }
 
-        if (configuration.has("acquisitionMode")) {
-            const std::string& acquisitionMode = configuration.get<std::string>("acquisitionMode");
-            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-            arv_camera_set_acquisition_mode(m_camera, arv_acquisition_mode_from_string(acquisitionMode.c_str()),
-                                            &error);
-            if (error != nullptr) {
-                KARABO_LOG_FRAMEWORK_ERROR << deviceId
-                                           << ": arv_camera_set_acquisition_mode failed: " << error->message;
-                configuration.erase("acquisitionMode");
-                g_clear_error(&error);
+        m_counter += 1;
+
+        if (m_timer.elapsed() >= 1. && m_is_acquiring) {
+            // Update frame rate and error count
+            this->updateFrameRate();
+
+            m_timer.now();
+            m_counter = 0;
+            m_process_time = 0.;
+            m_write_time = 0.;
+            for (LatencyHistogram& histogram : m_stage_times) {
+                histogram.reset();
             }
+            m_compressed_frames = 0ull;
+            m_compressed_bytes = 0ull;
+            m_original_bytes = 0ull;
         }
 
-        if (configuration.has("frameCount") && m_is_frame_count_available) {
-            gint64 frameCount = configuration.get<long long>("frameCount");
-
-            const bool success = this->set_frame_count(frameCount);
-            if (success) { // update value
-                configuration.set("frameCount", frameCount);
+        if (!m_isContinuousMode) {
+            if (m_imgsToBeAcquired > 1) {
+                --m_imgsToBeAcquired;
             } else {
-                configuration.erase("frameCount");
+                // Stop acquisition
+                m_imgsToBeAcquired = 0;
+                this->execute("stop");
             }
         }
+    }
 
-        // Filter configuration by tag "genicam" and loop over it
-        // XXX possibly need a tag "update_schema" for parameter changing image "size"
-        const Hash filtered = this->filterByTags(configuration, "genicam");
-        const Schema schema = this->getFullSchema();
-        std::vector<std::string> paths;
-        filtered.getPaths(paths);
-        for (const auto& key : paths) {
-            Result success = Result::FAIL;
-            const auto feature = this->getAliasFromKey<std::string>(key);
-            const auto valueType = this->getValueType(key);
-            const auto accessMode = schema.getAccessMode(key);
-            bool boolValue;
-            long long intValue;
-            double floatValue;
-            std::string stringValue;
 
-            if (accessMode == AccessType::READ) {
-                // Read-Only parameter
-                continue;
-            }
+    void AravisCamera::preview_frame(Frame& frame) {
+        const FramePlan& plan = *frame.plan;
+        if (!plan.preview) return;
 
-            if (m_is_binning_available && (key == "bin.x" || key == "bin.y")) {
-                // Already taken care previously by calling set_binning
-                continue;
-            }
+        const auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - m_last_preview).count() < plan.previewInterval) {
+            // Rate decimation
+            return;
+        }
 
-            switch (valueType) {
-                case Types::BOOL:
-                    boolValue = configuration.get<bool>(key);
-                    success = this->setBoolFeature(feature, boolValue);
-                    configuration.set<bool>(key, boolValue); // set read value
-                    break;
-                case Types::STRING:
-                    stringValue = configuration.get<std::string>(key);
-                    success = this->setStringFeature(feature, stringValue);
-                    configuration.set<std::string>(key, stringValue); // set read value
-                    break;
-                case Types::INT32:
-                    intValue = configuration.get<int>(key);
-                    success = this->setIntFeature(feature, intValue);
-                    configuration.set<int>(key, intValue); // set read value
-                    break;
-                case Types::INT64:
-                    intValue = configuration.get<long long>(key);
-                    success = this->setIntFeature(feature, intValue);
-                    configuration.set<long long>(key, intValue); // set read value
-                    break;
-                case Types::FLOAT:
-                    floatValue = configuration.get<float>(key);
-                    success = this->setFloatFeature(feature, floatValue);
-                    configuration.set<float>(key, floatValue); // set read value
-                    break;
-                case Types::DOUBLE:
-                    floatValue = configuration.get<double>(key);
-                    success = this->setFloatFeature(feature, floatValue);
-                    configuration.set<double>(key, floatValue); // set read value
-                    break;
-                default:
-                    throw KARABO_NOT_IMPLEMENTED_EXCEPTION(key + " datatype not available in GenICam");
+        const std::shared_ptr<WorkerPool> previewWorker = std::atomic_load(&m_preview_worker);
+        if (!previewWorker || m_is_previewing.exchange(true)) {
+            // The previous preview image is still being processed
+            return;
+        }
+        m_last_preview = now;
+
+        // The image data must stay valid until downscaled. If they are not owned, they are in the stream buffer,
+        // which is then pushed back to the stream once the preview image is done. N.B. The unpacked images are
+        // always owned while the preview is enabled, as the shared unpacking buffer is overwritten by the next one.
+        std::shared_ptr<void> owner = frame.owner;
+        if (!owner && frame.buffer != nullptr) {
+            const std::shared_ptr<StreamHandle> handle = frame.handle;
+            owner.reset(frame.buffer, [handle](ArvBuffer* buffer) { AravisCamera::release_buffer(handle, buffer); });
+            frame.buffer = nullptr;
+        }
+
+        previewWorker->post([this, image = *frame.image, owner, plan = frame.plan, ts = frame.ts]() mutable {
+            try {
+                this->write_preview(image, *plan, ts);
+            } catch (const std::exception& e) {
+                KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId() << ": Could not write preview image: " << e.what();
             }
+            owner.reset();
+            m_is_previewing = false;
+        });
+    }
 
-            if (success == Result::FAIL) {
-                const std::string message("Setting value for " + key + " may not have been successful");
-                KARABO_LOG_WARN << message << ". Value on device updated according to camera.";
-                this->set("status", message);
+
+    void AravisCamera::write_preview(const karabo::data::NDArray& image, const FramePlan& plan,
+                                     const karabo::data::Timestamp& ts) {
+        switch (image.getType()) {
+            case Types::UINT8:
+                this->downscale_preview<unsigned char, unsigned char>(image, plan, ts);
+                break;
+            case Types::UINT16:
+                if (plan.previewEightBit) {
+                    this->downscale_preview<unsigned short, unsigned char>(image, plan, ts);
+                } else {
+                    this->downscale_preview<unsigned short, unsigned short>(image, plan, ts);
+                }
+                break;
+            case Types::UINT32:
+                if (plan.previewEightBit) {
+                    this->downscale_preview<unsigned int, unsigned char>(image, plan, ts);
+                } else {
+                    this->downscale_preview<unsigned int, unsigned int>(image, plan, ts);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+
+    template <class T, class Out>
+    void AravisCamera::downscale_preview(const karabo::data::NDArray& image, const FramePlan& plan,
+                                         const karabo::data::Timestamp& ts) {
+        const Dims& shape = image.getShape();
+        const int height = shape.x1();
+        const int width = shape.x2();
+        const int channels = (shape.rank() > 2) ? shape.x3() : 1;
+        const int factor = plan.previewFactor;
+        const bool eightBit = sizeof(Out) < sizeof(T);
+        const int shift = eightBit ? std::max(0, plan.bpp / channels - 8) : 0;
+
+        const size_t previewHeight = height / factor;
+        const size_t previewWidth = width / factor;
+        auto data = std::make_shared<std::vector<Out>>(previewHeight * previewWidth * channels);
+        kernels::downscaleImage(image.getData<T>(), width, height, channels, factor, shift, data->data());
+
+        // The preview pixels are binned by factor, with respect to the images written to the other channels
+        const Dims& binning = plan.binning;
+        const Dims& roiOffsets = plan.roiOffsets;
+        Dims previewShape(previewHeight, previewWidth);
+        Dims previewBinning(binning.x1() * factor, binning.x2() * factor);
+        Dims previewOffsets(roiOffsets.x1() / factor, roiOffsets.x2() / factor);
+        if (channels > 1) {
+            previewShape = Dims(previewHeight, previewWidth, channels);
+            previewBinning = Dims(previewBinning.x1(), previewBinning.x2(), 1);
+            previewOffsets = Dims(previewOffsets.x1(), previewOffsets.x2(), 1);
+        }
+
+        const karabo::data::NDArray preview(data->data(), data->size(), [data](const void*) {}, previewShape);
+        karabo::xms::ImageData imageData(preview, plan.previewEncoding, eightBit ? 8 * channels : plan.bpp);
+        imageData.setBinning(previewBinning);
+        imageData.setROIOffsets(previewOffsets);
+
+        // The preview data are not re-used, thus they need not be copied
+        this->writeChannel("previewOutput", Hash("data.image", imageData), ts, true);
+    }
+
+
+    void AravisCamera::write_software_rois(const Frame& frame) {
+        const FramePlan& plan = *frame.plan;
+        const karabo::data::NDArray& image = *frame.image;
+
+        for (const SoftwareRoi& roi : plan.softwareRois) {
+            try {
+                switch (image.getType()) {
+                    case Types::UINT8:
+                        this->crop_software_roi<unsigned char>(image, plan, roi, frame.ts);
+                        break;
+                    case Types::UINT16:
+                        this->crop_software_roi<unsigned short>(image, plan, roi, frame.ts);
+                        break;
+                    case Types::UINT32:
+                        this->crop_software_roi<unsigned int>(image, plan, roi, frame.ts);
+                        break;
+                    default:
+                        break;
+                }
+            } catch (const std::exception& e) {
+                KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId() << ": Could not write " << roi.channel << ": "
+                                           << e.what();
             }
         }
     }
 
 
-    bool AravisCamera::synchronize_timestamp() {
-        // If the camera can provide HW timestamping, then synchronize it with the timeserver
-        return true;
+    template <class T>
+    void AravisCamera::crop_software_roi(const karabo::data::NDArray& image, const FramePlan& plan,
+                                         const SoftwareRoi& roi, const karabo::data::Timestamp& ts) {
+        const Dims& shape = image.getShape();
+        const int height = shape.x1();
+        const int width = shape.x2();
+        const int channels = (shape.rank() > 2) ? shape.x3() : 1;
+
+        // The region is clipped to the image
+        const int x = std::min(roi.x, width);
+        const int y = std::min(roi.y, height);
+        const int cropWidth = std::min(roi.width, width - x);
+        const int cropHeight = std::min(roi.height, height - y);
+        const size_t roiWidth = cropWidth / roi.bin;
+        const size_t roiHeight = cropHeight / roi.bin;
+        if (roiWidth == 0 || roiHeight == 0) return;
+
+        // Only the rows of the region are copied from the image
+        const T* pixels = image.getData<T>() + (size_t(y) * width + x) * channels;
+        const size_t rowSize = size_t(cropWidth) * channels;
+        std::vector<T> cropped(roi.bin > 1 ? rowSize * cropHeight : 0);
+        auto data = std::make_shared<std::vector<T>>(roiHeight * roiWidth * channels);
+        T* rows = (roi.bin > 1) ? cropped.data() : data->data();
+        for (int row = 0; row < cropHeight; ++row) {
+            std::copy(pixels + size_t(row) * width * channels, pixels + size_t(row) * width * channels + rowSize,
+                      rows + row * rowSize);
+        }
+        if (roi.bin > 1) {
+            kernels::downscaleImage(cropped.data(), cropWidth, cropHeight, channels, roi.bin, 0, data->data());
+        }
+
+        // The offsets are in pixels of the region, with respect to the sensor: the region is mapped back through
+        // the software flip and rotation. As those of the image, they are swapped by the rotations by 90 and 270.
+        int sourceX = x, sourceY = y, sourceWidth = cropWidth, sourceHeight = cropHeight;
+        const bool transposed = plan.orient && plan.orientation.transposed;
+        if (plan.orient) {
+            kernels::sourceRegion(plan.orientation, transposed ? height : width, transposed ? width : height,
+                                  sourceX, sourceY, sourceWidth, sourceHeight);
+        }
+        const Dims& binning = plan.binning;
+        const Dims& roiOffsets = plan.roiOffsets;
+        Dims roiShape(roiHeight, roiWidth);
+        Dims roiBinning(binning.x1() * roi.bin, binning.x2() * roi.bin);
+        Dims offsets = transposed ? Dims((roiOffsets.x1() + sourceX) / roi.bin, (roiOffsets.x2() + sourceY) / roi.bin)
+                                  : Dims((roiOffsets.x1() + sourceY) / roi.bin, (roiOffsets.x2() + sourceX) / roi.bin);
+        if (channels > 1) {
+            roiShape = Dims(roiHeight, roiWidth, channels);
+            roiBinning = Dims(roiBinning.x1(), roiBinning.x2(), 1);
+            offsets = Dims(offsets.x1(), offsets.x2(), 1);
+        }
+
+        const karabo::data::NDArray roiArray(data->data(), data->size(), [data](const void*) {}, roiShape);
+        karabo::xms::ImageData imageData(roiArray, roi.encoding, plan.bpp);
+        imageData.setBinning(roiBinning);
+        imageData.setROIOffsets(offsets);
+
+        // The region data are not re-used, thus they need not be copied
+        this->writeChannel(roi.channel, Hash("data.image", imageData), ts, true);
     }
 
 
-    bool AravisCamera::configure_timestamp_chunk() {
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+    void AravisCamera::captureDark() {
+        this->start_capture(CorrectionReference::DARK);
+    }
 
-        // By default chunk mode is disabled.
-        // It can be enabled in the derived class, if the camera provides HW timestamping.
-        arv_camera_set_chunk_mode(m_camera, false, nullptr);
-        m_chunk_mode = false;
 
-        return true;
+    void AravisCamera::captureFlat() {
+        this->start_capture(CorrectionReference::FLAT);
     }
 
 
-    bool AravisCamera::get_region(gint& x, gint& y, gint& width, gint& height) {
-        GError* error = nullptr;
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+    void AravisCamera::start_capture(CorrectionReference reference) {
+        boost::mutex::scoped_lock correction_lock(m_correction_mtx);
+        m_capture_reference = reference;
+        m_capture_target = this->get<unsigned int>("correction.referenceFrames");
+        m_capture_frames = 0;
+        m_capture_claimed = 0;
+        ++m_capture_generation;
+        m_capture_shape.clear();
+        m_capture_idle.clear();
+        m_is_capturing = true;
 
-        arv_camera_get_region(m_camera, &x, &y, &width, &height, &error);
+        const std::string name = (reference == CorrectionReference::DARK) ? "dark" : "flat";
+        this->set("status", "Capturing the " + name + " reference");
+    }
+
+
+    void AravisCamera::capture_frame(const Frame& frame) {
+        const karabo::data::NDArray& image = *frame.image;
+        const Types::ReferenceType type = image.getType();
+        if (type != Types::UINT8 && type != Types::UINT16 && type != Types::UINT32) return;
+        const std::vector<unsigned long long> shape = image.getShape().toVector();
+
+        std::shared_ptr<CaptureSums> partial;
+        unsigned int generation;
+        {
+            boost::mutex::scoped_lock correction_lock(m_correction_mtx);
+            if (!m_is_capturing || m_capture_claimed >= m_capture_target) {
+                // Completed, or the last images are being added concurrently
+                return;
+            }
+            if (shape != m_capture_shape || type != m_capture_type) {
+                // First image, or the image shape or type changed: the capture starts over
+                m_capture_frames = 0;
+                m_capture_claimed = 0;
+                ++m_capture_generation;
+                m_capture_shape = shape;
+                m_capture_type = type;
+                m_capture_idle.clear();
+            }
+            ++m_capture_claimed;
+            generation = m_capture_generation;
+            if (!m_capture_idle.empty()) {
+                partial = std::move(m_capture_idle.back());
+                m_capture_idle.pop_back();
+            }
+        }
+        if (!partial) {
+            // As many partial sums as images added concurrently, i.e. at most one per worker
+            partial = std::make_shared<CaptureSums>();
+            partial->generation = generation;
+            if (type == Types::UINT32) {
+                partial->wideSums.assign(image.size(), 0);
+            } else {
+                partial->sums.assign(image.size(), 0);
+            }
+        }
+
+        // At most 1000 images: the sums of 16-bit pixels fit in 32 bits
+        switch (type) {
+            case Types::UINT8:
+                kernels::accumulateSum(image.getData<unsigned char>(), image.size(), partial->sums.data());
+                break;
+            case Types::UINT16:
+                kernels::accumulateSum(image.getData<unsigned short>(), image.size(), partial->sums.data());
+                break;
+            default:
+                kernels::accumulateSum(image.getData<unsigned int>(), image.size(), partial->wideSums.data());
+                break;
+        }
 
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_WARN << this->getInstanceId() << ": arv_camera_get_region failed: " << error->message;
-            m_width = 0;
-            m_height = 0;
-            g_clear_error(&error);
-            return false; // failure
+        boost::mutex::scoped_lock correction_lock(m_correction_mtx);
+        if (!m_is_capturing || partial->generation != m_capture_generation) {
+            // The capture started over meanwhile
+            return;
         }
+        m_capture_idle.push_back(std::move(partial));
+        if (++m_capture_frames < m_capture_target) return;
 
-        m_width = width;
-        m_height = height;
-        return true; // success
+        // All the partial sums are idle. The reference is computed and saved by the event loop, not to delay the
+        // images.
+        m_is_capturing = false;
+        boost::asio::post(EventLoop::getIOService(),
+                          karabo::util::bind_weak(&AravisCamera::finish_capture, this, m_capture_reference,
+                                                  m_capture_shape, std::move(m_capture_idle), m_capture_frames));
+        m_capture_idle.clear();
     }
 
 
-    int AravisCamera::get_tick_frequency() {
-        // If the camera provides a "tick frequency", this function shall be overridden
-        return 0;
+    void AravisCamera::finish_capture(CorrectionReference reference, const std::vector<unsigned long long>& shape,
+                                      const std::vector<std::shared_ptr<CaptureSums>>& partials,
+                                      unsigned int frames) {
+        auto image = std::make_shared<ReferenceImage>();
+        image->shape = shape;
+        image->values.resize(Dims(shape).size());
+        std::vector<uint64_t> sums(image->values.size(), 0);
+        for (const std::shared_ptr<CaptureSums>& partial : partials) {
+            for (size_t i = 0; i < partial->sums.size(); ++i) {
+                sums[i] += partial->sums[i];
+            }
+            for (size_t i = 0; i < partial->wideSums.size(); ++i) {
+                sums[i] += partial->wideSums[i];
+            }
+        }
+        const double scale = 1. / frames;
+        for (size_t i = 0; i < sums.size(); ++i) {
+            image->values[i] = sums[i] * scale;
+        }
+
+        const bool dark = (reference == CorrectionReference::DARK);
+        const std::string name = dark ? "dark" : "flat";
+        {
+            boost::mutex::scoped_lock correction_lock(m_correction_mtx);
+            (dark ? m_dark : m_flat) = image;
+        }
+
+        const std::string path = this->get_reference_path(reference);
+        try {
+            std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+            saveToFile(Hash("shape", image->shape, "values", image->values), path);
+            this->set(Hash("correction." + name + "Reference", true, "status",
+                           "The " + name + " reference has been captured"));
+        } catch (const std::exception& e) {
+            const std::string message("Could not save the " + name + " reference to " + path);
+            KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId() << ": " << message << ": " << e.what();
+            this->set(Hash("correction." + name + "Reference", true, "status", message));
+        }
+
+        // The output schema changes if the correction becomes active
+        this->update_correction_maps();
+        m_need_schema_update = true;
+        if (!this->updateOutputSchema()) {
+            this->updateState(State::ERROR);
+        }
+        this->build_frame_plan();
     }
 
 
-    bool AravisCamera::get_timestamp(ArvBuffer* buffer, karabo::data::Timestamp& ts) {
-        // If the camera provides HW timestamping in chunk data, this function shall be overridden
-        return false;
+    std::string AravisCamera::get_reference_path(CorrectionReference reference) const {
+        // Device IDs contain slashes
+        std::string deviceId = this->getInstanceId();
+        std::replace(deviceId.begin(), deviceId.end(), '/', '_');
+        const std::string name = (reference == CorrectionReference::DARK) ? "dark" : "flat";
+        const std::filesystem::path directory(this->get<std::string>("correction.directory"));
+        return (directory / (deviceId + "_" + name + ".bin")).string();
     }
 
 
-    bool AravisCamera::is_frame_count_available() const {
-        GError* error = nullptr;
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
+    void AravisCamera::load_references() {
+        for (CorrectionReference reference : {CorrectionReference::DARK, CorrectionReference::FLAT}) {
+            const std::string path = this->get_reference_path(reference);
+            if (!std::filesystem::exists(path)) continue;
 
-        bool is_available = false;
-        guint n_values;
-        const char** options = arv_device_dup_available_enumeration_feature_values_as_strings(
-              m_device, "AcquisitionMode", &n_values, &error);
-        if (error != nullptr) {
-            KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
-                                       << ": arv_device_dup_available_enumeration_feature_values_as_strings failed: "
-                                       << error->message;
-            g_clear_error(&error);
-        } else {
-            for (size_t i = 0; i < n_values; ++i) {
-                if (std::string(options[i]) == "MultiFrame") {
-                    // Frame Count is available
-                    is_available = true;
-                    break;
+            const bool dark = (reference == CorrectionReference::DARK);
+            try {
+                Hash h;
+                loadFromFile(h, path);
+                auto image = std::make_shared<ReferenceImage>();
+                image->shape = h.get<std::vector<unsigned long long>>("shape");
+                image->values = h.get<std::vector<float>>("values");
+                if (Dims(image->shape).size() != image->values.size()) {
+                    throw KARABO_PARAMETER_EXCEPTION("The shape does not match the number of values");
+                }
+                {
+                    boost::mutex::scoped_lock correction_lock(m_correction_mtx);
+                    (dark ? m_dark : m_flat) = image;
                 }
+                this->set(dark ? "correction.darkReference" : "correction.flatReference", true);
+            } catch (const std::exception& e) {
+                KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId() << ": Could not load " << path << ": "
+                                           << e.what();
             }
         }
-        g_free(options);
-        return is_available;
+        this->update_correction_maps();
     }
 
 
-    bool AravisCamera::is_flip_x_available() const {
-        // If the camera provides horizontal flip, this function shall be overridden.
-        // Also, "genicam" tag and alias shall be provided for "flip.X".
-        return false;
+    void AravisCamera::update_correction_maps() {
+        std::shared_ptr<const ReferenceImage> dark, flat;
+        {
+            boost::mutex::scoped_lock correction_lock(m_correction_mtx);
+            dark = m_dark;
+            flat = m_flat;
+        }
+        if (dark && flat && dark->shape != flat->shape) {
+            KARABO_LOG_FRAMEWORK_WARN << this->getInstanceId()
+                                      << ": The dark and flat references have different shapes, the flat is ignored";
+            flat.reset();
+        }
+
+        std::shared_ptr<CorrectionMaps> maps;
+        if (dark || flat) {
+            maps = std::make_shared<CorrectionMaps>();
+            maps->shape = dark ? dark->shape : flat->shape;
+            const size_t n_pixels = dark ? dark->values.size() : flat->values.size();
+            maps->dark = dark ? dark->values : std::vector<float>(n_pixels, 0.f);
+            maps->gain.assign(n_pixels, 1.f);
+            if (flat) {
+                // Normalised to the mean signal of each channel, thus the corrected images keep the flat level
+                const size_t channels = (maps->shape.size() > 2) ? maps->shape[2] : 1;
+                std::vector<double> means(channels, 0.);
+                for (size_t i = 0; i < n_pixels; ++i) {
+                    means[i % channels] += flat->values[i] - maps->dark[i];
+                }
+                for (double& mean : means) {
+                    mean /= std::max<size_t>(1, n_pixels / channels);
+                }
+                for (size_t i = 0; i < n_pixels; ++i) {
+                    const float signal = flat->values[i] - maps->dark[i];
+                    maps->gain[i] = (signal > 0.f) ? means[i % channels] / signal : 0.f;
+                }
+            }
+        }
+
+        boost::mutex::scoped_lock correction_lock(m_correction_mtx);
+        m_correction_maps = maps;
     }
 
 
-    bool AravisCamera::is_flip_y_available() const {
-        // If the camera provides vertical flip, this function shall be overridden.
-        // Also, "genicam" tag and alias shall be provided for "flip.Y".
-        return false;
+    std::shared_ptr<const AravisCamera::CorrectionMaps> AravisCamera::get_correction_maps(
+          const std::vector<unsigned long long>& shape) {
+        if (!this->get<bool>("correction.enable")) {
+            return nullptr;
+        }
+        boost::mutex::scoped_lock correction_lock(m_correction_mtx);
+        if (!m_correction_maps || m_correction_maps->shape != shape) {
+            return nullptr;
+        }
+        return m_correction_maps;
     }
 
 
-    void AravisCamera::acquire() {
-        GError* error = nullptr;
-
-        m_timer.now();
-        m_counter = 0;
+    void AravisCamera::correct_frame(Frame& frame) {
+        const karabo::data::NDArray& image = *frame.image;
+        switch (image.getType()) {
+            case Types::UINT8:
+                this->correct_pixels(image.getData<unsigned char>(), frame);
+                break;
+            case Types::UINT16:
+                this->correct_pixels(image.getData<unsigned short>(), frame);
+                break;
+            case Types::UINT32:
+                this->correct_pixels(image.getData<unsigned int>(), frame);
+                break;
+            default:
+                break;
+        }
+    }
 
-        {
-            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-            const guint payload = arv_camera_get_payload(m_camera, &error);
 
-            if (error != nullptr) {
-                std::stringstream ss;
-                ss << "arv_camera_get_payload failed: " << error->message;
-                this->acquire_failed_helper(ss.str());
-                g_clear_error(&error);
-                return;
+    template <class T>
+    void AravisCamera::correct_pixels(const T* pixels, Frame& frame) {
+        const FramePlan& plan = *frame.plan;
+        const CorrectionMaps& maps = *plan.correction;
+        const Dims shape = frame.image->getShape();
+        const size_t n_pixels = shape.size();
+        if (n_pixels != maps.dark.size()) {
+            throw KARABO_PARAMETER_EXCEPTION("The correction references do not match the image");
+        }
+
+        // Into an image from the pool, in chunks processed concurrently by the worker pool, if any
+        std::shared_ptr<void> correctedOwner;
+        void* corrected = this->get_pooled_data(
+              n_pixels * (plan.correctionFloat ? sizeof(float) : sizeof(uint16_t)), correctedOwner);
+        const auto correctPixels = [&plan, &maps, pixels, corrected](size_t begin, size_t end) {
+            const float* dark = maps.dark.data() + begin;
+            const float* gain = maps.gain.data() + begin;
+            if (plan.correctionFloat) {
+                kernels::correctPixels(pixels + begin, end - begin, dark, gain, static_cast<float*>(corrected) + begin);
+            } else {
+                kernels::correctPixels(pixels + begin, end - begin, dark, gain, plan.correctionMax,
+                                       static_cast<uint16_t*>(corrected) + begin);
             }
+        };
+        if (frame.workers) {
+            frame.workers->parallel_for(n_pixels, 1 << 18, correctPixels);
+        } else {
+            correctPixels(0, n_pixels);
+        }
 
-            if (m_stream != nullptr && (payload != m_buffer_size || m_need_stream_clear)) {
-                // The payload size changed, or the stream need to be cleared for other reasons:
-                // clear the stream and the associated buffers.
-
-                this->clear_stream();
-                m_need_stream_clear = false;
-            }
-            m_buffer_size = payload;
+        // The uncorrected image, and the stream buffer, are not needed any more
+        frame.image.reset();
+        frame.owner = correctedOwner;
+        frame.stream_owner = false;
+        if (frame.buffer != nullptr) {
+            AravisCamera::release_buffer(frame.handle, frame.buffer);
+            frame.buffer = nullptr;
+        }
 
-            if (m_stream == nullptr) {
-                boost::mutex::scoped_lock stream_lock(m_stream_mtx);
+        if (plan.correctionFloat) {
+            this->make_image<float>(corrected, frame, shape);
+        } else {
+            this->make_image<unsigned short>(corrected, frame, shape);
+        }
+    }
 
-                m_stream = arv_camera_create_stream(m_camera, AravisCamera::stream_cb, static_cast<void*>(this),
-                                                    nullptr, &error);
 
-                if (error != nullptr) {
-                    std::stringstream ss;
-                    ss << "arv_camera_create_stream failed: " << error->message;
-                    this->acquire_failed_helper(ss.str());
-                    g_clear_error(&error);
-                    return;
-                }
+    void AravisCamera::accumulate_frame(const Frame& frame) {
+        const FramePlan& plan = *frame.plan;
+        if (plan.accumulation == AccumulationMode::NONE) return;
+
+        const karabo::data::NDArray& image = *frame.image;
+        const std::vector<unsigned long long> shape = image.getShape().toVector();
+        const bool reset = m_reset_accumulation.exchange(false);
+        if (!m_accumulation) {
+            m_accumulation = std::make_shared<Accumulation>();
+        }
+        Accumulation& accumulation = *m_accumulation;
+        if (reset || accumulation.mode != plan.accumulation || accumulation.target != plan.accumulationFrames ||
+            accumulation.shape != shape || accumulation.type != image.getType()) {
+            accumulation.mode = plan.accumulation;
+            accumulation.target = plan.accumulationFrames;
+            accumulation.shape = shape;
+            accumulation.type = image.getType();
+            accumulation.frames = 0;
+        }
+        if (accumulation.frames == 0) {
+            // The moving average starts from the first image, thus it needs not be cleared
+            const bool movingAverage = accumulation.mode == AccumulationMode::EWMA;
+            const bool wide = accumulation.type == Types::UINT32;
+            accumulation.sums.assign(movingAverage || wide ? 0 : image.size(), 0);
+            accumulation.wideSums.assign(movingAverage || !wide ? 0 : image.size(), 0);
+            accumulation.average.resize(movingAverage ? image.size() : 0);
+        }
+
+        switch (image.getType()) {
+            case Types::UINT8:
+                this->accumulate_pixels(image.getData<unsigned char>(), image.size(), frame.workers);
+                break;
+            case Types::UINT16:
+                this->accumulate_pixels(image.getData<unsigned short>(), image.size(), frame.workers);
+                break;
+            case Types::UINT32:
+                this->accumulate_pixels(image.getData<unsigned int>(), image.size(), frame.workers);
+                break;
+            default:
+                return;
+        }
 
-                // Create and push buffers to the stream
-                for (size_t i = 0; i < 10; i++) {
-                    arv_stream_push_buffer(m_stream, arv_buffer_new(m_buffer_size, NULL));
-                }
-            }
+        if (accumulation.frames % accumulation.target == 0) {
+            this->publish_accumulation(frame);
         }
+    }
 
-        // Synchronize timestamp.
-        // This will be repeated periodically during acquisition
-        this->synchronize_timestamp();
 
-        const std::string acquisitionMode = this->get<std::string>("acquisitionMode");
-        if (acquisitionMode == "SingleFrame") {
-            m_isContinuousMode = false;
-            m_imgsToBeAcquired = 1;
-        } else if (acquisitionMode == "MultiFrame") {
-            m_isContinuousMode = false;
-            m_imgsToBeAcquired = this->get<long long int>("frameCount");
+    template <class T>
+    void AravisCamera::accumulate_pixels(const T* pixels, size_t n_pixels, WorkerPool* workers) {
+        Accumulation& accumulation = *m_accumulation;
+        // Plain mean of the first images, until there are enough of them for the moving average
+        const float weight = 1.f / std::min(accumulation.frames + 1, accumulation.target);
+
+        const auto accumulate = [&accumulation, pixels, weight](size_t begin, size_t end) {
+            if (accumulation.mode == AccumulationMode::EWMA) {
+                kernels::accumulateEwma(pixels + begin, end - begin, weight, accumulation.average.data() + begin);
+            } else if constexpr (std::is_same_v<T, unsigned int>) {
+                kernels::accumulateSum(pixels + begin, end - begin, accumulation.wideSums.data() + begin);
+            } else {
+                kernels::accumulateSum(pixels + begin, end - begin, accumulation.sums.data() + begin);
+            }
+        };
+        if (workers) {
+            workers->parallel_for(n_pixels, 1 << 18, accumulate);
         } else {
-            m_isContinuousMode = true;
-            m_imgsToBeAcquired = 0; // unused in continuous mode
+            accumulate(0, n_pixels);
         }
+        ++accumulation.frames;
+    }
 
-        {
-            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-            arv_camera_start_acquisition(m_camera, &error);
-            if (error != nullptr) {
-                std::stringstream ss;
-                ss << "arv_camera_start_acquisition failed: " << error->message;
-                this->acquire_failed_helper(ss.str());
-                g_clear_error(&error);
-                return;
+
+    void AravisCamera::publish_accumulation(const Frame& frame) {
+        const bool movingAverage = m_accumulation->mode == AccumulationMode::EWMA;
+        const std::shared_ptr<WorkerPool> accumulationWorker = std::atomic_load(&m_accumulation_worker);
+        if (!accumulationWorker || m_is_writing_accumulation.exchange(true)) {
+            // The previous result is still being written
+            this->set("accumulation.dropped", ++m_dropped_accumulations);
+            if (!movingAverage) {
+                m_accumulation->frames = 0;
             }
+            return;
         }
 
-        m_is_acquiring = true;
-        this->set("status", "Acquisition started");
-        this->updateState(State::ACQUIRING);
+        // The spare buffer is free: the result is swapped into it, or copied in case of a moving average,
+        // which goes on. A new spare buffer is set up by accumulate_frame on the next image.
+        if (!m_accumulation_spare) {
+            m_accumulation_spare = std::make_shared<Accumulation>();
+        }
+        if (movingAverage) {
+            *m_accumulation_spare = *m_accumulation;
+        } else {
+            std::swap(m_accumulation, m_accumulation_spare);
+            m_accumulation->frames = 0;
+        }
+
+        accumulationWorker->post([this, result = m_accumulation_spare, plan = frame.plan, ts = frame.ts]() {
+            try {
+                this->write_accumulation(*result, *plan, ts);
+            } catch (const std::exception& e) {
+                KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
+                                           << ": Could not write accumulated image: " << e.what();
+            }
+            m_is_writing_accumulation = false;
+        });
     }
 
 
-    void AravisCamera::acquire_failed_helper(const std::string& detailed_msg) {
-        const std::string message("Could not start acquisition");
+    void AravisCamera::write_accumulation(const Accumulation& accumulation, const FramePlan& plan,
+                                          const karabo::data::Timestamp& ts) {
+        const Dims shape(accumulation.shape);
+        const size_t channels = (shape.rank() > 2) ? shape.x3() : 1;
+        const bool wide = !accumulation.wideSums.empty();
+        karabo::data::NDArray result;
+        if (accumulation.mode == AccumulationMode::SUM && wide) {
+            auto data = std::make_shared<std::vector<uint64_t>>(accumulation.wideSums);
+            result = karabo::data::NDArray(data->data(), data->size(), [data](const void*) {}, shape);
+        } else if (accumulation.mode == AccumulationMode::SUM) {
+            auto data = std::make_shared<std::vector<uint32_t>>(accumulation.sums);
+            result = karabo::data::NDArray(data->data(), data->size(), [data](const void*) {}, shape);
+        } else {
+            auto data = std::make_shared<std::vector<float>>(shape.size());
+            if (accumulation.mode == AccumulationMode::MEAN) {
+                const double scale = 1. / accumulation.frames;
+                for (size_t i = 0; i < data->size(); ++i) {
+                    (*data)[i] = (wide ? accumulation.wideSums[i] : accumulation.sums[i]) * scale;
+                }
+            } else {
+                std::copy(accumulation.average.begin(), accumulation.average.end(), data->begin());
+            }
+            result = karabo::data::NDArray(data->data(), data->size(), [data](const void*) {}, shape);
+        }
 
-        KARABO_LOG_ERROR << message;
-        KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId() << ": " << detailed_msg;
-        this->postAcquisitionStop();
-        this->updateState(State::ERROR, Hash("status", message));
-    }
+        // The sums of 32-bit images have 64 bits per channel, the other sums and the floats 32 bits
+        const unsigned short bits = (accumulation.mode == AccumulationMode::SUM && wide) ? 64 : 32;
+        karabo::xms::ImageData imageData(result, plan.encoding, bits * channels);
+        imageData.setBinning(plan.binning);
+        imageData.setROIOffsets(plan.roiOffsets);
 
+        // The result is copied from the accumulation buffer, thus it is not re-used
+        this->writeChannel("accumulatedOutput", Hash("data.image", imageData, "data.frames", accumulation.frames),
+                           ts, true);
+    }
 
-    void AravisCamera::stop() {
-        Hash h;
-        h.set("frameRate.actual", 0.f);
-        h.set("errorCount", 0ull);
-        h.set("lastError", "");
-        h.set("timestampErrorCount", 0ull);
-        h.set("lastTimestampError", "");
-        h.set("latency.mean", 0.f);
-        h.set("latency.min", 0.f);
-        h.set("latency.max", 0.f);
 
-        GError* error = nullptr;
-        {
-            boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-            arv_camera_stop_acquisition(m_camera, &error);
+    void AravisCamera::compress_frame(Frame& frame) {
+#ifdef KARABO_WITH_LZ4
+        const karabo::data::NDArray& image = *frame.image;
+        switch (image.getType()) {
+            case Types::UINT8:
+                this->compress_pixels(image.getData<unsigned char>(), frame);
+                break;
+            case Types::UINT16:
+                this->compress_pixels(image.getData<unsigned short>(), frame);
+                break;
+            default:
+                // The 32-bit and float images are not compressed
+                break;
         }
-        m_is_acquiring = false;
-        m_errorCount = 0;
-        m_lastError = ARV_BUFFER_STATUS_SUCCESS;
-        m_timestampErrorCount = 0;
-        m_timestampError = "";
+#endif
+    }
 
-        if (error != nullptr) {
-            const std::string message("Could not stop acquisition");
-            KARABO_LOG_ERROR << message;
-            KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
-                                       << ": arv_camera_stop_acquisition failed: " << error->message;
-            g_clear_error(&error);
-            h.set("status", message);
-            this->updateState(State::ERROR, h);
-            return;
+
+#ifdef KARABO_WITH_LZ4
+    template <class T>
+    void AravisCamera::compress_pixels(const T* pixels, Frame& frame) {
+        const size_t n_pixels = frame.image->getShape().size();
+        const size_t n_blocks = kernels::bitshuffleBlocks(n_pixels, sizeof(T));
+
+        // The blocks are compressed concurrently by the worker pool, if any, each one into a slot as large as its
+        // worst case, then the slots are packed into the stream
+        auto compressed = std::make_shared<std::vector<uint8_t>>(kernels::bitshuffleLz4Bound(n_pixels, sizeof(T)));
+        uint8_t* stream = compressed->data();
+        std::vector<size_t> blockSizes(n_blocks);
+        const auto fn = [pixels, n_pixels, stream, &blockSizes](size_t begin, size_t end) {
+            kernels::compressBitshuffleLz4(pixels, n_pixels, begin, end, stream + kernels::BITSHUFFLE_HEADER_BYTES,
+                                           blockSizes.data());
+        };
+        if (frame.workers) {
+            frame.workers->parallel_for(n_blocks, 4, fn);
+        } else {
+            fn(0, n_blocks);
         }
+        compressed->resize(kernels::packBitshuffleLz4(pixels, n_pixels, blockSizes.data(), stream));
 
-        h.set("status", "Acquisition stopped");
-        this->signalEOS(); // End-of-Stream signal
-        this->postAcquisitionStop();
-        this->updateState(State::ON, h);
+        frame.compressed = compressed;
+    }
+#endif
+
+
+    void AravisCamera::write_compressed(const Frame& frame) {
+        const FramePlan& plan = *frame.plan;
+        const karabo::data::NDArray& image = *frame.image;
+        const std::shared_ptr<std::vector<uint8_t>>& compressed = frame.compressed;
+        const unsigned long long compressedSize = compressed->size();
+        const unsigned long long originalSize = image.byteSize();
+
+        // The compressed stream is not copied, it is kept alive until the last consumer releases it
+        const ByteArray data(std::shared_ptr<char>(compressed, reinterpret_cast<char*>(compressed->data())),
+                             compressedSize);
+        Hash h("data.compressed", data, "data.codec", std::string(m_compressionCodec));
+        // The stream is a chunk of the HDF5 filter, i.e. it can be stored as it is with a direct chunk write.
+        // The options are the ones given to the filter: the default block size, and LZ4.
+        h.set("data.filterId", kernels::BITSHUFFLE_FILTER_ID);
+        h.set("data.filterOptions", std::vector<unsigned int>{0, kernels::BITSHUFFLE_LZ4});
+        h.set("data.blockSize", static_cast<unsigned int>(kernels::BITSHUFFLE_BLOCK_BYTES));
+        h.set("data.shape", image.getShape().toVector());
+        h.set("data.type", Types::to<ToLiteral>(image.getType()));
+        h.set("data.encoding", static_cast<int>(plan.encoding));
+        h.set("data.bitsPerPixel", plan.bpp);
+        h.set("data.binning", plan.binning.toVector());
+        h.set("data.roiOffsets", plan.roiOffsets.toVector());
+        h.set("data.compressedSize", compressedSize);
+        h.set("data.originalSize", originalSize);
+        h.set<float>("data.ratio", double(originalSize) / compressedSize);
+        this->writeChannel("compressedOutput", h, frame.ts);
+
+        m_compressed_frames += 1;
+        m_compressed_bytes += compressedSize;
+        m_original_bytes += originalSize;
     }
 
 
-    void AravisCamera::trigger() {
-        if (!m_arv_camera_trigger) {
+    void AravisCamera::startRecording() {
+        if (std::atomic_load(&m_recorder)) {
+            this->set("status", "Already recording");
             return;
         }
 
-        GError* error = nullptr;
+        // Device IDs contain slashes
+        std::string deviceId = this->getInstanceId();
+        std::replace(deviceId.begin(), deviceId.end(), '/', '_');
+        const std::filesystem::path directory(this->get<std::string>("recording.directory"));
+        const std::string path =
+              (directory / (deviceId + "_" + Epochstamp().toFormattedString("%Y%m%dT%H%M%S"))).string();
 
-        const std::string& triggerMode = this->get<std::string>("triggerMode");
-        if (triggerMode == "On") {
-            const std::string& triggerSource = this->get<std::string>("triggerSource");
-            if (triggerSource == "Software") {
-                boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-                arv_camera_software_trigger(m_camera, &error);
-                if (error != nullptr) {
-                    KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
-                                               << ": arv_camera_software_trigger failed: " << error->message;
-                    g_clear_error(&error);
-                }
-            }
+        std::shared_ptr<FrameRecorder> recorder;
+        try {
+            const unsigned long long chunkSize = this->get<unsigned int>("recording.chunkSize");
+            recorder = std::make_shared<FrameRecorder>(path, 1000000ull * chunkSize);
+        } catch (const std::exception& e) {
+            const std::string message("Could not start recording");
+            KARABO_LOG_ERROR << message;
+            KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId() << ": " << message << " to " << path << ": "
+                                       << e.what();
+            this->set("status", message);
+            return;
         }
+
+        m_recorded_frames = 0ull;
+        m_dropped_recordings = 0ull;
+        std::atomic_store(&m_recorder, recorder);
+
+        Hash h("recording.active", true, "recording.path", path, "recording.frames", 0ull);
+        h.set("recording.dropped", 0ull);
+        h.set("status", "Recording to " + path);
+        this->set(h);
     }
 
 
-    void AravisCamera::refresh() {
-        // Poll parameters and update options
-        const bool success = this->updateOutputSchema();
-        if (!success) {
-            this->updateState(State::ERROR);
+    void AravisCamera::stopRecording() {
+        this->stop_recording(std::atomic_load(&m_recorder), "Recording stopped");
+    }
+
+
+    void AravisCamera::stop_recording(const std::shared_ptr<FrameRecorder>& recorder, const std::string& status) {
+        std::shared_ptr<FrameRecorder> expected = recorder;
+        const std::shared_ptr<FrameRecorder> stopped;
+        if (!recorder || !std::atomic_compare_exchange_strong(&m_recorder, &expected, stopped)) {
+            // Not recording, or already stopped
+            return;
         }
+
+        // The queued images are still written, the files are closed after the last one
+        this->set(Hash("recording.active", false, "status", status));
     }
 
 
-    void AravisCamera::reset() {
-        if (!m_connect) {
-            // Connection task has been stopped
-            this->updateState(State::UNKNOWN, Hash("status", ""));
-            m_connect = true;
-            m_reconnect_timer.expires_from_now(boost::posix_time::milliseconds(1));
-            m_reconnect_timer.async_wait(
-                  karabo::util::bind_weak(&AravisCamera::connect, this, boost::asio::placeholders::error));
+    void AravisCamera::record_frame(const Frame& frame) {
+        const std::shared_ptr<FrameRecorder> recorder = std::atomic_load(&m_recorder);
+        const std::shared_ptr<WorkerPool> recordingWorker = std::atomic_load(&m_recording_worker);
+        if (!recorder || !recordingWorker) return;
+
+        const FramePlan& plan = *frame.plan;
+        if (m_recording_queue >= plan.recordingQueue) {
+            // The disk cannot keep up
+            ++m_dropped_recordings;
             return;
         }
 
-        // Poll parameters and update options
-        const bool success = this->updateOutputSchema();
-        if (success) {
-            this->updateState(State::ON, Hash("status", ""));
+        const karabo::data::NDArray& image = *frame.image;
+        karabo::data::ByteArray data = image.getByteArray(); // Keeps the owner, if any, alive
+        if (!frame.owner || frame.stream_owner) {
+            // The image is in the stream buffer, which must go back to the stream once written to the channels,
+            // not once written to disk. The copy is aligned, thus the recorder writes it without staging it.
+            std::shared_ptr<char> copyOwner;
+            char* copy = this->get_recording_data(data.second, copyOwner);
+            std::memcpy(copy, data.first.get(), data.second);
+            data.first = copyOwner;
         }
-    }
 
-    void AravisCamera::postAcquisitionStop() {
-        // Hook that can be implemented in the derived class, if needed.
+        const Epochstamp& epoch = frame.ts.getEpochstamp();
+        const FrameRecorder::IndexEntry entry = {frame.frame_id, frame.ts.getTrainId(), epoch.getSeconds(),
+                                                 epoch.getFractionalSeconds(), 0, 0};
+        const std::string layout = this->get_recording_layout(image.getShape().toVector(), image.getType(), plan);
+
+        ++m_recording_queue;
+        recordingWorker->post([this, recorder, data, entry, layout]() {
+            try {
+                recorder->write(data.first.get(), data.second, entry, layout);
+                m_recorded_bytes += data.second;
+                ++m_recorded_frames;
+                if (m_recorded_frames == 1) {
+                    this->set("recording.direct", recorder->isDirect());
+                }
+            } catch (const std::exception& e) {
+                KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId() << ": Could not record image: " << e.what();
+                this->stop_recording(recorder, "Recording failed, see the log");
+            }
+            --m_recording_queue;
+        });
     }
 
 
-    void AravisCamera::resetCamera() {
-        // To be implemented in the derived class, if the feature is available.
+    std::string AravisCamera::get_recording_layout(const std::vector<unsigned long long>& shape,
+                                                   karabo::data::Types::ReferenceType type,
+                                                   const FramePlan& plan) const {
+        std::ostringstream layout;
+        layout << "shape=" << toString(shape) << "\n"
+               << "type=" << Types::to<ToLiteral>(type) << "\n"
+               << "encoding=" << static_cast<int>(plan.encoding) << "\n"
+               << "bitsPerPixel=" << plan.bpp << "\n";
+        return layout.str();
     }
 
 
-    void AravisCamera::clear_camera() {
-        boost::mutex::scoped_lock camera_lock(m_camera_mtx);
-        g_clear_object(&m_camera);
-        m_device = nullptr; // Has been clearead by clearing m_camera
-        g_clear_object(&m_parser);
+    void AravisCamera::triggerEvent() {
+        // Handled with the next written image
+        m_event_requested = true;
     }
 
 
-    void AravisCamera::clear_stream() {
-        if (m_stream != nullptr) {
-            // Disable emission of signals and free resource
-            boost::mutex::scoped_lock stream_lock(m_stream_mtx);
-            g_clear_object(&m_stream);
+    void AravisCamera::buffer_event_frame(const Frame& frame) {
+        const FramePlan& plan = *frame.plan;
+        const bool requested = m_event_requested.exchange(false);
+        // The condition triggers an event when it becomes true, not as long as it stays true
+        const bool conditionMet = this->meets_event_condition(frame);
+        const bool triggered = requested || (conditionMet && !m_event_condition_met);
+        m_event_condition_met = conditionMet;
+        if (m_is_dumping) {
+            // The ring is frozen, or being allocated
+            if (triggered) {
+                this->set("preTrigger.missedEvents", ++m_missed_events);
+            }
+            return;
+        }
+        if (!plan.preTrigger) {
+            // The ring memory is released
+            m_event_ring.reset();
+            m_event_pending = false;
+            return;
         }
-    }
 
+        const karabo::data::NDArray& image = *frame.image;
+        if (!m_event_ring || m_event_ring->shape != image.getShape().toVector() ||
+            m_event_ring->type != image.getType() || m_event_ring->window != plan.eventHistory + plan.eventPost ||
+            m_event_ring->budget != plan.eventBudget) {
+            // The history starts over, as well as a pending event
+            m_event_pending = false;
+            this->allocate_event_ring(image, plan);
+            return;
+        }
 
-    void AravisCamera::stream_cb(void* context, ArvStreamCallbackType type, ArvBuffer* buffer) {
-        // This code is called from the stream receiving thread, which means all the time spent there is less time
-        // available for the reception of incoming packets
+        const double time = frame.ts.getEpochstamp().toTimestamp();
+        if (!m_event_pending && triggered) {
+            m_event_pending = true;
+            m_event_time = time;
+        }
 
-        Self* self = static_cast<Self*>(context);
-        const std::string& deviceId = self->getInstanceId();
+        EventRing& ring = *m_event_ring;
+        if (ring.slots.empty()) {
+            // The allocation failed
+            return;
+        }
+        EventSlot& slot = ring.slots[ring.next];
+        std::memcpy(slot.data.data(), image.getByteArray().first.get(), ring.bytes);
+        slot.valid = true;
+        slot.sequence = frame.sequence;
+        slot.frame_id = frame.frame_id;
+        slot.ts = frame.ts;
+        ring.next = (ring.next + 1) % ring.slots.size();
+
+        const std::shared_ptr<WorkerPool> eventWorker = std::atomic_load(&m_event_worker);
+        if (m_event_pending && time >= m_event_time + plan.eventPost && eventWorker) {
+            // End of the post-event window
+            m_event_pending = false;
+            m_is_dumping = true;
+            eventWorker->post([this, ring = m_event_ring, plan = frame.plan, eventTime = m_event_time]() {
+                try {
+                    this->dump_event(*ring, *plan, eventTime);
+                } catch (const std::exception& e) {
+                    KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId() << ": Could not dump event: " << e.what();
+                }
+                for (EventSlot& slot : ring->slots) {
+                    slot.valid = false;
+                }
+                m_is_dumping = false;
+            });
+        }
+    }
 
-        if (type == ARV_STREAM_CALLBACK_TYPE_INIT) {
-            // Stream thread started
-            KARABO_LOG_FRAMEWORK_DEBUG << deviceId << ": ARV_STREAM_CALLBACK_TYPE_INIT";
-            if (!arv_make_thread_realtime(10) && !arv_make_thread_high_priority(-10)) {
-                KARABO_LOG_FRAMEWORK_WARN << deviceId << ": Failed to make stream thread high priority";
-            }
-        } else if (type == ARV_STREAM_CALLBACK_TYPE_BUFFER_DONE) {
-            boost::mutex::scoped_lock stream_lock(self->m_stream_mtx);
 
-            // The buffer is received, successfully or not
-            ArvBufferStatus buffer_status = arv_buffer_get_status(buffer);
-            if (buffer == arv_stream_pop_buffer(self->m_stream) && buffer_status == ARV_BUFFER_STATUS_SUCCESS) {
-                // AravisCamera::process_buffer can take long thus is posted to the event loop
-                // 'process_buffer' shall also take care of calling arv_stream_push_buffer
-                self->m_outputStrand->post(karabo::util::bind_weak(&AravisCamera::process_buffer, self, buffer));
-            } else {
-                // Push back the buffer to the stream
-                arv_stream_push_buffer(self->m_stream, buffer);
+    bool AravisCamera::meets_event_condition(const Frame& frame) const {
+        const FramePlan& plan = *frame.plan;
+        if (plan.eventCondition == 0 || !frame.statistics || frame.statistics->count == 0) return false;
 
-                self->m_errorCount += 1;
-                if (buffer_status == ARV_BUFFER_STATUS_SUCCESS) {
-                    // Other ERROR:
-                    // The buffer status is OK but the buffer received by the
-                    // callback does not match the one popped from the queue.
-                    self->m_lastError = ARV_BUFFER_STATUS_UNKNOWN;
-                }
-            }
-        }
+        const double mean = double(frame.statistics->sum) / frame.statistics->count;
+        return (plan.eventCondition > 0) ? (mean > plan.eventThreshold) : (mean < plan.eventThreshold);
     }
 
 
-    void AravisCamera::process_buffer(ArvBuffer* arv_buffer) {
-        const karabo::data::Timestamp dev_ts = this->getActualTimestamp();
-        const std::string& deviceId = this->getInstanceId();
+    void AravisCamera::allocate_event_ring(const karabo::data::NDArray& image, const FramePlan& plan) {
+        auto ring = std::make_shared<EventRing>();
+        ring->shape = image.getShape().toVector();
+        ring->type = image.getType();
+        ring->bytes = image.byteSize();
+        ring->window = plan.eventHistory + plan.eventPost;
+        ring->budget = plan.eventBudget;
+
+        float frame_rate = m_last_frame_rate;
+        if (frame_rate <= 0.f && this->get<bool>("frameRate.enable")) {
+            // Frame rate not measured yet: use the target one
+            frame_rate = this->get<float>("frameRate.target");
+        }
+        // Enough images for the window, but not more than what fits in the memory budget
+        unsigned long long n_slots = std::ceil(ring->window * frame_rate) + 1;
+        n_slots = std::min<unsigned long long>(n_slots, ring->budget / std::max<size_t>(ring->bytes, 1));
+        n_slots = std::max(n_slots, 1ull);
+
+        // Allocating and zero-filling up to the memory budget takes long: it is done by the event thread, with
+        // the ring frozen. The images are not kept in the meanwhile.
+        const std::shared_ptr<WorkerPool> eventWorker = std::atomic_load(&m_event_worker);
+        if (!eventWorker) return;
+        m_event_ring.reset();
+        m_is_dumping = true;
+        eventWorker->post([this, ring, n_slots]() {
+            try {
+                ring->slots.resize(n_slots);
+                for (EventSlot& slot : ring->slots) {
+                    slot.data.resize(ring->bytes);
+                }
+            } catch (const std::exception& e) {
+                // The ring is kept empty, until the image or the configuration change
+                KARABO_LOG_FRAMEWORK_ERROR << this->getInstanceId()
+                                           << ": Could not allocate the pre-trigger history: " << e.what();
+                ring->slots.clear();
+            }
+            m_event_ring = ring;
+            this->set("preTrigger.capacity", static_cast<unsigned int>(ring->slots.size()));
+            m_is_dumping = false;
+        });
+    }
 
-        size_t buffer_size;
-        const void* buffer_data = arv_buffer_get_data(arv_buffer, &buffer_size);
 
-        karabo::data::Timestamp ts;
-        if (this->get_timestamp(arv_buffer, ts)) {
-            // Latency between the image timestamp and the reception time
-            const double latency = dev_ts.getEpochstamp() - ts.getEpochstamp();
-            if (m_counter == 0) {
-                m_min_latency = latency;
-                m_max_latency = latency;
-                m_mean_latency = latency;
-            } else {
-                m_min_latency = std::min(latency, m_min_latency);
-                m_max_latency = std::max(latency, m_max_latency);
-                m_mean_latency = (m_counter * m_mean_latency + latency) / (m_counter + 1);
+    void AravisCamera::dump_event(EventRing& ring, const FramePlan& plan, double eventTime) {
+        // The images of the window, in order of reception
+        std::vector<EventSlot*> slots;
+        for (EventSlot& slot : ring.slots) {
+            const double time = slot.ts.getEpochstamp().toTimestamp();
+            if (slot.valid && time >= eventTime - plan.eventHistory && time <= eventTime + plan.eventPost) {
+                slots.push_back(&slot);
+            }
+        }
+        std::sort(slots.begin(), slots.end(),
+                  [](const EventSlot* a, const EventSlot* b) { return a->sequence < b->sequence; });
+
+        const unsigned long long event = m_events + 1;
+        const Dims shape(ring.shape);
+        if (plan.eventToDisk) {
+            std::string deviceId = this->getInstanceId();
+            std::replace(deviceId.begin(), deviceId.end(), '/', '_');
+            const Epochstamp eventEpoch(static_cast<unsigned long long>(eventTime), 0ull);
+            const std::filesystem::path directory(this->get<std::string>("recording.directory"));
+            const std::filesystem::path path =
+                  directory / (deviceId + "_event_" + eventEpoch.toFormattedString("%Y%m%dT%H%M%S"));
+            FrameRecorder recorder(path.string(), 1000000ull * this->get<unsigned int>("recording.chunkSize"));
+            const std::string layout = this->get_recording_layout(ring.shape, ring.type, plan);
+            for (EventSlot* slot : slots) {
+                const Epochstamp& epoch = slot->ts.getEpochstamp();
+                recorder.write(slot->data.data(), ring.bytes,
+                               {slot->frame_id, slot->ts.getTrainId(), epoch.getSeconds(),
+                                epoch.getFractionalSeconds(), 0, 0},
+                               layout);
             }
         } else {
-            // HW timestamp not available: use actual one from device
-            ts = dev_ts;
+            for (EventSlot* slot : slots) {
+                // The ring is re-used after the dump, thus the images are copied for the local consumers
+                const karabo::data::NDArray array(
+                      std::shared_ptr<char>(reinterpret_cast<char*>(slot->data.data()), [](const char*) {}),
+                      ring.type, shape.size(), shape);
+                karabo::xms::ImageData imageData(array, plan.encoding, plan.bpp);
+                imageData.setBinning(plan.binning);
+                imageData.setROIOffsets(plan.roiOffsets);
+                this->writeChannel("eventOutput",
+                                   Hash("data.image", imageData, "data.frameId",
+                                        static_cast<unsigned long long>(slot->frame_id), "data.event", event),
+                                   slot->ts);
+            }
         }
 
-        // NB When a new pixel format is supported, do not forget to add it to m_supportedPixelFormats
-        // and to the updateOutputSchema function
-        switch (m_format) {
-            case ARV_PIXEL_FORMAT_MONO_8:
-                this->writeOutputChannels<unsigned char>(buffer_data, m_width, m_height, ts);
-                break;
-            case ARV_PIXEL_FORMAT_MONO_10:
-            case ARV_PIXEL_FORMAT_MONO_12:
-            case ARV_PIXEL_FORMAT_MONO_14:
-            case ARV_PIXEL_FORMAT_MONO_16:
-                this->writeOutputChannels<unsigned short>(buffer_data, m_width, m_height, ts);
-                break;
-            case ARV_PIXEL_FORMAT_MONO_10_PACKED:
-            case ARV_PIXEL_FORMAT_MONO_12_PACKED: {
-                const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer_data);
-                uint16_t* unpackedData = m_unpackedData.data();
-                unpackMono12Packed(data, m_width, m_height, unpackedData);
-                this->writeOutputChannels<unsigned short>(unpackedData, m_width, m_height, ts);
-            } break;
-            case ARV_PIXEL_FORMAT_MONO_10_P: {
-                const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer_data);
-                uint16_t* unpackedData = m_unpackedData.data();
-                unpackMono10p(data, m_width, m_height, unpackedData);
-                this->writeOutputChannels<unsigned short>(unpackedData, m_width, m_height, ts);
-            } break;
-            case ARV_PIXEL_FORMAT_MONO_12_P: {
-                const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer_data);
-                uint16_t* unpackedData = m_unpackedData.data();
-                unpackMono12p(data, m_width, m_height, unpackedData);
-                this->writeOutputChannels<unsigned short>(unpackedData, m_width, m_height, ts);
-            } break;
-            case ARV_PIXEL_FORMAT_RGB_8_PACKED:
-            case ARV_PIXEL_FORMAT_RGB_8_PLANAR:
-            case ARV_PIXEL_FORMAT_BGR_8_PACKED:
-                this->writeOutputChannels<unsigned char>(buffer_data, m_width, m_height, ts);
-                break;
-            case ARV_PIXEL_FORMAT_RGB_10_PACKED:
-            case ARV_PIXEL_FORMAT_RGB_10_PLANAR:
-            case ARV_PIXEL_FORMAT_BGR_10_PACKED:
-            case ARV_PIXEL_FORMAT_RGB_12_PACKED:
-            case ARV_PIXEL_FORMAT_RGB_12_PLANAR:
-            case ARV_PIXEL_FORMAT_BGR_12_PACKED:
-            case ARV_PIXEL_FORMAT_RGB_16_PLANAR:
-                // XXX not tested
-                this->writeOutputChannels<unsigned short>(buffer_data, m_width, m_height, ts);
-                break;
-            case ARV_PIXEL_FORMAT_BAYER_RG_8:
-            case ARV_PIXEL_FORMAT_BAYER_GR_8:
-                this->writeOutputChannels<unsigned char>(buffer_data, m_width, m_height, ts);
+        m_events = event;
+        this->set(Hash("preTrigger.events", event, "status",
+                       "Event dumped, " + toString(slots.size()) + " images"));
+    }
+
+
+    void AravisCamera::compute_statistics(Frame& frame) {
+        const karabo::data::NDArray& image = *frame.image;
+        const size_t n_pixels = image.getShape().size();
+        switch (image.getType()) {
+            case Types::UINT8:
+                this->accumulate_statistics(image.getData<unsigned char>(), n_pixels, frame);
                 break;
-            case ARV_PIXEL_FORMAT_BAYER_RG_10:
-            case ARV_PIXEL_FORMAT_BAYER_RG_12:
-            case ARV_PIXEL_FORMAT_BAYER_GR_10:
-            case ARV_PIXEL_FORMAT_BAYER_GR_12:
-                this->writeOutputChannels<unsigned short>(buffer_data, m_width, m_height, ts);
+            case Types::UINT16:
+                this->accumulate_statistics(image.getData<unsigned short>(), n_pixels, frame);
                 break;
-            case ARV_PIXEL_FORMAT_BAYER_RG_10P:
-            case ARV_PIXEL_FORMAT_BAYER_GR_10P: {
-                const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer_data);
-                uint16_t* unpackedData = m_unpackedData.data();
-                unpackBayer10p(data, m_width, m_height, unpackedData);
-                this->writeOutputChannels<unsigned short>(unpackedData, m_width, m_height, ts);
-            } break;
-            case ARV_PIXEL_FORMAT_BAYER_RG_12P:
-            case ARV_PIXEL_FORMAT_BAYER_GR_12P: {
-                const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer_data);
-                uint16_t* unpackedData = m_unpackedData.data();
-                unpackBayer12p(data, m_width, m_height, unpackedData);
-                this->writeOutputChannels<unsigned short>(unpackedData, m_width, m_height, ts);
-            } break;
-            case ARV_PIXEL_FORMAT_YCBCR_422_8:
-            case ARV_PIXEL_FORMAT_YUV_422_PACKED:
-            case ARV_PIXEL_FORMAT_YUV_422_YUYV_PACKED:
-                this->writeOutputChannels<unsigned char>(buffer_data, m_width, m_height, ts);
+            case Types::UINT32:
+                this->accumulate_statistics(image.getData<unsigned int>(), n_pixels, frame);
                 break;
             default:
-                if (m_pixelFormatOptions.find(m_format) != m_pixelFormatOptions.end()) {
-                    KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": Format " << m_pixelFormatOptions[m_format] << " ("
-                                               << m_format << ")"
-                                               << " is not yet supported";
-                } else {
-                    KARABO_LOG_FRAMEWORK_ERROR << deviceId << ": Format " << m_format << " is not yet supported";
-                }
-
-                if (this->getState() == State::ACQUIRING) {
-                    this->execute("stop");
-                }
+                break;
         }
+    }
 
-        { // Push back the buffer to the stream
-            arv_stream_push_buffer(m_stream, arv_buffer);
-            boost::mutex::scoped_lock stream_lock(m_stream_mtx);
-        }
 
-        m_counter += 1;
+    template <class T>
+    void AravisCamera::accumulate_statistics(const T* pixels, size_t n_pixels, Frame& frame) {
+        const FramePlan& plan = *frame.plan;
+        kernels::PixelStatistics& statistics = frame.statistics.emplace();
+        if (!frame.workers) {
+            kernels::accumulateStatistics(pixels, n_pixels, plan.saturation, plan.histogramShift, statistics);
+            return;
+        }
 
-        if (m_timer.elapsed() >= 1. && m_is_acquiring) {
-            // Update frame rate and error count
-            this->updateFrameRate();
+        // In chunks accumulated concurrently by the worker pool, then merged
+        boost::mutex statistics_mtx;
+        frame.workers->parallel_for(n_pixels, 1 << 18, [&](size_t begin, size_t end) {
+            kernels::PixelStatistics chunk;
+            kernels::accumulateStatistics(pixels + begin, end - begin, plan.saturation, plan.histogramShift, chunk);
+            boost::mutex::scoped_lock statistics_lock(statistics_mtx);
+            statistics.merge(chunk);
+        });
+    }
 
-            // Synchronize camera timestamp with timeserver.
-            // This shall be repetead regularly to correct for drift.
-            this->synchronize_timestamp();
 
-            m_timer.now();
-            m_counter = 0;
+    void AravisCamera::publish_statistics(const Frame& frame) {
+        const kernels::PixelStatistics& statistics = *frame.statistics;
+        if (statistics.saturated > 0) {
+            ++m_saturated_frames;
         }
 
-        if (!m_isContinuousMode) {
-            if (m_imgsToBeAcquired > 1) {
-                --m_imgsToBeAcquired;
-            } else {
-                // Stop acquisition
-                m_imgsToBeAcquired = 0;
-                this->execute("stop");
-            }
+        const auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - m_last_statistics).count() < frame.plan->statisticsInterval) {
+            // Rate decimation
+            return;
         }
+        m_last_statistics = now;
+
+        Hash h;
+        h.set("min", statistics.min);
+        h.set("max", statistics.max);
+        h.set("mean", statistics.count > 0 ? double(statistics.sum) / statistics.count : 0.);
+        h.set("sum", static_cast<unsigned long long>(statistics.sum));
+        h.set("saturated", static_cast<unsigned long long>(statistics.saturated));
+        h.set("saturatedFrames", m_saturated_frames);
+        h.set("histogram", std::vector<unsigned long long>(statistics.histogram,
+                                                           statistics.histogram + kernels::HISTOGRAM_BINS));
+        m_saturated_frames = 0ull;
+
+        this->writeChannel("statisticsOutput", h, frame.ts);
+        this->set(Hash("statistics", h), frame.ts);
     }
 
 
@@ -2862,16 +6381,82 @@ namespace karabo {
                 break;
         }
 
-        const unsigned short bpp = ARV_PIXEL_FORMAT_BIT_PER_PIXEL(m_format);
-        h.set("bpp", bpp);
+        unsigned short bpp = ARV_PIXEL_FORMAT_BIT_PER_PIXEL(m_format);
 
-        m_shape = shape;
+        const int binX = this->get<int>("bin.x");
+        const int binY = this->get<int>("bin.y");
+        const bool softwareBinning = m_is_software_binning && (binX > 1 || binY > 1);
+        if (softwareBinning && m_encoding == Encoding::GRAY && kType != Types::UNKNOWN) {
+            // The image is binned on the host, the columns and rows which do not fill a whole bin are dropped
+            const unsigned long long binnedHeight = height / binY;
+            const unsigned long long binnedWidth = width / binX;
+            if (rotation == 90 || rotation == 270) {
+                shape = {binnedWidth, binnedHeight};
+            } else {
+                shape = {binnedHeight, binnedWidth};
+            }
+            if (this->get<std::string>("bin.mode") == "Sum") {
+                // The sums need up to log2(binX * binY) more bits
+                unsigned short extraBits = 0;
+                while ((1 << extraBits) < binX * binY) ++extraBits;
+                bpp = std::min(32, bpp + extraBits);
+                kType = Types::UINT32;
+            }
+        }
+        h.set("bin.software", m_is_software_binning);
 
         size_t unpackedDataSize = width * height;
         if (shape.size() > 2) {
             unpackedDataSize *= shape[2];
         }
-        m_unpackedData.resize(unpackedDataSize);
+        {
+            boost::mutex::scoped_lock unpacked_lock(m_unpacked_mtx);
+            m_unpackedData.resize(unpackedDataSize);
+            m_unpackedPool.clear(); // Data still referenced by consumers are freed on release
+            m_imagePool.clear();
+        }
+
+        kernels::BayerPattern pattern;
+        unsigned int bits;
+        if (AravisCamera::get_bayer_layout(m_format, pattern, bits) &&
+            this->get<std::string>("demosaic.method") != "None") {
+            // The Bayer mosaic is interpolated to an RGB image
+            m_encoding = Encoding::RGB;
+            shape.push_back(3);
+            bpp *= 3;
+        }
+
+        const std::string& yuvConversion = this->get<std::string>("yuvConversion");
+        if ((m_encoding == Encoding::YUV422_YUYV || m_encoding == Encoding::YUV422_UYVY) && yuvConversion != "None") {
+            // The YUV 4:2:2 image is converted, the chroma pairs are replaced by the colour channels or dropped
+            shape.pop_back();
+            if (yuvConversion == "RGB8") {
+                m_encoding = Encoding::RGB;
+                shape.push_back(3);
+                bpp = 24;
+            } else {
+                m_encoding = Encoding::GRAY;
+                bpp = 8;
+            }
+        }
+
+        const bool correction = (this->get_correction_maps(shape) != nullptr);
+        if (correction) {
+            // The images are corrected on the host, to 16-bit pixels or to floats
+            const unsigned short channels = (shape.size() > 2) ? shape[2] : 1;
+            if (this->get<std::string>("correction.output") == "Float32") {
+                kType = Types::FLOAT;
+                bpp = 32 * channels;
+            } else {
+                kType = Types::UINT16;
+                bpp = std::min<unsigned short>(bpp, 16 * channels);
+            }
+        }
+        h.set("correction.active", correction);
+
+        h.set("bpp", bpp);
+
+        m_shape = shape;
 
         CameraImageSource::updateOutputSchema(shape, m_encoding, kType);
 
@@ -2934,6 +6519,16 @@ namespace karabo {
             this->disableElement("packetDelay", schemaUpdate);
             this->disableElement("autoPacketSize", schemaUpdate);
             this->disableElement("packetSize", schemaUpdate);
+            this->disableElement("streamStatistics.resentPackets", schemaUpdate);
+            this->disableElement("streamStatistics.missingPackets", schemaUpdate);
+            this->disableElement("streamStatistics.ignoredPackets", schemaUpdate);
+            this->disableElement("streamStatistics.timeouts", schemaUpdate);
+            this->disableElement("streamTuning.socketBufferMode", schemaUpdate);
+            this->disableElement("streamTuning.socketBufferSize", schemaUpdate);
+            this->disableElement("streamTuning.packetTimeout", schemaUpdate);
+            this->disableElement("streamTuning.frameRetention", schemaUpdate);
+            this->disableElement("streamTuning.packetResend", schemaUpdate);
+            this->disableElement("streamTuning.packetSocket", schemaUpdate);
         }
 
         if (m_is_device_reset_available) {
@@ -2993,7 +6588,7 @@ namespace karabo {
                   .commit();
         }
 
-        if (!m_is_binning_available) {
+        if (!m_is_binning_available && !m_is_software_binning) {
             // Binning is not available to arv_camera commands, but the feature can still be
             // accessible by alias.
             if (!this->keyHasAlias("bin.x")) {
@@ -3095,72 +6690,301 @@ namespace karabo {
         // Update device values only after schema (including options) has been updated
         this->set(h);
 
+        // Frame plan must be built from the updated values
+        this->build_frame_plan();
+
         return true; // success
     }
 
 
-    template <class T>
-    void AravisCamera::writeOutputChannels(const void* data, gint width, gint height,
-                                           const karabo::data::Timestamp& ts) {
-        Dims shape;
-        const unsigned int rotation = this->get<unsigned int>("rotation");
-        switch (rotation) {
+    void AravisCamera::build_frame_plan() {
+        auto plan = std::make_shared<FramePlan>();
+
+        plan->format = m_format;
+        plan->width = m_width;
+        plan->height = m_height;
+        plan->encoding = m_encoding;
+        plan->bpp = this->get<unsigned short>("bpp");
+        this->set_frame_processing(*plan, Hash());
+
+        std::vector<unsigned long long> shape = m_shape;
+        const bool planar = (m_format == ARV_PIXEL_FORMAT_RGB_8_PLANAR || m_format == ARV_PIXEL_FORMAT_RGB_10_PLANAR ||
+                             m_format == ARV_PIXEL_FORMAT_RGB_12_PLANAR || m_format == ARV_PIXEL_FORMAT_RGB_16_PLANAR);
+        Dims binning(plan->binY, plan->binX);
+        Dims roiOffsets(this->get<int>("roi.y"), this->get<int>("roi.x"));
+        if (plan->bin) {
+            // As with hardware binning, the offsets are in binned pixels
+            roiOffsets = Dims(roiOffsets.x1() / plan->binY, roiOffsets.x2() / plan->binX);
+        }
+        switch (plan->rotation) {
             case 90:
             case 270:
                 // N.B. In case image has to be rotated, in m_shape width and
                 // height are already swapped! Thus I have to swap again
                 // before I use it to construct the NDArray
-                {
-                    std::vector<unsigned long long> vec = m_shape;
-                    vec[0] = m_shape[1];
-                    vec[1] = m_shape[0];
-                    shape = Dims(vec);
-                    break;
+                // The planar images have the shape (3, height, width)
+                if (planar) {
+                    std::swap(shape[1], shape[2]);
+                } else if (shape.size() > 1) {
+                    std::swap(shape[0], shape[1]);
                 }
+                // Binning and ROI offsets must be reversed before adding the
+                // 3rd dimension (i.e. channel)
+                binning.reverse();
+                roiOffsets.reverse();
+                break;
             default:
-                shape = Dims(m_shape);
                 break;
         }
+        plan->shape = Dims(shape);
 
-        // Non-copy NDArray constructor
-        karabo::data::NDArray imgArray((T*)data, shape.size(), karabo::data::NDArray::NullDeleter(), shape);
+        if (plan->shape.rank() == 3) { // color image
+            binning = Dims(binning.x1(), binning.x2(), 1);
+            roiOffsets = Dims(roiOffsets.x1(), roiOffsets.x2(), 1);
+        }
+        plan->binning = binning;
+        plan->roiOffsets = roiOffsets;
 
-        const unsigned short bpp = this->get<unsigned short>("bpp");
-        Dims binning(this->get<int>("bin.y"), this->get<int>("bin.x"));
-        Dims roiOffsets(this->get<int>("roi.y"), this->get<int>("roi.x"));
+        const kernels::UnpackKernels& unpackKernels = kernels::getUnpackKernels();
+        switch (plan->format) {
+            case ARV_PIXEL_FORMAT_MONO_10_PACKED:
+            case ARV_PIXEL_FORMAT_MONO_12_PACKED:
+                plan->unpack = unpackKernels.mono12Packed;
+                plan->packedBits = 12;
+                break;
+            case ARV_PIXEL_FORMAT_MONO_12_P:
+            case ARV_PIXEL_FORMAT_BAYER_RG_12P:
+            case ARV_PIXEL_FORMAT_BAYER_GR_12P:
+                plan->unpack = unpackKernels.mono12p;
+                plan->packedBits = 12;
+                break;
+            case ARV_PIXEL_FORMAT_MONO_10_P:
+            case ARV_PIXEL_FORMAT_BAYER_RG_10P:
+            case ARV_PIXEL_FORMAT_BAYER_GR_10P:
+                plan->unpack = unpackKernels.mono10p;
+                plan->packedBits = 10;
+                break;
+            default:
+                plan->unpack = nullptr;
+                plan->packedBits = 0;
+                break;
+        }
 
-        // Apply flip on software if not available on camera
-        const bool flipX = this->get<bool>("flip.X") && !m_is_flip_x_available;
-        const bool flipY = this->get<bool>("flip.Y") && !m_is_flip_y_available;
-        if (flipX || flipY) {
-            util::flip_image<T>(imgArray, flipX, flipY);
+        std::vector<unsigned long long> orientedShape = shape;
+        if (plan->rotation == 90 || plan->rotation == 270) {
+            if (planar) {
+                std::swap(orientedShape[1], orientedShape[2]);
+            } else {
+                std::swap(orientedShape[0], orientedShape[1]);
+            }
+        }
+        plan->orientedShape = Dims(orientedShape);
+
+        if (plan->orient) {
+            // Software binning is done before the orientation
+            const int width = plan->bin ? plan->width / plan->binX : plan->width;
+            const int height = plan->bin ? plan->height / plan->binY : plan->height;
+            plan->orientation = kernels::getOrientation(width, height, plan->flipX, plan->flipY, plan->rotation);
+        }
+
+        plan->preview = this->get<bool>("preview.enable");
+        plan->previewInterval = 1. / this->get<float>("preview.maxRate");
+        plan->previewFactor = this->get<unsigned int>("preview.downscale");
+        plan->previewEightBit = this->get<bool>("preview.eightBit");
+        bool bayer = false;
+        bool interleaved = true; // The images can be downscaled and cropped
+        switch (plan->encoding) {
+            case Encoding::BAYER_RG:
+            case Encoding::BAYER_GR:
+                // The mosaic is averaged, the colours are lost
+                bayer = true;
+                plan->previewEncoding = Encoding::GRAY;
+                break;
+            case Encoding::YUV422_YUYV:
+            case Encoding::YUV422_UYVY:
+                // The pairs of pixels sharing the chroma cannot be averaged
+                interleaved = false;
+                plan->previewEncoding = plan->encoding;
+                break;
+            default:
+                plan->previewEncoding = plan->encoding;
+                break;
+        }
+        switch (plan->format) {
+            case ARV_PIXEL_FORMAT_RGB_8_PLANAR:
+            case ARV_PIXEL_FORMAT_RGB_10_PLANAR:
+            case ARV_PIXEL_FORMAT_RGB_12_PLANAR:
+            case ARV_PIXEL_FORMAT_RGB_16_PLANAR:
+                // The channels are not interleaved
+                interleaved = false;
+                break;
+            default:
+                break;
+        }
+        plan->preview = plan->preview && interleaved;
+
+        plan->softwareRois.clear();
+        const std::vector<Hash> softwareRois = this->get<std::vector<Hash>>("softwareRois");
+        const size_t n_rois = interleaved ? std::min<size_t>(softwareRois.size(), m_maxSoftwareRois) : 0;
+        for (size_t i = 0; i < n_rois; ++i) {
+            const Hash& row = softwareRois[i];
+            SoftwareRoi roi;
+            roi.channel = "roiOutput" + toString(i);
+            roi.x = row.get<unsigned int>("x");
+            roi.y = row.get<unsigned int>("y");
+            roi.width = row.get<unsigned int>("width");
+            roi.height = row.get<unsigned int>("height");
+            roi.bin = row.get<unsigned int>("bin");
+            if (bayer) {
+                // The colour pattern of the mosaic is kept
+                roi.x &= ~1;
+                roi.y &= ~1;
+            }
+            roi.encoding = (bayer && roi.bin > 1) ? Encoding::GRAY : plan->encoding;
+            plan->softwareRois.push_back(roi);
         }
 
-        switch (rotation) {
-            case 90:
-            case 270:
-                util::rotate_image<T>(imgArray, rotation);
-                // Binning and ROI offsets must be reversed before adding the
-                // 3rd dimension (i.e. channel)
-                binning.reverse();
-                roiOffsets.reverse();
+        const std::string accumulationMode = this->get<std::string>("accumulation.mode");
+        if (!this->get<bool>("accumulation.enable")) {
+            plan->accumulation = AccumulationMode::NONE;
+        } else if (accumulationMode == "Sum") {
+            plan->accumulation = AccumulationMode::SUM;
+        } else if (accumulationMode == "Mean") {
+            plan->accumulation = AccumulationMode::MEAN;
+        } else {
+            plan->accumulation = AccumulationMode::EWMA;
+        }
+        plan->accumulationFrames = this->get<unsigned int>("accumulation.frames");
+
+        // The bits of each pixel value, i.e. of each channel, give the saturation and the histogram range
+        unsigned int channels = 1;
+        switch (plan->encoding) {
+            case Encoding::RGB:
+            case Encoding::BGR:
+                channels = 3;
                 break;
-            case 180:
-                util::rotate_image<T>(imgArray, rotation);
+            case Encoding::YUV422_YUYV:
+            case Encoding::YUV422_UYVY:
+                channels = 2;
                 break;
             default:
                 break;
         }
+        const unsigned int valueBits = std::max(1u, plan->bpp / channels);
+        const unsigned int saturation = this->get<unsigned int>("statistics.saturation");
+        plan->statistics = this->get<bool>("statistics.enable");
+        plan->saturation = (saturation > 0) ? saturation : (1ull << valueBits) - 1;
+        plan->histogramShift = std::max(0, int(valueBits) - 6); // 64 bins
+
+        // The bit depth is the one of the corrected images, if the correction is active
+        plan->correction = this->get_correction_maps(plan->orientedShape.toVector());
+        plan->correctionFloat = this->get<std::string>("correction.output") == "Float32";
+        plan->correctionMax = (1u << std::min(16u, valueBits)) - 1;
+        plan->statisticsInterval = 1. / this->get<float>("statistics.maxRate");
+        plan->compression = this->get<bool>("compression.enable");
+        plan->rawOutput = this->get<bool>("compression.rawOutput");
+        plan->recordingQueue = this->get<unsigned int>("recording.queueSize");
+        plan->preTrigger = this->get<bool>("preTrigger.enable");
+        plan->eventHistory = this->get<float>("preTrigger.history");
+        plan->eventPost = this->get<float>("preTrigger.postEvent");
+        plan->eventBudget = 1000000ull * this->get<unsigned int>("preTrigger.memoryBudget"); // MB -> B
+        const std::string eventCondition = this->get<std::string>("preTrigger.condition");
+        plan->eventCondition = (eventCondition == "Above") ? 1 : (eventCondition == "Below") ? -1 : 0;
+        plan->eventThreshold = this->get<double>("preTrigger.threshold");
+        plan->eventToDisk = this->get<std::string>("preTrigger.destination") == "Disk";
+
+        plan->process = AravisCamera::select_frame_processor(*plan);
+
+        // The frame processing reads the plan without locking
+        std::atomic_store(&m_framePlan, std::shared_ptr<const FramePlan>(plan));
+    }
 
-        if (shape.rank() == 3) { // color image
-            binning = Dims(binning.x1(), binning.x2(), 1);
-            roiOffsets = Dims(roiOffsets.x1(), roiOffsets.x2(), 1);
+
+    template <class T>
+    void AravisCamera::make_image(const void* data, Frame& frame, const karabo::data::Dims& shape) {
+        const std::shared_ptr<void>& owner = frame.owner;
+
+        // Non-copy NDArray constructor. If an owner is provided, it is kept alive until the last consumer
+        // releases the image, otherwise data must be valid until writeChannels returns.
+        karabo::data::NDArray imgArray =
+              owner ? karabo::data::NDArray((T*)data, shape.size(), [owner](const void*) {}, shape)
+                    : karabo::data::NDArray((T*)data, shape.size(), karabo::data::NDArray::NullDeleter(), shape);
+
+        frame.image.emplace(std::move(imgArray));
+    }
+
+    void AravisCamera::updateLatency(const boost::system::error_code& ec) {
+        if (ec == boost::asio::error::operation_aborted) return;
+        if (!m_is_acquiring) return;
+
+        Hash h;
+        this->update_latency(h);
+        this->set(h);
+
+        m_latency_timer.expires_from_now(boost::posix_time::seconds(1l));
+        m_latency_timer.async_wait(
+              karabo::util::bind_weak(&AravisCamera::updateLatency, this, boost::asio::placeholders::error));
+    }
+
+
+    void AravisCamera::update_latency(Hash& h) {
+        const std::chrono::seconds windowLength(this->get<unsigned int>("latency.windowLength"));
+        const auto now = std::chrono::steady_clock::now();
+
+        boost::mutex::scoped_lock latency_lock(m_latency_mtx);
+        m_latency_window.add(m_latency_second);
+        m_latency_total.add(m_latency_second);
+        m_latency_seconds.emplace_back(now, m_latency_second);
+        // The window is in seconds, whatever the delays of the timer
+        while (!m_latency_seconds.empty() && now - m_latency_seconds.front().first >= windowLength) {
+            m_latency_window.subtract(m_latency_seconds.front().second);
+            m_latency_seconds.pop_front();
+        }
+
+        const auto setPercentiles = [&h](const std::string& key, const LatencyHistogram& histogram) {
+            // us -> ms
+            h.set<float>(key + ".p50", 1.e-3 * histogram.quantile(0.5));
+            h.set<float>(key + ".p90", 1.e-3 * histogram.quantile(0.9));
+            h.set<float>(key + ".p99", 1.e-3 * histogram.quantile(0.99));
+            h.set<float>(key + ".p999", 1.e-3 * histogram.quantile(0.999));
+            h.set<float>(key + ".max", 1.e-3 * histogram.max());
+        };
+        setPercentiles("latency.second", m_latency_second);
+        setPercentiles("latency.window", m_latency_window);
+        setPercentiles("latency.total", m_latency_total);
+        m_latency_second.reset();
+    }
+
+
+    void AravisCamera::record_stage_times(const FrameTimes& times) {
+        for (size_t i = 0; i < m_pipelineStages.size(); ++i) {
+            const PipelineStage& stage = m_pipelineStages[i];
+            const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(times.*stage.end -
+                                                                                        times.*stage.begin);
+            m_stage_times[i].record(std::max<std::chrono::microseconds::rep>(0, duration.count()));
+        }
+    }
+
+
+    void AravisCamera::dumpLatencyHistogram() {
+        std::vector<std::pair<uint64_t, uint64_t>> buckets;
+        {
+            boost::mutex::scoped_lock latency_lock(m_latency_mtx);
+            buckets = m_latency_total.buckets();
         }
 
-        // Send image and metadata to output channel
-        this->writeChannels(imgArray, binning, bpp, m_encoding, roiOffsets, ts);
+        std::vector<float> bounds;
+        std::vector<unsigned long long> counts;
+        bounds.reserve(buckets.size());
+        counts.reserve(buckets.size());
+        for (const auto& [bound, count] : buckets) {
+            bounds.push_back(1.e-3 * bound); // us -> ms
+            counts.push_back(count);
+        }
+        this->set(Hash("latency.histogram.bounds", bounds, "latency.histogram.counts", counts));
     }
 
+
     void AravisCamera::updateFrameRate() {
         Hash h;
 
@@ -3169,16 +6993,44 @@ namespace karabo {
             h.set<float>("latency.min", 1000. * m_min_latency);
             h.set<float>("latency.max", 1000. * m_max_latency);
             h.set<float>("latency.mean", 1000. * m_mean_latency);
+
+            // Mean processing time per image, in ms
+            h.set<float>("processing.processTime", 1000. * m_process_time / m_counter);
+            h.set<float>("processing.writeTime", 1000. * m_write_time / m_counter);
+
+            for (size_t i = 0; i < m_pipelineStages.size(); ++i) {
+                // us -> ms
+                const std::string key = std::string("timing.") + m_pipelineStages[i].key;
+                h.set<float>(key + ".p50", 1.e-3 * m_stage_times[i].quantile(0.5));
+                h.set<float>(key + ".p99", 1.e-3 * m_stage_times[i].quantile(0.99));
+                h.set<float>(key + ".max", 1.e-3 * m_stage_times[i].max());
+            }
+        }
+
+        h.set<float>("recording.rate", 1.e-6 * m_recorded_bytes.exchange(0) / m_timer.elapsed());
+        h.set("recording.queueDepth", m_recording_queue.load());
+        h.set("recording.frames", m_recorded_frames.load());
+        h.set("recording.dropped", m_dropped_recordings.load());
+
+        if (m_compressed_frames > 0) {
+            h.set<float>("compression.ratio", double(m_original_bytes) / m_compressed_bytes);
+            h.set("compression.compressedSize", m_compressed_bytes / m_compressed_frames);
         }
 
         // Calculate frame rate
         const float frameRate = m_counter / m_timer.elapsed();
         h.set("frameRate.actual", frameRate);
+        m_last_frame_rate = frameRate;
+
+        this->update_buffer_pool(h);
+        this->update_stream_statistics(h, m_timer.elapsed());
 
-        if (m_errorCount != this->get<unsigned long long>("errorCount")) {
-            h.set("errorCount", m_errorCount);
-            if (m_bufferStatus.find(m_lastError) != m_bufferStatus.end()) {
-                const std::string& lastError = m_bufferStatus[m_lastError];
+        const unsigned long long errorCount = m_errorCount.load(std::memory_order_relaxed);
+        if (errorCount != this->get<unsigned long long>("errorCount")) {
+            h.set("errorCount", errorCount);
+            const auto status = m_bufferStatus.find(m_lastError.load(std::memory_order_relaxed));
+            if (status != m_bufferStatus.end()) {
+                const std::string& lastError = status->second;
                 if (lastError != this->get<std::string>("lastError")) {
                     h.set("lastError", lastError);
                 }
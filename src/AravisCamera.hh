@@ -9,6 +9,13 @@
 #ifndef KARABO_ARAVISCAMERA_HH
 #define KARABO_ARAVISCAMERA_HH
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <optional>
+#include <thread>
 #include <unordered_map>
 
 extern "C" {
@@ -18,6 +25,13 @@ extern "C" {
 #include <image_source/CameraImageSource.hh>
 #include <karabo/karabo.hpp>
 
+#include "Compression.hh"
+#include "Demosaic.hh"
+#include "FrameRecorder.hh"
+#include "LatencyHistogram.hh"
+#include "ImageKernels.hh"
+#include "SpscRing.hh"
+#include "WorkerPool.hh"
 #include "version.hh" // provides ARAVISCAMERAS_PACKAGE_VERSION
 
 /**
@@ -49,7 +63,7 @@ namespace karabo {
         /**
          * The destructor will be called in case the device gets killed
          */
-        virtual ~AravisCamera() = default;
+        virtual ~AravisCamera();
 
         virtual void preDestruction() final;
 
@@ -97,10 +111,21 @@ namespace karabo {
         bool isFeatureAvailable(const std::string& feature) const;
         virtual void configure(karabo::data::Hash& configuration);
 
+        mutable boost::mutex m_parser_mtx; // Lock for ArvChunkParser
+
+        // Karabo time and camera time taken at the same moment, used to convert camera timestamps.
+        // It is updated by synchronize_timestamp, periodically and independently of the image processing.
+        struct TimestampReference {
+            karabo::data::Timestamp karabo_time;
+            gint64 camera_time; // in ticks
+            int tick_frequency;
+        };
+        void set_timestamp_reference(const TimestampReference& reference);
+        std::shared_ptr<const TimestampReference> get_timestamp_reference() const;
+
         virtual bool synchronize_timestamp();
         virtual bool configure_timestamp_chunk();
         bool m_chunk_mode;
-        karabo::data::Timestamp m_reference_karabo_time;
 
         gint m_width;
         gint m_height;
@@ -129,7 +154,6 @@ namespace karabo {
         virtual std::string get_frame_rate_enable_parameter_name() const;
 
        private:
-        karabo::net::Strand::Pointer m_outputStrand;
 
         bool m_need_schema_update;
         void initialize();
@@ -154,6 +178,10 @@ namespace karabo {
 
         boost::asio::deadline_timer m_poll_timer;
 
+        boost::asio::deadline_timer m_sync_timer;
+        std::shared_ptr<const TimestampReference> m_timestamp_reference; // Only access with std::atomic_load/store
+        void syncTimestamp(const boost::system::error_code& ec);
+
         bool m_is_acquiring;
         void acquire();
         void acquire_failed_helper(const std::string& detailed_msg);
@@ -162,6 +190,12 @@ namespace karabo {
         void refresh();
         void reset();
         virtual void resetCamera();
+        void captureDark();
+        void captureFlat();
+        void startRecording();
+        void stopRecording();
+        void triggerEvent();
+        void dumpLatencyHistogram();
 
         void getPathsByTag(std::vector<std::string>& paths, const std::string& tags);
 
@@ -179,25 +213,413 @@ namespace karabo {
 
         void clear_camera();
 
+        // Shared by the device and the buffers handed over to consumers: a buffer released after the stream
+        // has been cleared is freed, instead of being pushed back.
+        // It is also the context of stream_cb, thus it must outlive the stream.
+        struct StreamHandle {
+            boost::mutex mtx;
+            ArvStream* stream = nullptr; // Protected by mtx, nullptr once the stream is cleared
+            std::atomic<ArvStream*> rx_stream{nullptr}; // Used by stream_cb, never reset
+            AravisCamera* camera = nullptr;
+            unsigned int generation = 0;
+        };
+        std::shared_ptr<StreamHandle> m_stream_handle; // Protected by m_stream_mtx
+        unsigned int m_stream_generation;              // Incremented at every stream creation
+        static void release_buffer(const std::shared_ptr<StreamHandle>& handle, ArvBuffer* buffer);
+        uint16_t* get_unpacked_data(std::shared_ptr<void>& owner, bool pooled);
+        void* get_pooled_data(size_t size, std::shared_ptr<void>& owner);
+        char* get_recording_data(size_t size, std::shared_ptr<char>& owner);
+
+        // Buffers received successfully, handed over from the stream thread to the processing thread
+        struct ReadyBuffer {
+            ArvBuffer* buffer;       // nullptr requests the processing thread to stop
+            unsigned int generation; // Generation of the stream the buffer belongs to
+            std::chrono::steady_clock::time_point received;
+        };
+        SpscRing<ReadyBuffer> m_ready_buffers;
+        std::thread m_processing_thread;
+        void process_buffers();
+        void stop_processing_thread();
+
         static void stream_cb(void* context, ArvStreamCallbackType type, ArvBuffer* buffer);
-        void process_buffer(ArvBuffer* buffer);
+        void process_buffer(ArvBuffer* buffer, const std::shared_ptr<StreamHandle>& handle,
+                            std::chrono::steady_clock::time_point received);
         static void control_lost_cb(ArvGvDevice* gv_device, void* context);
 
         void pollOnce(karabo::data::Hash& h);
         void pollCamera(const boost::system::error_code& ec);
         void pollGenicamFeatures(const std::vector<std::string>& paths, karabo::data::Hash& h);
         bool updateOutputSchema();
+
+        struct Frame;
+        // Processes one image, a specialisation of process_frame selected when the frame plan is built
+        typedef void (AravisCamera::*FrameProcessor)(const void* data, Frame& frame);
+        // How the pixels are read from the stream buffer
+        enum class PixelSource {
+            DIRECT,  // As received
+            PACKED,  // Unpacked to 16 bits
+            YUV,     // YUV 4:2:2 converted to RGB8 or Mono8
+            PLANAR,  // As received, the channels in planes
+            RAW_YUV  // YUV 4:2:2 as received
+        };
+        // What is done to the pixels, before flipping and rotating the image
+        enum class PixelTransform {
+            NONE,
+            DEMOSAIC,   // Bayer mosaic interpolated to RGB
+            BIN_SUM,    // Software binning, into 32-bit sums
+            BIN_AVERAGE // Software binning, the pixel type is kept
+        };
+        // How the written images are accumulated
+        enum class AccumulationMode {
+            NONE,
+            SUM,  // 32-bit sums of N images
+            MEAN, // Means of N images, as floats
+            EWMA  // Exponentially weighted moving average with weight 1 / N, as floats
+        };
+
+        // Dark-frame subtraction and flat-field correction, applied after any other processing
+        enum class CorrectionReference { DARK, FLAT };
+        // Mean of the images captured as a correction reference
+        struct ReferenceImage {
+            std::vector<unsigned long long> shape;
+            std::vector<float> values;
+        };
+        // Per-pixel correction maps, of the image shape
+        struct CorrectionMaps {
+            std::vector<unsigned long long> shape;
+            std::vector<float> dark; // Zeros if there is no dark reference
+            std::vector<float> gain; // Ones if there is no flat reference
+        };
+
+        // Region cropped by the host from the written images, and written to an output channel of its own
+        struct SoftwareRoi {
+            std::string channel;
+            int x; // In pixels of the written images, i.e. after binning and rotation
+            int y;
+            int width;
+            int height;
+            int bin; // Binning factor of the region, in both directions
+            karabo::xms::Encoding encoding;
+        };
+
+        // Immutable snapshot of the parameters needed to process an image. It is rebuilt when the configuration
+        // changes, thus no property has to be read while processing images.
+        struct FramePlan {
+            ArvPixelFormat format;
+            gint width;
+            gint height;
+            karabo::data::Dims shape; // Image shape before rotation
+            unsigned int rotation;
+            bool flipX; // Horizontal flip to be done in software
+            bool flipY; // Vertical flip to be done in software
+            unsigned short bpp;
+            karabo::xms::Encoding encoding;
+            karabo::data::Dims binning;    // As written to the output channel, i.e. after rotation
+            karabo::data::Dims roiOffsets; // As written to the output channel, i.e. after rotation
+            bool orient;                      // Flip and/or rotation to be done in software
+            kernels::Orientation orientation; // Software flip and rotation, if orient
+            karabo::data::Dims orientedShape; // Image shape after rotation
+            kernels::UnpackFunction unpack;   // Kernel for the packed pixel format, if any
+            size_t packedBits;                // Bits per packed pixel
+            bool zeroCopy;                    // Hand over image ownership to the output channels
+            bool demosaic;                    // Interpolate the Bayer mosaic to an RGB image
+            kernels::DemosaicParameters demosaicParameters;
+            kernels::YuvFunction convertYuv;  // Kernel converting the YUV 4:2:2 pixels, if enabled
+            bool bin;                         // Binning to be done in software
+            bool binAverage;                  // Average, instead of sum, the binned pixels
+            int binX;
+            int binY;
+            bool preview;                     // Write downscaled images to the preview channel
+            double previewInterval;           // Minimum time between preview images (s)
+            int previewFactor;                // Downscaling factor of the preview images
+            bool previewEightBit;             // Convert the preview images to 8 bits
+            karabo::xms::Encoding previewEncoding;
+            std::vector<SoftwareRoi> softwareRois; // Empty if the images cannot be cropped
+            std::shared_ptr<const CorrectionMaps> correction; // nullptr if disabled, or no matching reference
+            bool correctionFloat;                  // The corrected images are floats, else 16-bit pixels
+            float correctionMax;                   // Clamping value of the corrected 16-bit pixels
+            AccumulationMode accumulation;         // NONE if disabled
+            unsigned int accumulationFrames;       // Images per result, or time constant of the moving average
+            bool statistics;                  // Compute the statistics of each image
+            uint32_t saturation;              // Pixel value counted as saturated
+            int histogramShift;               // Pixel values to histogram bins
+            double statisticsInterval;        // Minimum time between statistics updates (s)
+            bool compression;                 // Write the compressed images to their channel
+            bool rawOutput;                   // Write also the uncompressed images, when compressed
+            unsigned int recordingQueue;      // Maximum number of images waiting to be recorded
+            bool preTrigger;                  // Keep the latest images in the event ring
+            double eventHistory;              // Time kept before an event (s)
+            double eventPost;                 // Time kept after an event (s)
+            unsigned long long eventBudget;   // Maximum size of the event ring (B)
+            int eventCondition;               // Crossing of the threshold by the mean 0: no, 1: upwards, -1: downwards
+            double eventThreshold;
+            bool eventToDisk;                 // Dump the events to disk, else to the event channel
+            FrameProcessor process;           // nullptr if the configuration cannot be processed
+        };
+        std::shared_ptr<const FramePlan> m_framePlan; // Only to be accessed with std::atomic_load/store
+        void build_frame_plan();
+
+        // Monotonic times of the stages of an image
+        struct FrameTimes {
+            std::chrono::steady_clock::time_point received;    // Buffer done, in stream_cb
+            std::chrono::steady_clock::time_point dequeued;    // By the processing thread
+            std::chrono::steady_clock::time_point started;     // Processing started, by a worker if any
+            std::chrono::steady_clock::time_point processed;   // Unpacked, interpolated, binned, flipped and rotated
+            std::chrono::steady_clock::time_point transformed; // Also corrected, statistics and compression done
+            std::chrono::steady_clock::time_point writing;     // Its turn to be written came
+            std::chrono::steady_clock::time_point written;     // writeChannels returned
+            std::chrono::steady_clock::time_point done;        // The buffer pushed back, if not handed over
+        };
+        // The duration between two times of the frame
+        struct PipelineStage {
+            const char* key;
+            const char* name;
+            std::chrono::steady_clock::time_point FrameTimes::*begin;
+            std::chrono::steady_clock::time_point FrameTimes::*end;
+        };
+        static const std::vector<PipelineStage> m_pipelineStages;
+        // An image in flight in the processing pipeline
+        struct Frame {
+            unsigned long long sequence; // Order of reception, the images are written in this order
+            ArvBuffer* buffer;           // nullptr once handed over, or pushed back to the stream
+            guint64 frame_id;            // As given by the camera
+            std::shared_ptr<StreamHandle> handle;
+            std::shared_ptr<const FramePlan> plan;
+            WorkerPool* workers; // Processing the images concurrently, nullptr if not used, see wait_for_frames
+            karabo::data::Timestamp ts;
+            bool has_latency;
+            double latency;                             // Latency between image timestamp and reception (s)
+            std::shared_ptr<void> owner;                // Keeps the image data alive, if set
+            bool stream_owner = false;                  // The owner is the stream buffer (zero-copy output)
+            std::optional<karabo::data::NDArray> image; // Not set if the processing failed
+            double process_time = 0.;                   // Time spent in transform_frame (s)
+            std::optional<kernels::PixelStatistics> statistics; // Set if enabled and the processing succeeded
+            std::shared_ptr<std::vector<uint8_t>> compressed; // Set if enabled and the pixel type supported
+            FrameTimes times;
+        };
+        void transform_frame(Frame& frame);
+        void complete_frame(const std::shared_ptr<Frame>& frame);
+        void write_frame(Frame& frame);
+        template <class T, PixelSource Source, PixelTransform Transform, bool Orient, bool ZeroCopy>
+        void process_frame(const void* data, Frame& frame);
+        template <class T, PixelSource Source, PixelTransform Transform>
+        static FrameProcessor select_frame_processor(bool orient, bool zeroCopy);
+        template <class T, PixelSource Source>
+        static FrameProcessor select_frame_processor(PixelTransform transform, bool orient, bool zeroCopy);
+        static FrameProcessor select_frame_processor(const FramePlan& plan);
+        void set_frame_processing(FramePlan& plan, const karabo::data::Hash& configuration) const;
+        void check_frame_processor(const karabo::data::Hash& configuration) const;
+        template <class T, PixelSource Source>
+        const T* read_pixels(const void* data, Frame& frame, std::shared_ptr<void>& owner);
+        static bool get_bayer_layout(ArvPixelFormat format, kernels::BayerPattern& pattern, unsigned int& bits);
+        void* orient_image(const void* data, size_t pixelBytes, Frame& frame);
         template <class T>
-        void writeOutputChannels(const void* data, gint width, gint height, const karabo::data::Timestamp& ts);
+        void make_image(const void* data, Frame& frame, const karabo::data::Dims& shape);
+
+        std::shared_ptr<WorkerPool> m_workers; // Only access with std::atomic_load/store, nullptr if not used
+        boost::mutex m_reorder_mtx;
+        std::map<unsigned long long, std::shared_ptr<Frame>> m_reorder; // Processed images waiting to be written
+        std::atomic<unsigned long long> m_next_sequence; // Incremented by the processing thread only
+        unsigned long long m_next_write;    // Protected by m_reorder_mtx
+        bool m_is_writing;                  // Protected by m_reorder_mtx
+        double m_process_time;              // Time spent processing images since last update (s)
+        double m_write_time;                // Time spent writing images since last update (s)
+        std::vector<LatencyHistogram> m_stage_times; // Time spent in m_pipelineStages since last update (us)
+        void record_stage_times(const FrameTimes& times);
+        void update_workers();
+        void wait_for_frames();
         void updateFrameRate();
 
+        // Preview images are downscaled and written by a thread of their own, thus they never delay the output
+        // channels. An image is skipped if the previous preview image is still being processed.
+        std::shared_ptr<WorkerPool> m_preview_worker; // Only access with std::atomic_load/store
+        std::atomic<bool> m_is_previewing;
+        std::chrono::steady_clock::time_point m_last_preview; // Used by the writing thread only
+        void preview_frame(Frame& frame);
+        void write_preview(const karabo::data::NDArray& image, const FramePlan& plan,
+                           const karabo::data::Timestamp& ts);
+        template <class T, class Out>
+        void downscale_preview(const karabo::data::NDArray& image, const FramePlan& plan,
+                               const karabo::data::Timestamp& ts);
+
+        // The references are captured from the processed images before correction, by the frame transforms.
+        // Each transform adds its image to partial sums not used by the others, outside of the lock, thus the
+        // workers do not wait for each other. The partial sums are added up when the capture is complete.
+        struct CaptureSums {
+            unsigned int generation;        // m_capture_generation when set up
+            std::vector<uint32_t> sums;     // 8- and 16-bit images
+            std::vector<uint64_t> wideSums; // 32-bit images
+        };
+        boost::mutex m_correction_mtx; // Protects the references and the capture
+        std::shared_ptr<const ReferenceImage> m_dark;
+        std::shared_ptr<const ReferenceImage> m_flat;
+        std::shared_ptr<const CorrectionMaps> m_correction_maps;
+        std::atomic<bool> m_is_capturing;
+        CorrectionReference m_capture_reference;
+        unsigned int m_capture_target;
+        unsigned int m_capture_frames;     // Added to the partial sums
+        unsigned int m_capture_claimed;    // Being added, or added
+        unsigned int m_capture_generation; // Incremented when the capture starts over
+        std::vector<unsigned long long> m_capture_shape;
+        karabo::data::Types::ReferenceType m_capture_type;
+        std::vector<std::shared_ptr<CaptureSums>> m_capture_idle; // The partial sums not being added to
+        void start_capture(CorrectionReference reference);
+        void capture_frame(const Frame& frame);
+        void finish_capture(CorrectionReference reference, const std::vector<unsigned long long>& shape,
+                            const std::vector<std::shared_ptr<CaptureSums>>& partials, unsigned int frames);
+        std::string get_reference_path(CorrectionReference reference) const;
+        void load_references();
+        void update_correction_maps();
+        std::shared_ptr<const CorrectionMaps> get_correction_maps(const std::vector<unsigned long long>& shape);
+        void correct_frame(Frame& frame);
+        template <class T>
+        void correct_pixels(const T* pixels, Frame& frame);
+
+        // Software ROIs are cropped from the image by the writing thread, the source image is not copied
+        static const unsigned int m_maxSoftwareRois;
+        void write_software_rois(const Frame& frame);
+        template <class T>
+        void crop_software_roi(const karabo::data::NDArray& image, const FramePlan& plan, const SoftwareRoi& roi,
+                               const karabo::data::Timestamp& ts);
+
+        // Images are accumulated by the writing thread, with the help of the workers. The results are written by
+        // a thread of their own, from a second buffer, thus the accumulation never waits for the output channel.
+        struct Accumulation {
+            AccumulationMode mode = AccumulationMode::NONE;
+            unsigned int target = 0; // FramePlan::accumulationFrames
+            std::vector<unsigned long long> shape;
+            karabo::data::Types::ReferenceType type = karabo::data::Types::UNKNOWN;
+            unsigned int frames = 0; // Accumulated so far, the buffer is cleared on the next image if 0
+            std::vector<uint32_t> sums;     // SUM and MEAN of 8- and 16-bit images
+            std::vector<uint64_t> wideSums; // SUM and MEAN of 32-bit images, e.g. binned sums
+            std::vector<float> average;     // EWMA
+        };
+        std::shared_ptr<Accumulation> m_accumulation;         // Used by the writing thread only
+        std::shared_ptr<Accumulation> m_accumulation_spare;   // Protected by m_is_writing_accumulation
+        std::shared_ptr<WorkerPool> m_accumulation_worker;    // Only access with std::atomic_load/store
+        std::atomic<bool> m_is_writing_accumulation;
+        std::atomic<bool> m_reset_accumulation;               // Set on acquisition start
+        unsigned long long m_dropped_accumulations;           // Used by the writing thread only
+        void accumulate_frame(const Frame& frame);
+        template <class T>
+        void accumulate_pixels(const T* pixels, size_t n_pixels, WorkerPool* workers);
+        void publish_accumulation(const Frame& frame);
+        void write_accumulation(const Accumulation& accumulation, const FramePlan& plan,
+                                const karabo::data::Timestamp& ts);
+
+        // Image statistics, computed for every image and published at a limited rate
+        std::chrono::steady_clock::time_point m_last_statistics; // Used by the writing thread only
+        unsigned long long m_saturated_frames;                   // Since the last update, ditto
+        void compute_statistics(Frame& frame);
+        template <class T>
+        void accumulate_statistics(const T* pixels, size_t n_pixels, Frame& frame);
+        void publish_statistics(const Frame& frame);
+
+        // Lossless compression of the 8- and 16-bit images, done by the frame transforms, see Compression.hh.
+        // The compressed images are written to a channel of their own, with the metadata needed to decode them.
+        static const char* const m_compressionCodec;
+        unsigned long long m_compressed_frames; // Images written compressed since last update
+        unsigned long long m_compressed_bytes;  // Their compressed size, used by the writing thread only
+        unsigned long long m_original_bytes;    // Their uncompressed size, ditto
+        void compress_frame(Frame& frame);
+        template <class T>
+        void compress_pixels(const T* pixels, Frame& frame);
+        void write_compressed(const Frame& frame);
+
+        // Images are recorded to local disk by a thread of their own, from a bounded queue. Images are dropped
+        // if the queue is full, thus the recording never delays the output channels.
+        std::shared_ptr<FrameRecorder> m_recorder;            // Only access with std::atomic_load/store
+        std::shared_ptr<WorkerPool> m_recording_worker;       // Ditto
+        std::atomic<unsigned int> m_recording_queue;          // Images waiting to be recorded
+        std::atomic<unsigned long long> m_recorded_bytes;     // Since last update
+        std::atomic<unsigned long long> m_recorded_frames;    // Since recording start
+        std::atomic<unsigned long long> m_dropped_recordings; // Since recording start
+        void record_frame(const Frame& frame);
+        void stop_recording(const std::shared_ptr<FrameRecorder>& recorder, const std::string& status);
+        std::string get_recording_layout(const std::vector<unsigned long long>& shape,
+                                         karabo::data::Types::ReferenceType type, const FramePlan& plan) const;
+
+        // Pre-trigger history: the latest images are copied to a preallocated ring, without being published.
+        // At the end of the post-event window the ring is frozen, and the images around the event are dumped by a
+        // thread of their own. The history then starts over: events during the dump are missed.
+        struct EventSlot {
+            std::vector<uint8_t> data; // Allocated with the ring
+            bool valid = false;
+            unsigned long long sequence = 0;
+            guint64 frame_id = 0;
+            karabo::data::Timestamp ts;
+        };
+        struct EventRing {
+            std::vector<unsigned long long> shape;
+            karabo::data::Types::ReferenceType type = karabo::data::Types::UNKNOWN;
+            size_t bytes = 0;              // Per image
+            double window = 0.;            // FramePlan::eventHistory + eventPost
+            unsigned long long budget = 0; // FramePlan::eventBudget
+            std::vector<EventSlot> slots;
+            size_t next = 0;
+        };
+        std::shared_ptr<EventRing> m_event_ring;    // Used by the writing thread, or by the event one when frozen
+        std::shared_ptr<WorkerPool> m_event_worker; // Only access with std::atomic_load/store
+        std::atomic<bool> m_is_dumping;             // The event ring is frozen, dumped or allocated
+        std::atomic<bool> m_event_requested;        // By the triggerEvent slot
+        bool m_event_pending;                       // Used by the writing thread only
+        bool m_event_condition_met;                 // By the previous image, ditto
+        double m_event_time;                        // Of the pending event (s since epoch), ditto
+        std::atomic<unsigned long long> m_events;
+        std::atomic<unsigned long long> m_missed_events;
+        void buffer_event_frame(const Frame& frame);
+        bool meets_event_condition(const Frame& frame) const;
+        void allocate_event_ring(const karabo::data::NDArray& image, const FramePlan& plan);
+        void dump_event(EventRing& ring, const FramePlan& plan, double eventTime);
+
         bool resolveHostname(const std::string& hostname, std::string& ip_address, std::string& message);
 
         mutable boost::mutex m_stream_mtx; // Object lock for ArvStream
         bool m_need_stream_clear;          // After a reconfiguration the stream need to be cleared
         ArvStream* m_stream;
 
+        // Stream buffer pool
+        unsigned int m_pool_size;             // Number of buffers allocated to the stream
+        guint64 m_pool_underruns_start;       // Stream underruns at acquisition start
+        guint64 m_pool_underruns;             // Stream underruns at last pool update
+        std::atomic<float> m_last_frame_rate; // Last measured frame rate, it is not reset on stop
+        unsigned int get_buffer_pool_size(float frame_rate, unsigned int min_size) const;
+        void grow_buffer_pool(unsigned int n_buffers);
+        void update_buffer_pool(karabo::data::Hash& h);
+
+        // Stream statistics
+        struct StreamCounters {
+            guint64 completed = 0ull;
+            guint64 failures = 0ull;
+            guint64 underruns = 0ull;
+            guint64 resentPackets = 0ull; // GEV streams only
+            guint64 missingPackets = 0ull;
+            guint64 ignoredPackets = 0ull;
+            guint64 timeouts = 0ull;
+        };
+        StreamCounters m_stream_counters_start; // At acquisition start
+        guint64 m_last_completed;               // Completed buffers at last update
+        float m_link_capacity;                  // MB/s, 0 if not known
+        void read_stream_counters(StreamCounters& counters) const;
+
+        // Apply the 'streamTuning' settings to a new GEV stream, and check what the kernel granted
+        void tune_gv_stream(guint payload, karabo::data::Hash& h);
+        void update_stream_statistics(karabo::data::Hash& h, double elapsed);
+
+        // Buffers received by stream_cb, per status. The table is in the order of the ArvBufferStatus values
+        struct BufferStatusKey {
+            ArvBufferStatus status;
+            const char* key;
+            const char* name;
+        };
+        static const std::vector<BufferStatusKey> m_bufferStatusKeys;
+        std::array<std::atomic<unsigned long long>, ARV_BUFFER_STATUS_ABORTED - ARV_BUFFER_STATUS_UNKNOWN + 1>
+              m_status_counts;
+        std::atomic<unsigned long long> m_queue_overflows; // Images dropped as the processing queue was full
+        static size_t status_index(ArvBufferStatus status);
+
         bool m_is_binning_available;
+        bool m_is_software_binning; // Neither available to arv_camera commands nor by alias
         bool m_is_exposure_time_available;
         bool m_is_flip_x_available;
         bool m_is_flip_y_available;
@@ -210,14 +632,25 @@ namespace karabo {
         static const std::set<ArvPixelFormat> m_supportedPixelFormats;
         std::unordered_map<ArvPixelFormat, std::string> m_pixelFormatOptions;
 
-        unsigned long long m_errorCount;
-        ArvBufferStatus m_lastError;
+        // Written by the receiving thread, read by the writing thread
+        std::atomic<unsigned long long> m_errorCount;
+        std::atomic<ArvBufferStatus> m_lastError;
         std::unordered_map<ArvBufferStatus, std::string> m_bufferStatus;
 
         // Image latency
         karabo::data::Epochstamp m_timer;
         unsigned long m_counter;
         double m_mean_latency;
+        // Latency distributions (us), over the last second, a sliding window and since the acquisition start
+        boost::mutex m_latency_mtx; // Protects the histograms
+        LatencyHistogram m_latency_second;
+        LatencyHistogram m_latency_window;
+        LatencyHistogram m_latency_total;
+        // Making up the window, each one with the end of the interval it covers
+        std::deque<std::pair<std::chrono::steady_clock::time_point, LatencyHistogram>> m_latency_seconds;
+        boost::asio::deadline_timer m_latency_timer; // Updates the percentiles, also without images
+        void updateLatency(const boost::system::error_code& ec);
+        void update_latency(karabo::data::Hash& h);
 
         bool m_isContinuousMode;
         // Images to be acquired
@@ -226,7 +659,12 @@ namespace karabo {
         karabo::xms::Encoding m_encoding;
         std::vector<unsigned long long> m_shape;
 
+        boost::mutex m_unpacked_mtx; // Lock for the unpacked data pool
         std::vector<uint16_t> m_unpackedData;
+        std::vector<std::shared_ptr<std::vector<uint16_t>>> m_unpackedPool; // Used in zero-copy or parallel mode
+        std::vector<std::shared_ptr<std::vector<uint8_t>>> m_imagePool;     // Demosaiced, flipped or rotated images
+        // Aligned copies of the images queued for recording, only used by the writing thread
+        std::vector<std::pair<size_t, std::shared_ptr<char>>> m_recordingPool;
     };
 } // namespace karabo
 
@@ -507,14 +507,14 @@ namespace karabo {
     }
 
     AravisPhotonicScienceCamera::AravisPhotonicScienceCamera(const karabo::data::Hash& config)
-        : AravisCamera(config), m_reference_camera_timestamp(0.) {
+        : AravisCamera(config) {
         m_is_base_class = false;
         m_arv_camera_trigger = false; // Trigger properties to be accessed from non-standard paths
     }
 
     bool AravisPhotonicScienceCamera::synchronize_timestamp() {
         GError* error = nullptr;
-        double camera_timestamp;
+        gint64 camera_timestamp;
 
         boost::mutex::scoped_lock camera_lock(m_camera_mtx);
 
@@ -534,17 +534,19 @@ namespace karabo {
         }
 
         // Karabo current timestamp
-        m_reference_karabo_time = this->getActualTimestamp();
+        TimestampReference reference;
+        reference.karabo_time = this->getActualTimestamp();
+        reference.camera_time = camera_timestamp;
 
-        // Camera current timestamp (s)
-        const int tick_frequency = this->get<int>("tickFrequency");
-        if (tick_frequency == 0) {
+        // Camera clock frequency, needed to convert ticks to seconds
+        reference.tick_frequency = this->get<int>("tickFrequency");
+        if (reference.tick_frequency == 0) {
             KARABO_LOG_ERROR << "Could not synchronize timestamp: tick_frequency is 0";
             return false; // failure
         }
 
-        m_reference_camera_timestamp = camera_timestamp / tick_frequency;
-
+        // The reference is swapped atomically, images being processed are not blocked
+        this->set_timestamp_reference(reference);
         return true; // success
     }
 
@@ -589,10 +591,16 @@ namespace karabo {
         // The timestamp is provided in ns, thus convert it to s.
         const double timestamp = arv_buffer_get_timestamp(buffer) / 1e+9;
 
+        const std::shared_ptr<const TimestampReference> reference = this->get_timestamp_reference();
+        if (!reference) {
+            // Not synchronized yet
+            return false; // failure
+        }
+
         // Elapsed time since last synchronization.
         // NB This can be negative, if the image acquisition started before
         //    synchronization, but finished after.
-        const double elapsed_t = timestamp - m_reference_camera_timestamp;
+        const double elapsed_t = timestamp - double(reference->camera_time) / reference->tick_frequency;
 
         // Split elapsed time in seconds and attoseconds, then convert to TimeDuration.
         // elapsed_t is in seconds and TimeDuration expects fractions in attoseconds,
@@ -605,7 +613,7 @@ namespace karabo {
         const TimeDuration duration(seconds, fractions);
 
         // Calculate frame epochstamp from reference time and elapsed time
-        Epochstamp epoch(m_reference_karabo_time.getEpochstamp());
+        Epochstamp epoch(reference->karabo_time.getEpochstamp());
         if (seconds <= m_max_correction_time) {
             if (this->get<bool>("wouldCorrectAboveMaxTime")) {
                 this->set("wouldCorrectAboveMaxTime", false);
@@ -44,8 +44,6 @@ namespace karabo {
        private:
         void configure(karabo::data::Hash& configuration) override;
         void trigger() override;
-
-        double m_reference_camera_timestamp;
     };
 
 } // namespace karabo
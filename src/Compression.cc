@@ -0,0 +1,190 @@
+/*
+ * Author: <parenti>
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#include "Compression.hh"
+
+#include <lz4.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "ImageKernels.hh"
+
+namespace karabo {
+
+    namespace kernels {
+
+        namespace {
+
+            void writeUint32BE(uint8_t* out, uint32_t value) {
+                for (int i = 3; i >= 0; --i, value >>= 8) out[i] = value & 0xFF;
+            }
+
+
+            void writeUint64BE(uint8_t* out, uint64_t value) {
+                for (int i = 7; i >= 0; --i, value >>= 8) out[i] = value & 0xFF;
+            }
+
+
+            uint64_t readBE(const uint8_t* in, size_t bytes) {
+                uint64_t value = 0;
+                for (size_t i = 0; i < bytes; ++i) value = (value << 8) | in[i];
+                return value;
+            }
+
+
+            // Pixels of the block, the last one is rounded down to a multiple of 8
+            size_t blockCount(size_t n_pixels, size_t blockPixels, size_t block) {
+                return std::min(blockPixels, (n_pixels & ~size_t(7)) - block * blockPixels);
+            }
+
+
+            template <class T, class Shuffle>
+            void compressBlocks(Shuffle shuffle, const T* pixels, size_t n_pixels, size_t blockBegin, size_t blockEnd,
+                                uint8_t* slots, size_t* blockSizes) {
+                const size_t blockPixels = bitshuffleBlockPixels(sizeof(T));
+                const size_t slotBytes = bitshuffleLz4SlotBytes(sizeof(T));
+                alignas(32) uint8_t shuffled[BITSHUFFLE_BLOCK_BYTES];
+                uint8_t* planes[8 * sizeof(T)];
+                for (size_t block = blockBegin; block < blockEnd; ++block) {
+                    const size_t count = blockCount(n_pixels, blockPixels, block);
+                    for (size_t b = 0; b < 8 * sizeof(T); ++b) {
+                        planes[b] = shuffled + b * count / 8;
+                    }
+                    shuffle(pixels + block * blockPixels, count, planes);
+
+                    uint8_t* slot = slots + block * slotBytes;
+                    const int compressed = LZ4_compress_default(reinterpret_cast<const char*>(shuffled),
+                                                                reinterpret_cast<char*>(slot + 4), count * sizeof(T),
+                                                                slotBytes - 4);
+                    if (compressed <= 0) {
+                        // Not expected, the slot is as large as the worst case
+                        throw std::runtime_error("LZ4 compression failed");
+                    }
+                    writeUint32BE(slot, compressed);
+                    blockSizes[block] = 4 + compressed;
+                }
+            }
+
+
+            template <class T>
+            size_t packBlocks(const T* pixels, size_t n_pixels, const size_t* blockSizes, uint8_t* stream) {
+                writeUint64BE(stream, n_pixels * sizeof(T));
+                writeUint32BE(stream + 8, bitshuffleBlockPixels(sizeof(T)) * sizeof(T));
+
+                // The blocks are moved towards the start of the stream, each one after the previous one
+                const uint8_t* slots = stream + BITSHUFFLE_HEADER_BYTES;
+                const size_t slotBytes = bitshuffleLz4SlotBytes(sizeof(T));
+                const size_t n_blocks = bitshuffleBlocks(n_pixels, sizeof(T));
+                size_t offset = BITSHUFFLE_HEADER_BYTES;
+                for (size_t block = 0; block < n_blocks; ++block) {
+                    std::memmove(stream + offset, slots + block * slotBytes, blockSizes[block]);
+                    offset += blockSizes[block];
+                }
+
+                const size_t tail = n_pixels % 8;
+                std::memcpy(stream + offset, pixels + n_pixels - tail, tail * sizeof(T));
+                return offset + tail * sizeof(T);
+            }
+
+
+            template <class T>
+            bool decompressBlocks(const uint8_t* stream, size_t size, size_t n_pixels, T* pixels) {
+                if (size < BITSHUFFLE_HEADER_BYTES || readBE(stream, 8) != n_pixels * sizeof(T)) return false;
+                // The block size is the one of the stream, not necessarily the default one
+                const size_t blockBytes = readBE(stream + 8, 4);
+                if (blockBytes == 0 || blockBytes % (8 * sizeof(T)) != 0) return false;
+                const size_t blockPixels = blockBytes / sizeof(T);
+
+                std::vector<uint8_t> shuffled(blockBytes);
+                size_t offset = BITSHUFFLE_HEADER_BYTES;
+                for (size_t block = 0; block * blockPixels < (n_pixels & ~size_t(7)); ++block) {
+                    const size_t count = blockCount(n_pixels, blockPixels, block);
+                    if (size - offset < 4) return false;
+                    const size_t compressed = readBE(stream + offset, 4);
+                    offset += 4;
+                    if (size - offset < compressed) return false;
+                    const int decompressed =
+                          LZ4_decompress_safe(reinterpret_cast<const char*>(stream + offset),
+                                              reinterpret_cast<char*>(shuffled.data()), compressed, count * sizeof(T));
+                    if (decompressed != static_cast<int>(count * sizeof(T))) return false;
+                    offset += compressed;
+
+                    T* blockPixelsOut = pixels + block * blockPixels;
+                    for (size_t i = 0; i < count; ++i) {
+                        T pixel = 0;
+                        for (size_t b = 0; b < 8 * sizeof(T); ++b) {
+                            pixel |= T((shuffled[b * count / 8 + i / 8] >> (i % 8)) & 1) << b;
+                        }
+                        blockPixelsOut[i] = pixel;
+                    }
+                }
+
+                const size_t tail = n_pixels % 8;
+                if (size - offset != tail * sizeof(T)) return false;
+                std::memcpy(pixels + n_pixels - tail, stream + offset, tail * sizeof(T));
+                return true;
+            }
+
+        } // namespace
+
+
+        size_t bitshuffleBlocks(size_t n_pixels, size_t pixelBytes) {
+            const size_t blockPixels = bitshuffleBlockPixels(pixelBytes);
+            return (n_pixels / 8 * 8 + blockPixels - 1) / blockPixels;
+        }
+
+
+        size_t bitshuffleLz4SlotBytes(size_t pixelBytes) {
+            return 4 + LZ4_COMPRESSBOUND(bitshuffleBlockPixels(pixelBytes) * pixelBytes);
+        }
+
+
+        size_t bitshuffleLz4Bound(size_t n_pixels, size_t pixelBytes) {
+            return BITSHUFFLE_HEADER_BYTES +
+                   bitshuffleBlocks(n_pixels, pixelBytes) * bitshuffleLz4SlotBytes(pixelBytes) +
+                   (n_pixels % 8) * pixelBytes;
+        }
+
+
+        void compressBitshuffleLz4(const uint8_t* pixels, size_t n_pixels, size_t blockBegin, size_t blockEnd,
+                                   uint8_t* slots, size_t* blockSizes) {
+            compressBlocks(getBitshuffleKernels().pixels8, pixels, n_pixels, blockBegin, blockEnd, slots, blockSizes);
+        }
+
+
+        void compressBitshuffleLz4(const uint16_t* pixels, size_t n_pixels, size_t blockBegin, size_t blockEnd,
+                                   uint8_t* slots, size_t* blockSizes) {
+            compressBlocks(getBitshuffleKernels().pixels16, pixels, n_pixels, blockBegin, blockEnd, slots, blockSizes);
+        }
+
+
+        size_t packBitshuffleLz4(const uint8_t* pixels, size_t n_pixels, const size_t* blockSizes, uint8_t* stream) {
+            return packBlocks(pixels, n_pixels, blockSizes, stream);
+        }
+
+
+        size_t packBitshuffleLz4(const uint16_t* pixels, size_t n_pixels, const size_t* blockSizes, uint8_t* stream) {
+            return packBlocks(pixels, n_pixels, blockSizes, stream);
+        }
+
+
+        bool decompressBitshuffleLz4(const uint8_t* stream, size_t size, size_t n_pixels, uint8_t* pixels) {
+            return decompressBlocks(stream, size, n_pixels, pixels);
+        }
+
+
+        bool decompressBitshuffleLz4(const uint8_t* stream, size_t size, size_t n_pixels, uint16_t* pixels) {
+            return decompressBlocks(stream, size, n_pixels, pixels);
+        }
+
+    } // namespace kernels
+
+} // namespace karabo
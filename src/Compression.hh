@@ -0,0 +1,78 @@
+/*
+ * Author: <parenti>
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#ifndef KARABO_COMPRESSION_HH
+#define KARABO_COMPRESSION_HH
+
+#include <cstddef>
+#include <cstdint>
+
+namespace karabo {
+
+    namespace kernels {
+
+        /**
+         * Lossless compression in the format of the bitshuffle library with LZ4, as in the chunks of its HDF5 filter
+         * (ID 32008, compression option 2) and the DECTRIS 'bslz4' encoding, thus it can be decoded by standard tools:
+         *  - a 12-byte header: the uncompressed size in bytes (64-bit big-endian), then the block size in bytes
+         *    (32-bit big-endian);
+         *  - the blocks of BITSHUFFLE_BLOCK_BYTES, the last one holding the remaining pixels rounded down to a
+         *    multiple of 8: each one is bitshuffled, compressed with LZ4, and preceded by its compressed size
+         *    (32-bit big-endian);
+         *  - the n_pixels % 8 last pixels, as they are.
+         *
+         * The blocks can be compressed concurrently, each one into a slot of its own, then the slots are packed.
+         */
+        const unsigned int BITSHUFFLE_FILTER_ID = 32008;
+        const unsigned int BITSHUFFLE_LZ4 = 2;
+        const size_t BITSHUFFLE_HEADER_BYTES = 12;
+        const size_t BITSHUFFLE_BLOCK_BYTES = 8192; // The default of the library
+
+        inline size_t bitshuffleBlockPixels(size_t pixelBytes) {
+            return BITSHUFFLE_BLOCK_BYTES / pixelBytes;
+        }
+
+        // Number of compressed blocks of an image
+        size_t bitshuffleBlocks(size_t n_pixels, size_t pixelBytes);
+
+        // Size of the slot of a compressed block, the upper bound of its compressed size
+        size_t bitshuffleLz4SlotBytes(size_t pixelBytes);
+
+        // Size of the buffer holding the slots, then the packed stream
+        size_t bitshuffleLz4Bound(size_t n_pixels, size_t pixelBytes);
+
+        /**
+         * Compress the blocks [blockBegin, blockEnd) of an image, each one into its slot.
+         * @param slots The slots of all the blocks, starting after the header of the stream
+         * @param blockSizes The compressed sizes of the blocks, including their own header
+         */
+        void compressBitshuffleLz4(const uint8_t* pixels, size_t n_pixels, size_t blockBegin, size_t blockEnd,
+                                   uint8_t* slots, size_t* blockSizes);
+        void compressBitshuffleLz4(const uint16_t* pixels, size_t n_pixels, size_t blockBegin, size_t blockEnd,
+                                   uint8_t* slots, size_t* blockSizes);
+
+        /**
+         * Write the header, move the compressed blocks next to each other, and append the last pixels.
+         * @param stream Of bitshuffleLz4Bound bytes, holding the slots after the header
+         * @return The size of the compressed stream
+         */
+        size_t packBitshuffleLz4(const uint8_t* pixels, size_t n_pixels, const size_t* blockSizes, uint8_t* stream);
+        size_t packBitshuffleLz4(const uint16_t* pixels, size_t n_pixels, const size_t* blockSizes, uint8_t* stream);
+
+        /**
+         * Decompress a whole compressed stream, e.g. as a reference for consumers.
+         * @return false if the stream is corrupted, or does not hold n_pixels pixels
+         */
+        bool decompressBitshuffleLz4(const uint8_t* stream, size_t size, size_t n_pixels, uint8_t* pixels);
+        bool decompressBitshuffleLz4(const uint8_t* stream, size_t size, size_t n_pixels, uint16_t* pixels);
+
+    } // namespace kernels
+
+} // namespace karabo
+
+#endif
@@ -0,0 +1,438 @@
+/*
+ * Author: <parenti>
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#include "Demosaic.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KARABO_DEMOSAIC_X86
+#endif
+
+// The helpers are inlined in the kernels, which are compiled for several instruction sets.
+// Thus the ABI for passing vectors to functions does not matter, this file is compiled with -Wno-psabi.
+#define KARABO_DEMOSAIC_INLINE inline __attribute__((always_inline))
+
+namespace karabo {
+
+    namespace kernels {
+
+        namespace {
+
+            // The interpolation formulas are written once, for single pixels (int32_t) and for vectors of
+            // consecutive pixels. The vectors are compiled to the instruction set of the calling kernel.
+            typedef int32_t Vector4 __attribute__((vector_size(16)));
+            typedef int32_t Vector8 __attribute__((vector_size(32)));
+
+            template <class V>
+            constexpr int lanes = sizeof(V) / sizeof(int32_t);
+
+            template <class V>
+            concept IsVector = (lanes<V> > 1);
+
+            // Used to widen the pixels to 32 bits
+            typedef uint8_t Bytes __attribute__((vector_size(16)));
+            typedef uint16_t Words __attribute__((vector_size(16)));
+
+            constexpr int GainShift = 10; // White balance gains in fixed point
+
+
+            // Index of a neighbour, mirrored at the borders without repeating the border pixel:
+            // the mirrored pixel has the colour of the missing one.
+            KARABO_DEMOSAIC_INLINE int mirror(int i, int n) {
+                if (i < 0) i = -i;
+                if (i >= n) i = 2 * n - 2 - i;
+                return std::clamp(i, 0, n - 1); // Images smaller than the filter
+            }
+
+
+            template <class V>
+            KARABO_DEMOSAIC_INLINE V minimum(V a, V b) {
+                return a < b ? a : b;
+            }
+
+
+            template <class V>
+            KARABO_DEMOSAIC_INLINE V clip(V v, V maxValue) {
+                return minimum(v < V{} ? V{} : v, maxValue);
+            }
+
+
+            template <class V>
+            KARABO_DEMOSAIC_INLINE V absolute(V v) {
+                return v < V{} ? -v : v;
+            }
+
+
+            // The pixel x + dx of a row: one pixel, mirrored at the borders, or consecutive pixels
+            template <class T>
+            KARABO_DEMOSAIC_INLINE int32_t pixel(const T* row, int x, int dx, int width, int32_t) {
+                return row[mirror(x + dx, width)];
+            }
+
+            template <IsVector V>
+            KARABO_DEMOSAIC_INLINE V pixel(const uint8_t* row, int x, int dx, int, V) {
+                Bytes bytes = {};
+                std::memcpy(&bytes, row + x + dx, lanes<V>);
+                if constexpr (lanes<V> == 8) {
+                    const Bytes toWords = {0, 16, 1, 16, 2, 16, 3, 16, 4, 16, 5, 16, 6, 16, 7, 16};
+                    return __builtin_convertvector((Words)__builtin_shuffle(bytes, Bytes{}, toWords), V);
+                } else {
+                    const Bytes toInts = {0, 16, 16, 16, 1, 16, 16, 16, 2, 16, 16, 16, 3, 16, 16, 16};
+                    return (V)__builtin_shuffle(bytes, Bytes{}, toInts);
+                }
+            }
+
+            template <IsVector V>
+            KARABO_DEMOSAIC_INLINE V pixel(const uint16_t* row, int x, int dx, int, V) {
+                Words words = {};
+                std::memcpy(&words, row + x + dx, lanes<V> * sizeof(uint16_t));
+                if constexpr (lanes<V> == 8) {
+                    return __builtin_convertvector(words, V);
+                } else {
+                    const Words toInts = {0, 8, 1, 8, 2, 8, 3, 8};
+                    return (V)__builtin_shuffle(words, Words{}, toInts);
+                }
+            }
+
+            template <IsVector V>
+            KARABO_DEMOSAIC_INLINE V pixel(const int32_t* row, int x, int dx, int, V) {
+                V v;
+                std::memcpy(&v, row + x + dx, sizeof(v));
+                return v;
+            }
+
+
+            template <class T>
+            KARABO_DEMOSAIC_INLINE void store(T* rgb, int32_t r, int32_t g, int32_t b) {
+                rgb[0] = r;
+                rgb[1] = g;
+                rgb[2] = b;
+            }
+
+            template <class T, IsVector V>
+            KARABO_DEMOSAIC_INLINE void store(T* rgb, V r, V g, V b) {
+                for (int i = 0; i < lanes<V>; ++i) {
+                    rgb[3 * i] = r[i];
+                    rgb[3 * i + 1] = g[i];
+                    rgb[3 * i + 2] = b[i];
+                }
+            }
+
+            KARABO_DEMOSAIC_INLINE void store(int32_t* green, int32_t g) {
+                *green = g;
+            }
+
+            template <IsVector V>
+            KARABO_DEMOSAIC_INLINE void store(int32_t* green, V g) {
+                std::memcpy(green, &g, sizeof(g));
+            }
+
+
+            struct Balance {
+                int32_t red;
+                int32_t green;
+                int32_t blue;
+                int32_t maxValue;
+            };
+
+
+            template <class V>
+            KARABO_DEMOSAIC_INLINE V applyGain(V v, int32_t gain, int32_t maxValue) {
+                return minimum((v * gain + (1 << (GainShift - 1))) >> GainShift, V{} + maxValue);
+            }
+
+
+            // Rows around the one being interpolated, mirrored at the top and bottom borders
+            template <class T>
+            struct Rows {
+                const T* up2;
+                const T* up;
+                const T* row;
+                const T* down;
+                const T* down2;
+
+                Rows(const T* mosaic, int width, int height, int y)
+                    : up2(mosaic + size_t(mirror(y - 2, height)) * width),
+                      up(mosaic + size_t(mirror(y - 1, height)) * width),
+                      row(mosaic + size_t(y) * width),
+                      down(mosaic + size_t(mirror(y + 1, height)) * width),
+                      down2(mosaic + size_t(mirror(y + 2, height)) * width) {}
+            };
+
+
+            // Bilinear interpolation at one pixel (V = int32_t) or a vector of pixels.
+            // site: the pixel is red or blue. redRow: the row contains red pixels, otherwise blue ones.
+            template <class V, class T, class M>
+            KARABO_DEMOSAIC_INLINE void bilinear(const Rows<T>& rows, int x, int width, M site, bool redRow,
+                                                 const Balance& balance, T* rgb) {
+                const V c = pixel(rows.row, x, 0, width, V{});
+                const V w = pixel(rows.row, x, -1, width, V{});
+                const V e = pixel(rows.row, x, 1, width, V{});
+                const V n = pixel(rows.up, x, 0, width, V{});
+                const V s = pixel(rows.down, x, 0, width, V{});
+                const V diagonal = (pixel(rows.up, x, -1, width, V{}) + pixel(rows.up, x, 1, width, V{}) +
+                                    pixel(rows.down, x, -1, width, V{}) + pixel(rows.down, x, 1, width, V{}) + 2) >>
+                                   2;
+                const V cross = (w + e + n + s + 2) >> 2;
+                const V horizontal = (w + e + 1) >> 1;
+                const V vertical = (n + s + 1) >> 1;
+
+                // The colour of the row (red or blue) and the other one
+                const V rowColour = site ? c : horizontal;
+                const V otherColour = site ? diagonal : vertical;
+                const V g = site ? cross : c;
+                const V r = redRow ? rowColour : otherColour;
+                const V b = redRow ? otherColour : rowColour;
+
+                store(rgb, applyGain(r, balance.red, balance.maxValue), applyGain(g, balance.green, balance.maxValue),
+                      applyGain(b, balance.blue, balance.maxValue));
+            }
+
+
+            // Green at red and blue pixels, interpolated along the direction with the smallest gradient, and
+            // corrected with the curvature of the pixel colour (Hamilton-Adams)
+            template <class V, class T, class M>
+            KARABO_DEMOSAIC_INLINE void edgeAwareGreen(const Rows<T>& rows, int x, int width, M site,
+                                                       int32_t maxValue, int32_t* green) {
+                const V c = pixel(rows.row, x, 0, width, V{});
+                const V w = pixel(rows.row, x, -1, width, V{});
+                const V e = pixel(rows.row, x, 1, width, V{});
+                const V n = pixel(rows.up, x, 0, width, V{});
+                const V s = pixel(rows.down, x, 0, width, V{});
+                const V curvatureH = 2 * c - pixel(rows.row, x, -2, width, V{}) - pixel(rows.row, x, 2, width, V{});
+                const V curvatureV = 2 * c - pixel(rows.up2, x, 0, width, V{}) - pixel(rows.down2, x, 0, width, V{});
+
+                const V gradientH = absolute(w - e) + absolute(curvatureH);
+                const V gradientV = absolute(n - s) + absolute(curvatureV);
+                const V greenH = (2 * (w + e) + curvatureH + 2) >> 2;
+                const V greenV = (2 * (n + s) + curvatureV + 2) >> 2;
+                const V greenHV = (2 * (w + e + n + s) + curvatureH + curvatureV + 4) >> 3;
+
+                const V interpolated =
+                      clip(gradientH < gradientV ? greenH : (gradientV < gradientH ? greenV : greenHV), V{} + maxValue);
+                store(green, site ? interpolated : c);
+            }
+
+
+            // Red and blue from the colour differences to the green interpolated by edgeAwareGreen
+            template <class V, class T, class M>
+            KARABO_DEMOSAIC_INLINE void edgeAwareColours(const Rows<T>& rows, const int32_t* const greens[3], int x,
+                                                         int width, M site, bool redRow, const Balance& balance,
+                                                         T* rgb) {
+                const int32_t* greenUp = greens[0];
+                const int32_t* green = greens[1];
+                const int32_t* greenDown = greens[2];
+
+                const V c = pixel(rows.row, x, 0, width, V{});
+                const V g = pixel(green, x, 0, width, V{});
+                const V differenceW = pixel(rows.row, x, -1, width, V{}) - pixel(green, x, -1, width, V{});
+                const V differenceE = pixel(rows.row, x, 1, width, V{}) - pixel(green, x, 1, width, V{});
+                const V differenceN = pixel(rows.up, x, 0, width, V{}) - pixel(greenUp, x, 0, width, V{});
+                const V differenceS = pixel(rows.down, x, 0, width, V{}) - pixel(greenDown, x, 0, width, V{});
+                const V differenceDiagonal =
+                      pixel(rows.up, x, -1, width, V{}) - pixel(greenUp, x, -1, width, V{}) +
+                      pixel(rows.up, x, 1, width, V{}) - pixel(greenUp, x, 1, width, V{}) +
+                      pixel(rows.down, x, -1, width, V{}) - pixel(greenDown, x, -1, width, V{}) +
+                      pixel(rows.down, x, 1, width, V{}) - pixel(greenDown, x, 1, width, V{});
+
+                const V maxValue = V{} + balance.maxValue;
+                // At red and blue pixels the other colour is at the diagonals. At green pixels the colour of the
+                // row is at the left and right, the other one above and below.
+                const V rowColour = site ? c : clip(g + ((differenceW + differenceE + 1) >> 1), maxValue);
+                const V otherColour = clip(site ? g + ((differenceDiagonal + 2) >> 2)
+                                                : g + ((differenceN + differenceS + 1) >> 1),
+                                           maxValue);
+                const V r = redRow ? rowColour : otherColour;
+                const V b = redRow ? otherColour : rowColour;
+
+                store(rgb, applyGain(r, balance.red, balance.maxValue),
+                      applyGain(g, balance.green, balance.maxValue), applyGain(b, balance.blue, balance.maxValue));
+            }
+
+
+            // Call scalar(x, site) for single pixels at the borders, and vectors(x, site) for vectors of V pixels
+            // in between, unless V is int32_t. Vectors start at even pixels, so that the colour of each lane is
+            // the same for all of them.
+            template <class V, class Scalar, class Vectors>
+            KARABO_DEMOSAIC_INLINE void forEachPixel(int width, int siteX, const Scalar& scalar,
+                                                     const Vectors& vectors) {
+                constexpr int Border = 2; // Radius of the largest filter
+                int x = 0;
+                if constexpr (IsVector<V>) {
+                    for (; x < std::min(Border, width); ++x) {
+                        scalar(x, (x & 1) == siteX);
+                    }
+                    V parity;
+                    for (int i = 0; i < lanes<V>; ++i) {
+                        parity[i] = i & 1;
+                    }
+                    const V site = parity == (V{} + siteX);
+                    for (; x + lanes<V> + Border <= width; x += lanes<V>) {
+                        vectors(x, site);
+                    }
+                }
+                for (; x < width; ++x) {
+                    scalar(x, (x & 1) == siteX);
+                }
+            }
+
+
+            template <class T, class V>
+            KARABO_DEMOSAIC_INLINE void demosaicRows(const T* mosaic, int width, int height,
+                                                     const DemosaicParameters& parameters, int rowBegin, int rowEnd,
+                                                     T* rgb) {
+                const int redX = (parameters.pattern == BayerPattern::GRBG || parameters.pattern == BayerPattern::BGGR);
+                const int redY = (parameters.pattern == BayerPattern::GBRG || parameters.pattern == BayerPattern::BGGR);
+                const auto fixedPoint = [](float gain) {
+                    return static_cast<int32_t>(std::lround(std::clamp(gain, 0.f, 15.f) * (1 << GainShift)));
+                };
+                const Balance balance = {fixedPoint(parameters.redGain), fixedPoint(parameters.greenGain),
+                                         fixedPoint(parameters.blueGain), static_cast<int32_t>(parameters.maxValue)};
+
+                // The red and blue pixels of a row are at the columns of parity siteX
+                const auto isRedRow = [redY](int y) { return (y & 1) == redY; };
+                const auto siteX = [redX](bool redRow) { return redRow ? redX : 1 - redX; };
+
+                if (parameters.method == DemosaicMethod::BILINEAR) {
+                    for (int y = rowBegin; y < rowEnd; ++y) {
+                        const Rows<T> rows(mosaic, width, height, y);
+                        const bool redRow = isRedRow(y);
+                        T* rgbRow = rgb + 3 * size_t(y) * width;
+                        forEachPixel<V>(
+                              width, siteX(redRow),
+                              [&](int x, bool site) __attribute__((always_inline)) {
+                                  bilinear<int32_t>(rows, x, width, site, redRow, balance, rgbRow + 3 * x);
+                              },
+                              [&](int x, auto site) __attribute__((always_inline)) {
+                                  bilinear<V>(rows, x, width, site, redRow, balance, rgbRow + 3 * x);
+                              });
+                    }
+                    return;
+                }
+
+                // Edge-aware: the green of the rows above and below is needed too, it is kept in a ring of rows
+                std::vector<int32_t> greenRows(3 * size_t(width));
+                int32_t* greens[3] = {greenRows.data(), greenRows.data() + width, greenRows.data() + 2 * width};
+                const auto interpolateGreen = [&](int y, int32_t* green) __attribute__((always_inline)) {
+                    y = mirror(y, height);
+                    const Rows<T> rows(mosaic, width, height, y);
+                    forEachPixel<V>(
+                          width, siteX(isRedRow(y)),
+                          [&](int x, bool site) __attribute__((always_inline)) {
+                              edgeAwareGreen<int32_t>(rows, x, width, site, balance.maxValue, green + x);
+                          },
+                          [&](int x, auto site) __attribute__((always_inline)) {
+                              edgeAwareGreen<V>(rows, x, width, site, balance.maxValue, green + x);
+                          });
+                };
+
+                interpolateGreen(rowBegin - 1, greens[0]);
+                interpolateGreen(rowBegin, greens[1]);
+                for (int y = rowBegin; y < rowEnd; ++y) {
+                    interpolateGreen(y + 1, greens[2]);
+
+                    const Rows<T> rows(mosaic, width, height, y);
+                    const bool redRow = isRedRow(y);
+                    T* rgbRow = rgb + 3 * size_t(y) * width;
+                    const int32_t* const rowGreens[3] = {greens[0], greens[1], greens[2]};
+                    forEachPixel<V>(
+                          width, siteX(redRow),
+                          [&](int x, bool site) __attribute__((always_inline)) {
+                              edgeAwareColours<int32_t>(rows, rowGreens, x, width, site, redRow, balance,
+                                                        rgbRow + 3 * x);
+                          },
+                          [&](int x, auto site) __attribute__((always_inline)) {
+                              edgeAwareColours<V>(rows, rowGreens, x, width, site, redRow, balance,
+                                                       rgbRow + 3 * x);
+                          });
+
+                    std::rotate(greens, greens + 1, greens + 3);
+                }
+            }
+
+
+            // Scalar kernels: reference implementation
+
+            void demosaic8Scalar(const uint8_t* mosaic, int width, int height, const DemosaicParameters& parameters,
+                                 int rowBegin, int rowEnd, uint8_t* rgb) {
+                demosaicRows<uint8_t, int32_t>(mosaic, width, height, parameters, rowBegin, rowEnd, rgb);
+            }
+
+            void demosaic16Scalar(const uint16_t* mosaic, int width, int height,
+                                  const DemosaicParameters& parameters, int rowBegin, int rowEnd, uint16_t* rgb) {
+                demosaicRows<uint16_t, int32_t>(mosaic, width, height, parameters, rowBegin, rowEnd, rgb);
+            }
+
+            const DemosaicKernels scalarKernels = {demosaic8Scalar, demosaic16Scalar};
+
+#ifdef KARABO_DEMOSAIC_X86
+
+            __attribute__((target("sse4.1"))) void demosaic8Sse41(const uint8_t* mosaic, int width, int height,
+                                                                  const DemosaicParameters& parameters, int rowBegin,
+                                                                  int rowEnd, uint8_t* rgb) {
+                demosaicRows<uint8_t, Vector4>(mosaic, width, height, parameters, rowBegin, rowEnd, rgb);
+            }
+
+            __attribute__((target("sse4.1"))) void demosaic16Sse41(const uint16_t* mosaic, int width, int height,
+                                                                   const DemosaicParameters& parameters, int rowBegin,
+                                                                   int rowEnd, uint16_t* rgb) {
+                demosaicRows<uint16_t, Vector4>(mosaic, width, height, parameters, rowBegin, rowEnd, rgb);
+            }
+
+            __attribute__((target("avx2"))) void demosaic8Avx2(const uint8_t* mosaic, int width, int height,
+                                                               const DemosaicParameters& parameters, int rowBegin,
+                                                               int rowEnd, uint8_t* rgb) {
+                demosaicRows<uint8_t, Vector8>(mosaic, width, height, parameters, rowBegin, rowEnd, rgb);
+            }
+
+            __attribute__((target("avx2"))) void demosaic16Avx2(const uint16_t* mosaic, int width, int height,
+                                                                const DemosaicParameters& parameters, int rowBegin,
+                                                                int rowEnd, uint16_t* rgb) {
+                demosaicRows<uint16_t, Vector8>(mosaic, width, height, parameters, rowBegin, rowEnd, rgb);
+            }
+
+            const DemosaicKernels sse41Kernels = {demosaic8Sse41, demosaic16Sse41};
+            // The pixels are widened to 32 bits, a vector of 8 of them fits in an AVX2 register.
+            // AVX-512 would not bring more.
+            const DemosaicKernels avx2Kernels = {demosaic8Avx2, demosaic16Avx2};
+
+#endif
+
+        } // namespace
+
+
+        const DemosaicKernels& getDemosaicKernels(SimdLevel level) {
+#ifdef KARABO_DEMOSAIC_X86
+            switch (level) {
+                case SimdLevel::AVX512BW:
+                case SimdLevel::AVX2:
+                    return avx2Kernels;
+                case SimdLevel::SSE41:
+                    return sse41Kernels;
+                default:
+                    break;
+            }
+#endif
+            return scalarKernels;
+        }
+
+
+        const DemosaicKernels& getDemosaicKernels() {
+            // Thread-safe initialization, done once
+            static const DemosaicKernels& kernels = getDemosaicKernels(detectSimdLevel());
+            return kernels;
+        }
+
+    } // namespace kernels
+
+} // namespace karabo
@@ -0,0 +1,76 @@
+/*
+ * Author: <parenti>
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#ifndef KARABO_DEMOSAIC_HH
+#define KARABO_DEMOSAIC_HH
+
+#include <cstdint>
+
+#include "ImageKernels.hh"
+
+namespace karabo {
+
+    namespace kernels {
+
+        // Colours of the 2x2 pixels at the top-left corner of the mosaic, row by row
+        enum class BayerPattern { RGGB, GRBG, GBRG, BGGR };
+
+        enum class DemosaicMethod {
+            BILINEAR,  // Average of the nearest pixels of the missing colours
+            EDGE_AWARE // Green interpolated along the edges, red and blue from the colour differences
+        };
+
+        struct DemosaicParameters {
+            BayerPattern pattern;
+            DemosaicMethod method;
+            // White balance, in the range [0, 15]
+            float redGain;
+            float greenGain;
+            float blueGain;
+            unsigned int maxValue; // The output is clipped to this value, e.g. 4095 for 12-bit pixels
+        };
+
+        // Interpolate the rows [rowBegin, rowEnd) of an RGB image, with interleaved channels, from a Bayer mosaic.
+        // Each row only depends on the mosaic, thus stripes of rows can be computed in parallel.
+        typedef void (*Demosaic8Function)(const uint8_t* mosaic, int width, int height,
+                                          const DemosaicParameters& parameters, int rowBegin, int rowEnd,
+                                          uint8_t* rgb);
+        typedef void (*Demosaic16Function)(const uint16_t* mosaic, int width, int height,
+                                           const DemosaicParameters& parameters, int rowBegin, int rowEnd,
+                                           uint16_t* rgb);
+
+        struct DemosaicKernels {
+            Demosaic8Function rgb8;
+            Demosaic16Function rgb16;
+        };
+
+        /**
+         * The kernels for a given instruction set. The caller has to verify that the CPU supports it.
+         */
+        const DemosaicKernels& getDemosaicKernels(SimdLevel level);
+
+        /**
+         * The kernels for the best instruction set available, selected on first call.
+         */
+        const DemosaicKernels& getDemosaicKernels();
+
+        inline void demosaic(const uint8_t* mosaic, int width, int height, const DemosaicParameters& parameters,
+                             int rowBegin, int rowEnd, uint8_t* rgb) {
+            getDemosaicKernels().rgb8(mosaic, width, height, parameters, rowBegin, rowEnd, rgb);
+        }
+
+        inline void demosaic(const uint16_t* mosaic, int width, int height, const DemosaicParameters& parameters,
+                             int rowBegin, int rowEnd, uint16_t* rgb) {
+            getDemosaicKernels().rgb16(mosaic, width, height, parameters, rowBegin, rowEnd, rgb);
+        }
+
+    } // namespace kernels
+
+} // namespace karabo
+
+#endif
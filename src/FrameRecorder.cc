@@ -0,0 +1,169 @@
+/*
+ * Author: <parenti>
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#include "FrameRecorder.hh"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace karabo {
+
+    namespace {
+
+        std::runtime_error file_error(const std::string& what, const std::string& path, int error) {
+            return std::runtime_error("Could not " + what + " '" + path + "': " + std::strerror(error));
+        }
+
+
+        void write_all(int fd, const void* data, size_t size, uint64_t offset, const std::string& path) {
+            const char* bytes = static_cast<const char*>(data);
+            while (size > 0) {
+                const ssize_t written = ::pwrite(fd, bytes, size, offset);
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    throw file_error("write", path, errno);
+                }
+                bytes += written;
+                size -= written;
+                offset += written;
+            }
+        }
+
+    } // namespace
+
+
+    FrameRecorder::FrameRecorder(const std::string& directory, size_t chunkBytes)
+        : m_directory(directory),
+          m_chunkBytes(chunkBytes),
+          m_chunk(0),
+          m_dataFd(-1),
+          m_indexFd(-1),
+          m_dataOffset(0),
+          m_indexOffset(0),
+          m_direct(false),
+          m_staging(nullptr),
+          m_stagingSize(0) {
+        std::filesystem::create_directories(m_directory);
+    }
+
+
+    FrameRecorder::~FrameRecorder() {
+        this->close_chunk();
+        std::free(m_staging);
+    }
+
+
+    void FrameRecorder::write(const void* data, size_t size, const IndexEntry& entry, const std::string& layout) {
+        // O_DIRECT needs aligned offsets, sizes and memory
+        const size_t padded = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        if (m_dataFd < 0 || layout != m_layout || (m_dataOffset > 0 && m_dataOffset + padded > m_chunkBytes)) {
+            this->open_chunk(layout);
+        }
+
+        // Aligned images are written from where they are, only the last partial block is copied and padded
+        const char* bytes = static_cast<const char*>(data);
+        const size_t direct = (reinterpret_cast<uintptr_t>(data) % ALIGNMENT == 0) ? size / ALIGNMENT * ALIGNMENT : 0;
+        if (direct > 0) {
+            write_all(m_dataFd, bytes, direct, m_dataOffset, m_path + ".dat");
+        }
+
+        const size_t staged = padded - direct;
+        if (staged > m_stagingSize) {
+            std::free(m_staging);
+            m_staging = nullptr;
+            m_stagingSize = 0;
+            if (posix_memalign(&m_staging, ALIGNMENT, staged) != 0) {
+                throw std::runtime_error("Could not allocate the recording buffer");
+            }
+            m_stagingSize = staged;
+        }
+        if (staged > 0) {
+            std::memcpy(m_staging, bytes + direct, size - direct);
+            std::memset(static_cast<char*>(m_staging) + size - direct, 0, staged - (size - direct));
+            write_all(m_dataFd, m_staging, staged, m_dataOffset + direct, m_path + ".dat");
+        }
+
+        // The index entry is written once the image is, thus a truncated recording stays consistent
+        IndexEntry indexEntry = entry;
+        indexEntry.offset = m_dataOffset;
+        indexEntry.size = size;
+        write_all(m_indexFd, &indexEntry, sizeof(indexEntry), m_indexOffset, m_path + ".idx");
+
+        m_dataOffset += padded;
+        m_indexOffset += sizeof(indexEntry);
+    }
+
+
+    std::shared_ptr<char> FrameRecorder::allocate(size_t size) {
+        void* data = nullptr;
+        if (posix_memalign(&data, ALIGNMENT, std::max<size_t>(size, 1)) != 0) {
+            throw std::runtime_error("Could not allocate the recording buffer");
+        }
+        return std::shared_ptr<char>(static_cast<char*>(data), std::free);
+    }
+
+
+    void FrameRecorder::open_chunk(const std::string& layout) {
+        this->close_chunk();
+
+        // The chunk names are not re-used, even if this one cannot be opened
+        char name[32];
+        std::snprintf(name, sizeof(name), "chunk_%05u", m_chunk++);
+        const std::string path = m_directory + "/" + name;
+
+        std::ofstream layoutFile(path + ".txt");
+        layoutFile << layout;
+        if (!layoutFile) {
+            throw file_error("write", path + ".txt", errno);
+        }
+
+        const int flags = O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC;
+        m_dataFd = ::open((path + ".dat").c_str(), flags | O_DIRECT, 0644);
+        m_direct = (m_dataFd >= 0);
+        if (m_dataFd < 0 && errno == EINVAL) {
+            // Not supported by the file system, e.g. tmpfs
+            m_dataFd = ::open((path + ".dat").c_str(), flags, 0644);
+        }
+        if (m_dataFd < 0) {
+            throw file_error("create", path + ".dat", errno);
+        }
+        m_indexFd = ::open((path + ".idx").c_str(), flags, 0644);
+        if (m_indexFd < 0) {
+            const int error = errno;
+            this->close_chunk();
+            throw file_error("create", path + ".idx", error);
+        }
+
+        m_path = path;
+        m_layout = layout;
+        m_dataOffset = 0;
+        m_indexOffset = 0;
+    }
+
+
+    void FrameRecorder::close_chunk() {
+        if (m_dataFd >= 0) {
+            ::close(m_dataFd);
+            m_dataFd = -1;
+        }
+        if (m_indexFd >= 0) {
+            ::close(m_indexFd);
+            m_indexFd = -1;
+        }
+    }
+
+} // namespace karabo
@@ -0,0 +1,104 @@
+/*
+ * Author: <parenti>
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#ifndef KARABO_FRAMERECORDER_HH
+#define KARABO_FRAMERECORDER_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace karabo {
+
+    /**
+     * Append-only recording of images to a local disk, for bursts which the output channels cannot sustain.
+     *
+     * A recording is a directory of chunks, chunk n being made of three files:
+     *  - chunk_<n>.dat: the images, each one starting at a multiple of ALIGNMENT bytes, padded with zeros;
+     *  - chunk_<n>.idx: one IndexEntry per image, in native byte order;
+     *  - chunk_<n>.txt: the layout of the images, e.g. shape and pixel type, as given by the caller.
+     * A new chunk is started when the data file is full, or when the image layout changes.
+     *
+     * The data files are written with O_DIRECT, if the file system supports it, thus a long recording does not
+     * evict the rest of the page cache. The class is not thread-safe: it is meant to be used by one writing thread.
+     */
+    class FrameRecorder {
+       public:
+        static constexpr size_t ALIGNMENT = 4096;
+
+        struct IndexEntry {
+            uint64_t frameId;
+            uint64_t trainId;
+            uint64_t seconds;  // Since the epoch
+            uint64_t fraction; // Fractional seconds, in attoseconds
+            uint64_t offset;   // In the data file
+            uint64_t size;     // Image size, without padding
+        };
+
+        /**
+         * @param directory Created if needed, it must not hold another recording
+         * @param chunkBytes Maximum size of a data file, though a chunk holds at least one image
+         */
+        FrameRecorder(const std::string& directory, size_t chunkBytes);
+
+        /**
+         * The files are closed.
+         */
+        ~FrameRecorder();
+
+        FrameRecorder(const FrameRecorder&) = delete;
+        FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+        /**
+         * Append an image. Throws std::runtime_error if it cannot be written.
+         * @param entry The identification of the image, its offset and size are set by the recorder
+         * @param layout The description of the image, written to the layout file of a new chunk
+         */
+        void write(const void* data, size_t size, const IndexEntry& entry, const std::string& layout);
+
+        /**
+         * Memory aligned to ALIGNMENT: images in it are written without being copied to the staging buffer first,
+         * except for their last, partial, block.
+         */
+        static std::shared_ptr<char> allocate(size_t size);
+
+        const std::string& directory() const {
+            return m_directory;
+        }
+
+        // The data files are written bypassing the page cache
+        bool isDirect() const {
+            return m_direct;
+        }
+
+        unsigned int chunks() const {
+            return m_chunk;
+        }
+
+       private:
+        void open_chunk(const std::string& layout);
+        void close_chunk();
+
+        const std::string m_directory;
+        const size_t m_chunkBytes;
+        unsigned int m_chunk; // Number of chunks started
+        std::string m_path;   // Of the current chunk, without extension
+        std::string m_layout; // Of the current chunk
+        int m_dataFd;         // -1 if no chunk is open
+        int m_indexFd;
+        uint64_t m_dataOffset;
+        uint64_t m_indexOffset;
+        bool m_direct;
+        void* m_staging; // Aligned copy of the image, or of its last block, as needed by O_DIRECT
+        size_t m_stagingSize;
+    };
+
+} // namespace karabo
+
+#endif
@@ -0,0 +1,1966 @@
+/*
+ * Author: <parenti>
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#include "ImageKernels.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <image_source/CameraImageSource.hh>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KARABO_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace karabo {
+
+    namespace kernels {
+
+        // Scalar kernels: reference implementation, also used for the pixels left over by the SIMD kernels
+
+        static void unpackMono12PackedScalar(const uint8_t* data, size_t n_pixels, uint16_t* unpacked) {
+            size_t i = 0;
+            for (; i + 1 < n_pixels; i += 2, data += 3) {
+                unpacked[i] = (data[0] << 4) | (data[1] & 0xF);
+                unpacked[i + 1] = (data[2] << 4) | (data[1] >> 4);
+            }
+            if (i < n_pixels) {
+                unpacked[i] = (data[0] << 4) | (data[1] & 0xF);
+            }
+        }
+
+
+        static void unpackMono12pScalar(const uint8_t* data, size_t n_pixels, uint16_t* unpacked) {
+            size_t i = 0;
+            for (; i + 1 < n_pixels; i += 2, data += 3) {
+                unpacked[i] = data[0] | ((data[1] & 0xF) << 8);
+                unpacked[i + 1] = (data[1] >> 4) | (data[2] << 4);
+            }
+            if (i < n_pixels) {
+                unpacked[i] = data[0] | ((data[1] & 0xF) << 8);
+            }
+        }
+
+
+        static void unpackMono10pScalar(const uint8_t* data, size_t n_pixels, uint16_t* unpacked) {
+            size_t i = 0;
+            for (; i + 3 < n_pixels; i += 4, data += 5) {
+                unpacked[i] = data[0] | ((data[1] & 0x3) << 8);
+                unpacked[i + 1] = (data[1] >> 2) | ((data[2] & 0xF) << 6);
+                unpacked[i + 2] = (data[2] >> 4) | ((data[3] & 0x3F) << 4);
+                unpacked[i + 3] = (data[3] >> 6) | (data[4] << 2);
+            }
+            // Up to 3 pixels left, each of them spans two bytes
+            for (size_t k = 0; i < n_pixels; ++i, ++k) {
+                const size_t bit = 10 * k;
+                const unsigned int value = data[bit / 8] | (data[bit / 8 + 1] << 8);
+                unpacked[i] = (value >> (bit % 8)) & 0x3FF;
+            }
+        }
+
+        static const UnpackKernels scalarKernels = {unpackMono12PackedScalar, unpackMono12pScalar,
+                                                    unpackMono10pScalar};
+
+#ifdef KARABO_KERNELS_X86
+
+        // All the SIMD kernels shuffle the packed bytes such that each 16-bit lane holds the two bytes
+        // containing one pixel. Then the pixel is aligned and masked in a few integer operations.
+        // Loads are at most 16 bytes per 128-bit lane, thus the main loops stop early enough not to read
+        // past the end of the input, and the scalar kernels take care of the remaining pixels.
+
+        // Mono12Packed: pixel 2k from bytes (3k+1, 3k), pixel 2k+1 from bytes (3k+1, 3k+2)
+        alignas(16) static const int8_t shuffle12Packed[16] = {1, 0, 1, 2, 4, 3, 4, 5, 7, 6, 7, 8, 10, 9, 10, 11};
+        // Mono12p: pixel 2k from bytes (3k, 3k+1), pixel 2k+1 from bytes (3k+1, 3k+2)
+        alignas(16) static const int8_t shuffle12p[16] = {0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11};
+        // Mono10p: pixel 4g+i from bytes (5g+i, 5g+i+1), starting at bit 2i
+        alignas(16) static const int8_t shuffle10p[16] = {0, 1, 1, 2, 2, 3, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9};
+        // Multiplying by 2^(6-2i) moves the pixel to the upper 10 bits, where a shift by 6 extracts it
+        alignas(16) static const int16_t multiply10p[8] = {64, 16, 4, 1, 64, 16, 4, 1};
+
+
+        __attribute__((target("sse4.1"))) static void unpackMono12PackedSse41(const uint8_t* data, size_t n_pixels,
+                                                                              uint16_t* unpacked) {
+            const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(shuffle12Packed));
+            const __m128i maskHigh = _mm_set1_epi16(0x0FF0);
+            const __m128i maskLow = _mm_set1_epi16(0x000F);
+            const size_t n_bytes = (3 * n_pixels + 1) / 2;
+
+            size_t i = 0;
+            for (; 3 * i / 2 + 16 <= n_bytes; i += 8) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 3 * i / 2));
+                const __m128i v = _mm_shuffle_epi8(in, shuffle);
+                const __m128i odd = _mm_srli_epi16(v, 4);
+                const __m128i even = _mm_or_si128(_mm_and_si128(odd, maskHigh), _mm_and_si128(v, maskLow));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(unpacked + i), _mm_blend_epi16(even, odd, 0xAA));
+            }
+            unpackMono12PackedScalar(data + 3 * i / 2, n_pixels - i, unpacked + i);
+        }
+
+
+        __attribute__((target("sse4.1"))) static void unpackMono12pSse41(const uint8_t* data, size_t n_pixels,
+                                                                         uint16_t* unpacked) {
+            const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(shuffle12p));
+            const __m128i mask = _mm_set1_epi16(0x0FFF);
+            const size_t n_bytes = (3 * n_pixels + 1) / 2;
+
+            size_t i = 0;
+            for (; 3 * i / 2 + 16 <= n_bytes; i += 8) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 3 * i / 2));
+                const __m128i v = _mm_shuffle_epi8(in, shuffle);
+                const __m128i even = _mm_and_si128(v, mask);
+                const __m128i odd = _mm_srli_epi16(v, 4);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(unpacked + i), _mm_blend_epi16(even, odd, 0xAA));
+            }
+            unpackMono12pScalar(data + 3 * i / 2, n_pixels - i, unpacked + i);
+        }
+
+
+        __attribute__((target("sse4.1"))) static void unpackMono10pSse41(const uint8_t* data, size_t n_pixels,
+                                                                         uint16_t* unpacked) {
+            const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(shuffle10p));
+            const __m128i multiply = _mm_load_si128(reinterpret_cast<const __m128i*>(multiply10p));
+            const size_t n_bytes = (10 * n_pixels + 7) / 8;
+
+            size_t i = 0;
+            for (; 5 * i / 4 + 16 <= n_bytes; i += 8) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 5 * i / 4));
+                const __m128i v = _mm_shuffle_epi8(in, shuffle);
+                const __m128i out = _mm_srli_epi16(_mm_mullo_epi16(v, multiply), 6);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(unpacked + i), out);
+            }
+            unpackMono10pScalar(data + 5 * i / 4, n_pixels - i, unpacked + i);
+        }
+
+
+        // Load two 128-bit lanes from data and data + offset
+        __attribute__((target("avx2"))) static inline __m256i load2x128(const uint8_t* data, size_t offset) {
+            const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+            return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        }
+
+
+        __attribute__((target("avx2"))) static void unpackMono12PackedAvx2(const uint8_t* data, size_t n_pixels,
+                                                                           uint16_t* unpacked) {
+            const __m256i shuffle =
+                  _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(shuffle12Packed)));
+            const __m256i maskHigh = _mm256_set1_epi16(0x0FF0);
+            const __m256i maskLow = _mm256_set1_epi16(0x000F);
+            const size_t n_bytes = (3 * n_pixels + 1) / 2;
+
+            size_t i = 0;
+            for (; 3 * i / 2 + 28 <= n_bytes; i += 16) {
+                const __m256i v = _mm256_shuffle_epi8(load2x128(data + 3 * i / 2, 12), shuffle);
+                const __m256i odd = _mm256_srli_epi16(v, 4);
+                const __m256i even =
+                      _mm256_or_si256(_mm256_and_si256(odd, maskHigh), _mm256_and_si256(v, maskLow));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(unpacked + i), _mm256_blend_epi16(even, odd, 0xAA));
+            }
+            unpackMono12PackedSse41(data + 3 * i / 2, n_pixels - i, unpacked + i);
+        }
+
+
+        __attribute__((target("avx2"))) static void unpackMono12pAvx2(const uint8_t* data, size_t n_pixels,
+                                                                      uint16_t* unpacked) {
+            const __m256i shuffle =
+                  _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(shuffle12p)));
+            const __m256i mask = _mm256_set1_epi16(0x0FFF);
+            const size_t n_bytes = (3 * n_pixels + 1) / 2;
+
+            size_t i = 0;
+            for (; 3 * i / 2 + 28 <= n_bytes; i += 16) {
+                const __m256i v = _mm256_shuffle_epi8(load2x128(data + 3 * i / 2, 12), shuffle);
+                const __m256i even = _mm256_and_si256(v, mask);
+                const __m256i odd = _mm256_srli_epi16(v, 4);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(unpacked + i), _mm256_blend_epi16(even, odd, 0xAA));
+            }
+            unpackMono12pSse41(data + 3 * i / 2, n_pixels - i, unpacked + i);
+        }
+
+
+        __attribute__((target("avx2"))) static void unpackMono10pAvx2(const uint8_t* data, size_t n_pixels,
+                                                                      uint16_t* unpacked) {
+            const __m256i shuffle =
+                  _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(shuffle10p)));
+            const __m256i multiply =
+                  _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(multiply10p)));
+            const size_t n_bytes = (10 * n_pixels + 7) / 8;
+
+            size_t i = 0;
+            for (; 5 * i / 4 + 26 <= n_bytes; i += 16) {
+                const __m256i v = _mm256_shuffle_epi8(load2x128(data + 5 * i / 4, 10), shuffle);
+                const __m256i out = _mm256_srli_epi16(_mm256_mullo_epi16(v, multiply), 6);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(unpacked + i), out);
+            }
+            unpackMono10pSse41(data + 5 * i / 4, n_pixels - i, unpacked + i);
+        }
+
+
+        // Broadcast a 128-bit pattern to the four lanes
+        __attribute__((target("avx512f,avx512bw"))) static inline __m512i broadcast128(const void* pattern) {
+            // The masked variant avoids an undefined source operand
+            return _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_load_si128(reinterpret_cast<const __m128i*>(pattern)));
+        }
+
+
+        // Load four 128-bit lanes from data, data + offset, data + 2 * offset and data + 3 * offset
+        __attribute__((target("avx512f,avx512bw"))) static inline __m512i load4x128(const uint8_t* data,
+                                                                                    size_t offset) {
+            __m512i v = _mm512_zextsi128_si512(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+            v = _mm512_inserti32x4(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset)), 1);
+            v = _mm512_inserti32x4(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 2 * offset)), 2);
+            v = _mm512_inserti32x4(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 3 * offset)), 3);
+            return v;
+        }
+
+
+        __attribute__((target("avx512f,avx512bw"))) static void unpackMono12PackedAvx512(const uint8_t* data,
+                                                                                         size_t n_pixels,
+                                                                                         uint16_t* unpacked) {
+            const __m512i shuffle =
+                  broadcast128(shuffle12Packed);
+            const __m512i maskHigh = _mm512_set1_epi16(0x0FF0);
+            const __m512i maskLow = _mm512_set1_epi16(0x000F);
+            const size_t n_bytes = (3 * n_pixels + 1) / 2;
+
+            size_t i = 0;
+            for (; 3 * i / 2 + 52 <= n_bytes; i += 32) {
+                const __m512i v = _mm512_shuffle_epi8(load4x128(data + 3 * i / 2, 12), shuffle);
+                const __m512i odd = _mm512_srli_epi16(v, 4);
+                const __m512i even =
+                      _mm512_or_si512(_mm512_and_si512(odd, maskHigh), _mm512_and_si512(v, maskLow));
+                _mm512_storeu_si512(unpacked + i, _mm512_mask_blend_epi16(0xAAAAAAAA, even, odd));
+            }
+            unpackMono12PackedAvx2(data + 3 * i / 2, n_pixels - i, unpacked + i);
+        }
+
+
+        __attribute__((target("avx512f,avx512bw"))) static void unpackMono12pAvx512(const uint8_t* data,
+                                                                                    size_t n_pixels,
+                                                                                    uint16_t* unpacked) {
+            const __m512i shuffle =
+                  broadcast128(shuffle12p);
+            const __m512i mask = _mm512_set1_epi16(0x0FFF);
+            const size_t n_bytes = (3 * n_pixels + 1) / 2;
+
+            size_t i = 0;
+            for (; 3 * i / 2 + 52 <= n_bytes; i += 32) {
+                const __m512i v = _mm512_shuffle_epi8(load4x128(data + 3 * i / 2, 12), shuffle);
+                const __m512i even = _mm512_and_si512(v, mask);
+                const __m512i odd = _mm512_srli_epi16(v, 4);
+                _mm512_storeu_si512(unpacked + i, _mm512_mask_blend_epi16(0xAAAAAAAA, even, odd));
+            }
+            unpackMono12pAvx2(data + 3 * i / 2, n_pixels - i, unpacked + i);
+        }
+
+
+        __attribute__((target("avx512f,avx512bw"))) static void unpackMono10pAvx512(const uint8_t* data,
+                                                                                    size_t n_pixels,
+                                                                                    uint16_t* unpacked) {
+            const __m512i shuffle =
+                  broadcast128(shuffle10p);
+            const __m512i multiply =
+                  broadcast128(multiply10p);
+            const size_t n_bytes = (10 * n_pixels + 7) / 8;
+
+            size_t i = 0;
+            for (; 5 * i / 4 + 46 <= n_bytes; i += 32) {
+                const __m512i v = _mm512_shuffle_epi8(load4x128(data + 5 * i / 4, 10), shuffle);
+                const __m512i out = _mm512_srli_epi16(_mm512_mullo_epi16(v, multiply), 6);
+                _mm512_storeu_si512(unpacked + i, out);
+            }
+            unpackMono10pAvx2(data + 5 * i / 4, n_pixels - i, unpacked + i);
+        }
+
+        static const UnpackKernels sse41Kernels = {unpackMono12PackedSse41, unpackMono12pSse41, unpackMono10pSse41};
+        static const UnpackKernels avx2Kernels = {unpackMono12PackedAvx2, unpackMono12pAvx2, unpackMono10pAvx2};
+        static const UnpackKernels avx512Kernels = {unpackMono12PackedAvx512, unpackMono12pAvx512,
+                                                    unpackMono10pAvx512};
+
+#endif
+
+
+        SimdLevel detectSimdLevel() {
+#ifdef KARABO_KERNELS_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512bw")) return SimdLevel::AVX512BW;
+            if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+            if (__builtin_cpu_supports("sse4.1")) return SimdLevel::SSE41;
+#endif
+            return SimdLevel::SCALAR;
+        }
+
+
+        const char* toString(SimdLevel level) {
+            switch (level) {
+                case SimdLevel::AVX512BW:
+                    return "AVX-512BW";
+                case SimdLevel::AVX2:
+                    return "AVX2";
+                case SimdLevel::SSE41:
+                    return "SSE4.1";
+                default:
+                    return "Scalar";
+            }
+        }
+
+
+        const UnpackKernels& getUnpackKernels(SimdLevel level) {
+#ifdef KARABO_KERNELS_X86
+            switch (level) {
+                case SimdLevel::AVX512BW:
+                    return avx512Kernels;
+                case SimdLevel::AVX2:
+                    return avx2Kernels;
+                case SimdLevel::SSE41:
+                    return sse41Kernels;
+                default:
+                    break;
+            }
+#endif
+            return scalarKernels;
+        }
+
+
+        const UnpackKernels& getUnpackKernels() {
+            // Thread-safe initialization, done once
+            static const UnpackKernels& kernels = getUnpackKernels(detectSimdLevel());
+            return kernels;
+        }
+
+
+        // YUV 4:2:2 conversion. The chroma terms are computed in 16-bit fixed point, with 8 fractional bits,
+        // each term rounded separately: the scalar kernels give exactly the same result as the SIMD ones,
+        // where the products are done by pmulhrsw on the chroma shifted left by 7 bits.
+
+        static const int yuvRedV = 359;   // 1.402 * 256
+        static const int yuvGreenU = 88;  // 0.344136 * 256
+        static const int yuvGreenV = 183; // 0.714136 * 256
+        static const int yuvBlueU = 454;  // 1.772 * 256
+
+        static inline uint8_t clampByte(int value) {
+            return static_cast<uint8_t>(std::clamp(value, 0, 255));
+        }
+
+        static inline void yuvToRgbPixel(int y, int u, int v, uint8_t* rgb) {
+            u -= 128;
+            v -= 128;
+            rgb[0] = clampByte(y + ((yuvRedV * v + 128) >> 8));
+            rgb[1] = clampByte(y - ((yuvGreenU * u + 128) >> 8) - ((yuvGreenV * v + 128) >> 8));
+            rgb[2] = clampByte(y + ((yuvBlueU * u + 128) >> 8));
+        }
+
+
+        // Y, U and V are the byte offsets of the first luma and of the chroma in each group of 4 bytes
+        template <size_t Y, size_t U, size_t V>
+        static void yuvToRgbScalar(const uint8_t* yuv, size_t n_pixels, uint8_t* rgb) {
+            size_t i = 0;
+            for (; i + 1 < n_pixels; i += 2, yuv += 4, rgb += 6) {
+                yuvToRgbPixel(yuv[Y], yuv[U], yuv[V], rgb);
+                yuvToRgbPixel(yuv[Y + 2], yuv[U], yuv[V], rgb + 3);
+            }
+            if (i < n_pixels) {
+                // Odd number of pixels: the last one comes without the red chroma
+                yuvToRgbPixel(yuv[Y], yuv[U], (V < 2) ? yuv[V] : 128, rgb);
+            }
+        }
+
+
+        template <size_t Y>
+        static void yuvToMonoScalar(const uint8_t* yuv, size_t n_pixels, uint8_t* mono) {
+            for (size_t i = 0; i < n_pixels; ++i) {
+                mono[i] = yuv[2 * i + Y % 2];
+            }
+        }
+
+        static const YuvKernels scalarYuvKernels = {yuvToRgbScalar<0, 1, 3>, yuvToRgbScalar<1, 0, 2>,
+                                                    yuvToMonoScalar<0>, yuvToMonoScalar<1>};
+
+#ifdef KARABO_KERNELS_X86
+
+        // Shuffles of 8 pixels (16 bytes) to the luma and the chroma of each pixel, in 16-bit lanes
+        struct YuvShuffles {
+            alignas(16) int8_t luma[16];
+            alignas(16) int8_t u[16];
+            alignas(16) int8_t v[16];
+        };
+
+        static const YuvShuffles yuyvShuffles = {{0, -1, 2, -1, 4, -1, 6, -1, 8, -1, 10, -1, 12, -1, 14, -1},
+                                                 {1, -1, 1, -1, 5, -1, 5, -1, 9, -1, 9, -1, 13, -1, 13, -1},
+                                                 {3, -1, 3, -1, 7, -1, 7, -1, 11, -1, 11, -1, 15, -1, 15, -1}};
+        static const YuvShuffles uyvyShuffles = {{1, -1, 3, -1, 5, -1, 7, -1, 9, -1, 11, -1, 13, -1, 15, -1},
+                                                 {0, -1, 0, -1, 4, -1, 4, -1, 8, -1, 8, -1, 12, -1, 12, -1},
+                                                 {2, -1, 2, -1, 6, -1, 6, -1, 10, -1, 10, -1, 14, -1, 14, -1}};
+
+        // Interleave R0..R7 G0..G7 (rg) and B0..B7 (b) to 24 bytes: the first 16 bytes, then the last 8 ones
+        alignas(16) static const int8_t interleaveRg0[16] = {0, 8, -1, 1, 9, -1, 2, 10, -1, 3, 11, -1, 4, 12, -1, 5};
+        alignas(16) static const int8_t interleaveB0[16] = {-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1};
+        alignas(16) static const int8_t interleaveRg1[16] = {13, -1, 6, 14, -1, 7, 15, -1,
+                                                             -1, -1, -1, -1, -1, -1, -1, -1};
+        alignas(16) static const int8_t interleaveB1[16] = {-1, 5, -1, -1, 6, -1, -1, 7,
+                                                            -1, -1, -1, -1, -1, -1, -1, -1};
+
+
+        template <size_t Y, size_t U, size_t V>
+        __attribute__((target("sse4.1"))) static void yuvToRgbSse41(const uint8_t* yuv, size_t n_pixels,
+                                                                    uint8_t* rgb) {
+            const YuvShuffles& shuffles = (Y == 0) ? yuyvShuffles : uyvyShuffles;
+            const __m128i lumaShuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(shuffles.luma));
+            const __m128i uShuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(shuffles.u));
+            const __m128i vShuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(shuffles.v));
+            const __m128i rg0 = _mm_load_si128(reinterpret_cast<const __m128i*>(interleaveRg0));
+            const __m128i b0 = _mm_load_si128(reinterpret_cast<const __m128i*>(interleaveB0));
+            const __m128i rg1 = _mm_load_si128(reinterpret_cast<const __m128i*>(interleaveRg1));
+            const __m128i b1 = _mm_load_si128(reinterpret_cast<const __m128i*>(interleaveB1));
+            const __m128i offset = _mm_set1_epi16(128);
+            const __m128i redV = _mm_set1_epi16(yuvRedV);
+            const __m128i greenU = _mm_set1_epi16(yuvGreenU);
+            const __m128i greenV = _mm_set1_epi16(yuvGreenV);
+            const __m128i blueU = _mm_set1_epi16(yuvBlueU);
+
+            size_t i = 0;
+            for (; i + 8 <= n_pixels; i += 8) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(yuv + 2 * i));
+                const __m128i y = _mm_shuffle_epi8(in, lumaShuffle);
+                const __m128i u = _mm_slli_epi16(_mm_sub_epi16(_mm_shuffle_epi8(in, uShuffle), offset), 7);
+                const __m128i v = _mm_slli_epi16(_mm_sub_epi16(_mm_shuffle_epi8(in, vShuffle), offset), 7);
+
+                const __m128i r = _mm_add_epi16(y, _mm_mulhrs_epi16(v, redV));
+                const __m128i g =
+                      _mm_sub_epi16(_mm_sub_epi16(y, _mm_mulhrs_epi16(u, greenU)), _mm_mulhrs_epi16(v, greenV));
+                const __m128i b = _mm_add_epi16(y, _mm_mulhrs_epi16(u, blueU));
+
+                // Saturated to [0, 255]
+                const __m128i rgBytes = _mm_packus_epi16(r, g);
+                const __m128i bBytes = _mm_packus_epi16(b, b);
+                const __m128i out0 = _mm_or_si128(_mm_shuffle_epi8(rgBytes, rg0), _mm_shuffle_epi8(bBytes, b0));
+                const __m128i out1 = _mm_or_si128(_mm_shuffle_epi8(rgBytes, rg1), _mm_shuffle_epi8(bBytes, b1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb + 3 * i), out0);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(rgb + 3 * i + 16), out1);
+            }
+            yuvToRgbScalar<Y, U, V>(yuv + 2 * i, n_pixels - i, rgb + 3 * i);
+        }
+
+
+        // Luma in the lower (YUYV) or upper (UYVY) byte of each 16-bit lane
+        template <size_t Y>
+        __attribute__((target("sse4.1"))) static inline __m128i lumaSse41(__m128i in) {
+            return (Y == 0) ? _mm_and_si128(in, _mm_set1_epi16(0x00FF)) : _mm_srli_epi16(in, 8);
+        }
+
+
+        template <size_t Y>
+        __attribute__((target("sse4.1"))) static void yuvToMonoSse41(const uint8_t* yuv, size_t n_pixels,
+                                                                     uint8_t* mono) {
+            size_t i = 0;
+            for (; i + 16 <= n_pixels; i += 16) {
+                const __m128i in0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(yuv + 2 * i));
+                const __m128i in1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(yuv + 2 * i + 16));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(mono + i),
+                                 _mm_packus_epi16(lumaSse41<Y>(in0), lumaSse41<Y>(in1)));
+            }
+            yuvToMonoScalar<Y>(yuv + 2 * i, n_pixels - i, mono + i);
+        }
+
+
+        // Broadcast a 128-bit pattern to the two lanes
+        __attribute__((target("avx2"))) static inline __m256i broadcast2x128(const void* pattern) {
+            return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(pattern)));
+        }
+
+
+        // Same as the SSE4.1 kernels, 8 pixels in each 128-bit lane
+        template <size_t Y, size_t U, size_t V>
+        __attribute__((target("avx2"))) static void yuvToRgbAvx2(const uint8_t* yuv, size_t n_pixels, uint8_t* rgb) {
+            const YuvShuffles& shuffles = (Y == 0) ? yuyvShuffles : uyvyShuffles;
+            const __m256i lumaShuffle = broadcast2x128(shuffles.luma);
+            const __m256i uShuffle = broadcast2x128(shuffles.u);
+            const __m256i vShuffle = broadcast2x128(shuffles.v);
+            const __m256i rg0 = broadcast2x128(interleaveRg0);
+            const __m256i b0 = broadcast2x128(interleaveB0);
+            const __m256i rg1 = broadcast2x128(interleaveRg1);
+            const __m256i b1 = broadcast2x128(interleaveB1);
+            const __m256i offset = _mm256_set1_epi16(128);
+            const __m256i redV = _mm256_set1_epi16(yuvRedV);
+            const __m256i greenU = _mm256_set1_epi16(yuvGreenU);
+            const __m256i greenV = _mm256_set1_epi16(yuvGreenV);
+            const __m256i blueU = _mm256_set1_epi16(yuvBlueU);
+
+            size_t i = 0;
+            for (; i + 16 <= n_pixels; i += 16) {
+                const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(yuv + 2 * i));
+                const __m256i y = _mm256_shuffle_epi8(in, lumaShuffle);
+                const __m256i u = _mm256_slli_epi16(_mm256_sub_epi16(_mm256_shuffle_epi8(in, uShuffle), offset), 7);
+                const __m256i v = _mm256_slli_epi16(_mm256_sub_epi16(_mm256_shuffle_epi8(in, vShuffle), offset), 7);
+
+                const __m256i r = _mm256_add_epi16(y, _mm256_mulhrs_epi16(v, redV));
+                const __m256i g = _mm256_sub_epi16(_mm256_sub_epi16(y, _mm256_mulhrs_epi16(u, greenU)),
+                                                   _mm256_mulhrs_epi16(v, greenV));
+                const __m256i b = _mm256_add_epi16(y, _mm256_mulhrs_epi16(u, blueU));
+
+                const __m256i rgBytes = _mm256_packus_epi16(r, g);
+                const __m256i bBytes = _mm256_packus_epi16(b, b);
+                const __m256i out0 =
+                      _mm256_or_si256(_mm256_shuffle_epi8(rgBytes, rg0), _mm256_shuffle_epi8(bBytes, b0));
+                const __m256i out1 =
+                      _mm256_or_si256(_mm256_shuffle_epi8(rgBytes, rg1), _mm256_shuffle_epi8(bBytes, b1));
+                uint8_t* out = rgb + 3 * i;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(out0));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 16), _mm256_castsi256_si128(out1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 24), _mm256_extracti128_si256(out0, 1));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 40), _mm256_extracti128_si256(out1, 1));
+            }
+            yuvToRgbSse41<Y, U, V>(yuv + 2 * i, n_pixels - i, rgb + 3 * i);
+        }
+
+
+        template <size_t Y>
+        __attribute__((target("avx2"))) static inline __m256i lumaAvx2(__m256i in) {
+            return (Y == 0) ? _mm256_and_si256(in, _mm256_set1_epi16(0x00FF)) : _mm256_srli_epi16(in, 8);
+        }
+
+
+        template <size_t Y>
+        __attribute__((target("avx2"))) static void yuvToMonoAvx2(const uint8_t* yuv, size_t n_pixels,
+                                                                  uint8_t* mono) {
+            size_t i = 0;
+            for (; i + 32 <= n_pixels; i += 32) {
+                const __m256i in0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(yuv + 2 * i));
+                const __m256i in1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(yuv + 2 * i + 32));
+                // The packing works in 128-bit lanes: restore the order of the 64-bit halves
+                const __m256i packed = _mm256_packus_epi16(lumaAvx2<Y>(in0), lumaAvx2<Y>(in1));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(mono + i), _mm256_permute4x64_epi64(packed, 0xD8));
+            }
+            yuvToMonoSse41<Y>(yuv + 2 * i, n_pixels - i, mono + i);
+        }
+
+        static const YuvKernels sse41YuvKernels = {yuvToRgbSse41<0, 1, 3>, yuvToRgbSse41<1, 0, 2>,
+                                                   yuvToMonoSse41<0>, yuvToMonoSse41<1>};
+        // The conversion is bound by the memory bandwidth already with AVX2
+        static const YuvKernels avx2YuvKernels = {yuvToRgbAvx2<0, 1, 3>, yuvToRgbAvx2<1, 0, 2>, yuvToMonoAvx2<0>,
+                                                  yuvToMonoAvx2<1>};
+
+#endif
+
+
+        const YuvKernels& getYuvKernels(SimdLevel level) {
+#ifdef KARABO_KERNELS_X86
+            switch (level) {
+                case SimdLevel::AVX512BW:
+                case SimdLevel::AVX2:
+                    return avx2YuvKernels;
+                case SimdLevel::SSE41:
+                    return sse41YuvKernels;
+                default:
+                    break;
+            }
+#endif
+            return scalarYuvKernels;
+        }
+
+
+        const YuvKernels& getYuvKernels() {
+            // Thread-safe initialization, done once
+            static const YuvKernels& kernels = getYuvKernels(detectSimdLevel());
+            return kernels;
+        }
+
+
+        // Binning: the rows of each bin are added up in 32-bit sums, with widening vertical adds, then
+        // the groups of binX sums are added up with horizontal adds.
+
+        static void accumulateRow8Scalar(const uint8_t* row, size_t n_pixels, uint32_t* sums) {
+            for (size_t i = 0; i < n_pixels; ++i) {
+                sums[i] += row[i];
+            }
+        }
+
+
+        static void accumulateRow16Scalar(const uint16_t* row, size_t n_pixels, uint32_t* sums) {
+            for (size_t i = 0; i < n_pixels; ++i) {
+                sums[i] += row[i];
+            }
+        }
+
+
+        static void reduceRowScalar(const uint32_t* sums, size_t n_binned, int factor, uint32_t* binned) {
+            for (size_t i = 0; i < n_binned; ++i, sums += factor) {
+                uint32_t sum = 0;
+                for (int k = 0; k < factor; ++k) {
+                    sum += sums[k];
+                }
+                binned[i] = sum;
+            }
+        }
+
+        static const BinKernels scalarBinKernels = {accumulateRow8Scalar, accumulateRow16Scalar, reduceRowScalar};
+
+#ifdef KARABO_KERNELS_X86
+
+        __attribute__((target("sse4.1"))) static void accumulateRow8Sse41(const uint8_t* row, size_t n_pixels,
+                                                                          uint32_t* sums) {
+            size_t i = 0;
+            for (; i + 16 <= n_pixels; i += 16) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+                // Groups of 4 bytes widened to 32 bits
+                const __m128i pixels[4] = {_mm_cvtepu8_epi32(in), _mm_cvtepu8_epi32(_mm_srli_si128(in, 4)),
+                                           _mm_cvtepu8_epi32(_mm_srli_si128(in, 8)),
+                                           _mm_cvtepu8_epi32(_mm_srli_si128(in, 12))};
+                __m128i* out = reinterpret_cast<__m128i*>(sums + i);
+                for (int k = 0; k < 4; ++k) {
+                    _mm_storeu_si128(out + k, _mm_add_epi32(_mm_loadu_si128(out + k), pixels[k]));
+                }
+            }
+            accumulateRow8Scalar(row + i, n_pixels - i, sums + i);
+        }
+
+
+        __attribute__((target("sse4.1"))) static void accumulateRow16Sse41(const uint16_t* row, size_t n_pixels,
+                                                                           uint32_t* sums) {
+            size_t i = 0;
+            for (; i + 8 <= n_pixels; i += 8) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+                __m128i* out = reinterpret_cast<__m128i*>(sums + i);
+                _mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), _mm_cvtepu16_epi32(in)));
+                _mm_storeu_si128(out + 1, _mm_add_epi32(_mm_loadu_si128(out + 1),
+                                                        _mm_cvtepu16_epi32(_mm_srli_si128(in, 8))));
+            }
+            accumulateRow16Scalar(row + i, n_pixels - i, sums + i);
+        }
+
+
+        __attribute__((target("sse4.1"))) static inline __m128i load128(const uint32_t* data) {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        }
+
+
+        __attribute__((target("sse4.1"))) static void reduceRowSse41(const uint32_t* sums, size_t n_binned,
+                                                                     int factor, uint32_t* binned) {
+            size_t i = 0;
+            if (factor == 2) {
+                for (; i + 4 <= n_binned; i += 4) {
+                    const __m128i pairs = _mm_hadd_epi32(load128(sums + 2 * i), load128(sums + 2 * i + 4));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(binned + i), pairs);
+                }
+            } else if (factor == 4) {
+                for (; i + 4 <= n_binned; i += 4) {
+                    const __m128i pairs0 = _mm_hadd_epi32(load128(sums + 4 * i), load128(sums + 4 * i + 4));
+                    const __m128i pairs1 = _mm_hadd_epi32(load128(sums + 4 * i + 8), load128(sums + 4 * i + 12));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(binned + i), _mm_hadd_epi32(pairs0, pairs1));
+                }
+            }
+            reduceRowScalar(sums + factor * i, n_binned - i, factor, binned + i);
+        }
+
+
+        __attribute__((target("avx2"))) static void accumulateRow8Avx2(const uint8_t* row, size_t n_pixels,
+                                                                       uint32_t* sums) {
+            size_t i = 0;
+            for (; i + 16 <= n_pixels; i += 16) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+                __m256i* out = reinterpret_cast<__m256i*>(sums + i);
+                _mm256_storeu_si256(out, _mm256_add_epi32(_mm256_loadu_si256(out), _mm256_cvtepu8_epi32(in)));
+                _mm256_storeu_si256(out + 1, _mm256_add_epi32(_mm256_loadu_si256(out + 1),
+                                                              _mm256_cvtepu8_epi32(_mm_srli_si128(in, 8))));
+            }
+            accumulateRow8Sse41(row + i, n_pixels - i, sums + i);
+        }
+
+
+        __attribute__((target("avx2"))) static void accumulateRow16Avx2(const uint16_t* row, size_t n_pixels,
+                                                                        uint32_t* sums) {
+            size_t i = 0;
+            for (; i + 16 <= n_pixels; i += 16) {
+                const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+                __m256i* out = reinterpret_cast<__m256i*>(sums + i);
+                _mm256_storeu_si256(out, _mm256_add_epi32(_mm256_loadu_si256(out),
+                                                          _mm256_cvtepu16_epi32(_mm256_castsi256_si128(in))));
+                _mm256_storeu_si256(out + 1, _mm256_add_epi32(_mm256_loadu_si256(out + 1),
+                                                              _mm256_cvtepu16_epi32(_mm256_extracti128_si256(in, 1))));
+            }
+            accumulateRow16Sse41(row + i, n_pixels - i, sums + i);
+        }
+
+
+        __attribute__((target("avx2"))) static inline __m256i load256(const uint32_t* data) {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        }
+
+
+        __attribute__((target("avx2"))) static void reduceRowAvx2(const uint32_t* sums, size_t n_binned, int factor,
+                                                                  uint32_t* binned) {
+            size_t i = 0;
+            // The horizontal adds work in 128-bit lanes: the results are permuted back in order
+            if (factor == 2) {
+                for (; i + 8 <= n_binned; i += 8) {
+                    const __m256i pairs = _mm256_hadd_epi32(load256(sums + 2 * i), load256(sums + 2 * i + 8));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(binned + i),
+                                        _mm256_permute4x64_epi64(pairs, 0xD8));
+                }
+            } else if (factor == 4) {
+                const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+                for (; i + 8 <= n_binned; i += 8) {
+                    const __m256i pairs0 = _mm256_hadd_epi32(load256(sums + 4 * i), load256(sums + 4 * i + 8));
+                    const __m256i pairs1 = _mm256_hadd_epi32(load256(sums + 4 * i + 16), load256(sums + 4 * i + 24));
+                    const __m256i quads = _mm256_hadd_epi32(pairs0, pairs1);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(binned + i),
+                                        _mm256_permutevar8x32_epi32(quads, order));
+                }
+            }
+            reduceRowSse41(sums + factor * i, n_binned - i, factor, binned + i);
+        }
+
+        static const BinKernels sse41BinKernels = {accumulateRow8Sse41, accumulateRow16Sse41, reduceRowSse41};
+        // The binning is bound by the memory bandwidth already with AVX2
+        static const BinKernels avx2BinKernels = {accumulateRow8Avx2, accumulateRow16Avx2, reduceRowAvx2};
+
+#endif
+
+
+        const BinKernels& getBinKernels(SimdLevel level) {
+#ifdef KARABO_KERNELS_X86
+            switch (level) {
+                case SimdLevel::AVX512BW:
+                case SimdLevel::AVX2:
+                    return avx2BinKernels;
+                case SimdLevel::SSE41:
+                    return sse41BinKernels;
+                default:
+                    break;
+            }
+#endif
+            return scalarBinKernels;
+        }
+
+
+        const BinKernels& getBinKernels() {
+            // Thread-safe initialization, done once
+            static const BinKernels& kernels = getBinKernels(detectSimdLevel());
+            return kernels;
+        }
+
+
+        template <class T>
+        static void accumulateRow(const BinKernels& binKernels, const T* row, size_t n_pixels, uint32_t* sums) {
+            if constexpr (sizeof(T) == 1) {
+                binKernels.accumulate8(row, n_pixels, sums);
+            } else {
+                binKernels.accumulate16(row, n_pixels, sums);
+            }
+        }
+
+
+        // Bin the rows [rowBegin, rowEnd). Binned is uint32_t for the sums, T for the means.
+        template <class T, class Binned>
+        static void binRows(const T* image, int width, int binX, int binY, int rowBegin, int rowEnd,
+                            Binned* binned) {
+            const BinKernels& binKernels = getBinKernels();
+            const size_t binnedWidth = width / binX;
+            const uint32_t count = binX * binY;
+            std::vector<uint32_t> sums(binnedWidth * binX);
+            std::vector<uint32_t> means(std::is_same_v<Binned, uint32_t> ? 0 : binnedWidth);
+
+            for (int y = rowBegin; y < rowEnd; ++y) {
+                std::fill(sums.begin(), sums.end(), 0);
+                for (int dy = 0; dy < binY; ++dy) {
+                    accumulateRow(binKernels, image + (size_t(y) * binY + dy) * width, sums.size(), sums.data());
+                }
+
+                Binned* out = binned + size_t(y) * binnedWidth;
+                if constexpr (std::is_same_v<Binned, uint32_t>) {
+                    binKernels.reduce(sums.data(), binnedWidth, binX, out);
+                } else {
+                    binKernels.reduce(sums.data(), binnedWidth, binX, means.data());
+                    for (size_t i = 0; i < binnedWidth; ++i) {
+                        out[i] = (means[i] + count / 2) / count;
+                    }
+                }
+            }
+        }
+
+
+        void binSum(const uint8_t* image, int width, int binX, int binY, int rowBegin, int rowEnd, uint32_t* binned) {
+            binRows(image, width, binX, binY, rowBegin, rowEnd, binned);
+        }
+
+
+        void binSum(const uint16_t* image, int width, int binX, int binY, int rowBegin, int rowEnd,
+                    uint32_t* binned) {
+            binRows(image, width, binX, binY, rowBegin, rowEnd, binned);
+        }
+
+
+        void binAverage(const uint8_t* image, int width, int binX, int binY, int rowBegin, int rowEnd,
+                        uint8_t* binned) {
+            binRows(image, width, binX, binY, rowBegin, rowEnd, binned);
+        }
+
+
+        void binAverage(const uint16_t* image, int width, int binX, int binY, int rowBegin, int rowEnd,
+                        uint16_t* binned) {
+            binRows(image, width, binX, binY, rowBegin, rowEnd, binned);
+        }
+
+
+        template <class T, class Out>
+        void downscaleImage(const T* image, int width, int height, int channels, int factor, int shift,
+                            Out* downscaled) {
+            const size_t outWidth = width / factor;
+            const size_t outHeight = height / factor;
+            const uint64_t count = uint64_t(factor) * factor;
+            const uint64_t maxValue = std::numeric_limits<Out>::max();
+            const auto mean = [count, shift, maxValue](uint64_t sum) {
+                return static_cast<Out>(std::min(((sum + count / 2) / count) >> shift, maxValue));
+            };
+
+            if constexpr (sizeof(T) <= 2) {
+                if (channels == 1) {
+                    // Monochrome images are summed up by the binning kernels
+                    std::vector<uint32_t> sums(outWidth * outHeight);
+                    binSum(image, width, factor, factor, 0, outHeight, sums.data());
+                    std::transform(sums.begin(), sums.end(), downscaled, mean);
+                    return;
+                }
+            }
+
+            const size_t rowSize = size_t(width) * channels;
+            std::vector<uint64_t> sums(outWidth * channels);
+            for (size_t y = 0; y < outHeight; ++y) {
+                std::fill(sums.begin(), sums.end(), 0);
+                for (int dy = 0; dy < factor; ++dy) {
+                    const T* pixel = image + (y * factor + dy) * rowSize;
+                    for (size_t x = 0; x < outWidth; ++x) {
+                        uint64_t* sum = sums.data() + x * channels;
+                        for (int dx = 0; dx < factor; ++dx, pixel += channels) {
+                            for (int c = 0; c < channels; ++c) sum[c] += pixel[c];
+                        }
+                    }
+                }
+                std::transform(sums.begin(), sums.end(), downscaled + y * outWidth * channels, mean);
+            }
+        }
+
+        template void downscaleImage(const uint8_t*, int, int, int, int, int, uint8_t*);
+        template void downscaleImage(const uint16_t*, int, int, int, int, int, uint16_t*);
+        template void downscaleImage(const uint16_t*, int, int, int, int, int, uint8_t*);
+        template void downscaleImage(const uint32_t*, int, int, int, int, int, uint32_t*);
+        template void downscaleImage(const uint32_t*, int, int, int, int, int, uint8_t*);
+
+
+        // Statistics: the minimum, maximum, sum and saturated count are reduced in SIMD registers, block by block.
+        // The histogram is filled by scalar code in the same pass over each block, while it is still in cache,
+        // with four sub-histograms to avoid the store-to-load dependencies between consecutive equal values.
+        static const size_t statisticsBlock = 4096;
+
+        void PixelStatistics::merge(const PixelStatistics& other) {
+            count += other.count;
+            sum += other.sum;
+            min = std::min(min, other.min);
+            max = std::max(max, other.max);
+            saturated += other.saturated;
+            for (int i = 0; i < HISTOGRAM_BINS; ++i) {
+                histogram[i] += other.histogram[i];
+            }
+        }
+
+
+        template <class T>
+        static void histogramScalar(const T* pixels, size_t n_pixels, int histogramShift, PixelStatistics& statistics) {
+            uint32_t counts[4][HISTOGRAM_BINS] = {};
+            const auto bin = [histogramShift](uint32_t value) {
+                return std::min<uint32_t>(value >> histogramShift, HISTOGRAM_BINS - 1);
+            };
+            size_t i = 0;
+            for (; i + 4 <= n_pixels; i += 4) {
+                ++counts[0][bin(pixels[i])];
+                ++counts[1][bin(pixels[i + 1])];
+                ++counts[2][bin(pixels[i + 2])];
+                ++counts[3][bin(pixels[i + 3])];
+            }
+            for (; i < n_pixels; ++i) {
+                ++counts[0][bin(pixels[i])];
+            }
+            for (int b = 0; b < HISTOGRAM_BINS; ++b) {
+                statistics.histogram[b] += counts[0][b] + counts[1][b] + counts[2][b] + counts[3][b];
+            }
+        }
+
+
+        // Minimum, maximum, sum and saturated count
+        template <class T>
+        static void reduceScalar(const T* pixels, size_t n_pixels, uint32_t saturation, PixelStatistics& statistics) {
+            uint32_t min = statistics.min;
+            uint32_t max = statistics.max;
+            uint64_t sum = 0;
+            uint64_t saturated = 0;
+            for (size_t i = 0; i < n_pixels; ++i) {
+                const uint32_t value = pixels[i];
+                min = std::min(min, value);
+                max = std::max(max, value);
+                sum += value;
+                saturated += (value >= saturation);
+            }
+            statistics.min = min;
+            statistics.max = max;
+            statistics.sum += sum;
+            statistics.saturated += saturated;
+        }
+
+
+        template <class T, void (*Reduce)(const T*, size_t, uint32_t, PixelStatistics&)>
+        static void statisticsBlocks(const T* pixels, size_t n_pixels, uint32_t saturation, int histogramShift,
+                                     PixelStatistics& statistics) {
+            for (size_t i = 0; i < n_pixels; i += statisticsBlock) {
+                const size_t n = std::min(statisticsBlock, n_pixels - i);
+                Reduce(pixels + i, n, saturation, statistics);
+                histogramScalar(pixels + i, n, histogramShift, statistics);
+            }
+            statistics.count += n_pixels;
+        }
+
+        static const StatisticsKernels scalarStatisticsKernels = {statisticsBlocks<uint8_t, reduceScalar<uint8_t>>,
+                                                                  statisticsBlocks<uint16_t, reduceScalar<uint16_t>>};
+
+#ifdef KARABO_KERNELS_X86
+
+        // Horizontal reductions of the 16-bit minima and maxima, of the 32-bit sums of biased pixels and of the
+        // 16-bit saturated counts, for n_pixels 16-bit pixels
+        __attribute__((target("sse4.1"))) static inline void finish16Sse41(__m128i min, __m128i max, __m128i sums,
+                                                                           __m128i counts, size_t n_pixels,
+                                                                           uint32_t saturation,
+                                                                           PixelStatistics& statistics) {
+            const __m128i ones = _mm_set1_epi16(-1);
+            statistics.min = std::min<uint32_t>(statistics.min, _mm_extract_epi16(_mm_minpos_epu16(min), 0));
+            statistics.max = std::max<uint32_t>(
+                  statistics.max, 0xFFFF - _mm_extract_epi16(_mm_minpos_epu16(_mm_xor_si128(max, ones)), 0));
+
+            sums = _mm_add_epi32(sums, _mm_srli_si128(sums, 8));
+            sums = _mm_add_epi32(sums, _mm_srli_si128(sums, 4));
+            // The pixels were biased by -0x8000
+            statistics.sum += int64_t(_mm_cvtsi128_si32(sums)) + 0x8000 * int64_t(n_pixels);
+
+            counts = _mm_madd_epi16(counts, _mm_set1_epi16(1));
+            counts = _mm_add_epi32(counts, _mm_srli_si128(counts, 8));
+            counts = _mm_add_epi32(counts, _mm_srli_si128(counts, 4));
+            if (saturation <= 0xFFFF) {
+                statistics.saturated += _mm_cvtsi128_si32(counts);
+            }
+        }
+
+
+        // Horizontal reductions of the 8-bit minima and maxima, and of the 64-bit sums and saturated counts
+        __attribute__((target("sse4.1"))) static inline void finish8Sse41(__m128i min, __m128i max, __m128i sums,
+                                                                          __m128i counts, uint32_t saturation,
+                                                                          PixelStatistics& statistics) {
+            min = _mm_cvtepu8_epi16(_mm_min_epu8(min, _mm_srli_si128(min, 8)));
+            max = _mm_cvtepu8_epi16(_mm_max_epu8(max, _mm_srli_si128(max, 8)));
+            finish16Sse41(min, max, _mm_setzero_si128(), _mm_setzero_si128(), 0, 0x10000, statistics);
+
+            sums = _mm_add_epi64(sums, _mm_srli_si128(sums, 8));
+            statistics.sum += _mm_cvtsi128_si64(sums);
+            counts = _mm_add_epi64(counts, _mm_srli_si128(counts, 8));
+            if (saturation <= 0xFF) {
+                statistics.saturated += _mm_cvtsi128_si64(counts);
+            }
+        }
+
+
+        // n_pixels is at most statisticsBlock, thus the 32-bit sums and the 16-bit counts cannot overflow
+        __attribute__((target("sse4.1"))) static void reduce16Sse41(const uint16_t* pixels, size_t n_pixels,
+                                                                    uint32_t saturation, PixelStatistics& statistics) {
+            const __m128i bias = _mm_set1_epi16(-0x8000);
+            const __m128i ones = _mm_set1_epi16(1);
+            const __m128i threshold = _mm_set1_epi16(std::min<uint32_t>(saturation, 0xFFFF));
+            __m128i min = _mm_set1_epi16(-1);
+            __m128i max = _mm_setzero_si128();
+            __m128i sums = _mm_setzero_si128();
+            __m128i counts = _mm_setzero_si128();
+            size_t i = 0;
+            for (; i + 8 <= n_pixels; i += 8) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+                min = _mm_min_epu16(min, in);
+                max = _mm_max_epu16(max, in);
+                // Biased to signed 16-bit values, which pmaddwd adds up in pairs
+                sums = _mm_add_epi32(sums, _mm_madd_epi16(_mm_xor_si128(in, bias), ones));
+                // -1 in the lanes at or above the threshold
+                counts = _mm_sub_epi16(counts, _mm_cmpeq_epi16(_mm_max_epu16(in, threshold), in));
+            }
+            finish16Sse41(min, max, sums, counts, i, saturation, statistics);
+            reduceScalar(pixels + i, n_pixels - i, saturation, statistics);
+        }
+
+
+        __attribute__((target("sse4.1"))) static void reduce8Sse41(const uint8_t* pixels, size_t n_pixels,
+                                                                   uint32_t saturation, PixelStatistics& statistics) {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i ones = _mm_set1_epi8(1);
+            const __m128i threshold = _mm_set1_epi8(std::min<uint32_t>(saturation, 0xFF));
+            __m128i min = _mm_set1_epi8(-1);
+            __m128i max = zero;
+            __m128i sums = zero;
+            __m128i counts = zero;
+            size_t i = 0;
+            for (; i + 16 <= n_pixels; i += 16) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+                min = _mm_min_epu8(min, in);
+                max = _mm_max_epu8(max, in);
+                // psadbw adds up groups of 8 bytes into 64-bit lanes
+                sums = _mm_add_epi64(sums, _mm_sad_epu8(in, zero));
+                const __m128i above = _mm_cmpeq_epi8(_mm_max_epu8(in, threshold), in);
+                counts = _mm_add_epi64(counts, _mm_sad_epu8(_mm_and_si128(above, ones), zero));
+            }
+            finish8Sse41(min, max, sums, counts, saturation, statistics);
+            reduceScalar(pixels + i, n_pixels - i, saturation, statistics);
+        }
+
+
+        // Same as the SSE4.1 kernels, the two 128-bit lanes are combined at the end of the block
+        __attribute__((target("avx2"))) static void reduce16Avx2(const uint16_t* pixels, size_t n_pixels,
+                                                                 uint32_t saturation, PixelStatistics& statistics) {
+            const __m256i bias = _mm256_set1_epi16(-0x8000);
+            const __m256i ones = _mm256_set1_epi16(1);
+            const __m256i threshold = _mm256_set1_epi16(std::min<uint32_t>(saturation, 0xFFFF));
+            __m256i min = _mm256_set1_epi16(-1);
+            __m256i max = _mm256_setzero_si256();
+            __m256i sums = _mm256_setzero_si256();
+            __m256i counts = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 16 <= n_pixels; i += 16) {
+                const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + i));
+                min = _mm256_min_epu16(min, in);
+                max = _mm256_max_epu16(max, in);
+                sums = _mm256_add_epi32(sums, _mm256_madd_epi16(_mm256_xor_si256(in, bias), ones));
+                counts = _mm256_sub_epi16(counts, _mm256_cmpeq_epi16(_mm256_max_epu16(in, threshold), in));
+            }
+            const __m128i low[4] = {_mm256_castsi256_si128(min), _mm256_castsi256_si128(max),
+                                    _mm256_castsi256_si128(sums), _mm256_castsi256_si128(counts)};
+            const __m128i high[4] = {_mm256_extracti128_si256(min, 1), _mm256_extracti128_si256(max, 1),
+                                     _mm256_extracti128_si256(sums, 1), _mm256_extracti128_si256(counts, 1)};
+            finish16Sse41(_mm_min_epu16(low[0], high[0]), _mm_max_epu16(low[1], high[1]),
+                          _mm_add_epi32(low[2], high[2]), _mm_add_epi16(low[3], high[3]), i, saturation, statistics);
+            reduce16Sse41(pixels + i, n_pixels - i, saturation, statistics);
+        }
+
+
+        __attribute__((target("avx2"))) static void reduce8Avx2(const uint8_t* pixels, size_t n_pixels,
+                                                                uint32_t saturation, PixelStatistics& statistics) {
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i ones = _mm256_set1_epi8(1);
+            const __m256i threshold = _mm256_set1_epi8(std::min<uint32_t>(saturation, 0xFF));
+            __m256i min = _mm256_set1_epi8(-1);
+            __m256i max = zero;
+            __m256i sums = zero;
+            __m256i counts = zero;
+            size_t i = 0;
+            for (; i + 32 <= n_pixels; i += 32) {
+                const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + i));
+                min = _mm256_min_epu8(min, in);
+                max = _mm256_max_epu8(max, in);
+                sums = _mm256_add_epi64(sums, _mm256_sad_epu8(in, zero));
+                const __m256i above = _mm256_cmpeq_epi8(_mm256_max_epu8(in, threshold), in);
+                counts = _mm256_add_epi64(counts, _mm256_sad_epu8(_mm256_and_si256(above, ones), zero));
+            }
+            const __m128i low[4] = {_mm256_castsi256_si128(min), _mm256_castsi256_si128(max),
+                                    _mm256_castsi256_si128(sums), _mm256_castsi256_si128(counts)};
+            const __m128i high[4] = {_mm256_extracti128_si256(min, 1), _mm256_extracti128_si256(max, 1),
+                                     _mm256_extracti128_si256(sums, 1), _mm256_extracti128_si256(counts, 1)};
+            finish8Sse41(_mm_min_epu8(low[0], high[0]), _mm_max_epu8(low[1], high[1]), _mm_add_epi64(low[2], high[2]),
+                         _mm_add_epi64(low[3], high[3]), saturation, statistics);
+            reduce8Sse41(pixels + i, n_pixels - i, saturation, statistics);
+        }
+
+        static const StatisticsKernels sse41StatisticsKernels = {statisticsBlocks<uint8_t, reduce8Sse41>,
+                                                                 statisticsBlocks<uint16_t, reduce16Sse41>};
+        // The histogram dominates already with AVX2
+        static const StatisticsKernels avx2StatisticsKernels = {statisticsBlocks<uint8_t, reduce8Avx2>,
+                                                                statisticsBlocks<uint16_t, reduce16Avx2>};
+
+#endif
+
+
+        const StatisticsKernels& getStatisticsKernels(SimdLevel level) {
+#ifdef KARABO_KERNELS_X86
+            switch (level) {
+                case SimdLevel::AVX512BW:
+                case SimdLevel::AVX2:
+                    return avx2StatisticsKernels;
+                case SimdLevel::SSE41:
+                    return sse41StatisticsKernels;
+                default:
+                    break;
+            }
+#endif
+            return scalarStatisticsKernels;
+        }
+
+
+        const StatisticsKernels& getStatisticsKernels() {
+            // Thread-safe initialization, done once
+            static const StatisticsKernels& kernels = getStatisticsKernels(detectSimdLevel());
+            return kernels;
+        }
+
+
+        void accumulateStatistics(const uint32_t* pixels, size_t n_pixels, uint32_t saturation, int histogramShift,
+                                  PixelStatistics& statistics) {
+            statisticsBlocks<uint32_t, reduceScalar<uint32_t>>(pixels, n_pixels, saturation, histogramShift,
+                                                                statistics);
+        }
+
+
+        // Accumulation: the sums re-use the widening adds of the binning, the moving averages are updated in
+        // single precision, without fused multiply-adds, thus all the instruction sets give the same results.
+
+        template <class T>
+        static void ewmaScalar(const T* pixels, size_t n_pixels, float weight, float* average) {
+            for (size_t i = 0; i < n_pixels; ++i) {
+                average[i] += weight * (static_cast<float>(pixels[i]) - average[i]);
+            }
+        }
+
+        static const AccumulateKernels scalarAccumulateKernels = {accumulateRow8Scalar, accumulateRow16Scalar,
+                                                                  ewmaScalar<uint8_t>, ewmaScalar<uint16_t>};
+
+#ifdef KARABO_KERNELS_X86
+
+        __attribute__((target("sse4.1"))) static inline void ewma4Sse41(__m128i pixels, __m128 weight,
+                                                                        float* average) {
+            const __m128 previous = _mm_loadu_ps(average);
+            const __m128 difference = _mm_sub_ps(_mm_cvtepi32_ps(pixels), previous);
+            _mm_storeu_ps(average, _mm_add_ps(previous, _mm_mul_ps(weight, difference)));
+        }
+
+
+        __attribute__((target("sse4.1"))) static void ewma8Sse41(const uint8_t* pixels, size_t n_pixels,
+                                                                 float weight, float* average) {
+            const __m128 w = _mm_set1_ps(weight);
+            size_t i = 0;
+            for (; i + 16 <= n_pixels; i += 16) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+                ewma4Sse41(_mm_cvtepu8_epi32(in), w, average + i);
+                ewma4Sse41(_mm_cvtepu8_epi32(_mm_srli_si128(in, 4)), w, average + i + 4);
+                ewma4Sse41(_mm_cvtepu8_epi32(_mm_srli_si128(in, 8)), w, average + i + 8);
+                ewma4Sse41(_mm_cvtepu8_epi32(_mm_srli_si128(in, 12)), w, average + i + 12);
+            }
+            ewmaScalar(pixels + i, n_pixels - i, weight, average + i);
+        }
+
+
+        __attribute__((target("sse4.1"))) static void ewma16Sse41(const uint16_t* pixels, size_t n_pixels,
+                                                                  float weight, float* average) {
+            const __m128 w = _mm_set1_ps(weight);
+            size_t i = 0;
+            for (; i + 8 <= n_pixels; i += 8) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+                ewma4Sse41(_mm_cvtepu16_epi32(in), w, average + i);
+                ewma4Sse41(_mm_cvtepu16_epi32(_mm_srli_si128(in, 8)), w, average + i + 4);
+            }
+            ewmaScalar(pixels + i, n_pixels - i, weight, average + i);
+        }
+
+
+        __attribute__((target("avx2"))) static inline void ewma8Avx2(__m256i pixels, __m256 weight, float* average) {
+            const __m256 previous = _mm256_loadu_ps(average);
+            const __m256 difference = _mm256_sub_ps(_mm256_cvtepi32_ps(pixels), previous);
+            _mm256_storeu_ps(average, _mm256_add_ps(previous, _mm256_mul_ps(weight, difference)));
+        }
+
+
+        __attribute__((target("avx2"))) static void ewma8Avx2(const uint8_t* pixels, size_t n_pixels, float weight,
+                                                              float* average) {
+            const __m256 w = _mm256_set1_ps(weight);
+            size_t i = 0;
+            for (; i + 16 <= n_pixels; i += 16) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+                ewma8Avx2(_mm256_cvtepu8_epi32(in), w, average + i);
+                ewma8Avx2(_mm256_cvtepu8_epi32(_mm_srli_si128(in, 8)), w, average + i + 8);
+            }
+            ewma8Sse41(pixels + i, n_pixels - i, weight, average + i);
+        }
+
+
+        __attribute__((target("avx2"))) static void ewma16Avx2(const uint16_t* pixels, size_t n_pixels, float weight,
+                                                               float* average) {
+            const __m256 w = _mm256_set1_ps(weight);
+            size_t i = 0;
+            for (; i + 16 <= n_pixels; i += 16) {
+                const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + i));
+                ewma8Avx2(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(in)), w, average + i);
+                ewma8Avx2(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(in, 1)), w, average + i + 8);
+            }
+            ewma16Sse41(pixels + i, n_pixels - i, weight, average + i);
+        }
+
+        static const AccumulateKernels sse41AccumulateKernels = {accumulateRow8Sse41, accumulateRow16Sse41,
+                                                                 ewma8Sse41, ewma16Sse41};
+        // Bound by the memory bandwidth, as the binning
+        static const AccumulateKernels avx2AccumulateKernels = {accumulateRow8Avx2, accumulateRow16Avx2, ewma8Avx2,
+                                                                ewma16Avx2};
+
+#endif
+
+
+        const AccumulateKernels& getAccumulateKernels(SimdLevel level) {
+#ifdef KARABO_KERNELS_X86
+            switch (level) {
+                case SimdLevel::AVX512BW:
+                case SimdLevel::AVX2:
+                    return avx2AccumulateKernels;
+                case SimdLevel::SSE41:
+                    return sse41AccumulateKernels;
+                default:
+                    break;
+            }
+#endif
+            return scalarAccumulateKernels;
+        }
+
+
+        const AccumulateKernels& getAccumulateKernels() {
+            // Thread-safe initialization, done once
+            static const AccumulateKernels& kernels = getAccumulateKernels(detectSimdLevel());
+            return kernels;
+        }
+
+
+        void accumulateSum(const uint32_t* pixels, size_t n_pixels, uint64_t* sums) {
+            for (size_t i = 0; i < n_pixels; ++i) {
+                sums[i] += pixels[i];
+            }
+        }
+
+
+        void accumulateEwma(const uint32_t* pixels, size_t n_pixels, float weight, float* average) {
+            ewmaScalar(pixels, n_pixels, weight, average);
+        }
+
+
+        // Correction: the same single precision operations in the same order for all the instruction sets, and
+        // the conversion rounds to nearest even as std::lrint, thus the results are the same.
+
+        template <class T>
+        static void correctScalar(const T* pixels, size_t n_pixels, const float* dark, const float* gain,
+                                  float maxValue, uint16_t* corrected) {
+            for (size_t i = 0; i < n_pixels; ++i) {
+                const float value = (static_cast<float>(pixels[i]) - dark[i]) * gain[i];
+                corrected[i] = static_cast<uint16_t>(std::lrint(std::min(std::max(value, 0.f), maxValue)));
+            }
+        }
+
+
+        template <class T>
+        static void correctFloatScalar(const T* pixels, size_t n_pixels, const float* dark, const float* gain,
+                                       float* corrected) {
+            for (size_t i = 0; i < n_pixels; ++i) {
+                corrected[i] = (static_cast<float>(pixels[i]) - dark[i]) * gain[i];
+            }
+        }
+
+        static const CorrectionKernels scalarCorrectionKernels = {correctScalar<uint8_t>, correctScalar<uint16_t>,
+                                                                  correctFloatScalar<uint8_t>,
+                                                                  correctFloatScalar<uint16_t>};
+
+#ifdef KARABO_KERNELS_X86
+
+        // Correct 4 pixels widened to 32 bits
+        __attribute__((target("sse4.1"))) static inline __m128 correct4Sse41(__m128i pixels, const float* dark,
+                                                                             const float* gain) {
+            const __m128 value = _mm_sub_ps(_mm_cvtepi32_ps(pixels), _mm_loadu_ps(dark));
+            return _mm_mul_ps(value, _mm_loadu_ps(gain));
+        }
+
+
+        __attribute__((target("sse4.1"))) static inline __m128i clamp4Sse41(__m128 value, __m128 maxValue) {
+            return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), maxValue));
+        }
+
+
+        __attribute__((target("sse4.1"))) static void correct8Sse41(const uint8_t* pixels, size_t n_pixels,
+                                                                    const float* dark, const float* gain,
+                                                                    float maxValue, uint16_t* corrected) {
+            const __m128 max = _mm_set1_ps(maxValue);
+            size_t i = 0;
+            for (; i + 8 <= n_pixels; i += 8) {
+                const __m128i in = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixels + i));
+                const __m128i lo = clamp4Sse41(correct4Sse41(_mm_cvtepu8_epi32(in), dark + i, gain + i), max);
+                const __m128i hi =
+                      clamp4Sse41(correct4Sse41(_mm_cvtepu8_epi32(_mm_srli_si128(in, 4)), dark + i + 4, gain + i + 4),
+                                  max);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(corrected + i), _mm_packus_epi32(lo, hi));
+            }
+            correctScalar(pixels + i, n_pixels - i, dark + i, gain + i, maxValue, corrected + i);
+        }
+
+
+        __attribute__((target("sse4.1"))) static void correct16Sse41(const uint16_t* pixels, size_t n_pixels,
+                                                                     const float* dark, const float* gain,
+                                                                     float maxValue, uint16_t* corrected) {
+            const __m128 max = _mm_set1_ps(maxValue);
+            size_t i = 0;
+            for (; i + 8 <= n_pixels; i += 8) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+                const __m128i lo = clamp4Sse41(correct4Sse41(_mm_cvtepu16_epi32(in), dark + i, gain + i), max);
+                const __m128i hi =
+                      clamp4Sse41(correct4Sse41(_mm_cvtepu16_epi32(_mm_srli_si128(in, 8)), dark + i + 4, gain + i + 4),
+                                  max);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(corrected + i), _mm_packus_epi32(lo, hi));
+            }
+            correctScalar(pixels + i, n_pixels - i, dark + i, gain + i, maxValue, corrected + i);
+        }
+
+
+        __attribute__((target("sse4.1"))) static void correctFloat8Sse41(const uint8_t* pixels, size_t n_pixels,
+                                                                         const float* dark, const float* gain,
+                                                                         float* corrected) {
+            size_t i = 0;
+            for (; i + 8 <= n_pixels; i += 8) {
+                const __m128i in = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixels + i));
+                _mm_storeu_ps(corrected + i, correct4Sse41(_mm_cvtepu8_epi32(in), dark + i, gain + i));
+                _mm_storeu_ps(corrected + i + 4,
+                              correct4Sse41(_mm_cvtepu8_epi32(_mm_srli_si128(in, 4)), dark + i + 4, gain + i + 4));
+            }
+            correctFloatScalar(pixels + i, n_pixels - i, dark + i, gain + i, corrected + i);
+        }
+
+
+        __attribute__((target("sse4.1"))) static void correctFloat16Sse41(const uint16_t* pixels, size_t n_pixels,
+                                                                          const float* dark, const float* gain,
+                                                                          float* corrected) {
+            size_t i = 0;
+            for (; i + 8 <= n_pixels; i += 8) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+                _mm_storeu_ps(corrected + i, correct4Sse41(_mm_cvtepu16_epi32(in), dark + i, gain + i));
+                _mm_storeu_ps(corrected + i + 4,
+                              correct4Sse41(_mm_cvtepu16_epi32(_mm_srli_si128(in, 8)), dark + i + 4, gain + i + 4));
+            }
+            correctFloatScalar(pixels + i, n_pixels - i, dark + i, gain + i, corrected + i);
+        }
+
+
+        // Correct 8 pixels widened to 32 bits
+        __attribute__((target("avx2"))) static inline __m256 correct8Avx2(__m256i pixels, const float* dark,
+                                                                          const float* gain) {
+            const __m256 value = _mm256_sub_ps(_mm256_cvtepi32_ps(pixels), _mm256_loadu_ps(dark));
+            return _mm256_mul_ps(value, _mm256_loadu_ps(gain));
+        }
+
+
+        __attribute__((target("avx2"))) static inline __m256i clamp8Avx2(__m256 value, __m256 maxValue) {
+            return _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), maxValue));
+        }
+
+
+        // Pack two groups of 8 32-bit values to 16 bits, in order: the packing works in 128-bit lanes
+        __attribute__((target("avx2"))) static inline void storePacked16Avx2(__m256i lo, __m256i hi,
+                                                                             uint16_t* out) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+                                _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xD8));
+        }
+
+
+        __attribute__((target("avx2"))) static void correct8Avx2(const uint8_t* pixels, size_t n_pixels,
+                                                                 const float* dark, const float* gain, float maxValue,
+                                                                 uint16_t* corrected) {
+            const __m256 max = _mm256_set1_ps(maxValue);
+            size_t i = 0;
+            for (; i + 16 <= n_pixels; i += 16) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+                const __m256i lo = clamp8Avx2(correct8Avx2(_mm256_cvtepu8_epi32(in), dark + i, gain + i), max);
+                const __m256i hi = clamp8Avx2(
+                      correct8Avx2(_mm256_cvtepu8_epi32(_mm_srli_si128(in, 8)), dark + i + 8, gain + i + 8), max);
+                storePacked16Avx2(lo, hi, corrected + i);
+            }
+            correct8Sse41(pixels + i, n_pixels - i, dark + i, gain + i, maxValue, corrected + i);
+        }
+
+
+        __attribute__((target("avx2"))) static void correct16Avx2(const uint16_t* pixels, size_t n_pixels,
+                                                                  const float* dark, const float* gain,
+                                                                  float maxValue, uint16_t* corrected) {
+            const __m256 max = _mm256_set1_ps(maxValue);
+            size_t i = 0;
+            for (; i + 16 <= n_pixels; i += 16) {
+                const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + i));
+                const __m256i lo = clamp8Avx2(
+                      correct8Avx2(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(in)), dark + i, gain + i), max);
+                const __m256i hi = clamp8Avx2(
+                      correct8Avx2(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(in, 1)), dark + i + 8, gain + i + 8),
+                      max);
+                storePacked16Avx2(lo, hi, corrected + i);
+            }
+            correct16Sse41(pixels + i, n_pixels - i, dark + i, gain + i, maxValue, corrected + i);
+        }
+
+
+        __attribute__((target("avx2"))) static void correctFloat8Avx2(const uint8_t* pixels, size_t n_pixels,
+                                                                      const float* dark, const float* gain,
+                                                                      float* corrected) {
+            size_t i = 0;
+            for (; i + 16 <= n_pixels; i += 16) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+                _mm256_storeu_ps(corrected + i, correct8Avx2(_mm256_cvtepu8_epi32(in), dark + i, gain + i));
+                _mm256_storeu_ps(corrected + i + 8, correct8Avx2(_mm256_cvtepu8_epi32(_mm_srli_si128(in, 8)),
+                                                                 dark + i + 8, gain + i + 8));
+            }
+            correctFloat8Sse41(pixels + i, n_pixels - i, dark + i, gain + i, corrected + i);
+        }
+
+
+        __attribute__((target("avx2"))) static void correctFloat16Avx2(const uint16_t* pixels, size_t n_pixels,
+                                                                       const float* dark, const float* gain,
+                                                                       float* corrected) {
+            size_t i = 0;
+            for (; i + 16 <= n_pixels; i += 16) {
+                const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + i));
+                _mm256_storeu_ps(corrected + i,
+                                 correct8Avx2(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(in)), dark + i, gain + i));
+                _mm256_storeu_ps(corrected + i + 8, correct8Avx2(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(in, 1)),
+                                                                 dark + i + 8, gain + i + 8));
+            }
+            correctFloat16Sse41(pixels + i, n_pixels - i, dark + i, gain + i, corrected + i);
+        }
+
+        static const CorrectionKernels sse41CorrectionKernels = {correct8Sse41, correct16Sse41, correctFloat8Sse41,
+                                                                 correctFloat16Sse41};
+        // Bound by the memory bandwidth, the dark and gain maps being read for every image
+        static const CorrectionKernels avx2CorrectionKernels = {correct8Avx2, correct16Avx2, correctFloat8Avx2,
+                                                                correctFloat16Avx2};
+
+#endif
+
+
+        const CorrectionKernels& getCorrectionKernels(SimdLevel level) {
+#ifdef KARABO_KERNELS_X86
+            switch (level) {
+                case SimdLevel::AVX512BW:
+                case SimdLevel::AVX2:
+                    return avx2CorrectionKernels;
+                case SimdLevel::SSE41:
+                    return sse41CorrectionKernels;
+                default:
+                    break;
+            }
+#endif
+            return scalarCorrectionKernels;
+        }
+
+
+        const CorrectionKernels& getCorrectionKernels() {
+            // Thread-safe initialization, done once
+            static const CorrectionKernels& kernels = getCorrectionKernels(detectSimdLevel());
+            return kernels;
+        }
+
+
+        void correctPixels(const uint32_t* pixels, size_t n_pixels, const float* dark, const float* gain,
+                           float maxValue, uint16_t* corrected) {
+            correctScalar(pixels, n_pixels, dark, gain, maxValue, corrected);
+        }
+
+
+        void correctPixels(const uint32_t* pixels, size_t n_pixels, const float* dark, const float* gain,
+                           float* corrected) {
+            correctFloatScalar(pixels, n_pixels, dark, gain, corrected);
+        }
+
+
+        // Bitshuffle: the SIMD kernels gather the bytes of 16 or 32 pixels, then extract each bit of them with a
+        // movemask and a byte-wise shift, from the most significant one.
+
+        template <class T>
+        static void bitshuffleScalar(const T* pixels, size_t n_pixels, uint8_t* const* planes) {
+            for (size_t j = 0; 8 * j < n_pixels; ++j) {
+                const size_t count = std::min<size_t>(8, n_pixels - 8 * j);
+                for (size_t b = 0; b < 8 * sizeof(T); ++b) {
+                    uint8_t byte = 0;
+                    for (size_t k = 0; k < count; ++k) {
+                        byte |= ((pixels[8 * j + k] >> b) & 1) << k;
+                    }
+                    planes[b][j] = byte;
+                }
+            }
+        }
+
+        static const BitshuffleKernels scalarBitshuffleKernels = {bitshuffleScalar<uint8_t>,
+                                                                  bitshuffleScalar<uint16_t>};
+
+#ifdef KARABO_KERNELS_X86
+
+        // Write bit b of 16 bytes to planes[b + first] at byte offset, for b = 7..0
+        __attribute__((target("sse4.1"))) static inline void movemask16Sse41(__m128i bytes, uint8_t* const* planes,
+                                                                             size_t offset) {
+            for (int b = 7; b >= 0; --b) {
+                const uint16_t bits = _mm_movemask_epi8(bytes);
+                std::memcpy(planes[b] + offset, &bits, sizeof(bits));
+                bytes = _mm_add_epi8(bytes, bytes);
+            }
+        }
+
+
+        __attribute__((target("sse4.1"))) static void bitshuffle8Sse41(const uint8_t* pixels, size_t n_pixels,
+                                                                       uint8_t* const* planes) {
+            size_t i = 0;
+            for (; i + 16 <= n_pixels; i += 16) {
+                movemask16Sse41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i)), planes, i / 8);
+            }
+            uint8_t* const tail[8] = {planes[0] + i / 8, planes[1] + i / 8, planes[2] + i / 8, planes[3] + i / 8,
+                                      planes[4] + i / 8, planes[5] + i / 8, planes[6] + i / 8, planes[7] + i / 8};
+            bitshuffleScalar(pixels + i, n_pixels - i, tail);
+        }
+
+
+        __attribute__((target("sse4.1"))) static void bitshuffle16Sse41(const uint16_t* pixels, size_t n_pixels,
+                                                                        uint8_t* const* planes) {
+            const __m128i lowMask = _mm_set1_epi16(0x00FF);
+            size_t i = 0;
+            for (; i + 16 <= n_pixels; i += 16) {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i + 8));
+                const __m128i low = _mm_packus_epi16(_mm_and_si128(a, lowMask), _mm_and_si128(b, lowMask));
+                const __m128i high = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+                movemask16Sse41(low, planes, i / 8);
+                movemask16Sse41(high, planes + 8, i / 8);
+            }
+            uint8_t* tail[16];
+            for (int b = 0; b < 16; ++b) tail[b] = planes[b] + i / 8;
+            bitshuffleScalar(pixels + i, n_pixels - i, tail);
+        }
+
+
+        __attribute__((target("avx2"))) static inline void movemask32Avx2(__m256i bytes, uint8_t* const* planes,
+                                                                          size_t offset) {
+            for (int b = 7; b >= 0; --b) {
+                const uint32_t bits = _mm256_movemask_epi8(bytes);
+                std::memcpy(planes[b] + offset, &bits, sizeof(bits));
+                bytes = _mm256_add_epi8(bytes, bytes);
+            }
+        }
+
+
+        __attribute__((target("avx2"))) static void bitshuffle8Avx2(const uint8_t* pixels, size_t n_pixels,
+                                                                    uint8_t* const* planes) {
+            size_t i = 0;
+            for (; i + 32 <= n_pixels; i += 32) {
+                movemask32Avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + i)), planes, i / 8);
+            }
+            uint8_t* const tail[8] = {planes[0] + i / 8, planes[1] + i / 8, planes[2] + i / 8, planes[3] + i / 8,
+                                      planes[4] + i / 8, planes[5] + i / 8, planes[6] + i / 8, planes[7] + i / 8};
+            bitshuffle8Sse41(pixels + i, n_pixels - i, tail);
+        }
+
+
+        __attribute__((target("avx2"))) static void bitshuffle16Avx2(const uint16_t* pixels, size_t n_pixels,
+                                                                     uint8_t* const* planes) {
+            const __m256i lowMask = _mm256_set1_epi16(0x00FF);
+            size_t i = 0;
+            for (; i + 32 <= n_pixels; i += 32) {
+                const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + i));
+                const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + i + 16));
+                // The packing works in 128-bit lanes: the quarters are permuted back in order
+                const __m256i low = _mm256_permute4x64_epi64(
+                      _mm256_packus_epi16(_mm256_and_si256(a, lowMask), _mm256_and_si256(b, lowMask)), 0xD8);
+                const __m256i high = _mm256_permute4x64_epi64(
+                      _mm256_packus_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8)), 0xD8);
+                movemask32Avx2(low, planes, i / 8);
+                movemask32Avx2(high, planes + 8, i / 8);
+            }
+            uint8_t* tail[16];
+            for (int b = 0; b < 16; ++b) tail[b] = planes[b] + i / 8;
+            bitshuffle16Sse41(pixels + i, n_pixels - i, tail);
+        }
+
+        static const BitshuffleKernels sse41BitshuffleKernels = {bitshuffle8Sse41, bitshuffle16Sse41};
+        static const BitshuffleKernels avx2BitshuffleKernels = {bitshuffle8Avx2, bitshuffle16Avx2};
+
+#endif
+
+
+        const BitshuffleKernels& getBitshuffleKernels(SimdLevel level) {
+#ifdef KARABO_KERNELS_X86
+            switch (level) {
+                case SimdLevel::AVX512BW:
+                case SimdLevel::AVX2:
+                    return avx2BitshuffleKernels;
+                case SimdLevel::SSE41:
+                    return sse41BitshuffleKernels;
+                default:
+                    break;
+            }
+#endif
+            return scalarBitshuffleKernels;
+        }
+
+
+        const BitshuffleKernels& getBitshuffleKernels() {
+            // Thread-safe initialization, done once
+            static const BitshuffleKernels& kernels = getBitshuffleKernels(detectSimdLevel());
+            return kernels;
+        }
+
+
+        Orientation getOrientation(int width, int height, bool flipX, bool flipY, unsigned int rotation) {
+            // Transform a small probe image, whose pixel values are their source indices, to find out
+            // where the pixels (0, 0), (0, 1) and (1, 0) go. The result is then scaled to the actual size.
+            const size_t probeHeight = 2;
+            const size_t probeWidth = 3;
+            std::vector<uint16_t> probe(probeHeight * probeWidth);
+            for (size_t i = 0; i < probe.size(); ++i) probe[i] = i;
+
+            karabo::data::NDArray array(probe.data(), probe.size(), karabo::data::NDArray::NullDeleter(),
+                                        karabo::data::Dims(probeHeight, probeWidth));
+            if (flipX || flipY) {
+                util::flip_image<uint16_t>(array, flipX, flipY);
+            }
+            if (rotation != 0) {
+                util::rotate_image<uint16_t>(array, rotation);
+            }
+
+            const size_t outWidth = array.getShape().x2();
+            const uint16_t* out = array.getData<uint16_t>();
+            // (row, column) in the transformed probe of the source pixel at index value
+            const auto locate = [out, outWidth, &probe](uint16_t value) {
+                const size_t index = std::find(out, out + probe.size(), value) - out;
+                return std::make_pair(ptrdiff_t(index / outWidth), ptrdiff_t(index % outWidth));
+            };
+            const auto p00 = locate(0);
+            const auto p01 = locate(1);
+            const auto p10 = locate(probeWidth);
+            // Unit steps in the output, when moving along x and y in the source
+            const ptrdiff_t dxRow = p01.first - p00.first, dxCol = p01.second - p00.second;
+            const ptrdiff_t dyRow = p10.first - p00.first, dyCol = p10.second - p00.second;
+
+            // Output size of the actual image
+            const bool transposed = (dxRow != 0);
+            const ptrdiff_t outH = transposed ? width : height;
+            const ptrdiff_t outW = transposed ? height : width;
+
+            // The source origin goes to the first or last row/column, depending on the direction of the steps
+            const ptrdiff_t originRow = (dxRow + dyRow < 0) ? outH - 1 : 0;
+            const ptrdiff_t originCol = (dxCol + dyCol < 0) ? outW - 1 : 0;
+
+            Orientation orientation;
+            orientation.origin = originRow * outW + originCol;
+            orientation.strideX = dxRow * outW + dxCol;
+            orientation.strideY = dyRow * outW + dyCol;
+            orientation.transposed = transposed;
+            return orientation;
+        }
+
+
+        void sourceRegion(const Orientation& orientation, int width, int height, int& x, int& y, int& regionWidth,
+                          int& regionHeight) {
+            if (regionWidth <= 0 || regionHeight <= 0) return;
+
+            const ptrdiff_t outW = orientation.transposed ? height : width;
+            const ptrdiff_t originRow = orientation.origin / outW;
+            const ptrdiff_t originCol = orientation.origin % outW;
+            // Source pixel (y, x) of the destination pixel (row, col): the steps along x and y are +-1 or +-outW
+            const auto source = [&orientation, outW, originRow, originCol](ptrdiff_t row, ptrdiff_t col) {
+                const ptrdiff_t dRow = row - originRow;
+                const ptrdiff_t dCol = col - originCol;
+                if (orientation.transposed) {
+                    return std::make_pair(dCol * orientation.strideY, dRow * orientation.strideX / outW);
+                }
+                return std::make_pair(dRow * orientation.strideY / outW, dCol * orientation.strideX);
+            };
+            const auto first = source(y, x);
+            const auto last = source(y + regionHeight - 1, x + regionWidth - 1);
+
+            y = std::min(first.first, last.first);
+            x = std::min(first.second, last.second);
+            if (orientation.transposed) {
+                std::swap(regionWidth, regionHeight);
+            }
+        }
+
+
+        // Copy the pixels of a block of the source image to their oriented positions.
+        // Rotations by 90 and 270 degrees are done in square tiles, transposed in registers for 8- and 16-bit
+        // pixels. The tiles are walked in bands of rows, such that each output row receives a contiguous run
+        // of pixels (at least a cache line) before moving to the next one.
+
+        static const size_t bandRows = 64;
+
+
+        // Copy pixel by pixel the source region [y0, y1) x [x0, x1)
+        template <size_t PixelBytes>
+        static void orientRegion(const uint8_t* src, size_t width, size_t y0, size_t y1, size_t x0, size_t x1,
+                                 ptrdiff_t strideY, ptrdiff_t strideX, uint8_t* dst) {
+            for (size_t y = y0; y < y1; ++y) {
+                const uint8_t* in = src + (y * width + x0) * PixelBytes;
+                uint8_t* out = dst + (ptrdiff_t(y) * strideY + ptrdiff_t(x0) * strideX) * ptrdiff_t(PixelBytes);
+                for (size_t x = x0; x < x1; ++x, in += PixelBytes, out += strideX * ptrdiff_t(PixelBytes)) {
+                    std::memcpy(out, in, PixelBytes);
+                }
+            }
+        }
+
+
+        // Fallback for pixel sizes which are not instantiated
+        static void orientRegion(size_t pixelBytes, const uint8_t* src, size_t width, size_t y0, size_t y1,
+                                 size_t x0, size_t x1, ptrdiff_t strideY, ptrdiff_t strideX, uint8_t* dst) {
+            for (size_t y = y0; y < y1; ++y) {
+                for (size_t x = x0; x < x1; ++x) {
+                    std::memcpy(dst + (ptrdiff_t(y) * strideY + ptrdiff_t(x) * strideX) * ptrdiff_t(pixelBytes),
+                                src + (y * width + x) * pixelBytes, pixelBytes);
+                }
+            }
+        }
+
+
+#ifdef KARABO_KERNELS_X86
+
+        // Transpose an 8x8 tile of 16-bit pixels. The source rows are read in reversed order if strideY < 0,
+        // such that the output runs are always written in increasing addresses.
+        static inline void transposeTile16(const uint8_t* src, size_t srcPitch, uint8_t* dst, ptrdiff_t dstPitch,
+                                           bool reverse) {
+            __m128i r[8];
+            for (int i = 0; i < 8; ++i) {
+                const int row = reverse ? 7 - i : i;
+                r[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + row * srcPitch));
+            }
+            const __m128i a0 = _mm_unpacklo_epi16(r[0], r[1]), a1 = _mm_unpackhi_epi16(r[0], r[1]);
+            const __m128i a2 = _mm_unpacklo_epi16(r[2], r[3]), a3 = _mm_unpackhi_epi16(r[2], r[3]);
+            const __m128i a4 = _mm_unpacklo_epi16(r[4], r[5]), a5 = _mm_unpackhi_epi16(r[4], r[5]);
+            const __m128i a6 = _mm_unpacklo_epi16(r[6], r[7]), a7 = _mm_unpackhi_epi16(r[6], r[7]);
+            const __m128i b0 = _mm_unpacklo_epi32(a0, a2), b1 = _mm_unpackhi_epi32(a0, a2);
+            const __m128i b2 = _mm_unpacklo_epi32(a1, a3), b3 = _mm_unpackhi_epi32(a1, a3);
+            const __m128i b4 = _mm_unpacklo_epi32(a4, a6), b5 = _mm_unpackhi_epi32(a4, a6);
+            const __m128i b6 = _mm_unpacklo_epi32(a5, a7), b7 = _mm_unpackhi_epi32(a5, a7);
+            const __m128i c[8] = {_mm_unpacklo_epi64(b0, b4), _mm_unpackhi_epi64(b0, b4),
+                                  _mm_unpacklo_epi64(b1, b5), _mm_unpackhi_epi64(b1, b5),
+                                  _mm_unpacklo_epi64(b2, b6), _mm_unpackhi_epi64(b2, b6),
+                                  _mm_unpacklo_epi64(b3, b7), _mm_unpackhi_epi64(b3, b7)};
+            for (int j = 0; j < 8; ++j) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + j * dstPitch), c[j]);
+            }
+        }
+
+
+        // Transpose a 16x16 tile of 8-bit pixels, see transposeTile16
+        static inline void transposeTile8(const uint8_t* src, size_t srcPitch, uint8_t* dst, ptrdiff_t dstPitch,
+                                          bool reverse) {
+            __m128i a[16], b[16];
+            for (int i = 0; i < 16; ++i) {
+                const int row = reverse ? 15 - i : i;
+                a[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + row * srcPitch));
+            }
+            for (int i = 0; i < 8; ++i) {
+                b[i] = _mm_unpacklo_epi8(a[2 * i], a[2 * i + 1]);
+                b[i + 8] = _mm_unpackhi_epi8(a[2 * i], a[2 * i + 1]);
+            }
+            for (int i = 0; i < 8; ++i) {
+                a[i] = _mm_unpacklo_epi16(b[2 * i], b[2 * i + 1]);
+                a[i + 8] = _mm_unpackhi_epi16(b[2 * i], b[2 * i + 1]);
+            }
+            for (int i = 0; i < 8; ++i) {
+                b[i] = _mm_unpacklo_epi32(a[2 * i], a[2 * i + 1]);
+                b[i + 8] = _mm_unpackhi_epi32(a[2 * i], a[2 * i + 1]);
+            }
+            for (int i = 0; i < 8; ++i) {
+                a[i] = _mm_unpacklo_epi64(b[2 * i], b[2 * i + 1]);
+                a[i + 8] = _mm_unpackhi_epi64(b[2 * i], b[2 * i + 1]);
+            }
+            // After the four interleaving stages, the output row j is in a[k] with k the 4-bit reversal of j
+            static const int bitReversed[16] = {0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15};
+            for (int j = 0; j < 16; ++j) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + j * dstPitch), a[bitReversed[j]]);
+            }
+        }
+
+
+        // Rotate by 90 or 270 degrees with in-register transposes of Tile x Tile pixels
+        template <size_t PixelBytes, size_t Tile, void (*Transpose)(const uint8_t*, size_t, uint8_t*, ptrdiff_t, bool)>
+        static void transposeBlock(const uint8_t* src, size_t width, size_t rows, ptrdiff_t strideY,
+                                   ptrdiff_t strideX, uint8_t* dst) {
+            const size_t fullRows = rows - rows % Tile;
+            const size_t fullCols = width - width % Tile;
+            const bool reverse = (strideY < 0);
+
+            for (size_t y0 = 0; y0 < fullRows; y0 += bandRows) {
+                const size_t y1 = std::min(fullRows, y0 + bandRows);
+                for (size_t x = 0; x < fullCols; x += Tile) {
+                    for (size_t y = y0; y < y1; y += Tile) {
+                        // First source row of the tile in the output order
+                        const size_t firstRow = reverse ? y + Tile - 1 : y;
+                        uint8_t* out = dst + (ptrdiff_t(firstRow) * strideY + ptrdiff_t(x) * strideX) *
+                                                   ptrdiff_t(PixelBytes);
+                        Transpose(src + (y * width + x) * PixelBytes, width * PixelBytes, out,
+                                  strideX * ptrdiff_t(PixelBytes), reverse);
+                    }
+                }
+            }
+
+            // Borders which do not fill a tile
+            orientRegion<PixelBytes>(src, width, 0, fullRows, fullCols, width, strideY, strideX, dst);
+            orientRegion<PixelBytes>(src, width, fullRows, rows, 0, width, strideY, strideX, dst);
+        }
+
+#endif
+
+
+        // Rotate by 90 or 270 degrees in cache-sized tiles, pixel by pixel
+        template <size_t PixelBytes>
+        static void tileBlock(const uint8_t* src, size_t width, size_t rows, ptrdiff_t strideY, ptrdiff_t strideX,
+                              uint8_t* dst) {
+            const size_t tile = 16;
+            for (size_t y0 = 0; y0 < rows; y0 += bandRows) {
+                const size_t y1 = std::min(rows, y0 + bandRows);
+                for (size_t x0 = 0; x0 < width; x0 += tile) {
+                    orientRegion<PixelBytes>(src, width, y0, y1, x0, std::min(width, x0 + tile), strideY, strideX,
+                                             dst);
+                }
+            }
+        }
+
+
+        // Flip only, or rotation by 180 degrees: the rows are copied, reversed if needed
+        template <size_t PixelBytes>
+        static void copyRows(const uint8_t* src, size_t width, size_t rows, ptrdiff_t strideY, ptrdiff_t strideX,
+                             uint8_t* dst) {
+            for (size_t y = 0; y < rows; ++y) {
+                const uint8_t* in = src + y * width * PixelBytes;
+                uint8_t* out = dst + ptrdiff_t(y) * strideY * ptrdiff_t(PixelBytes);
+                if (strideX == 1) {
+                    std::memcpy(out, in, width * PixelBytes);
+                } else if (PixelBytes == 1) {
+                    std::reverse_copy(in, in + width, out - (width - 1));
+                } else if (PixelBytes == 2) {
+                    const uint16_t* in16 = reinterpret_cast<const uint16_t*>(in);
+                    std::reverse_copy(in16, in16 + width, reinterpret_cast<uint16_t*>(out) - (width - 1));
+                } else {
+                    orientRegion<PixelBytes>(in, width, 0, 1, 0, width, 0, strideX, out);
+                }
+            }
+        }
+
+
+        template <size_t PixelBytes>
+        static void orientBlock(const uint8_t* src, size_t width, size_t rows, ptrdiff_t strideY, ptrdiff_t strideX,
+                                uint8_t* dst) {
+            if (strideX == 1 || strideX == -1) {
+                copyRows<PixelBytes>(src, width, rows, strideY, strideX, dst);
+                return;
+            }
+#ifdef KARABO_KERNELS_X86
+            if (PixelBytes == 1) {
+                transposeBlock<1, 16, transposeTile8>(src, width, rows, strideY, strideX, dst);
+                return;
+            } else if (PixelBytes == 2) {
+                transposeBlock<2, 8, transposeTile16>(src, width, rows, strideY, strideX, dst);
+                return;
+            }
+#endif
+            tileBlock<PixelBytes>(src, width, rows, strideY, strideX, dst);
+        }
+
+
+        // Orient rows of the source image, dst pointing to the output position of the first source pixel
+        static void orientBlock(size_t pixelBytes, const uint8_t* src, size_t width, size_t rows, ptrdiff_t strideY,
+                                ptrdiff_t strideX, uint8_t* dst) {
+            switch (pixelBytes) {
+                case 1:
+                    return orientBlock<1>(src, width, rows, strideY, strideX, dst);
+                case 2:
+                    return orientBlock<2>(src, width, rows, strideY, strideX, dst);
+                case 3: // RGB8
+                    return orientBlock<3>(src, width, rows, strideY, strideX, dst);
+                case 4: // YUV422 8-bit, or two 16-bit channels
+                    return orientBlock<4>(src, width, rows, strideY, strideX, dst);
+                case 6: // RGB16
+                    return orientBlock<6>(src, width, rows, strideY, strideX, dst);
+                default:
+                    return orientRegion(pixelBytes, src, width, 0, rows, 0, width, strideY, strideX, dst);
+            }
+        }
+
+
+        void orientImage(const void* image, int width, int height, size_t pixelBytes, const Orientation& orientation,
+                         void* oriented) {
+            orientBlock(pixelBytes, static_cast<const uint8_t*>(image), width, height, orientation.strideY,
+                        orientation.strideX,
+                        static_cast<uint8_t*>(oriented) + orientation.origin * ptrdiff_t(pixelBytes));
+        }
+
+
+        void orientYuv422(const uint8_t* yuv, int width, int height, bool uyvy, const Orientation& orientation,
+                          uint8_t* oriented) {
+            const int luma = uyvy ? 1 : 0;
+            const int chroma = 1 - luma;
+            const size_t n_pixels = size_t(width) * height;
+
+            // The luma is moved pixel by pixel, each pixel taking the chroma (U, V) of its source pair along
+            std::vector<uint8_t> pixelChroma(2 * n_pixels);
+            for (int y = 0; y < height; ++y) {
+                const uint8_t* row = yuv + 2 * size_t(y) * width;
+                for (int x = 0; x < width; ++x) {
+                    const ptrdiff_t index = orientation.origin + y * orientation.strideY + x * orientation.strideX;
+                    const uint8_t* pair = row + 2 * (x & ~1);
+                    oriented[2 * index + luma] = row[2 * x + luma];
+                    pixelChroma[2 * index] = pair[chroma];
+                    // A last unpaired pixel has no V, it is taken as neutral
+                    pixelChroma[2 * index + 1] = ((x | 1) < width) ? pair[2 + chroma] : 128;
+                }
+            }
+
+            // Then the chroma is resampled by the pairs of the oriented image, starting at each row
+            const int outWidth = orientation.transposed ? height : width;
+            const int outHeight = orientation.transposed ? width : height;
+            for (int y = 0; y < outHeight; ++y) {
+                for (int x = 0; x < outWidth; x += 2) {
+                    const size_t index = size_t(y) * outWidth + x;
+                    const uint8_t* first = &pixelChroma[2 * index];
+                    if (x + 1 < outWidth) {
+                        oriented[2 * index + chroma] = (first[0] + first[2] + 1) / 2;
+                        oriented[2 * index + 2 + chroma] = (first[1] + first[3] + 1) / 2;
+                    } else {
+                        oriented[2 * index + chroma] = first[0];
+                    }
+                }
+            }
+        }
+
+
+        void unpackOriented(UnpackFunction unpack, size_t bits, const uint8_t* data, int width, int height,
+                            const Orientation& orientation, uint16_t* oriented) {
+            // A multiple of 4 rows starts on a byte boundary for all packed formats.
+            // The strip is a band of the tiled rotation, thus each output row receives a full cache line.
+            const size_t stripRows = bandRows;
+            thread_local std::vector<uint16_t> strip;
+            strip.resize(stripRows * width);
+
+            for (size_t y0 = 0; y0 < size_t(height); y0 += stripRows) {
+                const size_t rows = std::min(stripRows, height - y0);
+                unpack(data + y0 * width * bits / 8, rows * width, strip.data());
+
+                uint16_t* dst = oriented + orientation.origin + ptrdiff_t(y0) * orientation.strideY;
+                orientBlock<2>(reinterpret_cast<const uint8_t*>(strip.data()), width, rows, orientation.strideY,
+                               orientation.strideX, reinterpret_cast<uint8_t*>(dst));
+            }
+        }
+
+
+        void unpackStatistics(UnpackFunction unpack, size_t bits, const uint8_t* data, size_t n_pixels,
+                              uint32_t saturation, int histogramShift, uint16_t* unpacked,
+                              PixelStatistics& statistics) {
+            // A strip of a multiple of 4 pixels starts on a byte boundary for all packed formats
+            const StatisticsKernels& statisticsKernels = getStatisticsKernels();
+            for (size_t i = 0; i < n_pixels; i += statisticsBlock) {
+                const size_t n = std::min(statisticsBlock, n_pixels - i);
+                unpack(data + i * bits / 8, n, unpacked + i);
+                statisticsKernels.pixels16(unpacked + i, n, saturation, histogramShift, statistics);
+            }
+        }
+
+    } // namespace kernels
+
+} // namespace karabo
@@ -0,0 +1,376 @@
+/*
+ * Author: <parenti>
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#ifndef KARABO_IMAGEKERNELS_HH
+#define KARABO_IMAGEKERNELS_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace karabo {
+
+    namespace kernels {
+
+        // Instruction sets the kernels are compiled for, in increasing order
+        enum class SimdLevel { SCALAR, SSE41, AVX2, AVX512BW };
+
+        /**
+         * The best instruction set supported by both the CPU and the kernels.
+         */
+        SimdLevel detectSimdLevel();
+
+        const char* toString(SimdLevel level);
+
+        // Unpack n_pixels packed pixels to 16-bit pixels
+        typedef void (*UnpackFunction)(const uint8_t* data, size_t n_pixels, uint16_t* unpacked);
+
+        struct UnpackKernels {
+            UnpackFunction mono12Packed; // GigE Vision Mono12Packed, 2 pixels in 3 bytes, MSB first
+            UnpackFunction mono12p;      // PFNC Mono12p or Bayer**12p, 2 pixels in 3 bytes, LSB first
+            UnpackFunction mono10p;      // PFNC Mono10p or Bayer**10p, 4 pixels in 5 bytes, LSB first
+        };
+
+        /**
+         * The kernels for a given instruction set. The caller has to verify that the CPU supports it.
+         */
+        const UnpackKernels& getUnpackKernels(SimdLevel level);
+
+        /**
+         * The kernels for the best instruction set available, selected on first call.
+         */
+        const UnpackKernels& getUnpackKernels();
+
+        // Drop-in replacements of the imageSource routines, using the best kernels available
+        inline void unpackMono12Packed(const uint8_t* data, int width, int height, uint16_t* unpacked) {
+            getUnpackKernels().mono12Packed(data, size_t(width) * height, unpacked);
+        }
+
+        inline void unpackMono12p(const uint8_t* data, int width, int height, uint16_t* unpacked) {
+            getUnpackKernels().mono12p(data, size_t(width) * height, unpacked);
+        }
+
+        inline void unpackMono10p(const uint8_t* data, int width, int height, uint16_t* unpacked) {
+            getUnpackKernels().mono10p(data, size_t(width) * height, unpacked);
+        }
+
+        // The Bayer packed formats have the same bit layout as the Mono ones
+        inline void unpackBayer12p(const uint8_t* data, int width, int height, uint16_t* unpacked) {
+            getUnpackKernels().mono12p(data, size_t(width) * height, unpacked);
+        }
+
+        inline void unpackBayer10p(const uint8_t* data, int width, int height, uint16_t* unpacked) {
+            getUnpackKernels().mono10p(data, size_t(width) * height, unpacked);
+        }
+
+        // Convert n_pixels YUV 4:2:2 pixels (2 bytes per pixel, the chroma shared by pairs of pixels)
+        // to 8-bit RGB (3 bytes per pixel) or to 8-bit luma. The full-range ITU-R BT.601 matrix is used.
+        typedef void (*YuvFunction)(const uint8_t* yuv, size_t n_pixels, uint8_t* converted);
+
+        struct YuvKernels {
+            YuvFunction yuyvToRgb;  // YUYV byte order (aka YUY2): YCbCr422_8, YUV422_YUYV_Packed
+            YuvFunction uyvyToRgb;  // UYVY byte order: YUV422_Packed
+            YuvFunction yuyvToMono; // Luma only, extracted without any arithmetic
+            YuvFunction uyvyToMono;
+        };
+
+        /**
+         * The kernels for a given instruction set. The caller has to verify that the CPU supports it.
+         */
+        const YuvKernels& getYuvKernels(SimdLevel level);
+
+        /**
+         * The kernels for the best instruction set available, selected on first call.
+         */
+        const YuvKernels& getYuvKernels();
+
+        // Add a row of pixels to a row of 32-bit sums
+        typedef void (*AccumulateRow8Function)(const uint8_t* row, size_t n_pixels, uint32_t* sums);
+        typedef void (*AccumulateRow16Function)(const uint16_t* row, size_t n_pixels, uint32_t* sums);
+        // Add up groups of factor consecutive sums, for n_binned groups
+        typedef void (*ReduceRowFunction)(const uint32_t* sums, size_t n_binned, int factor, uint32_t* binned);
+
+        struct BinKernels {
+            AccumulateRow8Function accumulate8;
+            AccumulateRow16Function accumulate16;
+            ReduceRowFunction reduce; // Horizontal adds for factors 2 and 4, scalar for the others
+        };
+
+        /**
+         * The kernels for a given instruction set. The caller has to verify that the CPU supports it.
+         */
+        const BinKernels& getBinKernels(SimdLevel level);
+
+        /**
+         * The kernels for the best instruction set available, selected on first call.
+         */
+        const BinKernels& getBinKernels();
+
+        /**
+         * Bin an image by binX x binY pixels, using the best kernels available. The columns and rows which do not
+         * fill a whole bin are dropped, i.e. the binned image is width / binX pixels wide.
+         * Only the binned rows [rowBegin, rowEnd) are computed, thus stripes of rows can be binned in parallel.
+         * @param binned The sums of the pixels in each bin
+         */
+        void binSum(const uint8_t* image, int width, int binX, int binY, int rowBegin, int rowEnd, uint32_t* binned);
+        void binSum(const uint16_t* image, int width, int binX, int binY, int rowBegin, int rowEnd,
+                    uint32_t* binned);
+
+        /**
+         * As binSum, but each binned pixel is the rounded mean of the pixels in the bin, of the input type.
+         */
+        void binAverage(const uint8_t* image, int width, int binX, int binY, int rowBegin, int rowEnd,
+                        uint8_t* binned);
+        void binAverage(const uint16_t* image, int width, int binX, int binY, int rowBegin, int rowEnd,
+                        uint16_t* binned);
+
+        /**
+         * Downscale an image by averaging blocks of factor x factor pixels, e.g. for a preview. The channels of
+         * interleaved colour images are averaged separately, and the columns and rows which do not fill a whole
+         * block are dropped. Instantiated for 8-, 16- and 32-bit pixels, downscaled to the same type or to 8 bits.
+         * @param shift The rounded means are shifted right by this number of bits, e.g. 4 for 12-bit to 8-bit
+         * @param downscaled The output image, of size (height / factor) * (width / factor) * channels
+         */
+        template <class T, class Out>
+        void downscaleImage(const T* image, int width, int height, int channels, int factor, int shift,
+                            Out* downscaled);
+
+        // Number of bins of the coarse histogram of the pixel values
+        const int HISTOGRAM_BINS = 64;
+
+        // Statistics of the pixel values of an image, accumulated over parts of it.
+        // The channels of colour images are taken together.
+        struct PixelStatistics {
+            uint64_t count = 0;
+            uint64_t sum = 0;
+            uint32_t min = UINT32_MAX;
+            uint32_t max = 0;
+            uint64_t saturated = 0; // Pixels at or above the saturation value
+            // Bin i counts the values v with (v >> histogramShift) == i, the last bin also the larger values
+            uint64_t histogram[HISTOGRAM_BINS] = {};
+
+            // Add the statistics of another part of the image
+            void merge(const PixelStatistics& other);
+        };
+
+        // Accumulate the statistics of n_pixels pixels
+        typedef void (*Statistics8Function)(const uint8_t* pixels, size_t n_pixels, uint32_t saturation,
+                                            int histogramShift, PixelStatistics& statistics);
+        typedef void (*Statistics16Function)(const uint16_t* pixels, size_t n_pixels, uint32_t saturation,
+                                             int histogramShift, PixelStatistics& statistics);
+
+        struct StatisticsKernels {
+            Statistics8Function pixels8;
+            Statistics16Function pixels16;
+        };
+
+        /**
+         * The kernels for a given instruction set. The caller has to verify that the CPU supports it.
+         */
+        const StatisticsKernels& getStatisticsKernels(SimdLevel level);
+
+        /**
+         * The kernels for the best instruction set available, selected on first call.
+         */
+        const StatisticsKernels& getStatisticsKernels();
+
+        inline void accumulateStatistics(const uint8_t* pixels, size_t n_pixels, uint32_t saturation,
+                                         int histogramShift, PixelStatistics& statistics) {
+            getStatisticsKernels().pixels8(pixels, n_pixels, saturation, histogramShift, statistics);
+        }
+
+        inline void accumulateStatistics(const uint16_t* pixels, size_t n_pixels, uint32_t saturation,
+                                         int histogramShift, PixelStatistics& statistics) {
+            getStatisticsKernels().pixels16(pixels, n_pixels, saturation, histogramShift, statistics);
+        }
+
+        // 32-bit pixels, e.g. binned sums, are not vectorised
+        void accumulateStatistics(const uint32_t* pixels, size_t n_pixels, uint32_t saturation, int histogramShift,
+                                  PixelStatistics& statistics);
+
+        /**
+         * Unpack pixels and accumulate their statistics in one pass: the pixels are unpacked in strips which are
+         * still in cache when their statistics are accumulated.
+         * @param unpack The kernel unpacking bits-bit pixels
+         */
+        void unpackStatistics(UnpackFunction unpack, size_t bits, const uint8_t* data, size_t n_pixels,
+                              uint32_t saturation, int histogramShift, uint16_t* unpacked,
+                              PixelStatistics& statistics);
+
+        // Update the exponentially weighted moving average of n_pixels pixels:
+        // average += weight * (pixel - average)
+        typedef void (*Ewma8Function)(const uint8_t* pixels, size_t n_pixels, float weight, float* average);
+        typedef void (*Ewma16Function)(const uint16_t* pixels, size_t n_pixels, float weight, float* average);
+
+        struct AccumulateKernels {
+            AccumulateRow8Function sum8; // Add the pixels to 32-bit sums, as for the binning
+            AccumulateRow16Function sum16;
+            Ewma8Function ewma8;
+            Ewma16Function ewma16;
+        };
+
+        /**
+         * The kernels for a given instruction set. The caller has to verify that the CPU supports it.
+         */
+        const AccumulateKernels& getAccumulateKernels(SimdLevel level);
+
+        /**
+         * The kernels for the best instruction set available, selected on first call.
+         */
+        const AccumulateKernels& getAccumulateKernels();
+
+        inline void accumulateSum(const uint8_t* pixels, size_t n_pixels, uint32_t* sums) {
+            getAccumulateKernels().sum8(pixels, n_pixels, sums);
+        }
+
+        inline void accumulateSum(const uint16_t* pixels, size_t n_pixels, uint32_t* sums) {
+            getAccumulateKernels().sum16(pixels, n_pixels, sums);
+        }
+
+        inline void accumulateEwma(const uint8_t* pixels, size_t n_pixels, float weight, float* average) {
+            getAccumulateKernels().ewma8(pixels, n_pixels, weight, average);
+        }
+
+        inline void accumulateEwma(const uint16_t* pixels, size_t n_pixels, float weight, float* average) {
+            getAccumulateKernels().ewma16(pixels, n_pixels, weight, average);
+        }
+
+        // 32-bit pixels, e.g. binned sums, are not vectorised. They are added to 64-bit sums, not to overflow.
+        void accumulateSum(const uint32_t* pixels, size_t n_pixels, uint64_t* sums);
+        void accumulateEwma(const uint32_t* pixels, size_t n_pixels, float weight, float* average);
+
+        // Dark-frame subtraction and flat-field correction of n_pixels pixels: (pixel - dark) * gain, either
+        // rounded to nearest and clamped to [0, maxValue], or as floats
+        typedef void (*Correct8Function)(const uint8_t* pixels, size_t n_pixels, const float* dark, const float* gain,
+                                         float maxValue, uint16_t* corrected);
+        typedef void (*Correct16Function)(const uint16_t* pixels, size_t n_pixels, const float* dark,
+                                          const float* gain, float maxValue, uint16_t* corrected);
+        typedef void (*CorrectFloat8Function)(const uint8_t* pixels, size_t n_pixels, const float* dark,
+                                              const float* gain, float* corrected);
+        typedef void (*CorrectFloat16Function)(const uint16_t* pixels, size_t n_pixels, const float* dark,
+                                               const float* gain, float* corrected);
+
+        struct CorrectionKernels {
+            Correct8Function clamped8;
+            Correct16Function clamped16;
+            CorrectFloat8Function float8;
+            CorrectFloat16Function float16;
+        };
+
+        /**
+         * The kernels for a given instruction set. The caller has to verify that the CPU supports it.
+         */
+        const CorrectionKernels& getCorrectionKernels(SimdLevel level);
+
+        /**
+         * The kernels for the best instruction set available, selected on first call.
+         */
+        const CorrectionKernels& getCorrectionKernels();
+
+        inline void correctPixels(const uint8_t* pixels, size_t n_pixels, const float* dark, const float* gain,
+                                  float maxValue, uint16_t* corrected) {
+            getCorrectionKernels().clamped8(pixels, n_pixels, dark, gain, maxValue, corrected);
+        }
+
+        inline void correctPixels(const uint16_t* pixels, size_t n_pixels, const float* dark, const float* gain,
+                                  float maxValue, uint16_t* corrected) {
+            getCorrectionKernels().clamped16(pixels, n_pixels, dark, gain, maxValue, corrected);
+        }
+
+        inline void correctPixels(const uint8_t* pixels, size_t n_pixels, const float* dark, const float* gain,
+                                  float* corrected) {
+            getCorrectionKernels().float8(pixels, n_pixels, dark, gain, corrected);
+        }
+
+        inline void correctPixels(const uint16_t* pixels, size_t n_pixels, const float* dark, const float* gain,
+                                  float* corrected) {
+            getCorrectionKernels().float16(pixels, n_pixels, dark, gain, corrected);
+        }
+
+        // 32-bit pixels, e.g. binned sums, are not vectorised
+        void correctPixels(const uint32_t* pixels, size_t n_pixels, const float* dark, const float* gain,
+                           float maxValue, uint16_t* corrected);
+        void correctPixels(const uint32_t* pixels, size_t n_pixels, const float* dark, const float* gain,
+                           float* corrected);
+
+        // Bitshuffle, i.e. transpose the pixels into bit-planes: bit b of pixel 8j+k is bit k of byte j of plane b.
+        // It is the transposition of the bitshuffle library for little-endian pixels, see Compression.hh.
+        // Bitshuffle n_pixels pixels into the 8 or 16 planes, n_pixels / 8 bytes each, rounded up
+        typedef void (*Bitshuffle8Function)(const uint8_t* pixels, size_t n_pixels, uint8_t* const* planes);
+        typedef void (*Bitshuffle16Function)(const uint16_t* pixels, size_t n_pixels, uint8_t* const* planes);
+
+        struct BitshuffleKernels {
+            Bitshuffle8Function pixels8;
+            Bitshuffle16Function pixels16;
+        };
+
+        /**
+         * The kernels for a given instruction set. The caller has to verify that the CPU supports it.
+         */
+        const BitshuffleKernels& getBitshuffleKernels(SimdLevel level);
+
+        /**
+         * The kernels for the best instruction set available, selected on first call.
+         */
+        const BitshuffleKernels& getBitshuffleKernels();
+
+        // Destination index of the source pixel (y, x): origin + y * strideY + x * strideX.
+        // It describes any combination of flips and rotations by multiples of 90 degrees.
+        struct Orientation {
+            ptrdiff_t origin;
+            ptrdiff_t strideY;
+            ptrdiff_t strideX;
+            bool transposed; // The rows of the source are the columns of the destination
+        };
+
+        /**
+         * The orientation applied by the imageSource util::flip_image and util::rotate_image routines,
+         * in this order, for an image of the given size.
+         */
+        Orientation getOrientation(int width, int height, bool flipX, bool flipY, unsigned int rotation);
+
+        /**
+         * The region of the source image which an orientation moves to a region of the oriented image.
+         * @param width, height The size of the source image
+         * @param x, y, regionWidth, regionHeight The region in the oriented image, replaced by the one in the source
+         */
+        void sourceRegion(const Orientation& orientation, int width, int height, int& x, int& y, int& regionWidth,
+                          int& regionHeight);
+
+        /**
+         * Flip and/or rotate an image. Rotations by 90 and 270 degrees are done in tiles, transposed in registers
+         * for 8- and 16-bit pixels.
+         * @param pixelBytes The size of one pixel, e.g. 3 for RGB8
+         * @param oriented The output image, it must not overlap the input one
+         */
+        void orientImage(const void* image, int width, int height, size_t pixelBytes, const Orientation& orientation,
+                         void* oriented);
+
+        /**
+         * Flip and/or rotate a YUV 4:2:2 image, in which the pairs of pixels of each row share the chroma. The luma
+         * is moved pixel by pixel, the chroma is then averaged over the new pairs. Not optimised.
+         * @param uyvy The byte order is UYVY, else YUYV
+         * @param oriented The output image, it must not overlap the input one
+         */
+        void orientYuv422(const uint8_t* yuv, int width, int height, bool uyvy, const Orientation& orientation,
+                          uint8_t* oriented);
+
+        /**
+         * Unpack and orient an image in one pass. The packed image is read once, and the oriented image is
+         * written once, in strips of rows which stay in cache in between.
+         * @param unpack The kernel unpacking bits-bit pixels
+         * @param oriented The output image, of size width * height
+         */
+        void unpackOriented(UnpackFunction unpack, size_t bits, const uint8_t* data, int width, int height,
+                            const Orientation& orientation, uint16_t* oriented);
+
+    } // namespace kernels
+
+} // namespace karabo
+
+#endif
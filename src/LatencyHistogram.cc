@@ -0,0 +1,78 @@
+/*
+ * Author: <parenti>
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#include "LatencyHistogram.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace karabo {
+
+    void LatencyHistogram::add(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            m_counts[i] += other.m_counts[i];
+        }
+        m_count += other.m_count;
+        m_max = std::max(m_max, other.m_max);
+    }
+
+
+    void LatencyHistogram::subtract(const LatencyHistogram& other) {
+        size_t last = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            m_counts[i] -= other.m_counts[i];
+            if (m_counts[i] > 0) last = i;
+        }
+        m_count -= other.m_count;
+        // The exact maximum is lost, the bucket bound is the best estimate left
+        m_max = (m_count > 0) ? std::min(m_max, bucketUpperBound(last)) : 0;
+    }
+
+
+    void LatencyHistogram::reset() {
+        m_counts.fill(0);
+        m_count = 0;
+        m_max = 0;
+    }
+
+
+    uint64_t LatencyHistogram::quantile(double q) const {
+        if (m_count == 0) return 0;
+
+        // The rank of the value, starting from 1
+        const uint64_t rank = std::max<uint64_t>(1, std::ceil(std::clamp(q, 0., 1.) * m_count));
+        uint64_t cumulated = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            cumulated += m_counts[i];
+            if (cumulated >= rank) {
+                return std::min(bucketUpperBound(i), m_max);
+            }
+        }
+        return m_max;
+    }
+
+
+    std::vector<std::pair<uint64_t, uint64_t>> LatencyHistogram::buckets() const {
+        std::vector<std::pair<uint64_t, uint64_t>> buckets;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            if (m_counts[i] > 0) {
+                buckets.emplace_back(bucketUpperBound(i), m_counts[i]);
+            }
+        }
+        return buckets;
+    }
+
+
+    uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+        if (index < SUB_BUCKETS) return index;
+        const size_t shift = (index - SUB_BUCKETS) / (SUB_BUCKETS / 2) + 1;
+        const uint64_t mantissa = (index - SUB_BUCKETS) % (SUB_BUCKETS / 2) + SUB_BUCKETS / 2;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+} // namespace karabo
@@ -0,0 +1,92 @@
+/*
+ * Author: <parenti>
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#ifndef KARABO_LATENCYHISTOGRAM_HH
+#define KARABO_LATENCYHISTOGRAM_HH
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace karabo {
+
+    /**
+     * Histogram of durations with logarithmic buckets, in the spirit of HdrHistogram: fixed memory, constant
+     * recording cost, and buckets narrower than 2 / SUB_BUCKETS of their values, i.e. 1.6 %, over the whole range.
+     *
+     * Values below SUB_BUCKETS have a bucket each. Above, every power of two is split into SUB_BUCKETS / 2
+     * buckets of equal width. Values above MAX_VALUE are counted in the last bucket.
+     */
+    class LatencyHistogram {
+       public:
+        static constexpr unsigned int SUB_BITS = 7;
+        static constexpr uint64_t SUB_BUCKETS = 1ull << SUB_BITS;
+        static constexpr unsigned int MAX_BITS = 32;
+        static constexpr uint64_t MAX_VALUE = (1ull << MAX_BITS) - 1;
+        static constexpr size_t BUCKETS = SUB_BUCKETS + (MAX_BITS - SUB_BITS) * (SUB_BUCKETS / 2);
+
+        LatencyHistogram() {
+            this->reset();
+        }
+
+        void record(uint64_t value) {
+            m_counts[bucketIndex(value)] += 1;
+            m_count += 1;
+            if (value > m_max) m_max = value;
+        }
+
+        void add(const LatencyHistogram& other);
+
+        // The values of other must have been recorded in this histogram
+        void subtract(const LatencyHistogram& other);
+
+        void reset();
+
+        uint64_t count() const {
+            return m_count;
+        }
+
+        // The largest value recorded, unless subtracted: then an upper bound of the largest value
+        uint64_t max() const {
+            return m_max;
+        }
+
+        /**
+         * The value at or below which a fraction q of the recorded values lie, as the upper bound of its bucket.
+         * @param q In the range [0, 1]
+         * @return 0 if the histogram is empty
+         */
+        uint64_t quantile(double q) const;
+
+        /**
+         * The non-empty buckets, as pairs of their upper bound and count.
+         */
+        std::vector<std::pair<uint64_t, uint64_t>> buckets() const;
+
+        static size_t bucketIndex(uint64_t value) {
+            if (value < SUB_BUCKETS) return value;
+            if (value > MAX_VALUE) value = MAX_VALUE;
+            // The leading bit and the SUB_BITS - 1 following ones
+            const unsigned int msb = 63 - __builtin_clzll(value);
+            const unsigned int shift = msb - (SUB_BITS - 1);
+            return SUB_BUCKETS + (shift - 1) * (SUB_BUCKETS / 2) + ((value >> shift) - SUB_BUCKETS / 2);
+        }
+
+        static uint64_t bucketUpperBound(size_t index);
+
+       private:
+        std::array<uint64_t, BUCKETS> m_counts;
+        uint64_t m_count;
+        uint64_t m_max;
+    };
+
+} // namespace karabo
+
+#endif
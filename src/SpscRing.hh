@@ -0,0 +1,120 @@
+/*
+ * Author: <parenti>
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#ifndef KARABO_SPSCRING_HH
+#define KARABO_SPSCRING_HH
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace karabo {
+
+    /**
+     * Bounded lock-free queue for exactly one producer thread and one consumer thread.
+     *
+     * The producer never blocks nor allocates: try_push fails if the queue is full.
+     * The consumer can sleep in wait() until the producer pushes a new element.
+     */
+    template <class T>
+    class SpscRing {
+       public:
+        /**
+         * @param capacity The minimum number of elements the queue can hold. It is rounded up to a power of two.
+         */
+        explicit SpscRing(size_t capacity) : m_head(0), m_tail(0), m_highWaterMark(0) {
+            size_t size = 1;
+            while (size < capacity) size <<= 1;
+            m_mask = size - 1;
+            m_slots.resize(size);
+        }
+
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        /**
+         * Append an element to the queue. To be called only from the producer thread.
+         * @return false if the queue is full
+         */
+        bool try_push(const T& value) {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            const size_t depth = tail - m_head.load(std::memory_order_acquire);
+            if (depth > m_mask) {
+                return false; // full
+            }
+
+            m_slots[tail & m_mask] = value;
+            m_tail.store(tail + 1, std::memory_order_release);
+            // Only issues a system call if the consumer is sleeping in wait()
+            m_tail.notify_one();
+
+            if (depth + 1 > m_highWaterMark.load(std::memory_order_relaxed)) {
+                m_highWaterMark.store(depth + 1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+
+        /**
+         * Remove the oldest element from the queue. To be called only from the consumer thread.
+         * @return false if the queue is empty
+         */
+        bool try_pop(T& value) {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tail.load(std::memory_order_acquire)) {
+                return false; // empty
+            }
+
+            value = m_slots[head & m_mask];
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Block until the queue is not empty. To be called only from the consumer thread.
+         */
+        void wait() const {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            m_tail.wait(head, std::memory_order_acquire);
+        }
+
+        size_t capacity() const {
+            return m_mask + 1;
+        }
+
+        /**
+         * The number of elements currently in the queue. Can be called from any thread.
+         */
+        size_t depth() const {
+            const size_t head = m_head.load(std::memory_order_acquire);
+            return m_tail.load(std::memory_order_acquire) - head;
+        }
+
+        /**
+         * The maximum number of elements in the queue, since the last reset.
+         */
+        size_t highWaterMark() const {
+            return m_highWaterMark.load(std::memory_order_relaxed);
+        }
+
+        void resetHighWaterMark() {
+            m_highWaterMark.store(0, std::memory_order_relaxed);
+        }
+
+       private:
+        // Producer and consumer indices live on different cache lines, to avoid false sharing
+        alignas(64) std::atomic<size_t> m_head; // Written by the consumer
+        alignas(64) std::atomic<size_t> m_tail; // Written by the producer
+        alignas(64) std::atomic<size_t> m_highWaterMark;
+        size_t m_mask;
+        std::vector<T> m_slots;
+    };
+
+} // namespace karabo
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Author: <parenti>
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#include "WorkerPool.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace karabo {
+
+    WorkerPool::WorkerPool(unsigned int n_threads) : m_state(std::make_shared<State>()) {
+        n_threads = std::max(1u, n_threads);
+        m_threads.reserve(n_threads);
+        for (unsigned int i = 0; i < n_threads; ++i) {
+            m_threads.emplace_back(&WorkerPool::run, m_state);
+        }
+    }
+
+
+    WorkerPool::~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_state->mtx);
+            m_state->stopping = true;
+        }
+        m_state->cv.notify_all();
+
+        for (std::thread& thread : m_threads) {
+            if (thread.get_id() == std::this_thread::get_id()) {
+                // Destroyed by one of its tasks, a thread cannot join itself
+                thread.detach();
+            } else {
+                thread.join();
+            }
+        }
+    }
+
+
+    void WorkerPool::post(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(m_state->mtx);
+            m_state->tasks.push_back(std::move(task));
+        }
+        m_state->cv.notify_one();
+    }
+
+
+    void WorkerPool::parallel_for(size_t n, size_t min_chunk, const std::function<void(size_t, size_t)>& fn) {
+        const size_t max_chunks = std::max<size_t>(1, n / std::max<size_t>(1, min_chunk));
+        const size_t n_chunks = std::min<size_t>(m_threads.size() + 1, max_chunks);
+        if (n_chunks <= 1) {
+            fn(0, n);
+            return;
+        }
+
+        // Shared by the caller and the helper tasks, which may outlive this call if they start late
+        struct Progress {
+            std::atomic<size_t> next{0};
+            std::atomic<size_t> done{0};
+            std::mutex mtx;
+            std::condition_variable cv;
+        };
+        auto progress = std::make_shared<Progress>();
+
+        const auto work = [progress, n, n_chunks, &fn]() {
+            size_t i;
+            while ((i = progress->next.fetch_add(1)) < n_chunks) {
+                // The sizes of the ranges differ by one at most, none is empty as n_chunks <= n
+                fn(i * n / n_chunks, (i + 1) * n / n_chunks);
+                if (progress->done.fetch_add(1) + 1 == n_chunks) {
+                    std::lock_guard<std::mutex> lock(progress->mtx);
+                    progress->cv.notify_all();
+                }
+            }
+        };
+
+        for (size_t i = 1; i < n_chunks; ++i) {
+            this->post(work);
+        }
+        work();
+
+        std::unique_lock<std::mutex> lock(progress->mtx);
+        progress->cv.wait(lock, [&progress, n_chunks]() { return progress->done.load() == n_chunks; });
+    }
+
+
+    void WorkerPool::run(const std::shared_ptr<State>& state) {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(state->mtx);
+                state->cv.wait(lock, [&state]() { return state->stopping || !state->tasks.empty(); });
+                if (state->tasks.empty()) {
+                    return; // Stopping, and no task left
+                }
+                task = std::move(state->tasks.front());
+                state->tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+} // namespace karabo
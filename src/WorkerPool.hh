@@ -0,0 +1,78 @@
+/*
+ * Author: <parenti>
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#ifndef KARABO_WORKERPOOL_HH
+#define KARABO_WORKERPOOL_HH
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace karabo {
+
+    /**
+     * Fixed-size pool of threads executing tasks in the order they are posted.
+     *
+     * The pool is not meant to be shared: it is owned by one device and used for its image processing only,
+     * thus a slow consumer elsewhere in the device server cannot delay the images.
+     */
+    class WorkerPool {
+       public:
+        /**
+         * @param n_threads The number of worker threads, at least one thread is started
+         */
+        explicit WorkerPool(unsigned int n_threads);
+
+        /**
+         * Pending tasks are executed before the worker threads are joined.
+         * If called by a task, the thread executing it is not joined: it ends once no task is left.
+         */
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        /**
+         * Queue a task for execution in one of the worker threads.
+         */
+        void post(std::function<void()> task);
+
+        /**
+         * Call fn(begin, end) on consecutive ranges covering [0, n), in parallel.
+         * The calling thread takes part in the execution, and the call returns when all ranges are done.
+         * @param n The size of the index range
+         * @param min_chunk The minimum size of a range, to limit the scheduling overhead
+         */
+        void parallel_for(size_t n, size_t min_chunk, const std::function<void(size_t, size_t)>& fn);
+
+        unsigned int size() const {
+            return m_threads.size();
+        }
+
+       private:
+        // Shared with the threads, thus a thread which is not joined can still access it
+        struct State {
+            std::mutex mtx;
+            std::condition_variable cv;
+            std::deque<std::function<void()>> tasks;
+            bool stopping = false;
+        };
+
+        static void run(const std::shared_ptr<State>& state);
+
+        const std::shared_ptr<State> m_state;
+        std::vector<std::thread> m_threads;
+    };
+
+} // namespace karabo
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ * Author: parenti
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+// Benchmark of the image orientation: imageSource util::rotate_image, as used so far, compared to the
+// tiled kernels::orientImage. Not part of the test suite, run it manually on the target machine:
+//     ./bench-aravisCameras [repetitions]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <image_source/CameraImageSource.hh>
+#include <vector>
+
+#include "ImageKernels.hh"
+
+using namespace karabo;
+
+namespace {
+
+    struct Sensor {
+        const char* name;
+        int width;
+        int height;
+    };
+
+    // Typical sensor sizes of the cameras in use
+    const Sensor sensors[] = {{"VGA", 640, 480},           {"2.3 MP", 1920, 1200}, {"5 MP", 2448, 2048},
+                              {"12 MP", 4096, 3000},       {"20 MP", 5472, 3648}};
+
+
+    template <class T>
+    double timeCurrent(std::vector<T>& image, int width, int height, unsigned int rotation, int repetitions) {
+        double total = 0.;
+        for (int i = 0; i < repetitions; ++i) {
+            data::NDArray array(image.data(), image.size(), data::NDArray::NullDeleter(), data::Dims(height, width));
+            const auto start = std::chrono::steady_clock::now();
+            util::rotate_image<T>(array, rotation);
+            total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        return total / repetitions;
+    }
+
+
+    template <class T>
+    double timeTiled(const std::vector<T>& image, int width, int height, unsigned int rotation, int repetitions) {
+        std::vector<T> oriented(image.size());
+        const kernels::Orientation orientation = kernels::getOrientation(width, height, false, false, rotation);
+        double total = 0.;
+        for (int i = 0; i < repetitions; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            kernels::orientImage(image.data(), width, height, sizeof(T), orientation, oriented.data());
+            total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        return total / repetitions;
+    }
+
+
+    template <class T>
+    void benchmark(const char* type, int repetitions) {
+        for (const Sensor& sensor : sensors) {
+            std::vector<T> image(size_t(sensor.width) * sensor.height);
+            for (size_t i = 0; i < image.size(); ++i) image[i] = static_cast<T>(std::rand());
+
+            for (unsigned int rotation : {90u, 180u, 270u}) {
+                const double current = timeCurrent<T>(image, sensor.width, sensor.height, rotation, repetitions);
+                const double tiled = timeTiled<T>(image, sensor.width, sensor.height, rotation, repetitions);
+                std::printf("%-8s %-7s %4u deg  current %8.2f ms  tiled %8.2f ms  speed-up %5.1fx\n", type,
+                            sensor.name, rotation, current, tiled, current / tiled);
+            }
+        }
+    }
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    const int repetitions = (argc > 1) ? std::atoi(argv[1]) : 10;
+
+    benchmark<unsigned char>("uint8", repetitions);
+    benchmark<unsigned short>("uint16", repetitions);
+
+    return 0;
+}
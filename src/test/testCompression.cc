@@ -0,0 +1,126 @@
+/*
+ * Author: parenti
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+#include <lz4.h>
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Compression.hh"
+
+using namespace karabo;
+
+namespace {
+
+    // 12-bit pixels, compressible as the 4 upper bit-planes are empty
+    template <class T>
+    std::vector<T> randomPixels(size_t n_pixels) {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<unsigned int> distribution(0, sizeof(T) == 1 ? 0xFF : 0x0FFF);
+        std::vector<T> pixels(n_pixels);
+        for (T& pixel : pixels) pixel = distribution(generator);
+        return pixels;
+    }
+
+
+    uint64_t readBE(const uint8_t* in, size_t bytes) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i) value = (value << 8) | in[i];
+        return value;
+    }
+
+
+    template <class T>
+    std::vector<uint8_t> compress(const std::vector<T>& pixels) {
+        const size_t n_pixels = pixels.size();
+        const size_t n_blocks = kernels::bitshuffleBlocks(n_pixels, sizeof(T));
+        std::vector<uint8_t> stream(kernels::bitshuffleLz4Bound(n_pixels, sizeof(T)));
+        std::vector<size_t> blockSizes(n_blocks);
+        uint8_t* slots = stream.data() + kernels::BITSHUFFLE_HEADER_BYTES;
+        // In two chunks, as done in parallel
+        kernels::compressBitshuffleLz4(pixels.data(), n_pixels, 0, n_blocks / 2, slots, blockSizes.data());
+        kernels::compressBitshuffleLz4(pixels.data(), n_pixels, n_blocks / 2, n_blocks, slots, blockSizes.data());
+        stream.resize(kernels::packBitshuffleLz4(pixels.data(), n_pixels, blockSizes.data(), stream.data()));
+        return stream;
+    }
+
+
+    template <class T>
+    void testRoundTrip(size_t n_pixels) {
+        const std::vector<T> pixels = randomPixels<T>(n_pixels);
+        const std::vector<uint8_t> stream = compress(pixels);
+        ASSERT_LE(stream.size(), kernels::bitshuffleLz4Bound(n_pixels, sizeof(T))) << n_pixels;
+
+        // The header
+        ASSERT_GE(stream.size(), kernels::BITSHUFFLE_HEADER_BYTES) << n_pixels;
+        EXPECT_EQ(n_pixels * sizeof(T), readBE(stream.data(), 8)) << n_pixels;
+        EXPECT_EQ(kernels::BITSHUFFLE_BLOCK_BYTES, readBE(stream.data() + 8, 4)) << n_pixels;
+
+        // The first block decompressed with LZ4 alone holds the bit-planes
+        const size_t count = std::min(kernels::bitshuffleBlockPixels(sizeof(T)), n_pixels / 8 * 8);
+        if (count > 0) {
+            const size_t compressed = readBE(stream.data() + kernels::BITSHUFFLE_HEADER_BYTES, 4);
+            std::vector<uint8_t> planes(count * sizeof(T));
+            ASSERT_EQ(static_cast<int>(planes.size()),
+                      LZ4_decompress_safe(
+                            reinterpret_cast<const char*>(stream.data() + kernels::BITSHUFFLE_HEADER_BYTES + 4),
+                            reinterpret_cast<char*>(planes.data()), compressed, planes.size()))
+                  << n_pixels;
+            for (size_t i = 0; i < count; i += 37) {
+                for (size_t b = 0; b < 8 * sizeof(T); ++b) {
+                    ASSERT_EQ((pixels[i] >> b) & 1, (planes[b * count / 8 + i / 8] >> (i % 8)) & 1) << i << " " << b;
+                }
+            }
+        }
+
+        std::vector<T> decompressed(n_pixels);
+        ASSERT_TRUE(kernels::decompressBitshuffleLz4(stream.data(), stream.size(), n_pixels, decompressed.data()))
+              << n_pixels;
+        EXPECT_EQ(pixels, decompressed) << n_pixels;
+
+        // Corrupted or truncated streams are rejected
+        EXPECT_FALSE(kernels::decompressBitshuffleLz4(stream.data(), stream.size() - 1, n_pixels, decompressed.data()))
+              << n_pixels;
+        EXPECT_FALSE(kernels::decompressBitshuffleLz4(stream.data(), stream.size(), n_pixels + 1, decompressed.data()))
+              << n_pixels;
+    }
+
+} // namespace
+
+
+TEST(Compression, testBlocks) {
+    EXPECT_EQ(4096u, kernels::bitshuffleBlockPixels(2));
+    EXPECT_EQ(0u, kernels::bitshuffleBlocks(7, 2));
+    EXPECT_EQ(1u, kernels::bitshuffleBlocks(8, 2));
+    EXPECT_EQ(1u, kernels::bitshuffleBlocks(4096, 2));
+    // The last block is rounded down to a multiple of 8
+    EXPECT_EQ(1u, kernels::bitshuffleBlocks(4103, 2));
+    EXPECT_EQ(2u, kernels::bitshuffleBlocks(4104, 2));
+    EXPECT_EQ(1u, kernels::bitshuffleBlocks(8192, 1));
+    EXPECT_EQ(2u, kernels::bitshuffleBlocks(8200, 1));
+}
+
+
+TEST(Compression, testRoundTrip) {
+    for (size_t n_pixels : {0, 5, 8, 1001, 4096, 4103, 3 * 4096 + 1001, 1024 * 768}) {
+        testRoundTrip<uint8_t>(n_pixels);
+        testRoundTrip<uint16_t>(n_pixels);
+    }
+}
+
+
+TEST(Compression, testRatio) {
+    // A dark image compresses to a small fraction of its size
+    const size_t n_pixels = 1024 * 768;
+    const std::vector<uint16_t> pixels(n_pixels, 3);
+    const std::vector<uint8_t> stream = compress(pixels);
+    EXPECT_LT(stream.size(), n_pixels * sizeof(uint16_t) / 50);
+}
@@ -0,0 +1,140 @@
+/*
+ * Author: parenti
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "Demosaic.hh"
+
+using namespace karabo;
+
+namespace {
+
+    // Sizes exercising the vector loops and the borders
+    const std::vector<std::pair<int, int>> imageSizes = {{1, 1}, {2, 2}, {5, 3}, {12, 7}, {33, 10}, {64, 17}};
+
+    const kernels::BayerPattern patterns[] = {kernels::BayerPattern::RGGB, kernels::BayerPattern::GRBG,
+                                              kernels::BayerPattern::GBRG, kernels::BayerPattern::BGGR};
+
+    template <class T>
+    std::vector<T> randomMosaic(size_t size, unsigned int maxValue) {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<unsigned int> distribution(0, maxValue);
+        std::vector<T> mosaic(size);
+        for (T& value : mosaic) {
+            value = distribution(generator);
+        }
+        return mosaic;
+    }
+
+
+    template <class T>
+    std::vector<T> demosaicImage(const kernels::DemosaicKernels& demosaicKernels, const std::vector<T>& mosaic,
+                                 int width, int height, const kernels::DemosaicParameters& parameters) {
+        std::vector<T> rgb(3 * mosaic.size());
+        if constexpr (sizeof(T) == 1) {
+            demosaicKernels.rgb8(mosaic.data(), width, height, parameters, 0, height, rgb.data());
+        } else {
+            demosaicKernels.rgb16(mosaic.data(), width, height, parameters, 0, height, rgb.data());
+        }
+        return rgb;
+    }
+
+
+    // Compare the kernels for all the instruction sets supported by the CPU to the scalar ones
+    template <class T>
+    void compareToScalar(kernels::DemosaicMethod method, unsigned int maxValue) {
+        const kernels::SimdLevel best = kernels::detectSimdLevel();
+        const kernels::DemosaicKernels& scalarKernels = kernels::getDemosaicKernels(kernels::SimdLevel::SCALAR);
+
+        for (const auto& [width, height] : imageSizes) {
+            const std::vector<T> mosaic = randomMosaic<T>(size_t(width) * height, maxValue);
+            for (kernels::BayerPattern pattern : patterns) {
+                const kernels::DemosaicParameters parameters = {pattern, method, 1.5f, 1.f, 0.75f, maxValue};
+                const std::vector<T> expected = demosaicImage(scalarKernels, mosaic, width, height, parameters);
+
+                for (int level = 1; level <= static_cast<int>(best); ++level) {
+                    const kernels::DemosaicKernels& demosaicKernels =
+                          kernels::getDemosaicKernels(static_cast<kernels::SimdLevel>(level));
+                    EXPECT_EQ(expected, demosaicImage(demosaicKernels, mosaic, width, height, parameters))
+                          << kernels::toString(static_cast<kernels::SimdLevel>(level)) << " " << width << "x"
+                          << height;
+                }
+            }
+        }
+    }
+
+} // namespace
+
+
+TEST(Demosaic, testBilinear) {
+    // 3x3 neighbourhood of a red pixel, BGGR pattern
+    const std::vector<uint8_t> mosaic = {10, 20, 30, //
+                                         40, 50, 60, //
+                                         70, 80, 90};
+    const kernels::DemosaicParameters parameters = {kernels::BayerPattern::BGGR, kernels::DemosaicMethod::BILINEAR,
+                                                    1.f, 1.f, 1.f, 255};
+    const std::vector<uint8_t> rgb =
+          demosaicImage(kernels::getDemosaicKernels(), mosaic, 3, 3, parameters);
+
+    // The central pixel is red: green is the mean of the cross, blue the mean of the diagonals
+    EXPECT_EQ(50, rgb[3 * 4]);
+    EXPECT_EQ((20 + 40 + 60 + 80 + 2) / 4, rgb[3 * 4 + 1]);
+    EXPECT_EQ((10 + 30 + 70 + 90 + 2) / 4, rgb[3 * 4 + 2]);
+    // The pixel above is green, in a blue row: blue from the left and right, red from above and below
+    EXPECT_EQ(50, rgb[3 * 1]); // The row above is mirrored
+    EXPECT_EQ(20, rgb[3 * 1 + 1]);
+    EXPECT_EQ((10 + 30 + 1) / 2, rgb[3 * 1 + 2]);
+}
+
+
+TEST(Demosaic, testUniformImage) {
+    // A grey image stays grey, with both methods, and the gains are applied and clipped
+    for (kernels::DemosaicMethod method : {kernels::DemosaicMethod::BILINEAR, kernels::DemosaicMethod::EDGE_AWARE}) {
+        for (kernels::BayerPattern pattern : patterns) {
+            const int width = 37, height = 11;
+            const std::vector<uint16_t> mosaic(size_t(width) * height, 1000);
+            const kernels::DemosaicParameters parameters = {pattern, method, 2.f, 1.f, 4.5f, 4095};
+            const std::vector<uint16_t> rgb = demosaicImage(kernels::getDemosaicKernels(), mosaic, width, height,
+                                                            parameters);
+            for (size_t i = 0; i < mosaic.size(); ++i) {
+                ASSERT_EQ(2000, rgb[3 * i]) << i;
+                ASSERT_EQ(1000, rgb[3 * i + 1]) << i;
+                ASSERT_EQ(4095, rgb[3 * i + 2]) << i;
+            }
+        }
+    }
+}
+
+
+TEST(Demosaic, testStripes) {
+    // Stripes of rows, as computed in parallel, give the same image as a single call
+    const int width = 50, height = 23;
+    const std::vector<uint16_t> mosaic = randomMosaic<uint16_t>(size_t(width) * height, 4095);
+    for (kernels::DemosaicMethod method : {kernels::DemosaicMethod::BILINEAR, kernels::DemosaicMethod::EDGE_AWARE}) {
+        const kernels::DemosaicParameters parameters = {kernels::BayerPattern::GRBG, method, 1.f, 1.f, 1.f, 4095};
+        const std::vector<uint16_t> expected =
+              demosaicImage(kernels::getDemosaicKernels(), mosaic, width, height, parameters);
+
+        std::vector<uint16_t> rgb(3 * mosaic.size());
+        for (int row = 0; row < height; row += 5) {
+            kernels::demosaic(mosaic.data(), width, height, parameters, row, std::min(row + 5, height), rgb.data());
+        }
+        EXPECT_EQ(expected, rgb);
+    }
+}
+
+
+TEST(Demosaic, testInstructionSets) {
+    compareToScalar<uint8_t>(kernels::DemosaicMethod::BILINEAR, 255);
+    compareToScalar<uint8_t>(kernels::DemosaicMethod::EDGE_AWARE, 255);
+    compareToScalar<uint16_t>(kernels::DemosaicMethod::BILINEAR, 4095);
+    compareToScalar<uint16_t>(kernels::DemosaicMethod::EDGE_AWARE, 65535);
+}
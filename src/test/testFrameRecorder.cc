@@ -0,0 +1,129 @@
+/*
+ * Author: parenti
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "FrameRecorder.hh"
+
+using namespace karabo;
+
+namespace {
+
+    std::string readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+
+    std::vector<FrameRecorder::IndexEntry> readIndex(const std::filesystem::path& path) {
+        const std::string bytes = readFile(path);
+        std::vector<FrameRecorder::IndexEntry> index(bytes.size() / sizeof(FrameRecorder::IndexEntry));
+        std::memcpy(index.data(), bytes.data(), index.size() * sizeof(FrameRecorder::IndexEntry));
+        return index;
+    }
+
+} // namespace
+
+
+TEST(FrameRecorder, testChunks) {
+    const std::filesystem::path directory = std::filesystem::path(testing::TempDir()) / "testFrameRecorder";
+    std::filesystem::remove_all(directory);
+
+    const std::vector<char> small(100, 'a'), large(5000, 'b'), other(100, 'c');
+    {
+        FrameRecorder recorder(directory.string(), 3 * FrameRecorder::ALIGNMENT);
+        // Two images in the first chunk, the third one does not fit
+        recorder.write(small.data(), small.size(), {1, 10, 100, 7, 0, 0}, "shape=100");
+        recorder.write(small.data(), small.size(), {2, 11, 101, 8, 0, 0}, "shape=100");
+        recorder.write(large.data(), large.size(), {3, 12, 102, 9, 0, 0}, "shape=100");
+        // The layout changes
+        recorder.write(other.data(), other.size(), {4, 13, 103, 0, 0, 0}, "shape=10,10");
+        EXPECT_EQ(3u, recorder.chunks());
+    }
+
+    const std::vector<FrameRecorder::IndexEntry> first = readIndex(directory / "chunk_00000.idx");
+    ASSERT_EQ(2u, first.size());
+    EXPECT_EQ(2u, first[1].frameId);
+    EXPECT_EQ(11u, first[1].trainId);
+    EXPECT_EQ(101u, first[1].seconds);
+    EXPECT_EQ(8u, first[1].fraction);
+    EXPECT_EQ(FrameRecorder::ALIGNMENT, first[1].offset);
+    EXPECT_EQ(100u, first[1].size);
+    const std::string data = readFile(directory / "chunk_00000.dat");
+    ASSERT_EQ(2 * FrameRecorder::ALIGNMENT, data.size());
+    EXPECT_EQ(std::string(small.begin(), small.end()), data.substr(first[1].offset, first[1].size));
+    EXPECT_EQ('\0', data[first[1].offset + first[1].size]); // Padding
+
+    const std::vector<FrameRecorder::IndexEntry> second = readIndex(directory / "chunk_00001.idx");
+    ASSERT_EQ(1u, second.size());
+    EXPECT_EQ(3u, second[0].frameId);
+    EXPECT_EQ(0u, second[0].offset);
+    EXPECT_EQ(std::string(large.begin(), large.end()),
+              readFile(directory / "chunk_00001.dat").substr(0, large.size()));
+
+    EXPECT_EQ("shape=100", readFile(directory / "chunk_00001.txt"));
+    EXPECT_EQ("shape=10,10", readFile(directory / "chunk_00002.txt"));
+    EXPECT_EQ(1u, readIndex(directory / "chunk_00002.idx").size());
+
+    std::filesystem::remove_all(directory);
+}
+
+
+TEST(FrameRecorder, testExistingRecording) {
+    // A recording is never overwritten
+    const std::filesystem::path directory = std::filesystem::path(testing::TempDir()) / "testFrameRecorderExisting";
+    std::filesystem::remove_all(directory);
+    const std::vector<char> image(10, 'a');
+    {
+        FrameRecorder recorder(directory.string(), 1 << 20);
+        recorder.write(image.data(), image.size(), {1, 0, 0, 0, 0, 0}, "");
+    }
+    FrameRecorder recorder(directory.string(), 1 << 20);
+    EXPECT_THROW(recorder.write(image.data(), image.size(), {1, 0, 0, 0, 0, 0}, ""), std::runtime_error);
+
+    std::filesystem::remove_all(directory);
+}
+
+
+TEST(FrameRecorder, testAligned) {
+    // An aligned image is written from where it is, only its last block is staged
+    const std::filesystem::path directory = std::filesystem::path(testing::TempDir()) / "testFrameRecorderAligned";
+    std::filesystem::remove_all(directory);
+    const size_t size = 2 * FrameRecorder::ALIGNMENT + 100;
+    const std::shared_ptr<char> aligned = FrameRecorder::allocate(size);
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(aligned.get()) % FrameRecorder::ALIGNMENT);
+    for (size_t i = 0; i < size; ++i) aligned.get()[i] = 'a' + i % 26;
+    const std::string image(aligned.get(), size);
+    {
+        FrameRecorder recorder(directory.string(), 1 << 20);
+        recorder.write(aligned.get(), size, {1, 0, 0, 0, 0, 0}, "");
+        recorder.write(aligned.get(), 2 * FrameRecorder::ALIGNMENT, {2, 0, 0, 0, 0, 0}, "");
+        recorder.write(aligned.get() + 1, 100, {3, 0, 0, 0, 0, 0}, "");
+    }
+
+    const std::vector<FrameRecorder::IndexEntry> index = readIndex(directory / "chunk_00000.idx");
+    ASSERT_EQ(3u, index.size());
+    EXPECT_EQ(3 * FrameRecorder::ALIGNMENT, index[1].offset);
+    EXPECT_EQ(5 * FrameRecorder::ALIGNMENT, index[2].offset);
+    const std::string data = readFile(directory / "chunk_00000.dat");
+    ASSERT_EQ(6 * FrameRecorder::ALIGNMENT, data.size());
+    EXPECT_EQ(image, data.substr(0, size));
+    const size_t padding = 3 * FrameRecorder::ALIGNMENT - size;
+    EXPECT_EQ(std::string(padding, '\0'), data.substr(size, padding));
+    EXPECT_EQ(image.substr(0, 2 * FrameRecorder::ALIGNMENT), data.substr(index[1].offset, index[1].size));
+    EXPECT_EQ(image.substr(1, 100), data.substr(index[2].offset, index[2].size));
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,733 @@
+/*
+ * Author: parenti
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <image_source/CameraImageSource.hh>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "ImageKernels.hh"
+
+using namespace karabo;
+
+namespace {
+
+    // Image sizes exercising the SIMD main loops and the scalar remainders.
+    // The number of pixels is a multiple of 4, i.e. an integer number of bytes in all the packed formats.
+    const std::vector<std::pair<int, int>> imageSizes = {{8, 1},   {16, 2},   {17, 4},   {32, 7},  {64, 5},
+                                                         {100, 3}, {640, 48}, {1001, 4}, {2048, 3}};
+
+    typedef std::function<void(const uint8_t*, int, int, uint16_t*)> ReferenceFunction;
+
+    std::vector<uint8_t> randomData(size_t size) {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int> distribution(0, 255);
+        std::vector<uint8_t> data(size);
+        for (uint8_t& byte : data) {
+            byte = distribution(generator);
+        }
+        return data;
+    }
+
+
+    // Compare the kernels for all the instruction sets supported by the CPU to the imageSource routine
+    void compareToReference(kernels::UnpackFunction kernels::UnpackKernels::*kernel, size_t bits,
+                            const ReferenceFunction& reference) {
+        const kernels::SimdLevel best = kernels::detectSimdLevel();
+
+        for (const auto& [width, height] : imageSizes) {
+            const size_t n_pixels = size_t(width) * height;
+            const std::vector<uint8_t> data = randomData((bits * n_pixels + 7) / 8);
+
+            std::vector<uint16_t> expected(n_pixels);
+            reference(data.data(), width, height, expected.data());
+
+            for (int level = 0; level <= static_cast<int>(best); ++level) {
+                const kernels::UnpackKernels& unpackKernels =
+                      kernels::getUnpackKernels(static_cast<kernels::SimdLevel>(level));
+                // One more pixel to detect writes past the end of the image
+                std::vector<uint16_t> unpacked(n_pixels + 1, 0xFFFF);
+                (unpackKernels.*kernel)(data.data(), n_pixels, unpacked.data());
+
+                EXPECT_EQ(0xFFFF, unpacked[n_pixels]) << kernels::toString(static_cast<kernels::SimdLevel>(level));
+                unpacked.pop_back();
+                EXPECT_EQ(expected, unpacked) << kernels::toString(static_cast<kernels::SimdLevel>(level)) << " "
+                                              << width << "x" << height;
+            }
+        }
+    }
+
+} // namespace
+
+
+TEST(ImageKernels, testMono12Packed) {
+    compareToReference(&kernels::UnpackKernels::mono12Packed, 12,
+                       [](const uint8_t* data, int width, int height, uint16_t* unpacked) {
+                           unpackMono12Packed(data, width, height, unpacked);
+                       });
+}
+
+
+TEST(ImageKernels, testMono12p) {
+    compareToReference(&kernels::UnpackKernels::mono12p, 12,
+                       [](const uint8_t* data, int width, int height, uint16_t* unpacked) {
+                           unpackMono12p(data, width, height, unpacked);
+                       });
+    compareToReference(&kernels::UnpackKernels::mono12p, 12,
+                       [](const uint8_t* data, int width, int height, uint16_t* unpacked) {
+                           unpackBayer12p(data, width, height, unpacked);
+                       });
+}
+
+
+TEST(ImageKernels, testMono10p) {
+    compareToReference(&kernels::UnpackKernels::mono10p, 10,
+                       [](const uint8_t* data, int width, int height, uint16_t* unpacked) {
+                           unpackMono10p(data, width, height, unpacked);
+                       });
+    compareToReference(&kernels::UnpackKernels::mono10p, 10,
+                       [](const uint8_t* data, int width, int height, uint16_t* unpacked) {
+                           unpackBayer10p(data, width, height, unpacked);
+                       });
+}
+
+
+TEST(ImageKernels, testUnpackOriented) {
+    const kernels::UnpackKernels& unpackKernels = kernels::getUnpackKernels();
+
+    // Include sizes which are not a multiple of the strip height
+    for (const auto& [width, height] : std::vector<std::pair<int, int>>{{8, 4}, {17, 4}, {64, 36}, {100, 72}}) {
+        const size_t n_pixels = size_t(width) * height;
+        const std::vector<uint8_t> data = randomData((12 * n_pixels + 7) / 8);
+
+        for (unsigned int rotation : {0u, 90u, 180u, 270u}) {
+            for (bool flipX : {false, true}) {
+                for (bool flipY : {false, true}) {
+                    // Current processing: unpack, then flip, then rotate
+                    std::vector<uint16_t> unpacked(n_pixels);
+                    unpackKernels.mono12p(data.data(), n_pixels, unpacked.data());
+                    data::NDArray expected(unpacked.data(), n_pixels, data::NDArray::NullDeleter(),
+                                           data::Dims(height, width));
+                    if (flipX || flipY) {
+                        util::flip_image<uint16_t>(expected, flipX, flipY);
+                    }
+                    if (rotation != 0) {
+                        util::rotate_image<uint16_t>(expected, rotation);
+                    }
+
+                    std::vector<uint16_t> oriented(n_pixels);
+                    const kernels::Orientation orientation =
+                          kernels::getOrientation(width, height, flipX, flipY, rotation);
+                    kernels::unpackOriented(unpackKernels.mono12p, 12, data.data(), width, height, orientation,
+                                            oriented.data());
+
+                    const uint16_t* expectedData = expected.getData<uint16_t>();
+                    EXPECT_EQ(std::vector<uint16_t>(expectedData, expectedData + n_pixels), oriented)
+                          << width << "x" << height << " rotation " << rotation << " flip " << flipX << flipY;
+                }
+            }
+        }
+    }
+}
+
+
+TEST(ImageKernels, testOrientImage) {
+    // Include sizes which are not a multiple of the tiles, nor of the bands of rows
+    const std::vector<std::pair<int, int>> sizes = {{1, 1}, {7, 3}, {16, 16}, {35, 70}, {130, 67}};
+    for (const auto& [width, height] : sizes) {
+        const size_t n_pixels = size_t(width) * height;
+        const std::vector<uint8_t> data = randomData(3 * n_pixels);
+
+        for (unsigned int rotation : {0u, 90u, 180u, 270u}) {
+            for (bool flipX : {false, true}) {
+                for (bool flipY : {false, true}) {
+                    const kernels::Orientation orientation =
+                          kernels::getOrientation(width, height, flipX, flipY, rotation);
+
+                    // 8-bit pixels
+                    std::vector<uint8_t> mono8(data.begin(), data.begin() + n_pixels);
+                    std::vector<uint8_t> oriented8(n_pixels);
+                    kernels::orientImage(mono8.data(), width, height, 1, orientation, oriented8.data());
+                    data::NDArray expected8(mono8.data(), n_pixels, data::NDArray::NullDeleter(),
+                                            data::Dims(height, width));
+                    if (flipX || flipY) util::flip_image<uint8_t>(expected8, flipX, flipY);
+                    if (rotation != 0) util::rotate_image<uint8_t>(expected8, rotation);
+                    const uint8_t* expectedData8 = expected8.getData<uint8_t>();
+                    EXPECT_EQ(std::vector<uint8_t>(expectedData8, expectedData8 + n_pixels), oriented8)
+                          << "8-bit " << width << "x" << height << " rotation " << rotation << " flip " << flipX
+                          << flipY;
+
+                    // 16-bit pixels
+                    std::vector<uint16_t> mono16(n_pixels);
+                    std::memcpy(mono16.data(), data.data(), 2 * n_pixels);
+                    std::vector<uint16_t> oriented16(n_pixels);
+                    kernels::orientImage(mono16.data(), width, height, 2, orientation, oriented16.data());
+                    data::NDArray expected16(mono16.data(), n_pixels, data::NDArray::NullDeleter(),
+                                             data::Dims(height, width));
+                    if (flipX || flipY) util::flip_image<uint16_t>(expected16, flipX, flipY);
+                    if (rotation != 0) util::rotate_image<uint16_t>(expected16, rotation);
+                    const uint16_t* expectedData16 = expected16.getData<uint16_t>();
+                    EXPECT_EQ(std::vector<uint16_t>(expectedData16, expectedData16 + n_pixels), oriented16)
+                          << "16-bit " << width << "x" << height << " rotation " << rotation << " flip " << flipX
+                          << flipY;
+
+                    // RGB8 pixels, compared to the 8-bit mapping of each channel
+                    std::vector<uint8_t> rgb(3 * n_pixels);
+                    kernels::orientImage(data.data(), width, height, 3, orientation, rgb.data());
+                    for (int y = 0; y < height; ++y) {
+                        for (int x = 0; x < width; ++x) {
+                            const ptrdiff_t index = orientation.origin + y * orientation.strideY +
+                                                    x * orientation.strideX;
+                            for (int c = 0; c < 3; ++c) {
+                                ASSERT_EQ(data[3 * (size_t(y) * width + x) + c], rgb[3 * index + c])
+                                      << "RGB8 " << width << "x" << height << " rotation " << rotation;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+TEST(ImageKernels, testSourceRegion) {
+    const std::vector<std::pair<int, int>> sizes = {{1, 1}, {7, 3}, {35, 70}};
+    for (const auto& [width, height] : sizes) {
+        const size_t n_pixels = size_t(width) * height;
+        std::vector<uint16_t> indices(n_pixels);
+        for (size_t i = 0; i < n_pixels; ++i) indices[i] = i;
+
+        for (unsigned int rotation : {0u, 90u, 180u, 270u}) {
+            for (bool flipX : {false, true}) {
+                for (bool flipY : {false, true}) {
+                    const kernels::Orientation orientation =
+                          kernels::getOrientation(width, height, flipX, flipY, rotation);
+                    std::vector<uint16_t> oriented(n_pixels);
+                    kernels::orientImage(indices.data(), width, height, 2, orientation, oriented.data());
+                    const int outW = orientation.transposed ? height : width;
+                    const int outH = orientation.transposed ? width : height;
+
+                    // A region in the corner of the oriented image, and one within it
+                    for (const auto& [x0, y0] : {std::make_pair(0, 0), std::make_pair(outW / 3, outH / 4)}) {
+                        const int w0 = std::max(1, outW / 2);
+                        const int h0 = std::max(1, outH / 3);
+                        int x = x0, y = y0, regionWidth = w0, regionHeight = h0;
+                        kernels::sourceRegion(orientation, width, height, x, y, regionWidth, regionHeight);
+                        ASSERT_EQ(w0 * h0, regionWidth * regionHeight);
+                        // The source pixels of the oriented region all lie within the source region
+                        for (int row = y0; row < y0 + h0; ++row) {
+                            for (int col = x0; col < x0 + w0; ++col) {
+                                const int index = oriented[size_t(row) * outW + col];
+                                const int sourceX = index % width;
+                                const int sourceY = index / width;
+                                ASSERT_TRUE(sourceX >= x && sourceX < x + regionWidth && sourceY >= y &&
+                                            sourceY < y + regionHeight)
+                                      << width << "x" << height << " rotation " << rotation << " flip " << flipX
+                                      << flipY << " pixel " << row << "," << col;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+TEST(ImageKernels, testOrientYuv422) {
+    const std::vector<std::pair<int, int>> sizes = {{1, 1}, {8, 3}, {7, 4}, {36, 70}};
+    for (const auto& [width, height] : sizes) {
+        const size_t n_pixels = size_t(width) * height;
+        const std::vector<uint8_t> luma = randomData(n_pixels);
+
+        for (bool uyvy : {false, true}) {
+            // The same chroma in all the pairs, thus it is unchanged by the resampling
+            std::vector<uint8_t> yuv(2 * n_pixels);
+            for (int y = 0; y < height; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    const size_t index = size_t(y) * width + x;
+                    yuv[2 * index + (uyvy ? 1 : 0)] = luma[index];
+                    yuv[2 * index + (uyvy ? 0 : 1)] = (x % 2 == 0) ? 60 : 200;
+                }
+            }
+
+            for (unsigned int rotation : {0u, 90u, 180u, 270u}) {
+                for (bool flipX : {false, true}) {
+                    const kernels::Orientation orientation =
+                          kernels::getOrientation(width, height, flipX, false, rotation);
+                    std::vector<uint8_t> oriented(2 * n_pixels);
+                    kernels::orientYuv422(yuv.data(), width, height, uyvy, orientation, oriented.data());
+                    std::vector<uint8_t> expectedLuma(n_pixels);
+                    kernels::orientImage(luma.data(), width, height, 1, orientation, expectedLuma.data());
+
+                    const int outWidth = orientation.transposed ? height : width;
+                    for (size_t index = 0; index < n_pixels; ++index) {
+                        const int x = index % outWidth;
+                        ASSERT_EQ(expectedLuma[index], oriented[2 * index + (uyvy ? 1 : 0)])
+                              << width << "x" << height << " rotation " << rotation << " flip " << flipX;
+                        // The chroma of the pairs, if all the rows have pairs only
+                        if (width % 2 == 0 && outWidth % 2 == 0) {
+                            ASSERT_EQ(x % 2 == 0 ? 60 : 200, oriented[2 * index + (uyvy ? 0 : 1)]) << index;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+TEST(ImageKernels, testYuvToRgb) {
+    const kernels::SimdLevel best = kernels::detectSimdLevel();
+    const kernels::YuvKernels& scalarKernels = kernels::getYuvKernels(kernels::SimdLevel::SCALAR);
+
+    // Sizes exercising the SIMD main loops and the scalar remainders, including an odd number of pixels
+    for (size_t n_pixels : {1, 2, 7, 8, 15, 16, 33, 100, 1001}) {
+        const std::vector<uint8_t> data = randomData(2 * n_pixels);
+
+        for (bool uyvy : {false, true}) {
+            const kernels::YuvFunction kernels::YuvKernels::*kernel =
+                  uyvy ? &kernels::YuvKernels::uyvyToRgb : &kernels::YuvKernels::yuyvToRgb;
+            std::vector<uint8_t> expected(3 * n_pixels);
+            (scalarKernels.*kernel)(data.data(), n_pixels, expected.data());
+
+            // The fixed-point conversion stays within 1 of the full-range BT.601 one
+            for (size_t i = 0; i + 1 < n_pixels; ++i) {
+                const uint8_t* pair = data.data() + 4 * (i / 2);
+                const double y = uyvy ? pair[1 + 2 * (i % 2)] : pair[2 * (i % 2)];
+                const double u = (uyvy ? pair[0] : pair[1]) - 128.;
+                const double v = (uyvy ? pair[2] : pair[3]) - 128.;
+                const double rgb[3] = {y + 1.402 * v, y - 0.344136 * u - 0.714136 * v, y + 1.772 * u};
+                for (int c = 0; c < 3; ++c) {
+                    EXPECT_NEAR(std::clamp(rgb[c], 0., 255.), expected[3 * i + c], 1.) << i << " " << c;
+                }
+            }
+
+            for (int level = 1; level <= static_cast<int>(best); ++level) {
+                const kernels::YuvKernels& yuvKernels = kernels::getYuvKernels(static_cast<kernels::SimdLevel>(level));
+                // One more pixel to detect writes past the end of the image
+                std::vector<uint8_t> rgb(3 * n_pixels + 3, 0xAA);
+                (yuvKernels.*kernel)(data.data(), n_pixels, rgb.data());
+                EXPECT_EQ(std::vector<uint8_t>(3, 0xAA), std::vector<uint8_t>(rgb.end() - 3, rgb.end()));
+                rgb.resize(3 * n_pixels);
+                EXPECT_EQ(expected, rgb) << kernels::toString(static_cast<kernels::SimdLevel>(level)) << " "
+                                         << n_pixels << (uyvy ? " UYVY" : " YUYV");
+            }
+        }
+    }
+
+    // Grey, white, and red at two intensities
+    const uint8_t yuyv[] = {128, 128, 255, 128, 76, 85, 29, 255};
+    std::vector<uint8_t> rgb(12);
+    kernels::getYuvKernels().yuyvToRgb(yuyv, 4, rgb.data());
+    EXPECT_EQ(std::vector<uint8_t>({128, 128, 128, 255, 255, 255, 254, 0, 0, 207, 0, 0}), rgb);
+}
+
+
+TEST(ImageKernels, testYuvToMono) {
+    const kernels::SimdLevel best = kernels::detectSimdLevel();
+
+    for (size_t n_pixels : {1, 2, 15, 16, 31, 32, 33, 100, 1001}) {
+        const std::vector<uint8_t> data = randomData(2 * n_pixels);
+        for (bool uyvy : {false, true}) {
+            std::vector<uint8_t> expected(n_pixels);
+            for (size_t i = 0; i < n_pixels; ++i) {
+                expected[i] = data[2 * i + (uyvy ? 1 : 0)];
+            }
+
+            for (int level = 0; level <= static_cast<int>(best); ++level) {
+                const kernels::YuvKernels& yuvKernels = kernels::getYuvKernels(static_cast<kernels::SimdLevel>(level));
+                std::vector<uint8_t> mono(n_pixels + 1, 0xAA);
+                (uyvy ? yuvKernels.uyvyToMono : yuvKernels.yuyvToMono)(data.data(), n_pixels, mono.data());
+                EXPECT_EQ(0xAA, mono[n_pixels]);
+                mono.pop_back();
+                EXPECT_EQ(expected, mono) << kernels::toString(static_cast<kernels::SimdLevel>(level)) << " "
+                                          << n_pixels << (uyvy ? " UYVY" : " YUYV");
+            }
+        }
+    }
+}
+
+
+TEST(ImageKernels, testBinKernels) {
+    const kernels::SimdLevel best = kernels::detectSimdLevel();
+    const kernels::BinKernels& scalarKernels = kernels::getBinKernels(kernels::SimdLevel::SCALAR);
+
+    for (size_t n_pixels : {1, 7, 8, 16, 31, 64, 100, 1001}) {
+        const std::vector<uint8_t> data = randomData(2 * n_pixels);
+        std::vector<uint16_t> row16(n_pixels);
+        std::memcpy(row16.data(), data.data(), 2 * n_pixels);
+        // Non-zero sums, as when several rows are accumulated
+        std::vector<uint32_t> initial(n_pixels);
+        for (size_t i = 0; i < n_pixels; ++i) initial[i] = 1000 * i;
+
+        std::vector<uint32_t> expected8 = initial, expected16 = initial;
+        scalarKernels.accumulate8(data.data(), n_pixels, expected8.data());
+        scalarKernels.accumulate16(row16.data(), n_pixels, expected16.data());
+
+        for (int level = 1; level <= static_cast<int>(best); ++level) {
+            const kernels::BinKernels& binKernels = kernels::getBinKernels(static_cast<kernels::SimdLevel>(level));
+            const std::string name = kernels::toString(static_cast<kernels::SimdLevel>(level));
+
+            std::vector<uint32_t> sums8 = initial, sums16 = initial;
+            binKernels.accumulate8(data.data(), n_pixels, sums8.data());
+            binKernels.accumulate16(row16.data(), n_pixels, sums16.data());
+            EXPECT_EQ(expected8, sums8) << name << " " << n_pixels;
+            EXPECT_EQ(expected16, sums16) << name << " " << n_pixels;
+
+            for (int factor : {1, 2, 3, 4, 5, 8}) {
+                const size_t n_binned = n_pixels / factor;
+                std::vector<uint32_t> expected(n_binned), binned(n_binned + 1, 0xAAAAAAAA);
+                scalarKernels.reduce(expected16.data(), n_binned, factor, expected.data());
+                binKernels.reduce(expected16.data(), n_binned, factor, binned.data());
+                EXPECT_EQ(0xAAAAAAAA, binned[n_binned]) << name;
+                binned.pop_back();
+                EXPECT_EQ(expected, binned) << name << " " << n_pixels << " factor " << factor;
+            }
+        }
+    }
+}
+
+
+TEST(ImageKernels, testBinImage) {
+    // Sizes which are not multiples of the binning factors
+    for (const auto& [width, height] : std::vector<std::pair<int, int>>{{1, 1}, {8, 6}, {37, 11}, {130, 67}}) {
+        const size_t n_pixels = size_t(width) * height;
+        const std::vector<uint8_t> data = randomData(2 * n_pixels);
+        std::vector<uint16_t> image16(n_pixels);
+        std::memcpy(image16.data(), data.data(), 2 * n_pixels);
+
+        for (const auto& [binX, binY] : std::vector<std::pair<int, int>>{{1, 1}, {2, 2}, {4, 1}, {1, 3}, {3, 5}}) {
+            const int binnedWidth = width / binX, binnedHeight = height / binY;
+            const size_t n_binned = size_t(binnedWidth) * binnedHeight;
+
+            // Reference: sum of each bin
+            std::vector<uint32_t> expected8(n_binned), expected16(n_binned);
+            for (int y = 0; y < binnedHeight; ++y) {
+                for (int x = 0; x < binnedWidth; ++x) {
+                    for (int dy = 0; dy < binY; ++dy) {
+                        for (int dx = 0; dx < binX; ++dx) {
+                            const size_t index = size_t(y * binY + dy) * width + x * binX + dx;
+                            expected8[size_t(y) * binnedWidth + x] += data[index];
+                            expected16[size_t(y) * binnedWidth + x] += image16[index];
+                        }
+                    }
+                }
+            }
+
+            // Computed in two stripes
+            std::vector<uint32_t> sum8(n_binned), sum16(n_binned);
+            std::vector<uint8_t> average8(n_binned);
+            std::vector<uint16_t> average16(n_binned);
+            const int middle = binnedHeight / 2;
+            for (const auto& [rowBegin, rowEnd] : {std::make_pair(0, middle), std::make_pair(middle, binnedHeight)}) {
+                kernels::binSum(data.data(), width, binX, binY, rowBegin, rowEnd, sum8.data());
+                kernels::binSum(image16.data(), width, binX, binY, rowBegin, rowEnd, sum16.data());
+                kernels::binAverage(data.data(), width, binX, binY, rowBegin, rowEnd, average8.data());
+                kernels::binAverage(image16.data(), width, binX, binY, rowBegin, rowEnd, average16.data());
+            }
+
+            EXPECT_EQ(expected8, sum8) << width << "x" << height << " bin " << binX << "x" << binY;
+            EXPECT_EQ(expected16, sum16) << width << "x" << height << " bin " << binX << "x" << binY;
+            const uint32_t count = binX * binY;
+            for (size_t i = 0; i < n_binned; ++i) {
+                ASSERT_EQ((expected8[i] + count / 2) / count, average8[i]) << i;
+                ASSERT_EQ((expected16[i] + count / 2) / count, average16[i]) << i;
+            }
+        }
+    }
+}
+
+
+TEST(ImageKernels, testDownscaleImage) {
+    const int width = 37, height = 22;
+    const std::vector<uint8_t> data = randomData(2 * 3 * size_t(width) * height);
+    std::vector<uint16_t> image16(3 * size_t(width) * height);
+    std::memcpy(image16.data(), data.data(), 2 * image16.size());
+    for (uint16_t& pixel : image16) pixel &= 0x0FFF; // 12-bit pixels
+
+    for (int channels : {1, 3}) {
+        for (int factor : {1, 2, 3, 4, 8}) {
+            const int outWidth = width / factor, outHeight = height / factor;
+            const size_t outSize = size_t(outWidth) * outHeight * channels;
+            const uint64_t count = factor * factor;
+
+            // Reference: rounded mean of each block, channel by channel
+            std::vector<uint16_t> expected(outSize);
+            for (int y = 0; y < outHeight; ++y) {
+                for (int x = 0; x < outWidth; ++x) {
+                    for (int c = 0; c < channels; ++c) {
+                        uint64_t sum = 0;
+                        for (int dy = 0; dy < factor; ++dy) {
+                            for (int dx = 0; dx < factor; ++dx) {
+                                sum += image16[(size_t(y * factor + dy) * width + x * factor + dx) * channels + c];
+                            }
+                        }
+                        expected[(size_t(y) * outWidth + x) * channels + c] = (sum + count / 2) / count;
+                    }
+                }
+            }
+
+            std::vector<uint16_t> downscaled(outSize + 1, 0xFFFF);
+            kernels::downscaleImage(image16.data(), width, height, channels, factor, 0, downscaled.data());
+            EXPECT_EQ(0xFFFF, downscaled[outSize]);
+            downscaled.pop_back();
+            EXPECT_EQ(expected, downscaled) << channels << " channels, factor " << factor;
+
+            // Converted to 8 bits
+            std::vector<uint8_t> downscaled8(outSize);
+            kernels::downscaleImage(image16.data(), width, height, channels, factor, 4, downscaled8.data());
+            for (size_t i = 0; i < outSize; ++i) {
+                ASSERT_EQ(expected[i] >> 4, downscaled8[i]) << i;
+            }
+
+            // 32-bit pixels, e.g. binned sums
+            const std::vector<uint32_t> image32(image16.begin(), image16.end());
+            std::vector<uint32_t> downscaled32(outSize);
+            kernels::downscaleImage(image32.data(), width, height, channels, factor, 0, downscaled32.data());
+            EXPECT_EQ(std::vector<uint32_t>(expected.begin(), expected.end()), downscaled32);
+        }
+    }
+}
+
+
+TEST(ImageKernels, testEwma) {
+    const kernels::SimdLevel best = kernels::detectSimdLevel();
+    const kernels::AccumulateKernels& scalarKernels = kernels::getAccumulateKernels(kernels::SimdLevel::SCALAR);
+
+    for (size_t n_pixels : {1, 7, 8, 16, 31, 64, 100, 1001}) {
+        const std::vector<uint8_t> data = randomData(2 * n_pixels);
+        std::vector<uint16_t> pixels16(n_pixels);
+        std::memcpy(pixels16.data(), data.data(), 2 * n_pixels);
+        std::vector<float> initial(n_pixels);
+        for (size_t i = 0; i < n_pixels; ++i) initial[i] = 0.5f * i;
+
+        std::vector<float> expected8 = initial, expected16 = initial;
+        scalarKernels.ewma8(data.data(), n_pixels, 0.1f, expected8.data());
+        scalarKernels.ewma16(pixels16.data(), n_pixels, 0.1f, expected16.data());
+        EXPECT_FLOAT_EQ(initial[0] + 0.1f * (data[0] - initial[0]), expected8[0]);
+
+        for (int level = 1; level <= static_cast<int>(best); ++level) {
+            const kernels::AccumulateKernels& accumulateKernels =
+                  kernels::getAccumulateKernels(static_cast<kernels::SimdLevel>(level));
+            const std::string name = kernels::toString(static_cast<kernels::SimdLevel>(level));
+
+            // Same operations in the same order, thus the same results
+            std::vector<float> average8 = initial, average16 = initial;
+            accumulateKernels.ewma8(data.data(), n_pixels, 0.1f, average8.data());
+            accumulateKernels.ewma16(pixels16.data(), n_pixels, 0.1f, average16.data());
+            EXPECT_EQ(expected8, average8) << name << " " << n_pixels;
+            EXPECT_EQ(expected16, average16) << name << " " << n_pixels;
+        }
+    }
+}
+
+
+TEST(ImageKernels, testAccumulateSum32) {
+    // The sums of 32-bit pixels, e.g. binned sums, do not overflow
+    const std::vector<uint32_t> pixels = {0u, 1u, 0xFFFFFFFFu};
+    std::vector<uint64_t> sums(pixels.size(), 0);
+    for (int i = 0; i < 3; ++i) {
+        kernels::accumulateSum(pixels.data(), pixels.size(), sums.data());
+    }
+    EXPECT_EQ((std::vector<uint64_t>{0ull, 3ull, 3ull * 0xFFFFFFFFull}), sums);
+}
+
+
+TEST(ImageKernels, testCorrection) {
+    const kernels::SimdLevel best = kernels::detectSimdLevel();
+    const kernels::CorrectionKernels& scalarKernels = kernels::getCorrectionKernels(kernels::SimdLevel::SCALAR);
+
+    for (size_t n_pixels : {1, 7, 8, 16, 31, 64, 100, 1001}) {
+        const std::vector<uint8_t> data = randomData(2 * n_pixels);
+        std::vector<uint16_t> pixels16(n_pixels);
+        std::memcpy(pixels16.data(), data.data(), 2 * n_pixels);
+        for (uint16_t& pixel : pixels16) pixel &= 0x0FFF; // 12-bit pixels
+        // Darks above some of the pixels, and gains pushing others above the clamping value
+        std::vector<float> dark(n_pixels), gain(n_pixels);
+        for (size_t i = 0; i < n_pixels; ++i) {
+            dark[i] = 20.f + 0.25f * (i % 200);
+            gain[i] = 0.5f + 0.01f * (i % 150);
+        }
+
+        std::vector<uint16_t> expected8(n_pixels), expected16(n_pixels);
+        std::vector<float> expectedFloat8(n_pixels), expectedFloat16(n_pixels);
+        scalarKernels.clamped8(data.data(), n_pixels, dark.data(), gain.data(), 255.f, expected8.data());
+        scalarKernels.clamped16(pixels16.data(), n_pixels, dark.data(), gain.data(), 4095.f, expected16.data());
+        scalarKernels.float8(data.data(), n_pixels, dark.data(), gain.data(), expectedFloat8.data());
+        scalarKernels.float16(pixels16.data(), n_pixels, dark.data(), gain.data(), expectedFloat16.data());
+        for (size_t i = 0; i < n_pixels; ++i) {
+            const float value = (pixels16[i] - dark[i]) * gain[i];
+            EXPECT_FLOAT_EQ(value, expectedFloat16[i]);
+            EXPECT_EQ(std::lrint(std::clamp(value, 0.f, 4095.f)), expected16[i]) << i;
+        }
+
+        for (int level = 1; level <= static_cast<int>(best); ++level) {
+            const kernels::CorrectionKernels& correctionKernels =
+                  kernels::getCorrectionKernels(static_cast<kernels::SimdLevel>(level));
+            const std::string name =
+                  std::string(kernels::toString(static_cast<kernels::SimdLevel>(level))) + " " +
+                  std::to_string(n_pixels);
+
+            std::vector<uint16_t> corrected8(n_pixels), corrected16(n_pixels);
+            std::vector<float> correctedFloat8(n_pixels), correctedFloat16(n_pixels);
+            correctionKernels.clamped8(data.data(), n_pixels, dark.data(), gain.data(), 255.f, corrected8.data());
+            correctionKernels.clamped16(pixels16.data(), n_pixels, dark.data(), gain.data(), 4095.f,
+                                        corrected16.data());
+            correctionKernels.float8(data.data(), n_pixels, dark.data(), gain.data(), correctedFloat8.data());
+            correctionKernels.float16(pixels16.data(), n_pixels, dark.data(), gain.data(), correctedFloat16.data());
+            EXPECT_EQ(expected8, corrected8) << name;
+            EXPECT_EQ(expected16, corrected16) << name;
+            EXPECT_EQ(expectedFloat8, correctedFloat8) << name;
+            EXPECT_EQ(expectedFloat16, correctedFloat16) << name;
+        }
+    }
+}
+
+
+TEST(ImageKernels, testBitshuffle) {
+    const kernels::SimdLevel best = kernels::detectSimdLevel();
+    const kernels::BitshuffleKernels& scalarKernels = kernels::getBitshuffleKernels(kernels::SimdLevel::SCALAR);
+
+    for (size_t n_pixels : {1, 7, 8, 16, 33, 100, 1001}) {
+        const std::vector<uint8_t> data = randomData(2 * n_pixels);
+        std::vector<uint16_t> pixels16(n_pixels);
+        std::memcpy(pixels16.data(), data.data(), 2 * n_pixels);
+        const size_t bytes = (n_pixels + 7) / 8;
+
+        std::vector<uint8_t> expected8(8 * bytes), expected16(16 * bytes);
+        uint8_t* planes8[8];
+        uint8_t* planes16[16];
+        for (size_t b = 0; b < 16; ++b) {
+            if (b < 8) planes8[b] = expected8.data() + b * bytes;
+            planes16[b] = expected16.data() + b * bytes;
+        }
+        scalarKernels.pixels8(data.data(), n_pixels, planes8);
+        scalarKernels.pixels16(pixels16.data(), n_pixels, planes16);
+        for (size_t i = 0; i < n_pixels; ++i) {
+            EXPECT_EQ((pixels16[i] >> 11) & 1, (expected16[11 * bytes + i / 8] >> (i % 8)) & 1) << i;
+        }
+
+        for (int level = 1; level <= static_cast<int>(best); ++level) {
+            const kernels::BitshuffleKernels& bitshuffleKernels =
+                  kernels::getBitshuffleKernels(static_cast<kernels::SimdLevel>(level));
+            std::vector<uint8_t> shuffled8(8 * bytes), shuffled16(16 * bytes);
+            for (size_t b = 0; b < 16; ++b) {
+                if (b < 8) planes8[b] = shuffled8.data() + b * bytes;
+                planes16[b] = shuffled16.data() + b * bytes;
+            }
+            bitshuffleKernels.pixels8(data.data(), n_pixels, planes8);
+            bitshuffleKernels.pixels16(pixels16.data(), n_pixels, planes16);
+            EXPECT_EQ(expected8, shuffled8) << kernels::toString(static_cast<kernels::SimdLevel>(level)) << " "
+                                            << n_pixels;
+            EXPECT_EQ(expected16, shuffled16) << kernels::toString(static_cast<kernels::SimdLevel>(level)) << " "
+                                              << n_pixels;
+        }
+    }
+}
+
+
+TEST(ImageKernels, testStatistics) {
+    const kernels::SimdLevel best = kernels::detectSimdLevel();
+
+    // Sizes exercising the vector loops, the remainders and several blocks
+    for (size_t n_pixels : {1, 15, 33, 4096, 5000, 12345}) {
+        const std::vector<uint8_t> data = randomData(2 * n_pixels);
+        std::vector<uint16_t> pixels16(n_pixels);
+        std::memcpy(pixels16.data(), data.data(), 2 * n_pixels);
+        for (uint16_t& pixel : pixels16) pixel &= 0x0FFF; // 12-bit pixels
+        const std::vector<uint32_t> pixels32(pixels16.begin(), pixels16.end());
+
+        // Reference
+        kernels::PixelStatistics expected8, expected16;
+        for (size_t i = 0; i < n_pixels; ++i) {
+            for (auto [statistics, value, saturation, shift] :
+                 {std::make_tuple(&expected8, uint32_t(data[i]), 250u, 2), //
+                  std::make_tuple(&expected16, uint32_t(pixels16[i]), 4000u, 6)}) {
+                statistics->min = std::min(statistics->min, value);
+                statistics->max = std::max(statistics->max, value);
+                statistics->sum += value;
+                statistics->saturated += (value >= saturation);
+                ++statistics->histogram[value >> shift];
+            }
+        }
+        expected8.count = expected16.count = n_pixels;
+
+        const auto compare = [](const kernels::PixelStatistics& expected, const kernels::PixelStatistics& actual,
+                                const std::string& name) {
+            EXPECT_EQ(expected.count, actual.count) << name;
+            EXPECT_EQ(expected.sum, actual.sum) << name;
+            EXPECT_EQ(expected.min, actual.min) << name;
+            EXPECT_EQ(expected.max, actual.max) << name;
+            EXPECT_EQ(expected.saturated, actual.saturated) << name;
+            EXPECT_TRUE(std::equal(expected.histogram, expected.histogram + kernels::HISTOGRAM_BINS,
+                                   actual.histogram))
+                  << name;
+        };
+
+        for (int level = 0; level <= static_cast<int>(best); ++level) {
+            const kernels::StatisticsKernels& statisticsKernels =
+                  kernels::getStatisticsKernels(static_cast<kernels::SimdLevel>(level));
+            const std::string name =
+                  std::string(kernels::toString(static_cast<kernels::SimdLevel>(level))) + " " +
+                  std::to_string(n_pixels);
+
+            kernels::PixelStatistics statistics8, statistics16;
+            statisticsKernels.pixels8(data.data(), n_pixels, 250, 2, statistics8);
+            statisticsKernels.pixels16(pixels16.data(), n_pixels, 4000, 6, statistics16);
+            compare(expected8, statistics8, name);
+            compare(expected16, statistics16, name);
+        }
+
+        // 32-bit pixels, and statistics merged from two parts
+        kernels::PixelStatistics statistics32, part;
+        const size_t middle = n_pixels / 2;
+        kernels::accumulateStatistics(pixels32.data(), middle, 4000, 6, statistics32);
+        kernels::accumulateStatistics(pixels32.data() + middle, n_pixels - middle, 4000, 6, part);
+        statistics32.merge(part);
+        compare(expected16, statistics32, "32-bit");
+
+        // The saturation is not reached
+        kernels::PixelStatistics unsaturated;
+        kernels::accumulateStatistics(pixels16.data(), n_pixels, 0x10000, 6, unsaturated);
+        EXPECT_EQ(0u, unsaturated.saturated);
+    }
+}
+
+
+TEST(ImageKernels, testUnpackStatistics) {
+    // The unpacked pixels and their statistics are the same as when done separately
+    const size_t n_pixels = 3 * 4096 + 100;
+    const std::vector<uint8_t> data = randomData(3 * n_pixels / 2);
+    const kernels::UnpackKernels& unpackKernels = kernels::getUnpackKernels();
+
+    std::vector<uint16_t> expected(n_pixels);
+    unpackKernels.mono12p(data.data(), n_pixels, expected.data());
+    kernels::PixelStatistics expectedStatistics;
+    kernels::accumulateStatistics(expected.data(), n_pixels, 4095, 6, expectedStatistics);
+
+    std::vector<uint16_t> unpacked(n_pixels);
+    kernels::PixelStatistics statistics;
+    kernels::unpackStatistics(unpackKernels.mono12p, 12, data.data(), n_pixels, 4095, 6, unpacked.data(),
+                              statistics);
+    EXPECT_EQ(expected, unpacked);
+    EXPECT_EQ(expectedStatistics.count, statistics.count);
+    EXPECT_EQ(expectedStatistics.sum, statistics.sum);
+    EXPECT_EQ(expectedStatistics.min, statistics.min);
+    EXPECT_EQ(expectedStatistics.max, statistics.max);
+    EXPECT_EQ(expectedStatistics.saturated, statistics.saturated);
+    EXPECT_TRUE(std::equal(expectedStatistics.histogram, expectedStatistics.histogram + kernels::HISTOGRAM_BINS,
+                           statistics.histogram));
+}
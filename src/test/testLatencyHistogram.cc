@@ -0,0 +1,80 @@
+/*
+ * Author: parenti
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "LatencyHistogram.hh"
+
+using namespace karabo;
+
+TEST(LatencyHistogram, testBuckets) {
+    // The buckets are contiguous, and each value falls within the bounds of its bucket
+    for (size_t i = 1; i < LatencyHistogram::BUCKETS; ++i) {
+        const uint64_t lower = LatencyHistogram::bucketUpperBound(i - 1) + 1;
+        const uint64_t upper = LatencyHistogram::bucketUpperBound(i);
+        ASSERT_LE(lower, upper) << i;
+        ASSERT_EQ(i, LatencyHistogram::bucketIndex(lower)) << i;
+        ASSERT_EQ(i, LatencyHistogram::bucketIndex(upper)) << i;
+        // The relative resolution, the small values have a bucket each
+        const uint64_t width = upper - lower + 1;
+        ASSERT_TRUE(width == 1 || double(width) / lower <= 2. / LatencyHistogram::SUB_BUCKETS) << i;
+    }
+    EXPECT_EQ(LatencyHistogram::MAX_VALUE, LatencyHistogram::bucketUpperBound(LatencyHistogram::BUCKETS - 1));
+    EXPECT_EQ(LatencyHistogram::BUCKETS - 1, LatencyHistogram::bucketIndex(~0ull));
+}
+
+
+TEST(LatencyHistogram, testQuantiles) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(0u, histogram.quantile(0.5));
+
+    std::mt19937 generator(42);
+    std::lognormal_distribution<double> distribution(8., 1.);
+    std::vector<uint64_t> values(100000);
+    for (uint64_t& value : values) {
+        value = distribution(generator);
+        histogram.record(value);
+    }
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(values.size(), histogram.count());
+    EXPECT_EQ(values.back(), histogram.max());
+
+    for (double q : {0., 0.5, 0.9, 0.99, 0.999, 1.}) {
+        const uint64_t exact = values[std::max<size_t>(1, std::ceil(q * values.size())) - 1];
+        const uint64_t estimate = histogram.quantile(q);
+        EXPECT_GE(estimate, exact) << q;
+        EXPECT_LE(estimate, exact + exact * 2. / LatencyHistogram::SUB_BUCKETS) << q;
+    }
+}
+
+
+TEST(LatencyHistogram, testWindow) {
+    // A sliding window, as the sum of the latest histograms
+    LatencyHistogram first, second, window;
+    for (uint64_t value = 1; value <= 100; ++value) first.record(1000 + value);
+    for (uint64_t value = 1; value <= 100; ++value) second.record(value);
+    window.add(first);
+    window.add(second);
+    EXPECT_EQ(200u, window.count());
+    EXPECT_EQ(1100u, window.max());
+
+    window.subtract(first);
+    EXPECT_EQ(100u, window.count());
+    EXPECT_EQ(100u, window.max());
+    EXPECT_EQ(50u, window.quantile(0.5));
+
+    const auto buckets = window.buckets();
+    ASSERT_EQ(100u, buckets.size());
+    EXPECT_EQ(1u, buckets.front().first);
+    EXPECT_EQ(1u, buckets.front().second);
+}
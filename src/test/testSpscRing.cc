@@ -0,0 +1,75 @@
+/*
+ * Author: parenti
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "SpscRing.hh"
+
+using namespace karabo;
+
+TEST(SpscRing, testCapacity) {
+    EXPECT_EQ(8u, SpscRing<int>(5).capacity());
+    EXPECT_EQ(8u, SpscRing<int>(8).capacity());
+
+    SpscRing<int> ring(4);
+    int value = -1;
+    EXPECT_FALSE(ring.try_pop(value));
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.try_push(i));
+    }
+    EXPECT_FALSE(ring.try_push(4)); // Full
+    EXPECT_EQ(4u, ring.depth());
+    EXPECT_EQ(4u, ring.highWaterMark());
+
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(ring.try_pop(value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_FALSE(ring.try_pop(value));
+    EXPECT_EQ(0u, ring.depth());
+    EXPECT_EQ(4u, ring.highWaterMark());
+    ring.resetHighWaterMark();
+    EXPECT_EQ(0u, ring.highWaterMark());
+
+    // The indices wrap around the slots
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(ring.try_push(i));
+        ASSERT_TRUE(ring.try_pop(value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_EQ(1u, ring.highWaterMark());
+}
+
+
+TEST(SpscRing, testThreads) {
+    // The consumer sleeps in wait(), the elements are received in order
+    const int n_values = 100000;
+    SpscRing<int> ring(16);
+    std::thread consumer([&ring]() {
+        int expected = 0;
+        while (expected < n_values) {
+            int value;
+            if (!ring.try_pop(value)) {
+                ring.wait();
+                continue;
+            }
+            ASSERT_EQ(expected, value);
+            ++expected;
+        }
+    });
+    for (int i = 0; i < n_values; ++i) {
+        while (!ring.try_push(i)) {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+    EXPECT_EQ(0u, ring.depth());
+    EXPECT_LE(ring.highWaterMark(), ring.capacity());
+}
@@ -0,0 +1,90 @@
+/*
+ * Author: parenti
+ *
+ * Created on October 16, 2026
+ *
+ * Copyright (c) European XFEL GmbH Schenefeld. All rights reserved.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "WorkerPool.hh"
+
+using namespace karabo;
+
+TEST(WorkerPool, testPost) {
+    std::atomic<int> done(0);
+    {
+        WorkerPool pool(3);
+        EXPECT_EQ(3u, pool.size());
+        for (int i = 0; i < 100; ++i) {
+            pool.post([&done]() { ++done; });
+        }
+        // The pending tasks are executed before the threads are joined
+    }
+    EXPECT_EQ(100, done.load());
+
+    // At least one thread
+    EXPECT_EQ(1u, WorkerPool(0).size());
+}
+
+
+TEST(WorkerPool, testParallelFor) {
+    for (unsigned int n_threads : {1u, 3u, 6u, 30u}) {
+        WorkerPool pool(n_threads);
+        for (size_t n : {0ul, 1ul, 7ul, 33ul, 513ul, 1000ul}) {
+            for (size_t min_chunk : {1ul, 4ul, 16ul, 2000ul}) {
+                // Consecutive, non-empty ranges covering [0, n)
+                std::mutex ranges_mtx;
+                std::vector<std::pair<size_t, size_t>> ranges;
+                pool.parallel_for(n, min_chunk, [&](size_t begin, size_t end) {
+                    std::lock_guard<std::mutex> lock(ranges_mtx);
+                    ranges.emplace_back(begin, end);
+                });
+                std::sort(ranges.begin(), ranges.end());
+                ASSERT_FALSE(ranges.empty());
+                size_t covered = 0;
+                for (const auto& [begin, end] : ranges) {
+                    ASSERT_EQ(covered, begin) << n << " " << min_chunk << " " << n_threads;
+                    ASSERT_TRUE(end > begin || n == 0) << n << " " << min_chunk << " " << n_threads;
+                    // The minimum size is kept, unless there is less to do
+                    ASSERT_GE(end - begin, std::min(n, min_chunk)) << n << " " << min_chunk << " " << n_threads;
+                    covered = end;
+                }
+                EXPECT_EQ(n, covered) << n << " " << min_chunk << " " << n_threads;
+                EXPECT_LE(ranges.size(), n_threads + 1) << n << " " << min_chunk << " " << n_threads;
+            }
+        }
+    }
+}
+
+
+TEST(WorkerPool, testDestroyedByTask) {
+    // A task may release the last reference to the pool, its thread is then not joined
+    std::atomic<int> done(0);
+    auto pool = std::make_shared<WorkerPool>(2);
+    for (int i = 0; i < 10; ++i) {
+        pool->post([&done]() { ++done; });
+    }
+    pool->post([pool, &done]() mutable {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        pool.reset();
+        ++done;
+    });
+    pool.reset();
+
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (done < 11 && std::chrono::steady_clock::now() < timeout) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(11, done.load());
+}